@@ -516,6 +516,9 @@ DEF_ATTR(RCACHE_COUNT, rcache_count, QUANTITY, 257,
          "Number of entries in root page cache.")
 DEF_ATTR(RCACHE_PGSZ, rcache_pgsz, BYTES, 4096,
          "Size of pages in root page cache.")
+DEF_ATTR(RCACHE_LEVELS, rcache_levels, QUANTITY, 3,
+         "Number of levels from the root of a b-tree kept in the root page "
+         "cache.")
 DEF_ATTR(DEADLK_PRIORITY_BUMP_ON_FSTBLK, deadlk_priority_bump_on_fstblk,
          QUANTITY, 5, NULL)
 DEF_ATTR(FSTBLK_MINQ, fstblk_minq, QUANTITY, 262144, NULL)
@@ -525,9 +528,14 @@ DEF_ATTR(
 DEF_ATTR(FDB_SQLSTATS_CACHE_LOCK_WAITTIME_NSEC,
          fdb_sqlstats_cache_waittime_nsec, QUANTITY, 1000, NULL)
 DEF_ATTR(PRIVATE_BLKSEQ_CACHESZ, private_blkseq_cachesz, BYTES, 4194304,
-         "Cache size of the blkseq table.")
+         "Deprecated and unused; blkseqs are kept in memory, bounded by "
+         "private_blkseq_maxmem.")
 DEF_ATTR(PRIVATE_BLKSEQ_MAXAGE, private_blkseq_maxage, SECS, 600,
          "Maximum time in seconds to let 'old' transactions live.")
+DEF_ATTR(PRIVATE_BLKSEQ_MAXMEM, private_blkseq_maxmem, BYTES, 1073741824,
+         "Memory cap for the blkseq tables, split evenly across the stripes. "
+         "A stripe over its share drops its older generation early. 0 for no "
+         "cap.")
 DEF_ATTR(PRIVATE_BLKSEQ_MAXTRAVERSE, private_blkseq_maxtraverse, QUANTITY, 4,
          NULL)
 DEF_ATTR_2(PRIVATE_BLKSEQ_STRIPES, private_blkseq_stripes, QUANTITY, 8,
@@ -668,6 +676,16 @@ DEF_ATTR(TEST_IO_TIME, test_io_time, SECS, 10, "Check I/O in watchdog this often
 DEF_ATTR(TEST_SQL_TIME, test_sql_time, SECS, 0, "Check SQL in watchdog this often")
 DEF_ATTR(DELETE_OLD_FILE_DEBUG, delete_old_file_debug, BOOLEAN, 0,
          "Spew debug info about deleting old files.")
+DEF_ATTR(IX_BLOOM_FILTERS, ix_bloom_filters, BOOLEAN, 0,
+         "Keep Bloom filters of the keys of unique indexes on the master, "
+         "so unique checks can skip the b-tree for keys that are not there.")
+DEF_ATTR(IX_BLOOM_BITS_PER_KEY, ix_bloom_bits_per_key, QUANTITY, 10,
+         "Bits per key in index Bloom filters.")
+DEF_ATTR(IX_BLOOM_MAX_MB, ix_bloom_max_mb, QUANTITY, 256,
+         "Largest index Bloom filter to build, in megabytes.")
+DEF_ATTR(TAG_CONVERT_PROGRAMS, tag_convert_programs, BOOLEAN, 1,
+         "Form keys and upgrade old record versions with cached per-schema "
+         "conversion programs.")
 
 /*
   BDB_ATTR_REPTIMEOUT
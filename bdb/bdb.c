@@ -45,6 +45,7 @@
 #include "thread_stats.h"
 #include "logmsg.h"
 #include "sys_wrap.h"
+#include "comdb2_atomic.h"
 
 extern void berkdb_dumptrans(DB_ENV *);
 extern int __db_panic(DB_ENV *dbenv, int err);
@@ -283,6 +284,30 @@ void bdb_get_cache_stats(bdb_state_type *bdb_state, uint64_t *hits,
     free(mpool_stats);
 }
 
+static void add_readahead_stats(DB *dbp, uint64_t *pages, uint64_t *hits,
+                                uint64_t *wasted)
+{
+    if (dbp == NULL)
+        return;
+    *pages += ATOMIC_LOAD64(dbp->pf_pages);
+    *hits += ATOMIC_LOAD64(dbp->pf_hits);
+    *wasted += ATOMIC_LOAD64(dbp->pf_wasted);
+}
+
+/* Cursor read ahead counters, summed over all the files of a table */
+void bdb_get_readahead_stats(bdb_state_type *bdb_state, uint64_t *pages,
+                             uint64_t *hits, uint64_t *wasted)
+{
+    *pages = *hits = *wasted = 0;
+    for (int dtanum = 0; dtanum < bdb_state->numdtafiles; dtanum++) {
+        for (int stripe = 0; stripe < MAXDTASTRIPE; stripe++)
+            add_readahead_stats(bdb_state->dbp_data[dtanum][stripe], pages,
+                                hits, wasted);
+    }
+    for (int ixnum = 0; ixnum < bdb_state->numix; ixnum++)
+        add_readahead_stats(bdb_state->dbp_ix[ixnum], pages, hits, wasted);
+}
+
 void add_dummy(bdb_state_type *bdb_state)
 {
     if (bdb_state->exiting)
@@ -540,8 +540,34 @@ int bdb_handle_reset(bdb_state_type *);
 int bdb_handle_reset_tran(bdb_state_type *, tran_type *, tran_type *);
 int bdb_handle_dbp_add_hash(bdb_state_type *bdb_state, int szkb);
 int bdb_handle_dbp_drop_hash(bdb_state_type *bdb_state);
+/* Allow or stop caching the top levels of an index (or of the data files if
+ * ixnum is -1) in the per-thread root page caches */
+int bdb_handle_dbp_set_rcache(bdb_state_type *bdb_state, int ixnum, int enable);
 int bdb_handle_dbp_hash_stat(bdb_state_type *bdb_state);
+/* Returns 0 if the key is certainly not in unique index ixnum, so a unique
+ * check need not look it up; 1 if it may be */
+int bdb_ix_bloom_may_contain(bdb_state_type *bdb_state, int ixnum,
+                             const void *key, int keylen);
+void bdb_ix_bloom_stats(bdb_state_type *bdb_state);
+void bdb_direct_count_stats(void);
 int bdb_handle_dbp_hash_stat_reset(bdb_state_type *bdb_state);
+
+typedef struct bdb_pgcompact_batch {
+    unsigned int nscanned;  /* pages looked at */
+    unsigned int nsparse;   /* leaf pages at most ff full */
+    unsigned int nfreed;    /* pages merged away, now on the free list */
+    unsigned int last_pgno; /* last page of the file */
+    unsigned int pgsize;
+} bdb_pgcompact_batch;
+
+/* Merge the sparse leaf pages among the next npages pages of a data file
+ * stripe (ixnum < 0) or of index ixnum, starting at *pgno.  *pgno is set to
+ * where the next batch should start, 0 once the whole file was scanned.
+ * Master only.  Fails with BDBERR_READONLY on a replicant and with
+ * BDBERR_BADARGS for btrees that page compaction may not touch. */
+int bdb_pgcompact_scan(bdb_state_type *bdb_state, int dtanum, int stripe,
+                       int ixnum, unsigned int *pgno, unsigned int npages,
+                       double ff, bdb_pgcompact_batch *batch, int *bdberr);
 int bdb_close_temp_state(bdb_state_type *bdb_state, int *bdberr);
 
 /* get file sizes for indexes and data files */
@@ -1246,6 +1272,19 @@ void *bdb_temp_table_data(struct temp_cursor *cursor);
 typedef int (*tmptbl_cmp)(void *, int, const void *, int, const void *);
 void bdb_temp_table_set_cmp_func(struct temp_table *table, tmptbl_cmp);
 
+/* Hash join tables: hash the first nfields of an unpacked key (nonzero rc
+ * if they hold values only the comparator can match), and compare the first
+ * nfields of a packed key against an unpacked key (0 if equal). */
+typedef int (*tmptbl_hash)(void *, int, void *, unsigned int *);
+typedef int (*tmptbl_prefix_cmp)(void *, int, int, const void *, void *);
+/* Turn an empty temptable into the build side of a hash join on the first
+ * nfields of its keys. It spills back to a temptable past maxmem bytes. */
+int bdb_temp_table_set_hash_join(bdb_state_type *bdb_state,
+                                 struct temp_table *tbl, int nfields,
+                                 tmptbl_hash hashfunc,
+                                 tmptbl_prefix_cmp cmpfunc,
+                                 unsigned long long maxmem, int *bdberr);
+
 int bdb_temp_table_find(bdb_state_type *bdb_state, struct temp_cursor *cursor,
                         const void *key, int keylen, void *unpacked,
                         int *bdberr);
@@ -1260,6 +1299,9 @@ void bdb_get_cache_stats(bdb_state_type *bdb_state, uint64_t *hits,
                          uint64_t *misses, uint64_t *reads, uint64_t *writes,
                          uint64_t *thits, uint64_t *tmisses);
 
+void bdb_get_readahead_stats(bdb_state_type *bdb_state, uint64_t *pages,
+                             uint64_t *hits, uint64_t *wasted);
+
 void bdb_stripe_get(bdb_state_type *bdb_state);
 void bdb_stripe_done(bdb_state_type *bdb_state);
 
@@ -47,73 +47,154 @@ static int bdb_blkseq_update_lsn_locked(bdb_state_type *bdb_state,
 
 extern int gbl_is_physical_replicant;
 
-static DB *create_blkseq(bdb_state_type *bdb_state, int stripe, int num)
+/* Blkseqs are kept in memory, in two hash tables per stripe.  New entries go
+ * into the first; every private_blkseq_maxage seconds the second one is
+ * dropped whole and the first one takes its place.  The log records written
+ * by bdb_blkseq_insert make them durable: bdb_recover_blkseq and
+ * bdb_blkseq_recover rebuild the tables from the log.
+ *
+ * The tables of a stripe may use their share of private_blkseq_maxmem.  A
+ * stripe over it rolls early, which shortens the window in which its
+ * replays are caught rather than growing without bound. */
+struct blkseq_entry {
+    int klen;
+    int dlen;
+    uint8_t *key;
+    uint8_t *data;
+    uint8_t buf[1];
+};
+
+static unsigned int blkseq_hashfunc(const void *p, int len)
 {
-    char fname[1024];
-    DB *db;
-    DB_ENV *env;
-    int fd;
-    int rc;
+    const struct blkseq_entry *ent = p;
+    unsigned int hash = 2166136261u;
 
-    env = bdb_state->blkseq_env[stripe];
+    for (int i = 0; i < ent->klen; i++)
+        hash = (hash ^ ent->key[i]) * 16777619u;
+    return hash;
+}
 
-    rc = db_create(&db, env, 0);
-    if (rc) {
-        logmsg(LOGMSG_ERROR, "blkseq create rc %d\n", rc);
+static int blkseq_cmpfunc(const void *p1, const void *p2, int len)
+{
+    const struct blkseq_entry *ent1 = p1;
+    const struct blkseq_entry *ent2 = p2;
+
+    if (ent1->klen != ent2->klen)
+        return ent1->klen - ent2->klen;
+    return memcmp(ent1->key, ent2->key, ent1->klen);
+}
+
+static hash_t *create_blkseq(void)
+{
+    return hash_init_user(blkseq_hashfunc, blkseq_cmpfunc, 0, 0);
+}
+
+static int64_t blkseq_entry_size(int klen, int dlen)
+{
+    /* the entry and, roughly, its hash table node */
+    return offsetof(struct blkseq_entry, buf) + klen + dlen + 4 * sizeof(void *);
+}
+
+static struct blkseq_entry *blkseq_entry_new(void *key, int klen, void *data,
+                                             int dlen)
+{
+    struct blkseq_entry *ent;
+
+    ent = malloc(offsetof(struct blkseq_entry, buf) + klen + dlen);
+    if (ent == NULL)
         return NULL;
+    ent->klen = klen;
+    ent->dlen = dlen;
+    ent->key = ent->buf;
+    ent->data = ent->buf + klen;
+    memcpy(ent->key, key, klen);
+    memcpy(ent->data, data, dlen);
+    return ent;
+}
+
+static int free_blkseq_entry(void *obj, void *arg)
+{
+    free(obj);
+    return 0;
+}
+
+static void destroy_blkseq(hash_t *h)
+{
+    if (h == NULL)
+        return;
+    hash_for(h, free_blkseq_entry, NULL);
+    hash_free(h);
+}
+
+static struct blkseq_entry *blkseq_lookup(hash_t *h, void *key, int klen)
+{
+    struct blkseq_entry k = {.klen = klen, .key = key};
+    return hash_find(h, &k);
+}
+
+/* Returns a malloced copy of the entry's data, like a DB_DBT_REALLOC get */
+static void *blkseq_copy_data(struct blkseq_entry *ent)
+{
+    void *out = malloc(ent->dlen ? ent->dlen : 1);
+    if (out)
+        memcpy(out, ent->data, ent->dlen);
+    return out;
+}
+
+/* Adds an entry to `h`, replacing any entry with the same key if `overwrite`
+ * is set, and keeps `*bytes` the size of the table.  Returns 0, DB_KEYEXIST
+ * or ENOMEM. */
+static int blkseq_put(hash_t *h, int64_t *bytes, void *key, int klen,
+                      void *data, int dlen, int overwrite)
+{
+    struct blkseq_entry *ent, *old;
+
+    if ((old = blkseq_lookup(h, key, klen)) != NULL) {
+        if (!overwrite)
+            return DB_KEYEXIST;
     }
-    snprintf(fname, sizeof(fname), "%s/_blkseq.%d.%d.XXXXXX", bdb_state->tmpdir,
-             stripe, num);
-    fd = mkstemp(fname);
-    if (fd == -1) {
-        logmsg(LOGMSG_ERROR, "mkstemp rc %d %s\n", errno, strerror(errno));
-        return NULL;
+    if ((ent = blkseq_entry_new(key, klen, data, dlen)) == NULL)
+        return ENOMEM;
+    if (old) {
+        hash_del(h, old);
+        *bytes -= blkseq_entry_size(old->klen, old->dlen);
+        free(old);
     }
-    rc = fchmod(fd, 0666);
-    if (rc) {
-        Close(fd);
-        logmsg(LOGMSG_ERROR, "fchmod rc %d %s\n", errno, strerror(errno));
-        return NULL;
+    if (hash_add(h, ent) != 0) {
+        free(ent);
+        return ENOMEM;
     }
-    ctrace("blkseq stripe %d file %d %s\n", stripe, num, fname);
-    rc = db->open(db, NULL, fname, NULL, DB_BTREE, DB_CREATE | DB_TRUNCATE,
-                  0666);
-    /* we don't need the descriptor mkstemp creates, just need a unique name */
-    Close(fd);
-    if (rc) {
-        logmsg(LOGMSG_ERROR, "blkseq->open rc %d\n", rc);
-        return NULL;
+    *bytes += blkseq_entry_size(klen, dlen);
+    return 0;
+}
+
+static void blkseq_del(hash_t *h, int64_t *bytes, void *key, int klen)
+{
+    struct blkseq_entry *ent;
+
+    if ((ent = blkseq_lookup(h, key, klen)) != NULL) {
+        hash_del(h, ent);
+        *bytes -= blkseq_entry_size(ent->klen, ent->dlen);
+        free(ent);
     }
-    return db;
 }
 
 void bdb_cleanup_private_blkseq(bdb_state_type *bdb_state)
 {
     if (!bdb_state) 
         return;
-    for (int stripe = 0; stripe < bdb_state->pvt_blkseq_stripes; stripe++) {
-        DB_ENV *env = bdb_state->blkseq_env[stripe];
-        if (env) {
+    if (bdb_state->blkseq_lk) {
+        for (int stripe = 0; stripe < bdb_state->pvt_blkseq_stripes; stripe++) {
             Pthread_mutex_destroy(&bdb_state->blkseq_lk[stripe]);
             for (int i = 0; i < 2; i++) {
-                DB *to_be_deleted = bdb_state->blkseq[i][stripe];
-                to_be_deleted->close(to_be_deleted, DB_NOSYNC);
+                destroy_blkseq(bdb_state->blkseq[i][stripe]);
+                bdb_state->blkseq[i][stripe] = NULL;
             }
-
-            env->close(env, 0);
-            bdb_state->blkseq_env[stripe] = NULL;
         }
-    }
-
-    if (bdb_state->blkseq_env) {
-        free(bdb_state->blkseq_env);
-        bdb_state->blkseq_env = NULL;
-    }
-
-    if (bdb_state->blkseq_lk) {
         free(bdb_state->blkseq_lk);
         bdb_state->blkseq_lk = NULL;
     }
+
     if (bdb_state->blkseq[0]) {
         free(bdb_state->blkseq[0]);
         bdb_state->blkseq[0] = NULL;
@@ -130,6 +211,10 @@ void bdb_cleanup_private_blkseq(bdb_state_type *bdb_state)
         free(bdb_state->blkseq_last_lsn[1]);
         bdb_state->blkseq_last_lsn[1] = NULL;
     }
+    for (int i = 0; i < 2; i++) {
+        free(bdb_state->blkseq_bytes[i]);
+        bdb_state->blkseq_bytes[i] = NULL;
+    }
 
     if (bdb_state->blkseq_last_roll_time) {
         free(bdb_state->blkseq_last_roll_time);
@@ -139,51 +224,32 @@ void bdb_cleanup_private_blkseq(bdb_state_type *bdb_state)
 
 int bdb_create_private_blkseq(bdb_state_type *bdb_state)
 {
-    DB_ENV *env;
-    int rc, nstripes;
+    int nstripes;
 
     nstripes = bdb_state->pvt_blkseq_stripes =
         bdb_state->attr->private_blkseq_stripes;
 
-    bdb_state->blkseq_env = malloc(nstripes * sizeof(DB_ENV *));
     bdb_state->blkseq_lk = malloc(nstripes * sizeof(pthread_mutex_t));
-    bdb_state->blkseq[0] = malloc(nstripes * sizeof(DB *));
-    bdb_state->blkseq[1] = malloc(nstripes * sizeof(DB *));
+    bdb_state->blkseq[0] = calloc(nstripes, sizeof(hash_t *));
+    bdb_state->blkseq[1] = calloc(nstripes, sizeof(hash_t *));
     bdb_state->blkseq_last_lsn[0] = malloc(nstripes * sizeof(DB_LSN));
     bdb_state->blkseq_last_lsn[1] = malloc(nstripes * sizeof(DB_LSN));
+    bdb_state->blkseq_bytes[0] = calloc(nstripes, sizeof(int64_t));
+    bdb_state->blkseq_bytes[1] = calloc(nstripes, sizeof(int64_t));
     bdb_state->blkseq_last_roll_time = malloc(nstripes * sizeof(time_t));
 
     bdb_state->blkseq_log_list = malloc(nstripes * sizeof(listc_t));
 
     for (int stripe = 0; stripe < nstripes; stripe++) {
-        rc = db_env_create(&env, 0);
-        if (rc) {
-            logmsg(LOGMSG_ERROR, "db_env_create rc %d\n", rc);
-            return rc;
-        }
-
-        bdb_state->blkseq_env[stripe] = env;
-        env->set_errfile(env, stderr);
-
-        rc = env->set_cachesize(env, 0, bdb_state->attr->private_blkseq_cachesz,
-                                1);
-        if (rc) {
-            logmsg(LOGMSG_ERROR, "blkseq->set_cachesize rc %d\n", rc);
-            return rc;
-        }
-        /* no locking around blkseq - we'll lock around them ourselves */
-        rc = env->open(env, bdb_state->tmpdir,
-                       DB_PRIVATE | DB_INIT_MPOOL | DB_CREATE, 0666);
-        if (rc) {
-            logmsg(LOGMSG_ERROR, "blkseq->open rc %d\n", rc);
-            return rc;
-        }
         Pthread_mutex_init(&bdb_state->blkseq_lk[stripe], NULL);
 
         for (int i = 0; i < 2; i++) {
-            bdb_state->blkseq[i][stripe] = create_blkseq(bdb_state, stripe, i);
-            if (bdb_state->blkseq[i][stripe] == NULL)
+            bdb_state->blkseq[i][stripe] = create_blkseq();
+            if (bdb_state->blkseq[i][stripe] == NULL) {
+                logmsg(LOGMSG_ERROR, "%s: can't create blkseq stripe %d\n",
+                       __func__, stripe);
                 return -1;
+            }
             bzero(&bdb_state->blkseq_last_lsn[i][stripe], sizeof(DB_LSN));
         }
         listc_init(&bdb_state->blkseq_log_list[stripe],
@@ -206,6 +272,61 @@ static uint8_t get_stripe(bdb_state_type *bdb_state, uint8_t *bytes, int len)
     return stripe % bdb_state->pvt_blkseq_stripes;
 }
 
+/* Makes the first table of the stripe the second one, behind a new empty
+ * one.  The old second table is returned in *to_be_deleted for the caller
+ * to free once it has released the stripe. */
+static int blkseq_roll_locked(bdb_state_type *bdb_state, uint8_t stripe,
+                              time_t now, hash_t **to_be_deleted)
+{
+    hash_t *newdb;
+
+    if ((newdb = create_blkseq()) == NULL)
+        return BDBERR_MISC;
+
+    *to_be_deleted = bdb_state->blkseq[1][stripe];
+    bdb_state->blkseq[1][stripe] = bdb_state->blkseq[0][stripe];
+    bdb_state->blkseq[0][stripe] = newdb;
+    bdb_state->blkseq_last_lsn[1][stripe] = bdb_state->blkseq_last_lsn[0][stripe];
+    bdb_state->blkseq_bytes[1][stripe] = bdb_state->blkseq_bytes[0][stripe];
+    bdb_state->blkseq_bytes[0][stripe] = 0;
+
+    bdb_state->blkseq_last_roll_time[stripe] = now;
+    return 0;
+}
+
+/* Is the stripe over its share of private_blkseq_maxmem?  The first table
+ * gets half of the share, so that rolling it leaves room for new entries. */
+static int blkseq_over_maxmem(bdb_state_type *bdb_state, uint8_t stripe)
+{
+    int64_t share;
+
+    if (bdb_state->attr->private_blkseq_maxmem <= 0)
+        return 0;
+    share = bdb_state->attr->private_blkseq_maxmem / bdb_state->pvt_blkseq_stripes;
+    return bdb_state->blkseq_bytes[0][stripe] > share / 2 ||
+           bdb_state->blkseq_bytes[0][stripe] +
+                   bdb_state->blkseq_bytes[1][stripe] >
+               share;
+}
+
+/* Rolls the stripe now if it is over its memory share; returns the table to
+ * free after unlocking, if any */
+static hash_t *blkseq_enforce_maxmem_locked(bdb_state_type *bdb_state,
+                                            uint8_t stripe)
+{
+    hash_t *to_be_deleted = NULL;
+
+    if (!blkseq_over_maxmem(bdb_state, stripe))
+        return NULL;
+    if (blkseq_roll_locked(bdb_state, stripe, comdb2_time_epoch(),
+                           &to_be_deleted) == 0)
+        logmsg(LOGMSG_WARN,
+               "blkseq stripe %d over its share of private_blkseq_maxmem, "
+               "rolled early\n",
+               stripe);
+    return to_be_deleted;
+}
+
 /* recovery callback from berkeley (through bdb_apprec) */
 int bdb_blkseq_recover(DB_ENV *dbenv, u_int32_t rectype, llog_blkseq_args *args,
                        DB_LSN *lsn, db_recops op)
@@ -239,6 +360,8 @@ int bdb_blkseq_recover(DB_ENV *dbenv, u_int32_t rectype, llog_blkseq_args *args,
     }
 
     if (op == DB_TXN_APPLY || op == DB_TXN_FORWARD_ROLL) {
+        hash_t *to_be_deleted;
+
         stripe =
             get_stripe(bdb_state, (uint8_t *)args->key.data, args->key.size);
 
@@ -247,15 +370,17 @@ int bdb_blkseq_recover(DB_ENV *dbenv, u_int32_t rectype, llog_blkseq_args *args,
         // printf("%d seconds old %x %x %x ", now - args->time, p[0], p[1],
         // p[2]);
         Pthread_mutex_lock(&bdb_state->blkseq_lk[stripe]);
-        rc = bdb_state->blkseq[0][stripe]->put(bdb_state->blkseq[0][stripe],
-                NULL, &args->key,
-                &args->data, DB_NOOVERWRITE);
+        rc = blkseq_put(bdb_state->blkseq[0][stripe],
+                        &bdb_state->blkseq_bytes[0][stripe], args->key.data,
+                        args->key.size, args->data.data, args->data.size, 0);
         if (rc == 0) {
             bdb_state->blkseq_last_lsn[0][stripe] = *lsn;
             rc = bdb_blkseq_update_lsn_locked(bdb_state, args->time, *lsn,
                     stripe);
         }
+        to_be_deleted = blkseq_enforce_maxmem_locked(bdb_state, stripe);
         Pthread_mutex_unlock(&bdb_state->blkseq_lk[stripe]);
+        destroy_blkseq(to_be_deleted);
         if (rc == DB_KEYEXIST)
             rc = 0;
         if (rc)
@@ -268,14 +393,10 @@ int bdb_blkseq_recover(DB_ENV *dbenv, u_int32_t rectype, llog_blkseq_args *args,
         stripe =
             get_stripe(bdb_state, (uint8_t *)args->key.data, args->key.size);
         Pthread_mutex_lock(&bdb_state->blkseq_lk[stripe]);
-        rc = bdb_state->blkseq[0][stripe]->del(bdb_state->blkseq[0][stripe],
-                                               NULL, &args->key, 0);
-        if (rc == 0 || rc == DB_NOTFOUND) {
-            rc = bdb_state->blkseq[1][stripe]->del(bdb_state->blkseq[1][stripe],
-                                                   NULL, &args->key, 0);
-            if (rc == DB_NOTFOUND)
-                rc = 0;
-        }
+        for (int i = 0; i < 2; i++)
+            blkseq_del(bdb_state->blkseq[i][stripe],
+                       &bdb_state->blkseq_bytes[i][stripe], args->key.data,
+                       args->key.size);
         Pthread_mutex_unlock(&bdb_state->blkseq_lk[stripe]);
     }
     // printf("\n");
@@ -323,33 +444,24 @@ static int bdb_blkseq_update_lsn_locked(bdb_state_type *bdb_state,
 int bdb_blkseq_find(bdb_state_type *bdb_state, tran_type *tran, void *key,
                     int klen, void **dtaout, int *lenout)
 {
-    DBT dkey = {0}, ddata = {0};
-    int rc;
+    struct blkseq_entry *ent = NULL;
+    int rc = IX_NOTFND;
     uint8_t stripe;
-    ddata.flags = DB_DBT_REALLOC;
     if (!bdb_state->attr->private_blkseq_enabled)
         return IX_EMPTY;
     stripe = get_stripe(bdb_state, (uint8_t *)key, klen);
     Pthread_mutex_lock(&bdb_state->blkseq_lk[stripe]);
-    dkey.data = key;
-    dkey.size = klen;
-    for (int i = 0; i < 2; i++) {
-        rc = bdb_state->blkseq[i][stripe]->get(bdb_state->blkseq[i][stripe],
-                                               NULL, &dkey, &ddata, 0);
-        if (rc == 0) {
-            if (dtaout)
-                *dtaout = ddata.data;
-            if (lenout)
-                *lenout = ddata.size;
-            Pthread_mutex_unlock(&bdb_state->blkseq_lk[stripe]);
-            return IX_FND;
-        } else if (rc != DB_NOTFOUND) {
-            Pthread_mutex_unlock(&bdb_state->blkseq_lk[stripe]);
-            return IX_ACCESS;
-        }
+    for (int i = 0; i < 2 && ent == NULL; i++)
+        ent = blkseq_lookup(bdb_state->blkseq[i][stripe], key, klen);
+    if (ent) {
+        rc = IX_FND;
+        if (dtaout && (*dtaout = blkseq_copy_data(ent)) == NULL)
+            rc = IX_ACCESS;
+        if (lenout)
+            *lenout = ent->dlen;
     }
     Pthread_mutex_unlock(&bdb_state->blkseq_lk[stripe]);
-    return IX_NOTFND;
+    return rc;
 }
 
 /*
@@ -359,10 +471,11 @@ int bdb_blkseq_find(bdb_state_type *bdb_state, tran_type *tran, void *key,
 int bdb_blkseq_insert(bdb_state_type *bdb_state, tran_type *tran, void *key, int klen, void *data, int datalen,
                       void **dtaout, int *lenout, int overwrite)
 {
+    struct blkseq_entry *ent;
+    hash_t *to_be_deleted = NULL;
     DBT dkey = {0}, ddata = {0};
     DB_LSN lsn;
     int now;
-    // int *k;
     int rc;
     uint8_t stripe;
     int write_ix = 0;
@@ -370,49 +483,31 @@ int bdb_blkseq_insert(bdb_state_type *bdb_state, tran_type *tran, void *key, int
     if (!bdb_state->attr->private_blkseq_enabled)
         return 0;
 
-    ddata.flags = DB_DBT_REALLOC;
-
-    // k = (int*) key;
-    // printf("inserting %x %x %x\n", k[0], k[1], k[2]);
     stripe = get_stripe(bdb_state, (uint8_t *)key, klen);
 
     Pthread_mutex_lock(&bdb_state->blkseq_lk[stripe]);
-    dkey.data = key;
-    dkey.size = klen;
 
     now = comdb2_time_epoch();
 
     for (int i = 0; i < 2; i++) {
-        rc = bdb_state->blkseq[i][stripe]->get(bdb_state->blkseq[i][stripe],
-                                               NULL, &dkey, &ddata, 0);
-        if (rc == 0) {
-            if (overwrite) {
-                write_ix = i;
-                break;
-            } else {
-                if (dtaout)
-                    *dtaout = ddata.data;
-                if (lenout)
-                    *lenout = ddata.size;
-                Pthread_mutex_unlock(&bdb_state->blkseq_lk[stripe]);
-                return IX_DUP;
-            }
-        } else if (rc != DB_NOTFOUND) {
-            logmsg(LOGMSG_ERROR, "bdb_blkseq_insert stripe %d num %d rc %d\n",
-                    stripe, i, rc);
-            Pthread_mutex_unlock(&bdb_state->blkseq_lk[stripe]);
-            return BDBERR_MISC; /* change this??? IX_DUP == 2 == BDBERR_MISC */
+        if ((ent = blkseq_lookup(bdb_state->blkseq[i][stripe], key, klen)) == NULL)
+            continue;
+        if (overwrite) {
+            write_ix = i;
+            break;
         }
+        if (dtaout)
+            *dtaout = blkseq_copy_data(ent);
+        if (lenout)
+            *lenout = ent->dlen;
+        Pthread_mutex_unlock(&bdb_state->blkseq_lk[stripe]);
+        return IX_DUP;
     }
 
-    /* Only set `ddata' after DB->get() to avoid reallocating a stack variable. */
-    ddata.data = data;
-    ddata.size = datalen;
-
-    /* not found in either tree - put it in the first */
-    int flags = overwrite ? 0 : DB_NOOVERWRITE;
-
-    rc = bdb_state->blkseq[write_ix][stripe]->put(bdb_state->blkseq[write_ix][stripe], NULL, &dkey, &ddata, flags);
+    /* not found in either table - put it in the first */
+    rc = blkseq_put(bdb_state->blkseq[write_ix][stripe],
+                    &bdb_state->blkseq_bytes[write_ix][stripe], key, klen, data,
+                    datalen, overwrite);
     if (rc) {
         logmsg(LOGMSG_ERROR, "blkseq put stripe %d error %d\n", stripe, rc);
         Pthread_mutex_unlock(&bdb_state->blkseq_lk[stripe]);
@@ -422,6 +517,11 @@ int bdb_blkseq_insert(bdb_state_type *bdb_state, tran_type *tran, void *key, int
     /* succeded in updating local table, log the update if transactional
      * (recovery isn't) */
     if (tran) {
+        dkey.data = key;
+        dkey.size = klen;
+        ddata.data = data;
+        ddata.size = datalen;
+
         if (!gbl_is_physical_replicant)
             rc = llog_blkseq_log(bdb_state->dbenv, tran->tid, &lsn, 0, now,
                                  &dkey, &ddata);
@@ -433,9 +533,15 @@ int bdb_blkseq_insert(bdb_state_type *bdb_state, tran_type *tran, void *key, int
             rc = bdb_blkseq_update_lsn_locked(bdb_state, now, lsn, stripe);
             bdb_state->blkseq_last_lsn[0][stripe] = lsn;
         }
+
+        /* Recovery without a transaction runs backwards through the log, so
+         * rolling there would drop the newest entries; the cleaner trims
+         * the stripe once it is up. */
+        to_be_deleted = blkseq_enforce_maxmem_locked(bdb_state, stripe);
     }
 
     Pthread_mutex_unlock(&bdb_state->blkseq_lk[stripe]);
+    destroy_blkseq(to_be_deleted);
     return rc;
 }
 
@@ -443,11 +549,8 @@ int bdb_blkseq_insert(bdb_state_type *bdb_state, tran_type *tran, void *key, int
 static int bdb_blkseq_clean_int(bdb_state_type *bdb_state, uint8_t stripe)
 {
     time_t now, last;
-    DB *to_be_deleted;
-    DB *newdb;
-    char *oldname = NULL;
+    hash_t *to_be_deleted = NULL;
     int rc = 0;
-    DB_ENV *env;
     int start, end;
 
     start = comdb2_time_epochms();
@@ -457,6 +560,15 @@ static int bdb_blkseq_clean_int(bdb_state_type *bdb_state, uint8_t stripe)
 
     last = bdb_state->blkseq_last_roll_time[stripe];
 
+    /* Over the memory cap?  Roll whatever the age. */
+    if (blkseq_over_maxmem(bdb_state, stripe)) {
+        logmsg(LOGMSG_WARN,
+               "blkseq stripe %d over its share of private_blkseq_maxmem, "
+               "rolled early\n",
+               stripe);
+        goto roll;
+    }
+
     /* Not yet time?  Do nothing. */
     if ((now - last) < bdb_state->attr->private_blkseq_maxage)
         goto done;
@@ -497,63 +609,24 @@ static int bdb_blkseq_clean_int(bdb_state_type *bdb_state, uint8_t stripe)
             goto done;
     }
 
-    /* create a new db first */
-    newdb = create_blkseq(bdb_state, stripe, 0);
-    if (newdb == NULL) {
-        rc = BDBERR_MISC;
-        goto done;
-    }
-
-    /* swap pointers */
-    to_be_deleted = bdb_state->blkseq[1][stripe];
-    bdb_state->blkseq[1][stripe] = bdb_state->blkseq[0][stripe];
-    bdb_state->blkseq[0][stripe] = newdb;
-    bdb_state->blkseq_last_lsn[1][stripe] = bdb_state->blkseq_last_lsn[0][stripe];
-
-    bdb_state->blkseq_last_roll_time[stripe] = now;
-
-    /* Clean up the old blkseq file. Get its name, close it, delete it. */
-    rc =
-        to_be_deleted->get_dbname(to_be_deleted, (const char **)&oldname, NULL);
-    if (rc) {
-        /* warn, but proceed - we leak a file, which will be cleaned up when
-         * the database next turns. */
-        logmsg(LOGMSG_ERROR, "can't find filename of blkseq table\n");
-    } else
-        oldname = strdup(oldname);
-
-    to_be_deleted->close(to_be_deleted, DB_NOSYNC);
-
-    if (oldname) {
-        DB *db;
-        env = bdb_state->blkseq_env[stripe];
+roll:
+    rc = blkseq_roll_locked(bdb_state, stripe, now, &to_be_deleted);
 
-        rc = db_create(&db, env, 0);
-        if (rc) {
-            logmsg(LOGMSG_ERROR, "blkseq create rc %d\n", rc);
-            rc = BDBERR_MISC;
-            goto done;
-        }
+done:
+    Pthread_mutex_unlock(&bdb_state->blkseq_lk[stripe]);
 
-        rc = db->remove(db, oldname, NULL, 0);
-        if (rc) {
-            logmsg(LOGMSG_ERROR, "db->remove %s rc %d\n", oldname, rc);
-            rc = BDBERR_MISC;
-            goto done;
-        }
-    }
-    if (bdb_state->attr->private_blkseq_close_warn_time) {
-        end = comdb2_time_epochms();
-        if ((end - start) > bdb_state->attr->private_blkseq_close_warn_time) {
-            logmsg(LOGMSG_WARN, "blkseq close took %dms\n", end - start);
+    /* Nothing can reach the old table anymore; free it without holding up
+     * the stripe */
+    if (to_be_deleted) {
+        destroy_blkseq(to_be_deleted);
+        if (bdb_state->attr->private_blkseq_close_warn_time) {
+            end = comdb2_time_epochms();
+            if ((end - start) > bdb_state->attr->private_blkseq_close_warn_time) {
+                logmsg(LOGMSG_WARN, "blkseq close took %dms\n", end - start);
+            }
         }
     }
 
-done:
-    Pthread_mutex_unlock(&bdb_state->blkseq_lk[stripe]);
-    if (oldname)
-        free(oldname);
-
     return rc;
 }
 
@@ -566,49 +639,44 @@ int bdb_blkseq_clean(bdb_state_type *bdb_state, uint8_t stripe)
     return rc;
 }
 
+struct blkseq_for_each_arg {
+    int stripe;
+    int ix;
+    DB_LSN *lsn;
+    void *arg;
+    void (*func)(int, int, void *, void *, void *, void *);
+};
+
+static int blkseq_for_each_entry(void *obj, void *arg)
+{
+    struct blkseq_entry *ent = obj;
+    struct blkseq_for_each_arg *fe = arg;
+    DBT dkey = {0}, ddata = {0};
+
+    dkey.data = ent->key;
+    dkey.size = ent->klen;
+    ddata.data = ent->data;
+    ddata.size = ent->dlen;
+    fe->func(fe->stripe, fe->ix, fe->lsn, &dkey, &ddata, fe->arg);
+    return 0;
+}
+
 static int bdb_blkseq_stripe_for_each(bdb_state_type *bdb_state, uint8_t stripe,
                                       void *arg,
                                       void (*func)(int, int, void *, void *,
                                                    void *, void *))
 {
-    DBC *dbc = NULL;
-    DBT dkey = {0}, ddata = {0};
-    int rc;
+    struct blkseq_for_each_arg fe = {.stripe = stripe, .arg = arg, .func = func};
 
-    dkey.flags = ddata.flags = DB_DBT_REALLOC;
     Pthread_mutex_lock(&bdb_state->blkseq_lk[stripe]);
-
     for (int i = 0; i < 2; i++) {
-        rc = bdb_state->blkseq[i][stripe]->cursor(bdb_state->blkseq[i][stripe],
-                                                  NULL, &dbc, 0);
-        if (rc)
-            goto done;
-        rc = dbc->c_get(dbc, &dkey, &ddata, DB_FIRST);
-        while (rc == 0) {
-            func(stripe, i, &(bdb_state->blkseq_last_lsn[i][stripe]), &dkey,
-                 &ddata, arg);
-            rc = dbc->c_get(dbc, &dkey, &ddata, DB_NEXT);
-        }
-        if (rc) {
-            if (rc != DB_NOTFOUND)
-                logmsg(LOGMSG_ERROR, "fstblk c_get rc %d\n", rc);
-            else
-                rc = 0;
-        }
-        dbc->c_close(dbc);
-        dbc = NULL;
+        fe.ix = i;
+        fe.lsn = &bdb_state->blkseq_last_lsn[i][stripe];
+        hash_for(bdb_state->blkseq[i][stripe], blkseq_for_each_entry, &fe);
     }
-
-done:
     Pthread_mutex_unlock(&bdb_state->blkseq_lk[stripe]);
-    if (dkey.data)
-        free(dkey.data);
-    if (ddata.data)
-        free(ddata.data);
-    if (dbc)
-        dbc->c_close(dbc);
 
-    return rc;
+    return 0;
 }
 
 void bdb_blkseq_for_each(bdb_state_type *bdb_state, void *arg,
@@ -142,6 +142,13 @@ bdb_cursor_open(bdb_state_type *bdb_state, cursor_tran_t *curtran,
                 int (*count_pagelock_cursors)(void *), void *countarg, int trak,
                 int *bdberr, int snapcur);
 
+/**
+ * Restrict full scans of a data cursor to stripes [lo, hi); the cursor
+ * still finds any genid directly.  Used by parallel stripe scans.
+ *
+ */
+int bdb_cursor_set_stripe_range(bdb_cursor_ifn_t *pcur_ifn, int lo, int hi);
+
 int bdb_cursor_process_skip(bdb_state_type *bdb_state, tran_type *tran,
                             /* upcall */
                             void *arg0, void *arg1,
@@ -644,6 +644,11 @@ struct bdb_cursor_impl_tag {
 
     struct pglogs_queue_cursor *queue_cursor;
 
+    /* parallel scans: data moves only visit stripes [stripe_lo, stripe_hi);
+       stripe_hi == 0 means no restriction */
+    int stripe_lo;
+    int stripe_hi;
+
     uint8_t ver;
     uint8_t trak;    /* debug this cursor: set to 1 for verbose */
     uint8_t used_rl; /* set to 1 if rl position was consumed */
@@ -764,6 +769,9 @@ typedef struct {
 
     int should_reject_timestamp;
     int should_reject;
+
+    /* bumped whenever master_host changes */
+    uint32_t master_changes;
 } repinfo_type;
 
 struct hostinfo
@@ -831,6 +839,9 @@ struct bdb_state_tag {
                                      blob files are striped too, otherwise
                                      they are not. */
     DB *dbp_ix[MAXINDEX];                    /* handle for the ixN files */
+    /* btrees kept out of the root page cache; applied whenever they open */
+    unsigned char norcache_ix[MAXINDEX];
+    unsigned char norcache_dta;
 
     pthread_key_t tid_key;
 
@@ -1042,10 +1053,10 @@ struct bdb_state_tag {
     int disable_page_order_tablescan;
 
     pthread_mutex_t *blkseq_lk;
-    DB_ENV **blkseq_env;
-    DB **blkseq[2];
+    hash_t **blkseq[2];
     time_t *blkseq_last_roll_time;
     DB_LSN *blkseq_last_lsn[2];
+    int64_t *blkseq_bytes[2];
     listc_t *blkseq_log_list;
     int pvt_blkseq_stripes;
     uint32_t genid_format;
@@ -1068,6 +1079,9 @@ struct bdb_state_tag {
     unsigned long long dtavers[1 + MAXBLOBS];
     unsigned long long ixvers[MAXINDEX];
     unsigned long long qvers[BDB_QUEUEDB_MAX_FILES];
+
+    /* Bloom filters of unique index keys (ix_bloom.c) */
+    struct ix_bloom *ixbloom[MAXINDEX];
 };
 
 #include <net_types.h>
@@ -1306,6 +1320,11 @@ void call_for_election(bdb_state_type *bdb_state, const char *func, int line);
 
 int bdb_next_dtafile(bdb_state_type *bdb_state);
 
+/* ix_bloom.c */
+void bdb_ix_bloom_add(bdb_state_type *bdb_state, int ixnum, const void *key,
+                      int keylen, int isdel);
+void bdb_ix_bloom_free(bdb_state_type *bdb_state);
+
 int ll_key_add(bdb_state_type *bdb_state, unsigned long long genid,
                tran_type *tran, int ixnum, DBT *dbt_key, DBT *dbt_data);
 int ll_dta_add(bdb_state_type *bdb_state, unsigned long long genid, DB *dbp,
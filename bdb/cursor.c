@@ -97,6 +97,7 @@ as long as there was a successful move in the past
 #include "thrman.h"
 
 #include "genid.h"
+#include "comdb2_atomic.h"
 
 //#define MERGE_DEBUG 1
 
@@ -131,6 +132,14 @@ int lkprintf(loglvl lvl, const char *fmt, ...)
     ((id) >= 0 && (((id) < cur->state->attr->dtastripe) ||                     \
                    ((id) == cur->state->attr->dtastripe && cur->addcur)))
 
+/* stripe window set by bdb_cursor_set_stripe_range; the virtual stripe
+   belongs to whichever window ends at the last real stripe */
+#define IN_STRIPE_WINDOW(id)                                                   \
+    (cur->stripe_hi == 0 ||                                                    \
+     ((id) >= cur->stripe_lo &&                                                \
+      ((id) < cur->stripe_hi ||                                                \
+       cur->stripe_hi >= cur->state->attr->dtastripe)))
+
 hash_t *logfile_pglogs_repo = NULL;
 static unsigned first_logfile;
 static unsigned last_logfile;
@@ -6230,6 +6239,13 @@ static int bdb_cursor_move_int(bdb_cursor_impl_t *cur, int how, int *bdberr)
             (how == DB_FIRST) ? 0 : (cur->state->attr->dtastripe -
                                      ((cur->addcur) ? 0 : 1)); /* last stripe */
 
+        if (cur->stripe_hi) {
+            if (how == DB_FIRST)
+                dtafile = cur->stripe_lo;
+            else if (cur->stripe_hi < cur->state->attr->dtastripe)
+                dtafile = cur->stripe_hi - 1;
+        }
+
         if (cur->data) {
             /* cursor is positioned */
             if (dtafile != cur->idx) {
@@ -6319,7 +6335,7 @@ static int bdb_cursor_move_int(bdb_cursor_impl_t *cur, int how, int *bdberr)
                 return -1;
             }
 
-            if (!IS_VALID_DTA(nextstripe))
+            if (!IS_VALID_DTA(nextstripe) || !IN_STRIPE_WINDOW(nextstripe))
                 return (how == DB_FIRST || how == DB_LAST) ? IX_EMPTY
                                                            : IX_PASTEOF;
 
@@ -8326,6 +8342,23 @@ static int bdb_cursor_set_curtran(bdb_cursor_ifn_t *pcur_ifn,
     return 0;
 }
 
+/**
+ * Restrict full scans of a data cursor to stripes [lo, hi)
+ *
+ */
+int bdb_cursor_set_stripe_range(bdb_cursor_ifn_t *pcur_ifn, int lo, int hi)
+{
+    bdb_cursor_impl_t *cur = pcur_ifn->impl;
+
+    if (cur->type != BDBC_DT || lo < 0 || hi <= lo ||
+        hi > cur->state->attr->dtastripe)
+        return -1;
+
+    cur->stripe_lo = lo;
+    cur->stripe_hi = hi;
+    return 0;
+}
+
 /**
  * Parse a string containing an enable/disable feature and
  * return a proper return code for it
@@ -8728,6 +8761,27 @@ struct count_arg {
 extern pthread_key_t query_info_key;
 extern int comdb2_sql_tick();
 #define UNUSED(x) ((void)(x))
+
+/* count leaf entries from page headers instead of bulk-reading records */
+int gbl_direct_count_pages = 0;
+
+/* btrees counted each way, for 'stat count' */
+static uint64_t direct_count_page_walks;
+static uint64_t direct_count_row_walks;
+
+void bdb_direct_count_stats(void)
+{
+    logmsg(LOGMSG_USER, "direct count page walks %" PRIu64 "\n",
+           ATOMIC_LOAD64(direct_count_page_walks));
+    logmsg(LOGMSG_USER, "direct count row walks  %" PRIu64 "\n",
+           ATOMIC_LOAD64(direct_count_row_walks));
+}
+
+static int db_count_tick(void *arg)
+{
+    return comdb2_sql_tick();
+}
+
 static void *db_count(void *varg)
 {
     int rc;
@@ -8759,6 +8813,17 @@ static void *db_count(void *varg)
         dbc->last_checkpoint_lsn = arg->last_checkpoint_lsn;
     }
     int64_t count = 0;
+    if (gbl_direct_count_pages) {
+        u_int64_t pgcount = 0;
+        ATOMIC_ADD64(direct_count_page_walks, 1);
+        rc = dbc->c_pgcount(dbc, &pgcount, db_count_tick, NULL);
+        /* report completion the same way the bulk walk does */
+        if (rc == 0)
+            rc = DB_NOTFOUND;
+        count = pgcount;
+        goto done;
+    }
+    ATOMIC_ADD64(direct_count_row_walks, 1);
     while ((rc = dbc->c_get(dbc, &k, &v, DB_NEXT | DB_MULTIPLE_KEY)) == 0) {
         rc = comdb2_sql_tick();
         if (rc != 0)
@@ -8777,6 +8842,7 @@ static void *db_count(void *varg)
             DB_MULTIPLE_KEY_NEXT(bulk, &v, kk, ks, vv, vs);
         }
     }
+done:
     dbc->c_close(dbc);
     arg->rc = rc;
     arg->count = count;
@@ -74,6 +74,7 @@
 #include <cheapstack.h>
 #include "bdb_int.h"
 #include "locks.h"
+#include "comdb2_atomic.h"
 #include "sys_wrap.h"
 #include <time.h>
 #include <ctrace.h>
@@ -258,8 +259,11 @@ void set_repinfo_master_host(bdb_state_type *bdb_state, char *master,
         logmsg(LOGMSG_USER, "Setting repinfo master to %s from %s line %u\n",
                master, func, line);
     }
+    struct interned_string *old = bdb_state->repinfo->master_host_interned;
     bdb_state->repinfo->master_host_interned = intern_ptr(master);
     bdb_state->repinfo->master_host = bdb_state->repinfo->master_host_interned->str;
+    if (old != bdb_state->repinfo->master_host_interned)
+        ATOMIC_ADD32(bdb_state->repinfo->master_changes, 1);
 
     if (master == db_eid_invalid) {
         /* whoismaster_rtn (new_master_callback) will be called when master is available */
@@ -1848,6 +1852,37 @@ int bdb_handle_dbp_drop_hash(bdb_state_type *bdb_state)
     return 0;
 }
 
+static void apply_rcache_flags(bdb_state_type *bdb_state)
+{
+    int dtanum, strnum, ixnum;
+    DB *dbp;
+
+    for (ixnum = 0; ixnum < bdb_state->numix; ixnum++) {
+        if ((dbp = bdb_state->dbp_ix[ixnum]) != NULL)
+            dbp->norcache = bdb_state->norcache_ix[ixnum];
+    }
+    for (dtanum = 0; dtanum < bdb_state->numdtafiles; dtanum++) {
+        for (strnum = bdb_get_datafile_num_files(bdb_state, dtanum) - 1;
+             strnum >= 0; strnum--) {
+            dbp = bdb_state->dbp_data[dtanum][strnum];
+            if (dbp)
+                dbp->norcache = bdb_state->norcache_dta;
+        }
+    }
+}
+
+int bdb_handle_dbp_set_rcache(bdb_state_type *bdb_state, int ixnum, int enable)
+{
+    if (ixnum < -1 || ixnum >= bdb_state->numix)
+        return -1;
+    if (ixnum >= 0)
+        bdb_state->norcache_ix[ixnum] = !enable;
+    else
+        bdb_state->norcache_dta = !enable;
+    apply_rcache_flags(bdb_state);
+    return 0;
+}
+
 int bdb_handle_dbp_hash_stat(bdb_state_type *bdb_state)
 {
     DB *dbp;
@@ -4838,6 +4873,8 @@ deadlock_again:
             set_gblcontext(bdb_state, master_cmpcontext);
     }
 
+    apply_rcache_flags(bdb_state);
+
     *pbdberr = BDBERR_NOERROR;
     return 0;
 }
@@ -7177,6 +7214,7 @@ static int bdb_free_int(bdb_state_type *bdb_state, bdb_state_type *replace,
 
         // free bthash
         bdb_handle_dbp_drop_hash(child);
+        bdb_ix_bloom_free(child);
         memset(child, 0xff, sizeof(bdb_state_type));
 
         if (replace) {
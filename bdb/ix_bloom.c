@@ -0,0 +1,532 @@
+/*
+   Copyright 2024 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * In-memory Bloom filters over the keys of unique indexes.
+ *
+ * A filter lets a unique key check skip the btree when the key is certainly
+ * not in the index.  That is only safe if every key that can be in the
+ * index is in the filter, so:
+ *
+ *  - filters are only used on the master, and only for as long as it stays
+ *    master: keys added by replication never go through ll_key_add().
+ *  - keys are added before they are put into the btree, and keys that are
+ *    deleted are added too, so that rolling the delete back cannot bring
+ *    back a key the filter has not seen.
+ *  - a filter is built in the background.  Once it is registered, every
+ *    key written goes into it; the builder then waits for the transactions
+ *    already writing to the table to finish (by taking the table lock once)
+ *    before it scans the index.
+ *
+ * Keys are never removed from a filter, so deletes and growth past the
+ * size it was built for make it less selective.  When that happens the
+ * filter is rebuilt, and the old one is used until the new one is ready.
+ */
+
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bdb_int.h"
+#include "locks.h"
+#include "comdb2_atomic.h"
+#include "logmsg.h"
+#include "schema_lk.h"
+#include "thrman.h"
+#include "thread_util.h"
+#include <sys_wrap.h>
+
+/* Keys read from the index per batch while building */
+#define BLOOM_BUILD_BATCH 10000
+/* Size filters for at least this many keys */
+#define BLOOM_MIN_KEYS 65536
+
+int db_is_exiting(void);
+
+struct bloom_filter {
+    uint64_t *bits;
+    uint64_t mask; /* number of bits - 1; a power of 2 */
+    int nhash;
+    int64_t capacity;
+    uint32_t master_changes;
+    uint8_t fileid[DB_FILE_ID_LEN];
+};
+
+struct ix_bloom {
+    pthread_rwlock_t lk;
+    struct bloom_filter *cur;  /* used for checks */
+    struct bloom_filter *next; /* being built */
+    int64_t nkeys;             /* keys in cur when it was built */
+    int64_t nadds;             /* keys added to cur since */
+    int64_t ndels;             /* keys deleted since */
+    int building;
+    int stale;
+    int64_t nchecks;
+    int64_t nskipped;
+};
+
+struct bloom_build_req {
+    char *table;
+    int ixnum;
+    LINKC_T(struct bloom_build_req) lnk;
+};
+
+static pthread_mutex_t bloom_lk = PTHREAD_MUTEX_INITIALIZER;
+static LISTC_T(struct bloom_build_req) build_reqs;
+static int builder_running;
+
+static inline uint64_t fmix64(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static uint64_t key_hash(const uint8_t *key, int len)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (int i = 0; i < len; i++) {
+        h ^= key[i];
+        h *= 0x100000001b3ULL;
+    }
+    return fmix64(h);
+}
+
+static struct bloom_filter *bloom_new(int64_t capacity, int bits_per_key,
+                                      int max_mb)
+{
+    struct bloom_filter *f;
+    uint64_t nbits = 64;
+
+    if (bits_per_key < 1)
+        bits_per_key = 1;
+    while (nbits < (uint64_t)capacity * bits_per_key)
+        nbits <<= 1;
+    if (nbits / 8 > (uint64_t)max_mb * 1024 * 1024)
+        return NULL;
+
+    if ((f = calloc(1, sizeof(struct bloom_filter))) == NULL)
+        return NULL;
+    if ((f->bits = calloc(nbits / 64, sizeof(uint64_t))) == NULL) {
+        free(f);
+        return NULL;
+    }
+    f->mask = nbits - 1;
+    /* ln(2) * bits per key hashes minimises false positives */
+    f->nhash = (bits_per_key * 69 + 50) / 100;
+    if (f->nhash < 1)
+        f->nhash = 1;
+    f->capacity = nbits / bits_per_key;
+    return f;
+}
+
+static void bloom_free(struct bloom_filter *f)
+{
+    if (f) {
+        free(f->bits);
+        free(f);
+    }
+}
+
+static void bloom_add(struct bloom_filter *f, const void *key, int len)
+{
+    uint64_t h = key_hash(key, len);
+    uint64_t delta = (h >> 33) | (h << 31) | 1;
+
+    for (int i = 0; i < f->nhash; i++, h += delta)
+        __atomic_fetch_or(&f->bits[(h & f->mask) >> 6], 1ULL << (h & 63),
+                          __ATOMIC_RELAXED);
+}
+
+static int bloom_test(struct bloom_filter *f, const void *key, int len)
+{
+    uint64_t h = key_hash(key, len);
+    uint64_t delta = (h >> 33) | (h << 31) | 1;
+
+    for (int i = 0; i < f->nhash; i++, h += delta) {
+        uint64_t w = __atomic_load_n(&f->bits[(h & f->mask) >> 6],
+                                     __ATOMIC_RELAXED);
+        if (!(w & (1ULL << (h & 63))))
+            return 0;
+    }
+    return 1;
+}
+
+static inline int keylen_for(bdb_state_type *bdb_state, int ixnum, int keylen)
+{
+    /* null keys in a unique index carry a genid; only hash the key */
+    return keylen < bdb_state->ixlen[ixnum] ? keylen : bdb_state->ixlen[ixnum];
+}
+
+static inline uint32_t master_changes(bdb_state_type *bdb_state)
+{
+    return ATOMIC_LOAD32(bdb_state->repinfo->master_changes);
+}
+
+static inline int iammaster(bdb_state_type *bdb_state)
+{
+    return bdb_state->repinfo->master_host == bdb_state->repinfo->myhost;
+}
+
+/* Is f still a filter of every key in the index? */
+static int bloom_usable(bdb_state_type *bdb_state, int ixnum,
+                        struct bloom_filter *f)
+{
+    return f->master_changes == master_changes(bdb_state) &&
+           iammaster(bdb_state) &&
+           memcmp(f->fileid, bdb_state->dbp_ix[ixnum]->fileid,
+                  DB_FILE_ID_LEN) == 0;
+}
+
+static struct ix_bloom *get_ix_bloom(bdb_state_type *bdb_state, int ixnum)
+{
+    struct ix_bloom *b;
+
+    if ((b = __atomic_load_n(&bdb_state->ixbloom[ixnum], __ATOMIC_ACQUIRE)) != NULL)
+        return b;
+
+    Pthread_mutex_lock(&bloom_lk);
+    if ((b = bdb_state->ixbloom[ixnum]) == NULL &&
+        (b = calloc(1, sizeof(struct ix_bloom))) != NULL) {
+        Pthread_rwlock_init(&b->lk, NULL);
+        __atomic_store_n(&bdb_state->ixbloom[ixnum], b, __ATOMIC_RELEASE);
+    }
+    Pthread_mutex_unlock(&bloom_lk);
+    return b;
+}
+
+static void *bloom_build_thd(void *arg);
+
+static void request_build(bdb_state_type *bdb_state, int ixnum,
+                          struct ix_bloom *b)
+{
+    struct bloom_build_req *req;
+    bdb_state_type *parent = bdb_state->parent;
+    int start = 0, idle = 0;
+
+    if (!CAS32(b->building, idle, 1))
+        return;
+
+    if ((req = calloc(1, sizeof(*req))) == NULL ||
+        (req->table = strdup(bdb_state->name)) == NULL) {
+        free(req);
+        XCHANGE32(b->building, 0);
+        return;
+    }
+    req->ixnum = ixnum;
+
+    Pthread_mutex_lock(&bloom_lk);
+    if (build_reqs.top == NULL && build_reqs.bot == NULL)
+        listc_init(&build_reqs, offsetof(struct bloom_build_req, lnk));
+    listc_abl(&build_reqs, req);
+    if (!builder_running)
+        start = builder_running = 1;
+    Pthread_mutex_unlock(&bloom_lk);
+
+    if (start) {
+        pthread_t tid;
+        Pthread_create(&tid, &parent->pthread_attr_detach, bloom_build_thd,
+                       parent);
+    }
+}
+
+int bdb_ix_bloom_may_contain(bdb_state_type *bdb_state, int ixnum,
+                             const void *key, int keylen)
+{
+    struct ix_bloom *b;
+    struct bloom_filter *f;
+    int found = 1, want_build = 0;
+
+    if (!bdb_state->attr->ix_bloom_filters || bdb_state->parent == NULL ||
+        bdb_state->ixdups[ixnum] || !iammaster(bdb_state))
+        return 1;
+    if ((b = get_ix_bloom(bdb_state, ixnum)) == NULL)
+        return 1;
+
+    Pthread_rwlock_rdlock(&b->lk);
+    f = b->cur;
+    if (f && bloom_usable(bdb_state, ixnum, f)) {
+        found = bloom_test(f, key, keylen_for(bdb_state, ixnum, keylen));
+        want_build = b->stale;
+    } else {
+        want_build = 1;
+    }
+    Pthread_rwlock_unlock(&b->lk);
+
+    ATOMIC_ADD64(b->nchecks, 1);
+    if (!found)
+        ATOMIC_ADD64(b->nskipped, 1);
+    if (want_build && !b->building)
+        request_build(bdb_state, ixnum, b);
+    return found;
+}
+
+void bdb_ix_bloom_add(bdb_state_type *bdb_state, int ixnum, const void *key,
+                      int keylen, int isdel)
+{
+    struct ix_bloom *b;
+
+    if (bdb_state->ixdups[ixnum] ||
+        (b = __atomic_load_n(&bdb_state->ixbloom[ixnum], __ATOMIC_ACQUIRE)) == NULL)
+        return;
+
+    keylen = keylen_for(bdb_state, ixnum, keylen);
+    Pthread_rwlock_rdlock(&b->lk);
+    if (b->next)
+        bloom_add(b->next, key, keylen);
+    if (b->cur) {
+        bloom_add(b->cur, key, keylen);
+        /* a check that comes after this must see these bits */
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+        int64_t n = isdel ? ATOMIC_ADD64(b->ndels, 1) : ATOMIC_ADD64(b->nadds, 1);
+        if (isdel ? n > b->nkeys / 2 + BLOOM_MIN_KEYS / 4
+                  : b->nkeys + n > b->cur->capacity)
+            b->stale = 1;
+    }
+    Pthread_rwlock_unlock(&b->lk);
+}
+
+void bdb_ix_bloom_free(bdb_state_type *bdb_state)
+{
+    for (int ixnum = 0; ixnum < MAXINDEX; ixnum++) {
+        struct ix_bloom *b = bdb_state->ixbloom[ixnum];
+        if (b == NULL)
+            continue;
+        bdb_state->ixbloom[ixnum] = NULL;
+        bloom_free(b->cur);
+        bloom_free(b->next);
+        Pthread_rwlock_destroy(&b->lk);
+        free(b);
+    }
+}
+
+void bdb_ix_bloom_stats(bdb_state_type *bdb_state)
+{
+    for (int ixnum = 0; ixnum < bdb_state->numix; ixnum++) {
+        struct ix_bloom *b = __atomic_load_n(&bdb_state->ixbloom[ixnum], __ATOMIC_ACQUIRE);
+        if (b == NULL)
+            continue;
+        Pthread_rwlock_rdlock(&b->lk);
+        logmsg(LOGMSG_USER,
+               "table %s ix %d: %s, %" PRId64 " keys, %" PRId64 " bytes, %" PRId64
+               " adds, %" PRId64 " deletes, %" PRId64 " checks, %" PRId64
+               " skipped%s\n",
+               bdb_state->name, ixnum,
+               b->cur && bloom_usable(bdb_state, ixnum, b->cur) ? "ready"
+                                                               : "not ready",
+               b->nkeys, b->cur ? (int64_t)(b->cur->mask + 1) / 8 : 0,
+               b->nadds, b->ndels, b->nchecks, b->nskipped,
+               b->building ? ", building" : "");
+        Pthread_rwlock_unlock(&b->lk);
+    }
+}
+
+/* Look the table up again; it may have been dropped or replaced since the
+ * build started.  Returns NULL if b is gone, and sets *usable to 0 if b is
+ * still there but f can no longer be trusted. */
+static bdb_state_type *build_table(bdb_state_type *parent,
+                                   struct bloom_build_req *req,
+                                   struct ix_bloom *b, struct bloom_filter *f,
+                                   int *usable)
+{
+    bdb_state_type *bdb_state = bdb_get_table_by_name(parent, req->table);
+
+    if (bdb_state == NULL || req->ixnum >= bdb_state->numix ||
+        bdb_state->ixbloom[req->ixnum] != b || b->next != f)
+        return NULL;
+    *usable = bloom_usable(bdb_state, req->ixnum, f);
+    return bdb_state;
+}
+
+/* Add up to BLOOM_BUILD_BATCH keys from lastkey on to f.  Returns 0 if
+ * there are more, DB_NOTFOUND at the end of the index, or an error. */
+static int build_batch(bdb_state_type *bdb_state, int ixnum,
+                       struct bloom_filter *f, DBT *lastkey, int first,
+                       int64_t *nkeys)
+{
+    DB *dbp = bdb_state->dbp_ix[ixnum];
+    DBC *dbc;
+    DBT data = {0};
+    int rc, n = 0;
+
+    data.flags = DB_DBT_PARTIAL;
+    if ((rc = dbp->cursor(dbp, NULL, &dbc, 0)) != 0)
+        return rc;
+
+    /* The last key may have been deleted since, so start from the first key
+     * at or after it.  Adding it twice does no harm. */
+    rc = dbc->c_get(dbc, lastkey, &data, first ? DB_FIRST : DB_SET_RANGE);
+    while (rc == 0) {
+        bloom_add(f, lastkey->data, keylen_for(bdb_state, ixnum, lastkey->size));
+        ++*nkeys;
+        if (++n == BLOOM_BUILD_BATCH)
+            break;
+        rc = dbc->c_get(dbc, lastkey, &data, DB_NEXT);
+    }
+    dbc->c_close(dbc);
+    return rc;
+}
+
+static void build_one(bdb_state_type *parent, struct bloom_build_req *req)
+{
+    bdb_state_type *bdb_state = parent;
+    bdb_state_type *table;
+    struct ix_bloom *b;
+    struct bloom_filter *f = NULL, *old;
+    tran_type *tran;
+    uint8_t keybuf[MAXKEYSZ];
+    DBT lastkey = {0};
+    int64_t nkeys = 0, capacity;
+    int rc, bdberr, usable, first = 1;
+
+    /* Register the new filter, then wait out the transactions that are
+     * already writing to the table: they may not have added their keys. */
+    rdlock_schema_lk();
+    BDB_READLOCK("ix_bloom_build");
+    table = bdb_get_table_by_name(parent, req->table);
+    if (table == NULL || req->ixnum >= table->numix ||
+        (b = table->ixbloom[req->ixnum]) == NULL) {
+        BDB_RELLOCK();
+        unlock_schema_lk();
+        return;
+    }
+    if (!iammaster(parent))
+        goto out;
+    capacity = 2 * (b->nkeys + b->nadds);
+    if (capacity < BLOOM_MIN_KEYS)
+        capacity = BLOOM_MIN_KEYS;
+    f = bloom_new(capacity, table->attr->ix_bloom_bits_per_key,
+                  table->attr->ix_bloom_max_mb);
+    if (f == NULL) {
+        logmsg(LOGMSG_WARN, "%s: no bloom filter for %s ix %d (%" PRId64
+                            " keys)\n",
+               __func__, req->table, req->ixnum, capacity / 2);
+        goto out;
+    }
+    f->master_changes = master_changes(parent);
+    memcpy(f->fileid, table->dbp_ix[req->ixnum]->fileid, DB_FILE_ID_LEN);
+
+    Pthread_rwlock_wrlock(&b->lk);
+    bloom_free(b->next);
+    b->next = f;
+    Pthread_rwlock_unlock(&b->lk);
+
+    if ((tran = bdb_tran_begin(table, NULL, &bdberr)) == NULL) {
+        rc = -1;
+        goto fail;
+    }
+    rc = bdb_lock_table_write(table, tran);
+    bdb_tran_abort(table, tran, &bdberr);
+    if (rc)
+        goto fail;
+    BDB_RELLOCK();
+    unlock_schema_lk();
+
+    lastkey.data = keybuf;
+    lastkey.ulen = sizeof(keybuf);
+    lastkey.flags = DB_DBT_USERMEM;
+    do {
+        rdlock_schema_lk();
+        BDB_READLOCK("ix_bloom_build");
+        if ((table = build_table(parent, req, b, f, &usable)) == NULL) {
+            /* the table went away, and b and f with it */
+            BDB_RELLOCK();
+            unlock_schema_lk();
+            return;
+        }
+        /* on exit, drop the partial filter and let a later build start */
+        if (!usable || db_is_exiting()) {
+            rc = -1;
+            goto fail;
+        }
+        rc = build_batch(table, req->ixnum, f, &lastkey, first, &nkeys);
+        if (rc == DB_LOCK_DEADLOCK) {
+            BDB_RELLOCK();
+            unlock_schema_lk();
+            poll(NULL, 0, 10);
+            rc = 0;
+            continue;
+        }
+        first = 0;
+        if (rc != 0 && rc != DB_NOTFOUND)
+            goto fail;
+        if (rc == 0) {
+            BDB_RELLOCK();
+            unlock_schema_lk();
+        }
+    } while (rc == 0);
+
+    /* still holding the locks from the last batch */
+    Pthread_rwlock_wrlock(&b->lk);
+    old = b->cur;
+    b->cur = f;
+    b->next = NULL;
+    b->nkeys = nkeys;
+    b->nadds = b->ndels = 0;
+    b->stale = nkeys > f->capacity;
+    Pthread_rwlock_unlock(&b->lk);
+    bloom_free(old);
+    logmsg(LOGMSG_INFO, "%s: built bloom filter for %s ix %d, %" PRId64
+                        " keys, %" PRIu64 " bytes\n",
+           __func__, req->table, req->ixnum, nkeys, (f->mask + 1) / 8);
+    goto out;
+
+fail:
+    logmsg(LOGMSG_ERROR, "%s: failed to build bloom filter for %s ix %d rc %d\n",
+           __func__, req->table, req->ixnum, rc);
+    Pthread_rwlock_wrlock(&b->lk);
+    if (b->next == f) {
+        b->next = NULL;
+        bloom_free(f);
+    }
+    Pthread_rwlock_unlock(&b->lk);
+out:
+    XCHANGE32(b->building, 0);
+    BDB_RELLOCK();
+    unlock_schema_lk();
+}
+
+static void *bloom_build_thd(void *arg)
+{
+    bdb_state_type *bdb_state = arg;
+    struct bloom_build_req *req;
+
+    thrman_register(THRTYPE_GENERIC);
+    thread_started("ix bloom build");
+    bdb_thread_event(bdb_state, BDBTHR_EVENT_START_RDWR);
+
+    while (1) {
+        Pthread_mutex_lock(&bloom_lk);
+        req = listc_rtl(&build_reqs);
+        if (req == NULL)
+            builder_running = 0;
+        Pthread_mutex_unlock(&bloom_lk);
+        if (req == NULL)
+            break;
+        build_one(bdb_state, req);
+        free(req->table);
+        free(req);
+    }
+
+    bdb_thread_event(bdb_state, BDBTHR_EVENT_DONE_RDWR);
+    return NULL;
+}
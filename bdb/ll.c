@@ -528,6 +528,9 @@ int ll_key_del(bdb_state_type *bdb_state, tran_type *tran, int ixnum, void *key,
             !payloadsz)
             payloadsz = &payloadsz_si;
 
+        /* the delete may be rolled back */
+        bdb_ix_bloom_add(bdb_state, ixnum, key, keylen, 1);
+
         /* open a cursor on the index, find exact key to be deleted
            (if key doesn't allow dupes we need to verify the genid),
            then delete */
@@ -856,6 +859,9 @@ int ll_key_add(bdb_state_type *bdb_state, unsigned long long ingenid,
             }
         }
 
+        /* before the put, so a unique check never misses this key */
+        bdb_ix_bloom_add(bdb_state, ixnum, dbt_key->data, dbt_key->size, 0);
+
         rc = bdb_state->dbp_ix[ixnum]->put(bdb_state->dbp_ix[ixnum], tran->tid,
                                            dbt_key, dbt_data, DB_NOOVERWRITE);
         if (rc) {
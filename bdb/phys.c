@@ -1045,6 +1045,7 @@ int ll_undo_del_ix_lk(bdb_state_type *bdb_state, tran_type *tran,
         bdb_state->dbenv, physical_tran->tid->txnid);
     if (rc)
         goto done;
+    bdb_ix_bloom_add(table, ixnum, key, keylen, 0);
     rc = dbp->put(dbp, physical_tran->tid, &dbt_key, &dbt_data, DB_NOOVERWRITE);
     if (rc)
         goto done;
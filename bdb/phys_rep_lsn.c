@@ -23,6 +23,7 @@ int matchable_log_type(int rectype);
 extern int gbl_physrep_debug;
 int gbl_physrep_exit_on_invalid_logstream = 0;
 int gbl_physrep_ignore_queues = 1;
+int gbl_physrep_timestamp_index = 1;
 
 LOG_INFO get_last_lsn(bdb_state_type *bdb_state)
 {
@@ -79,6 +80,209 @@ int compare_log(DBT *logrec, void *blob, unsigned int blob_len)
     return rc;
 }
 
+/* The first timestamped record at or after the start of a log file.  Log
+ * files only change when the log is truncated back into them, so these are
+ * kept across lookups and re-read from the log whenever they stop matching
+ * it. */
+struct logfile_head {
+    unsigned int file;
+    DB_LSN lsn;
+    u_int64_t timestamp;
+};
+
+static pthread_mutex_t logfile_heads_lk = PTHREAD_MUTEX_INITIALIZER;
+static struct logfile_head *logfile_heads;
+static int nlogfile_heads;
+static int maxlogfile_heads;
+
+/* Called with logfile_heads_lk held: position of file's entry, or of the
+ * entry it would be inserted before */
+static int logfile_head_pos(unsigned int file)
+{
+    int lo = 0, hi = nlogfile_heads;
+
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (logfile_heads[mid].file < file)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Forget the heads of log files that have been deleted */
+static void trim_logfile_heads(unsigned int first_file)
+{
+    int pos;
+
+    Pthread_mutex_lock(&logfile_heads_lk);
+    pos = logfile_head_pos(first_file);
+    if (pos > 0) {
+        nlogfile_heads -= pos;
+        memmove(logfile_heads, logfile_heads + pos,
+                nlogfile_heads * sizeof(struct logfile_head));
+    }
+    Pthread_mutex_unlock(&logfile_heads_lk);
+}
+
+static void put_logfile_head(const struct logfile_head *head)
+{
+    struct logfile_head *heads;
+    int pos;
+
+    Pthread_mutex_lock(&logfile_heads_lk);
+    pos = logfile_head_pos(head->file);
+    if (pos < nlogfile_heads && logfile_heads[pos].file == head->file) {
+        logfile_heads[pos] = *head;
+        goto done;
+    }
+    if (nlogfile_heads == maxlogfile_heads) {
+        int max = maxlogfile_heads ? maxlogfile_heads * 2 : 64;
+        heads = realloc(logfile_heads, max * sizeof(struct logfile_head));
+        if (heads == NULL)
+            goto done;
+        logfile_heads = heads;
+        maxlogfile_heads = max;
+    }
+    memmove(logfile_heads + pos + 1, logfile_heads + pos,
+            (nlogfile_heads - pos) * sizeof(struct logfile_head));
+    logfile_heads[pos] = *head;
+    nlogfile_heads++;
+done:
+    Pthread_mutex_unlock(&logfile_heads_lk);
+}
+
+static int get_cached_logfile_head(unsigned int file, struct logfile_head *head)
+{
+    int pos, found = 0;
+
+    Pthread_mutex_lock(&logfile_heads_lk);
+    pos = logfile_head_pos(file);
+    if (pos < nlogfile_heads && logfile_heads[pos].file == file) {
+        *head = logfile_heads[pos];
+        found = 1;
+    }
+    Pthread_mutex_unlock(&logfile_heads_lk);
+    return found;
+}
+
+/* Read a log record; *matchable is set if it is one of the records that
+ * carry a timestamp */
+static int read_log_record(DB_LOGC *logc, DB_LSN *lsn, DBT *logrec,
+                           u_int32_t flags, int *matchable,
+                           u_int64_t *timestamp)
+{
+    u_int32_t rectype;
+    int rc;
+
+    *matchable = 0;
+    if ((rc = logc->get(logc, lsn, logrec, flags)) != 0)
+        return rc;
+    if (lsn->offset == 0 || logrec->size < sizeof(u_int32_t))
+        return 0;
+    LOGCOPY_32(&rectype, logrec->data);
+    normalize_rectype(&rectype);
+    if (matchable_log_type(rectype)) {
+        *matchable = 1;
+        *timestamp = get_timestamp_from_matchable_record(logrec->data);
+    }
+    return 0;
+}
+
+/* Find the first matchable record at or after the start of a log file.
+ * Returns DB_NOTFOUND if there is none before the end of the log. */
+static int get_logfile_head(DB_LOGC *logc, unsigned int file, DBT *logrec,
+                            struct logfile_head *head)
+{
+    DB_LSN lsn;
+    u_int64_t timestamp;
+    u_int32_t flags;
+    int rc, matchable;
+
+    if (get_cached_logfile_head(file, head)) {
+        lsn = head->lsn;
+        if (read_log_record(logc, &lsn, logrec, DB_SET, &matchable,
+                            &timestamp) == 0 &&
+            matchable && timestamp == head->timestamp)
+            return 0;
+    }
+
+    /* Offset 0 is the log file header; the records follow it */
+    lsn.file = file;
+    lsn.offset = 0;
+    for (flags = DB_SET;; flags = DB_NEXT) {
+        if ((rc = read_log_record(logc, &lsn, logrec, flags, &matchable,
+                                  &timestamp)) != 0)
+            return rc;
+        if (matchable)
+            break;
+    }
+
+    head->file = file;
+    head->lsn = lsn;
+    head->timestamp = timestamp;
+    put_logfile_head(head);
+    return 0;
+}
+
+/* Bisect the log files on the timestamps of their first records for the
+ * first record that is newer than time.  The backward scan for time can
+ * start there instead of at the end of the log, and only has to read the log
+ * file before it.  Leaves start zeroed to scan from the end. */
+static void find_timestamp_scan_start(bdb_state_type *bdb_state, time_t time,
+                                      DB_LSN *start)
+{
+    struct logfile_head head;
+    DB_LOGC *logc;
+    DBT logrec;
+    DB_LSN lsn;
+    unsigned int first, last, lo, hi, mid;
+    int rc;
+
+    start->file = 0;
+    start->offset = 0;
+    if (bdb_state->dbenv->log_cursor(bdb_state->dbenv, &logc, 0) != 0)
+        return;
+    bzero(&logrec, sizeof(DBT));
+    logrec.flags = DB_DBT_REALLOC;
+
+    if (logc->get(logc, &lsn, &logrec, DB_FIRST) != 0)
+        goto done;
+    first = lsn.file;
+    if (logc->get(logc, &lsn, &logrec, DB_LAST) != 0)
+        goto done;
+    last = lsn.file;
+    trim_logfile_heads(first);
+
+    /* lo ends up as the first log file that starts after time */
+    lo = first;
+    hi = last;
+    while (lo <= hi) {
+        mid = lo + (hi - lo) / 2;
+        rc = get_logfile_head(logc, mid, &logrec, &head);
+        if (rc == 0 && head.timestamp <= time)
+            lo = mid + 1;
+        else if (rc == 0 || rc == DB_NOTFOUND)
+            hi = mid - 1;
+        else
+            goto done;
+    }
+
+    if (lo <= last && get_logfile_head(logc, lo, &logrec, &head) == 0)
+        *start = head.lsn;
+
+    if (gbl_physrep_debug) {
+        physrep_logmsg(LOGMSG_USER, "%s scanning back from {%u:%u}\n",
+                       __func__, start->file, start->offset);
+    }
+
+done:
+    if (logrec.data)
+        free(logrec.data);
+    logc->close(logc, 0);
+}
+
 int find_log_timestamp(bdb_state_type *bdb_state, time_t time,
                        unsigned int *file, unsigned int *offset)
 {
@@ -91,7 +295,12 @@ int find_log_timestamp(bdb_state_type *bdb_state, time_t time,
     DB_LSN rec_lsn;
     u_int32_t rectype;
 
-    /* get last record then iterate */
+    rec_lsn.file = 0;
+    rec_lsn.offset = 0;
+    if (gbl_physrep_timestamp_index)
+        find_timestamp_scan_start(bdb_state, time, &rec_lsn);
+
+    /* get last record (or the first one past time) then iterate */
     rc = bdb_state->dbenv->log_cursor(bdb_state->dbenv, &logc, 0);
     if (rc) {
         physrep_logmsg(LOGMSG_ERROR, "%s: Can't get log cursor rc %d\n", __func__, rc);
@@ -101,6 +310,16 @@ int find_log_timestamp(bdb_state_type *bdb_state, time_t time,
     bzero(&logrec, sizeof(DBT));
     logrec.flags = DB_DBT_REALLOC;
 
+    if (rec_lsn.file != 0 &&
+        (rc = logc->get(logc, &rec_lsn, &logrec, DB_SET)) != 0) {
+        physrep_logmsg(LOGMSG_ERROR, "%s: Can't get log record {%u:%u} rc %d\n",
+                       __func__, rec_lsn.file, rec_lsn.offset, rc);
+        logc->close(logc, 0);
+        if (logrec.data)
+            free(logrec.data);
+        return 1;
+    }
+
     do {
         do {
             rc = logc->get(logc, &rec_lsn, &logrec, DB_PREV);
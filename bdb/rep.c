@@ -46,6 +46,7 @@
 #include "phys_rep_lsn.h"
 #include <compat.h>
 #include "str0.h"
+#include "histogram.h"
 #include <thrman.h>
 #ifdef _LINUX_SOURCE
 #include <sys/syscall.h>
@@ -3136,6 +3137,7 @@ static int bdb_wait_for_seqnum_from_all_int(bdb_state_type *bdb_state,
     int outrc;
 
     int begin_time, end_time;
+    int64_t begin_us;
     int we_used = 0;
     const char *base_node = NULL;
     char str[80];
@@ -3168,6 +3170,7 @@ static int bdb_wait_for_seqnum_from_all_int(bdb_state_type *bdb_state,
     */
 
     begin_time = comdb2_time_epochms();
+    begin_us = comdb2_time_epochus();
 
     /* lame, i know.  go into a loop polling once per second to see if
        anyone is coherent yet.  don't wait forever - this must timeout
@@ -3404,6 +3407,9 @@ got_ack:
 
 done_wait:
 
+    if (total_commissioned)
+        comdb2_histogram_add(gbl_rep_ack_hist, comdb2_time_epochus() - begin_us);
+
     outrc = 0;
 
     if (!numfailed && !numskip && !numwait &&
@@ -4619,6 +4625,63 @@ int pgcompact_thdpool_init(void)
     thdpool_set_longwaitms(gbl_pgcompact_thdpool, 10000);
     return 0;
 }
+int bdb_pgcompact_scan(bdb_state_type *bdb_state, int dtanum, int stripe,
+                       int ixnum, unsigned int *pgno, unsigned int npages,
+                       double ff, bdb_pgcompact_batch *batch, int *bdberr)
+{
+    DB *dbp;
+    db_pgno_t pg, last_pgno;
+    u_int32_t nscanned, nsparse, nfreed;
+    int rc;
+
+    *bdberr = BDBERR_NOERROR;
+    memset(batch, 0, sizeof(*batch));
+
+    BDB_READLOCK("pgcompact_scan");
+
+    if (!bdb_amimaster(bdb_state)) {
+        BDB_RELLOCK();
+        *bdberr = BDBERR_READONLY;
+        return -1;
+    }
+
+    if (ixnum >= 0)
+        dbp = (ixnum < bdb_state->numix) ? bdb_state->dbp_ix[ixnum] : NULL;
+    else if (dtanum >= 0 && dtanum < bdb_state->numdtafiles && stripe >= 0 &&
+             stripe < MAXDTASTRIPE)
+        dbp = bdb_state->dbp_data[dtanum][stripe];
+    else
+        dbp = NULL;
+
+    /* Only touch the btrees that were opened for online compaction: that
+       leaves out blobs, recnum indexes, sqlite_stat tables and, unless
+       page_compact_indexes is set, indexes. */
+    if (dbp == NULL || dbp->type != DB_BTREE || !dbp->olcompact) {
+        BDB_RELLOCK();
+        *bdberr = BDBERR_BADARGS;
+        return -1;
+    }
+
+    pg = *pgno;
+    rc = __dbenv_pgcompact_scan(bdb_state->dbenv, dbp, &pg, npages, ff,
+                                gbl_pg_compact_target_ff, &nscanned, &nsparse,
+                                &nfreed, &last_pgno);
+    batch->nscanned = nscanned;
+    batch->nsparse = nsparse;
+    batch->nfreed = nfreed;
+    batch->last_pgno = last_pgno;
+    batch->pgsize = dbp->pgsize;
+    *pgno = pg;
+
+    BDB_RELLOCK();
+
+    if (rc != 0) {
+        *bdberr = BDBERR_MISC;
+        return -1;
+    }
+    return 0;
+}
+
 /****** btree page compact routines END ******/
 
 void berkdb_receive_msg(void *ack_handle, void *usr_ptr, char *from_host,
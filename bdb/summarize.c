@@ -41,8 +41,12 @@
 #include <unistd.h>
 #include <stddef.h>
 #include <pthread.h>
+#include <poll.h>
 #include <sbuf2.h>
 #include <fcntl.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
 
 #include <ctrace.h>
 
@@ -71,6 +75,7 @@
 #include "flibc.h"
 #include "logmsg.h"
 #include "analyze.h"
+#include "comdb2_atomic.h"
 
 extern int get_schema_change_in_progress(const char *func, int line);
 static double analyze_headroom = 6;
@@ -270,6 +275,77 @@ int sampler_close(sampler_t *sampler)
 }
 
 int gbl_debug_sleep_in_summarize = 0;
+
+/* If set, pread only the randomly chosen pages instead of reading the whole
+   index file and discarding what we don't keep. */
+int gbl_analyze_block_sampling = 0;
+
+/* Upper bound on the number of pages a sampling thread reads per second.
+   0 means unthrottled. */
+int gbl_analyze_max_pages_per_sec = 0;
+
+/* If set, sampling threads read at the idle I/O scheduling class. */
+int gbl_analyze_idle_ioprio = 0;
+
+/* Totals since startup, for 'stat analyze' */
+uint64_t gbl_analyze_pages_read;
+uint64_t gbl_analyze_block_sampled_pages;
+uint64_t gbl_analyze_throttle_waits;
+uint64_t gbl_analyze_throttle_ms;
+uint64_t gbl_analyze_idle_ioprio_runs;
+
+#ifdef __linux__
+#define SUMMARIZE_IOPRIO_WHO_PROCESS 1
+#define SUMMARIZE_IOPRIO_CLASS_IDLE 3
+#define SUMMARIZE_IOPRIO_CLASS_SHIFT 13
+
+/* Move the calling thread to the idle I/O class, and return its previous
+   priority (or -1 if it could not be changed). Only the CFQ/BFQ schedulers
+   honor this, it is harmless elsewhere. */
+static int summarize_set_idle_ioprio(void)
+{
+    int old = syscall(SYS_ioprio_get, SUMMARIZE_IOPRIO_WHO_PROCESS, 0);
+    if (old == -1)
+        return -1;
+    if (syscall(SYS_ioprio_set, SUMMARIZE_IOPRIO_WHO_PROCESS, 0,
+                SUMMARIZE_IOPRIO_CLASS_IDLE << SUMMARIZE_IOPRIO_CLASS_SHIFT)) {
+        logmsg(LOGMSG_DEBUG, "%s: ioprio_set failed %d %s\n", __func__, errno,
+               strerror(errno));
+        return -1;
+    }
+    ATOMIC_ADD64(gbl_analyze_idle_ioprio_runs, 1);
+    return old;
+}
+
+static void summarize_restore_ioprio(int old)
+{
+    if (old != -1)
+        (void)syscall(SYS_ioprio_set, SUMMARIZE_IOPRIO_WHO_PROCESS, 0, old);
+}
+#else
+static int summarize_set_idle_ioprio(void) { return -1; }
+static void summarize_restore_ioprio(int old) {}
+#endif
+
+/* Sleep until the next second once we've read max_per_sec pages in the
+   current one. */
+static void summarize_throttle(int max_per_sec, int *windowms,
+                               int *nread)
+{
+    if (max_per_sec <= 0)
+        return;
+    if (++(*nread) < max_per_sec)
+        return;
+    int elapsed = comdb2_time_epochms() - *windowms;
+    if (elapsed < 1000) {
+        ATOMIC_ADD64(gbl_analyze_throttle_waits, 1);
+        ATOMIC_ADD64(gbl_analyze_throttle_ms, 1000 - elapsed);
+        poll(NULL, 0, 1000 - elapsed);
+    }
+    *windowms = comdb2_time_epochms();
+    *nread = 0;
+}
+
 int bdb_summarize_table(bdb_state_type *bdb_state, int ixnum, int comp_pct,
                         sampler_t **samplerp, unsigned long long *outrecs,
                         unsigned long long *cmprecs, int *bdberr)
@@ -289,6 +365,12 @@ int bdb_summarize_table(bdb_state_type *bdb_state, int ixnum, int comp_pct,
     unsigned long long recs_looked_at = 0;
     int fd = -1;
     int last, now;
+    int block_sample = (gbl_analyze_block_sampling && comp_pct < 100);
+    unsigned long long npages = 0, pages_read = 0, pgno;
+    int max_per_sec = gbl_analyze_max_pages_per_sec;
+    int windowms = comdb2_time_epochms();
+    int window_nread = 0;
+    int oldprio = gbl_analyze_idle_ioprio ? summarize_set_idle_ioprio() : -1;
 #ifdef POSIX_FADV_SEQUENTIAL
     /* Release page cache every FADVISE_THRESH many pages. We could make it
        a tunable, but for now, leave it hardcoded. */
@@ -373,18 +455,51 @@ int bdb_summarize_table(bdb_state_type *bdb_state, int ixnum, int comp_pct,
         goto done;
     }
 
+    if (block_sample) {
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            logmsg(LOGMSG_ERROR, "can't stat input db: %d %s\n", errno,
+                   strerror(errno));
+            rc = -1;
+            goto done;
+        }
+        npages = st.st_size / pgsz;
+    }
+
 #ifdef POSIX_FADV_SEQUENTIAL
     // inform kernel that we will be accessing file sequentially
-    (void)posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    (void)posix_fadvise(fd, 0, 0,
+                        block_sample ? POSIX_FADV_RANDOM
+                                     : POSIX_FADV_SEQUENTIAL);
 #endif
 
     last = comdb2_time_epoch();
-    for (rc = read(fd, page, pgsz); rc == pgsz; rc = read(fd, page, pgsz)) {
+    for (pgno = 0;; ++pgno) {
+        /* In block-sampling mode we decide whether to keep a page before
+           reading it, and never touch the pages we'd discard. */
+        if (block_sample) {
+            if (pgno >= npages) {
+                rc = 0;
+                break;
+            }
+            if (rand() % 100 >= comp_pct)
+                continue;
+            rc = pread(fd, page, pgsz, (off_t)pgno * pgsz);
+        } else {
+            rc = read(fd, page, pgsz);
+        }
+        if (rc != pgsz)
+            break;
+        ++pages_read;
+        ATOMIC_ADD64(gbl_analyze_pages_read, 1);
+        if (block_sample)
+            ATOMIC_ADD64(gbl_analyze_block_sampled_pages, 1);
+        summarize_throttle(max_per_sec, &windowms, &window_nread);
 #ifdef POSIX_FADV_SEQUENTIAL
         /* Periodically hint the OS to release pages we've read. Only do so
            when directio is enabled for this operation will likely force out
            useful cached pages otherwise. */
-        if (usedio && ((++nread) % FADVISE_THRESH) == 0)
+        if (!block_sample && usedio && ((++nread) % FADVISE_THRESH) == 0)
             (void)posix_fadvise(fd, (nread - FADVISE_THRESH) * pgsz, FADVISE_THRESH * pgsz, POSIX_FADV_DONTNEED);
 #endif
         /* If it is not a leaf page, continue reading the file. */
@@ -459,7 +574,7 @@ int bdb_summarize_table(bdb_state_type *bdb_state, int ixnum, int comp_pct,
            even if we did check every entry, the results wouldn't be
            100% accurate anyway. */
         recs_looked_at += (n >> 1);
-        if (rand() % 100 >= comp_pct)
+        if (!block_sample && rand() % 100 >= comp_pct)
             continue;
         NUM_ENT(page) = n;
         nrecs += (n >> 1);
@@ -545,9 +660,15 @@ int bdb_summarize_table(bdb_state_type *bdb_state, int ixnum, int comp_pct,
         goto done;
     }
 
+    /* We only looked at a fraction of the file: scale the leaf entries we
+       saw up to the whole file. */
+    if (block_sample && pages_read > 0)
+        recs_looked_at = recs_looked_at * npages / pages_read;
+
     logmsg(LOGMSG_INFO, "summarize added %llu records, traversed %llu\n", nrecs,
            recs_looked_at);
 done:
+    summarize_restore_ioprio(oldprio);
     if (fd != -1)
         Close(fd);
     if (page)
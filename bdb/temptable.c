@@ -143,6 +143,7 @@ struct temp_cursor {
     int ind;
     int keymalloclen;
     int datamalloclen;
+    int hj_group; /* hash join: group being probed, -1 when scanning */
 };
 
 typedef struct arr_elem {
@@ -186,10 +187,16 @@ typedef struct arr_elem {
    a temparray will fall back to a temptable.
    A temparray is more efficient than a temptable. Besides, it uses far
    less memory than a temptable for small and medium-sized requests. */
+/* A hash join table is the build side of an equi-join. Entries are chained
+   in hash buckets on their first hj_nfields key fields, and entries with
+   equal join fields are kept adjacent in their chain, so a probe walks
+   exactly its matches. If the entries outgrow the memory budget, the table
+   falls back to a temptable, which answers the same probes with its btree. */
 enum {
     TEMP_TABLE_TYPE_BTREE,
     TEMP_TABLE_TYPE_HASH,
-    TEMP_TABLE_TYPE_ARRAY
+    TEMP_TABLE_TYPE_ARRAY,
+    TEMP_TABLE_TYPE_HASHJOIN
 };
 
 struct temp_table {
@@ -214,6 +221,18 @@ struct temp_table {
     unsigned long long inmemsz;
     unsigned long long cachesz;
     arr_elem_t *elements;
+
+    /* hash join build side */
+    int hj_nfields;
+    tmptbl_hash hj_hashfunc;
+    tmptbl_prefix_cmp hj_cmpfunc;
+    unsigned long long hj_maxmem;
+    arr_elem_t *hj_elems;   /* entries, in insertion order */
+    unsigned int *hj_hash;  /* hash of each entry */
+    int *hj_group;          /* first entry of each entry's group */
+    int *hj_next;           /* next entry in the bucket chain, or -1 */
+    int *hj_buckets;        /* first entry of each bucket, or -1 */
+    int hj_capacity;        /* entries allocated, also the bucket count */
 };
 
 enum { TMPTBL_PRIORITY, TMPTBL_WAIT };
@@ -235,7 +254,7 @@ static int temp_table_compare(DB *db, const DBT *dbt1, const DBT *dbt2);
 /* refactored both insert and put code paths here */
 static int bdb_temp_table_insert_put(bdb_state_type *, struct temp_table *,
                                      void *key, int keylen, void *data,
-                                     int dtalen, int *bdberr);
+                                     int dtalen, void *unpacked, int *bdberr);
 
 void *bdb_temp_table_get_cur(struct temp_cursor *skippy) { return skippy->cur; }
 
@@ -476,6 +495,323 @@ static void bdb_temp_table_reset(struct temp_table *tbl)
 static int bdb_temp_table_reset_cursors( bdb_state_type *bdb_state, struct temp_table *tbl, int *bdberr);
 static int bdb_temp_table_reset_cursor(bdb_state_type *bdb_state, struct temp_cursor *cur, int *bdberr);
 
+static void bdb_hash_join_free(struct temp_table *tbl)
+{
+    int ii;
+
+    for (ii = 0; ii != tbl->num_mem_entries; ++ii)
+        free(tbl->hj_elems[ii].key);
+    free(tbl->hj_elems);
+    free(tbl->hj_hash);
+    free(tbl->hj_group);
+    free(tbl->hj_next);
+    free(tbl->hj_buckets);
+    tbl->hj_elems = NULL;
+    tbl->hj_hash = NULL;
+    tbl->hj_group = NULL;
+    tbl->hj_next = NULL;
+    tbl->hj_buckets = NULL;
+    tbl->hj_capacity = 0;
+    tbl->inmemsz = 0;
+}
+
+/* Double the entry arrays and rehash. A group's first entry precedes its
+   other entries, so relinking in insertion order keeps groups adjacent. */
+static int bdb_hash_join_grow(struct temp_table *tbl)
+{
+    int ii, grp, buk, cap;
+    void *p;
+
+    cap = tbl->hj_capacity ? tbl->hj_capacity * 2 : 1024;
+
+    if ((p = realloc(tbl->hj_elems, cap * sizeof(arr_elem_t))) == NULL)
+        return -1;
+    tbl->hj_elems = p;
+    if ((p = realloc(tbl->hj_hash, cap * sizeof(unsigned int))) == NULL)
+        return -1;
+    tbl->hj_hash = p;
+    if ((p = realloc(tbl->hj_group, cap * sizeof(int))) == NULL)
+        return -1;
+    tbl->hj_group = p;
+    if ((p = realloc(tbl->hj_next, cap * sizeof(int))) == NULL)
+        return -1;
+    tbl->hj_next = p;
+    if ((p = realloc(tbl->hj_buckets, cap * sizeof(int))) == NULL)
+        return -1;
+    tbl->hj_buckets = p;
+    tbl->hj_capacity = cap;
+
+    memset(tbl->hj_buckets, 0xff, cap * sizeof(int));
+    for (ii = 0; ii != tbl->num_mem_entries; ++ii) {
+        grp = tbl->hj_group[ii];
+        if (grp != ii) {
+            tbl->hj_next[ii] = tbl->hj_next[grp];
+            tbl->hj_next[grp] = ii;
+        } else {
+            buk = tbl->hj_hash[ii] & (cap - 1);
+            tbl->hj_next[ii] = tbl->hj_buckets[buk];
+            tbl->hj_buckets[buk] = ii;
+        }
+    }
+    return 0;
+}
+
+static int bdb_hash_join_copy_to_temp_db(bdb_state_type *bdb_state,
+                                         struct temp_table *tbl, int *bdberr)
+{
+    int rc = 0, ii;
+    DBT dbt_key, dbt_data;
+    struct temp_cursor *cur;
+    arr_elem_t *elem;
+    unsigned long long nents = tbl->num_mem_entries;
+
+    bzero(&dbt_key, sizeof(DBT));
+    bzero(&dbt_data, sizeof(DBT));
+
+    if (tbl->dbenv_temp == NULL &&
+        (rc = create_temp_db_env(bdb_state, tbl, bdberr)) != 0) {
+        logmsg(LOGMSG_ERROR, "%s: create_temp_db_env rc %d\n", __func__, rc);
+        return rc;
+    }
+
+    for (ii = 0; ii != nents; ++ii) {
+        elem = &tbl->hj_elems[ii];
+        dbt_key.flags = dbt_data.flags = DB_DBT_USERMEM;
+        dbt_key.ulen = dbt_key.size = elem->keylen;
+        dbt_data.ulen = dbt_data.size = elem->dtalen;
+        dbt_data.data = elem->dta;
+        dbt_key.data = elem->key;
+
+        rc = tbl->tmpdb->put(tbl->tmpdb, NULL, &dbt_key, &dbt_data, 0);
+        if (rc) {
+            logmsg(LOGMSG_ERROR, "%s:%d put rc %d\n", __FILE__, __LINE__, rc);
+            return rc;
+        }
+    }
+
+    bdb_hash_join_free(tbl);
+    tbl->num_mem_entries = nents;
+
+    /* its now a btree! */
+    tbl->temp_table_type = TEMP_TABLE_TYPE_BTREE;
+
+    LISTC_FOR_EACH(&tbl->cursors, cur, lnk)
+    {
+        rc = tbl->tmpdb->cursor(tbl->tmpdb, NULL, &cur->cur, 0);
+        if (rc) {
+            cur->cur = NULL;
+            logmsg(LOGMSG_ERROR, "%s:%d cursor rc %d\n", __FILE__, __LINE__,
+                   rc);
+            goto done;
+        }
+
+        /* New cursor does not point to any data */
+        cur->key = cur->data = NULL;
+        cur->keylen = cur->datalen = 0;
+        cur->valid = 0;
+    }
+
+done:
+    return rc;
+}
+
+/* Returns 1 if the key cannot be hashed: the table is then a btree, and
+   the caller inserts into it. */
+static int bdb_hash_join_insert(bdb_state_type *bdb_state,
+                                struct temp_table *tbl, void *key, int keylen,
+                                void *data, int dtalen, void *unpacked,
+                                int *bdberr)
+{
+    int ii, rc, buk, ent;
+    unsigned int hash;
+    arr_elem_t *elem;
+    uint8_t *keycopy;
+
+    if (unpacked == NULL) {
+        logmsg(LOGMSG_ERROR, "%s: hash join insert without unpacked key\n",
+               __func__);
+        *bdberr = BDBERR_BADARGS;
+        return -1;
+    }
+
+    if (tbl->hj_hashfunc(tbl->usermem, tbl->hj_nfields, unpacked, &hash)) {
+        gbl_temptable_spills++;
+        rc = bdb_hash_join_copy_to_temp_db(bdb_state, tbl, bdberr);
+        if (unlikely(rc)) {
+            return -1;
+        }
+        return 1;
+    }
+
+    if (tbl->num_mem_entries == tbl->hj_capacity &&
+        bdb_hash_join_grow(tbl) != 0) {
+        *bdberr = BDBERR_MALLOC;
+        return -1;
+    }
+
+    keycopy = malloc(keylen + dtalen);
+    if (keycopy == NULL) {
+        *bdberr = BDBERR_MALLOC;
+        return -1;
+    }
+    memcpy(keycopy, key, keylen);
+    memcpy(keycopy + keylen, data, dtalen);
+
+    buk = hash & (tbl->hj_capacity - 1);
+
+    /* join an existing group right after its first entry */
+    for (ii = tbl->hj_buckets[buk]; ii != -1; ii = tbl->hj_next[ii]) {
+        elem = &tbl->hj_elems[ii];
+        if (tbl->hj_hash[ii] == hash &&
+            tbl->hj_cmpfunc(tbl->usermem, tbl->hj_nfields, elem->keylen,
+                            elem->key, unpacked) == 0)
+            break;
+    }
+
+    ent = tbl->num_mem_entries;
+    if (ii != -1) {
+        tbl->hj_group[ent] = tbl->hj_group[ii];
+        tbl->hj_next[ent] = tbl->hj_next[ii];
+        tbl->hj_next[ii] = ent;
+    } else {
+        tbl->hj_group[ent] = ent;
+        tbl->hj_next[ent] = tbl->hj_buckets[buk];
+        tbl->hj_buckets[buk] = ent;
+    }
+    tbl->hj_hash[ent] = hash;
+
+    elem = &tbl->hj_elems[ent];
+    elem->keylen = keylen;
+    elem->key = keycopy;
+    elem->dtalen = dtalen;
+    elem->dta = keycopy + keylen;
+
+    ++tbl->num_mem_entries;
+    tbl->inmemsz += (keylen + dtalen);
+
+    if (tbl->inmemsz > tbl->hj_maxmem) {
+        gbl_temptable_spills++;
+        rc = bdb_hash_join_copy_to_temp_db(bdb_state, tbl, bdberr);
+        if (unlikely(rc)) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+#define HJ_SET_CUR(c, i)                                                       \
+    do {                                                                       \
+        arr_elem_t *elem = &(c)->tbl->hj_elems[(i)];                           \
+        (c)->ind = (i);                                                        \
+        (c)->key = elem->key;                                                  \
+        (c)->keylen = elem->keylen;                                            \
+        (c)->data = elem->dta;                                                 \
+        (c)->datalen = elem->dtalen;                                           \
+        (c)->valid = 1;                                                        \
+    } while (0)
+
+/* Position on the first entry whose join fields match `unpacked'. A miss
+   is reported as IX_PASTEOF: nothing in this table is greater or equal.
+   Sets *unhashable if the probe can only be answered by a btree. */
+static int bdb_hash_join_find(struct temp_cursor *cur, void *unpacked,
+                              int *unhashable)
+{
+    struct temp_table *tbl = cur->tbl;
+    unsigned int hash;
+    arr_elem_t *elem;
+    int ii;
+
+    cur->valid = 0;
+    cur->hj_group = -1;
+    if (tbl->num_mem_entries == 0)
+        return IX_EMPTY;
+    if (unpacked == NULL) {
+        logmsg(LOGMSG_ERROR, "%s: hash join probe without unpacked key\n",
+               __func__);
+        return -1;
+    }
+
+    if (tbl->hj_hashfunc(tbl->usermem, tbl->hj_nfields, unpacked, &hash)) {
+        *unhashable = 1;
+        return -1;
+    }
+    for (ii = tbl->hj_buckets[hash & (tbl->hj_capacity - 1)]; ii != -1;
+         ii = tbl->hj_next[ii]) {
+        elem = &tbl->hj_elems[ii];
+        if (tbl->hj_hash[ii] == hash &&
+            tbl->hj_cmpfunc(tbl->usermem, tbl->hj_nfields, elem->keylen,
+                            elem->key, unpacked) == 0) {
+            cur->hj_group = tbl->hj_group[ii];
+            HJ_SET_CUR(cur, ii);
+            return 0;
+        }
+    }
+    return IX_PASTEOF;
+}
+
+/* After a find, walk the probed group; otherwise walk insertion order. */
+static int bdb_hash_join_next_prev(struct temp_cursor *cur, int how)
+{
+    struct temp_table *tbl = cur->tbl;
+    int ii;
+
+    if (cur->hj_group != -1) {
+        if (how != DB_NEXT) {
+            logmsg(LOGMSG_ERROR, "%s: only forward moves on a hash join "
+                                 "probe\n", __func__);
+            return -1;
+        }
+        ii = tbl->hj_next[cur->ind];
+        if (ii == -1 || tbl->hj_group[ii] != cur->hj_group) {
+            cur->valid = 0;
+            return IX_PASTEOF;
+        }
+    } else {
+        ii = (how == DB_NEXT) ? cur->ind + 1 : cur->ind - 1;
+        if (ii < 0 || ii >= tbl->num_mem_entries) {
+            cur->valid = 0;
+            return IX_PASTEOF;
+        }
+    }
+
+    HJ_SET_CUR(cur, ii);
+    return IX_FND;
+}
+
+int bdb_temp_table_set_hash_join(bdb_state_type *bdb_state,
+                                 struct temp_table *tbl, int nfields,
+                                 tmptbl_hash hashfunc,
+                                 tmptbl_prefix_cmp cmpfunc,
+                                 unsigned long long maxmem, int *bdberr)
+{
+    struct temp_cursor *cur;
+
+    if (tbl->temp_table_type != TEMP_TABLE_TYPE_BTREE ||
+        tbl->num_mem_entries != 0 || nfields <= 0) {
+        logmsg(LOGMSG_ERROR, "%s: not an empty temptable\n", __func__);
+        *bdberr = BDBERR_BADARGS;
+        return -1;
+    }
+
+    /* the btree cursors come back if the table spills */
+    LISTC_FOR_EACH(&tbl->cursors, cur, lnk)
+    {
+        if (bdb_temp_table_reset_cursor(bdb_state, cur, bdberr) != 0)
+            return -1;
+        cur->valid = 0;
+        cur->hj_group = -1;
+    }
+
+    tbl->hj_nfields = nfields;
+    tbl->hj_hashfunc = hashfunc;
+    tbl->hj_cmpfunc = cmpfunc;
+    tbl->hj_maxmem = maxmem;
+    tbl->inmemsz = 0;
+    tbl->temp_table_type = TEMP_TABLE_TYPE_HASHJOIN;
+    return 0;
+}
+
 static int bdb_temp_table_init_temp_db(bdb_state_type *bdb_state,
                                        struct temp_table *tbl, int *bdberr)
 {
@@ -841,6 +1177,11 @@ struct temp_cursor *bdb_temp_table_cursor(bdb_state_type *bdb_state,
     case TEMP_TABLE_TYPE_ARRAY:
         cur->ind = 0;
         break;
+
+    case TEMP_TABLE_TYPE_HASHJOIN:
+        cur->ind = 0;
+        cur->hj_group = -1;
+        break;
     }
 
     if (rc) {
@@ -874,7 +1215,7 @@ int bdb_temp_table_insert(bdb_state_type *bdb_state, struct temp_cursor *cur,
     struct temp_table *tbl = cur->tbl;
 
     int rc = bdb_temp_table_insert_put(bdb_state, tbl, key, keylen, data,
-                                       dtalen, bdberr);
+                                       dtalen, NULL, bdberr);
     if (rc <= 0)
         goto done;
 
@@ -992,6 +1333,7 @@ unsigned long long bdb_temp_table_new_rowid(struct temp_table *tbl)
         }
         break;
     case TEMP_TABLE_TYPE_ARRAY:
+    case TEMP_TABLE_TYPE_HASHJOIN:
         if (tbl->num_mem_entries == 0)
             tbl->rowid = 0;
         break;
@@ -1010,7 +1352,7 @@ int bdb_temp_table_put(bdb_state_type *bdb_state, struct temp_table *tbl,
     DBT dkey, ddata;
 
     int rc = bdb_temp_table_insert_put(bdb_state, tbl, key, keylen, data,
-                                       dtalen, bdberr);
+                                       dtalen, unpacked, bdberr);
     if (rc <= 0)
         goto done;
 
@@ -1079,6 +1421,18 @@ static int bdb_temp_table_first_last(bdb_state_type *bdb_state,
         return 0;
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_HASHJOIN) {
+        arrlen = cur->tbl->num_mem_entries;
+        cur->hj_group = -1;
+        if (arrlen == 0) {
+            cur->valid = 0;
+            return IX_EMPTY;
+        }
+
+        HJ_SET_CUR(cur, (how == DB_LAST) ? (arrlen - 1) : 0);
+        return 0;
+    }
+
     REOPEN_CURSOR(cur);
 
     /*Pthread_setspecific(cur->tbl->curkey, cur);*/
@@ -1161,6 +1515,9 @@ static int bdb_temp_table_next_prev_norewind(bdb_state_type *bdb_state,
         return 0;
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_HASHJOIN)
+        return bdb_hash_join_next_prev(cur, how);
+
     REOPEN_CURSOR(cur);
 
     /*Pthread_setspecific(cur->tbl->curkey, cur);*/
@@ -1425,6 +1782,18 @@ int bdb_temp_table_truncate(bdb_state_type *bdb_state, struct temp_table *tbl,
         tbl->num_mem_entries = 0;
         break;
 
+    case TEMP_TABLE_TYPE_HASHJOIN: {
+        struct temp_cursor *cur;
+        bdb_hash_join_free(tbl);
+        tbl->num_mem_entries = 0;
+        LISTC_FOR_EACH(&tbl->cursors, cur, lnk)
+        {
+            cur->key = cur->data = NULL;
+            cur->valid = 0;
+            cur->hj_group = -1;
+        }
+    } break;
+
     case TEMP_TABLE_TYPE_BTREE:
         if (tbl->num_mem_entries < 100)
             rc = bdb_temp_table_truncate_temp_db(bdb_state, tbl, bdberr);
@@ -1656,6 +2025,10 @@ int bdb_temp_table_destroy_lru(struct temp_table *tbl,
         }
         break;
 
+    case TEMP_TABLE_TYPE_HASHJOIN:
+        bdb_hash_join_free(tbl);
+        break;
+
     case TEMP_TABLE_TYPE_BTREE:
         break;
     }
@@ -1715,6 +2088,13 @@ int bdb_temp_table_delete(bdb_state_type *bdb_state, struct temp_cursor *cur,
         goto done;
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_HASHJOIN) {
+        logmsg(LOGMSG_ERROR, "bdb_temp_table_delete operation not "
+                             "supported for hash join.\n");
+        rc = -1;
+        goto done;
+    }
+
     if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_ARRAY) {
         elem = &cur->tbl->elements[cur->ind];
         free(elem->key);
@@ -1829,6 +2209,16 @@ int bdb_temp_table_find(bdb_state_type *bdb_state, struct temp_cursor *cur,
         return bdb_temp_table_find_hash(cur, key, keylen);
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_HASHJOIN) {
+        int unhashable = 0;
+        rc = bdb_hash_join_find(cur, unpacked, &unhashable);
+        if (!unhashable)
+            return rc;
+        gbl_temptable_spills++;
+        if (bdb_hash_join_copy_to_temp_db(bdb_state, cur->tbl, bdberr))
+            return -1;
+    }
+
     if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_ARRAY) {
 
         /* Find the 1st occurrence of `key'. If `key' is not found,
@@ -1979,6 +2369,12 @@ int bdb_temp_table_find_exact(bdb_state_type *bdb_state,
         return bdb_temp_table_find_exact_hash(cur, key, keylen);
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_HASHJOIN) {
+        logmsg(LOGMSG_ERROR, "bdb_temp_table_find_exact operation not "
+                             "supported for hash join.\n");
+        return -1;
+    }
+
     if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_ARRAY) {
 
         /* Find the 1st occurrence of `key'. */
@@ -2266,7 +2662,7 @@ int bdb_temp_table_maybe_reset_priority_thread(bdb_state_type *bdb_state,
 static int bdb_temp_table_insert_put(bdb_state_type *bdb_state,
                                      struct temp_table *tbl, void *key,
                                      int keylen, void *data, int dtalen,
-                                     int *bdberr)
+                                     void *unpacked, int *bdberr)
 {
     int rc, cmp, lo, hi, mid;
     tmptbl_cmp cmpfn;
@@ -2361,6 +2757,14 @@ static int bdb_temp_table_insert_put(bdb_state_type *bdb_state,
         return 0;
     }
 
+    if (tbl->temp_table_type == TEMP_TABLE_TYPE_HASHJOIN) {
+        rc = bdb_hash_join_insert(bdb_state, tbl, key, keylen, data, dtalen,
+                                  unpacked, bdberr);
+        if (rc != 1)
+            return rc;
+        /* spilled, insert into the btree */
+    }
+
     assert (tbl->temp_table_type == TEMP_TABLE_TYPE_BTREE);
     tbl->num_mem_entries++;
 
@@ -60,6 +60,7 @@
 
 #include "logmsg.h"
 #include "txn_properties.h"
+#include "histogram.h"
 #include <build/db.h>
 
 static unsigned int curtran_counter = 0;
@@ -1589,6 +1590,7 @@ int bdb_tran_commit_with_seqnum_int(bdb_state_type *bdb_state, tran_type *tran,
     tran_type *physical_tran = NULL;
     DB_LSN lsn;
     DB_LSN old_lsn;
+    int64_t startus = comdb2_time_epochus();
 
     bzero(&lsn, sizeof(DB_LSN));
     bzero(&old_lsn, sizeof(DB_LSN));
@@ -2086,6 +2088,7 @@ int bdb_tran_commit_with_seqnum_int(bdb_state_type *bdb_state, tran_type *tran,
     }
 
     outrc = 0;
+    comdb2_histogram_add(gbl_commit_latency_hist, comdb2_time_epochus() - startus);
 
 cleanup:
 
@@ -1,4 +1,7 @@
-#include <db.h>
+#include "db_config.h"
+#include "db_int.h"
+#include "dbinc/db_page.h"
+#include "dbinc/mp.h"
 #include <btree/bt_cache.h>
 #include <crc32c.h>
 
@@ -15,8 +18,16 @@ uint32_t rcache_savd;
 uint32_t rcache_invalid;
 uint32_t rcache_collide;
 
+/*
+ * Per-thread lookaside copies of the top levels of btrees.  A search walks
+ * the copies without locking or latching those pages, then locks the first
+ * page it could not find here and only then checks that every copy it used
+ * still matches its buffer pool page (see rcache_valid).  Internal pages
+ * near the root rarely change, so the check almost always passes.
+ */
 typedef struct {
 	uint8_t fileid[DB_FILE_ID_LEN];
+	db_pgno_t pgno;
 	uint16_t gen;
 	uint32_t hitmiss;
 	void *bfpool_pg;
@@ -26,13 +37,14 @@ typedef struct {
 typedef struct {
 	size_t pgsz;
 	size_t count;
+	int levels;
 	CacheSlot slots[];
 } CacheHndl;
 
 static __thread CacheHndl *hndl = NULL;
 
 void
-rcache_init(size_t count, size_t pgsz)
+rcache_init(size_t count, size_t pgsz, int levels)
 {
 #ifdef __x86_64
 	if (pgsz % (4 * 1024) != 0) {
@@ -48,6 +60,11 @@ rcache_init(size_t count, size_t pgsz)
 	}
 	hndl->count = count;
 	hndl->pgsz = pgsz;
+	if (levels < 1)
+		levels = 1;
+	else if (levels > RCACHE_MAX_LEVELS)
+		levels = RCACHE_MAX_LEVELS;
+	hndl->levels = levels;
 	uint8_t *pages = (uint8_t *)&hndl->slots[count];
 	CacheSlot *slot = &hndl->slots[0];
 	CacheSlot *end = &hndl->slots[count];
@@ -62,10 +79,17 @@ rcache_init(size_t count, size_t pgsz)
 }
 
 static inline void
-hash_fileid(void *fileid, uint32_t * crc, uint32_t * hash)
+hash_fileid(void *fileid, db_pgno_t pgno, uint32_t * crc, uint32_t * hash)
 {
 	*crc = crc32c(fileid, DB_FILE_ID_LEN);
-	*hash = *crc % hndl->count;
+	*hash = (*crc ^ (pgno * 0x9e3779b1U)) % hndl->count;
+}
+
+/* Number of levels from the root this thread keeps copies of (0: none). */
+int
+rcache_levels(void)
+{
+	return hndl ? hndl->levels : 0;
 }
 
 void
@@ -78,19 +102,19 @@ rcache_destroy(void)
 }
 
 int
-rcache_find(DB *dbp, void **cached_pg, void **bfpool_pg,
+rcache_find(DB *dbp, db_pgno_t pgno, void **cached_pg, void **bfpool_pg,
     uint16_t * gen, uint32_t * slot_ptr)
 {
-	if (hndl == NULL || dbp->pgsize > hndl->pgsz)
+	if (hndl == NULL || dbp->pgsize > hndl->pgsz || dbp->norcache)
 		return -1;
 	uint32_t crc, slot;
 
-	hash_fileid(dbp->fileid, &crc, &slot);
+	hash_fileid(dbp->fileid, pgno, &crc, &slot);
 	if (crc == 0)
 		return -1;
 	CacheSlot *cache = &hndl->slots[slot];
 
-	if (cache->bfpool_pg
+	if (cache->bfpool_pg && cache->pgno == pgno
 	    && memcmp(cache->fileid, dbp->fileid, DB_FILE_ID_LEN) == 0) {
 		*cached_pg = cache->cached_pg;
 		*bfpool_pg = cache->bfpool_pg;
@@ -108,11 +132,11 @@ rcache_find(DB *dbp, void **cached_pg, void **bfpool_pg,
 int
 rcache_save(DB *dbp, void *page, uint16_t gen)
 {
-	if (hndl == NULL || dbp->pgsize > hndl->pgsz)
+	if (hndl == NULL || dbp->pgsize > hndl->pgsz || dbp->norcache)
 		return -1;
 	uint32_t crc, slot;
 
-	hash_fileid(dbp->fileid, &crc, &slot);
+	hash_fileid(dbp->fileid, PGNO(page), &crc, &slot);
 	if (crc == 0)
 		return -1;
 	CacheSlot *cache = &hndl->slots[slot];
@@ -125,6 +149,7 @@ rcache_save(DB *dbp, void *page, uint16_t gen)
 		}
 	}
 	cache->hitmiss = 1;
+	cache->pgno = PGNO(page);
 	cache->bfpool_pg = page;
 	cache->gen = gen;
 	memcpy(cache->cached_pg, page, dbp->pgsize);
@@ -133,6 +158,26 @@ rcache_save(DB *dbp, void *page, uint16_t gen)
 	return 0;
 }
 
+/*
+ * Check that the copy in slot still matches the buffer pool page it was
+ * taken from.  Any change to a page changes its LSN, and the buffer may
+ * since have been reused for another page, so compare the page number too.
+ */
+int
+rcache_valid(uint32_t slot, uint16_t gen)
+{
+	CacheSlot *cache = &hndl->slots[slot];
+	PAGE *cached_pg = cache->cached_pg;
+	PAGE *bfpool_pg = cache->bfpool_pg;
+
+	if (bfpool_pg == NULL || gen != GET_BH_GEN(bfpool_pg))
+		return 0;
+	if (PGNO(bfpool_pg) != PGNO(cached_pg) ||
+	    memcmp(&LSN(bfpool_pg), &LSN(cached_pg), sizeof(DB_LSN)) != 0)
+		return 0;
+	return gen == GET_BH_GEN(bfpool_pg);	/* re-check */
+}
+
 void
 rcache_invalidate(uint32_t slot)
 {
@@ -1,10 +1,15 @@
 #ifndef INCLUDE_BT_CACHE_H
 #define INCLUDE_BT_CACHE_H
 
+/* Most btree levels a thread may keep copies of */
+#define RCACHE_MAX_LEVELS 8
+
 struct __db;
-int rcache_find(struct __db *, void **cached_pg, void **bfpool_pg,
-	uint16_t * gen, uint32_t * slot);
+int rcache_levels(void);
+int rcache_find(struct __db *, db_pgno_t pgno, void **cached_pg,
+	void **bfpool_pg, uint16_t * gen, uint32_t * slot);
 int rcache_save(struct __db *, void *page, uint16_t gen);
+int rcache_valid(uint32_t slot, uint16_t gen);
 void rcache_invalidate(uint32_t slot);
 
 #define GET_BH_GEN(pg) (*(uint16_t *)((uint8_t *)pg - (offsetof(BH, buf) - offsetof(BH, generation))))
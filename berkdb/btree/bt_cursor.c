@@ -560,6 +560,26 @@ comdb2__db_c_firstleaf(dbc, pgno)
 	return rc;
 }
 
+static int
+comdb2__db_c_pgcount(dbc, countp, tick, tickarg)
+	DBC *dbc;
+	u_int64_t *countp;
+	int (*tick) __P((void *));
+	void *tickarg;
+{
+	int rc = __db_c_pgcount(dbc, countp, tick, tickarg);
+
+	if (rc == DB_LOCK_DEADLOCK) {
+#ifndef TESTSUITE
+		if (debug_switch_verbose_cursor_deadlocks() &&
+		    !gbl_disable_deadlock_trace)
+			stack_me("c_pgcount deadlock");
+#endif
+	}
+
+	return rc;
+}
+
 int
 comdb2__db_c_unpause(dbc, dbcps)
 	DBC *dbc;
@@ -936,6 +956,7 @@ __bam_c_init(dbc, dbtype)
 
 	dbc->c_close_ser = comdb2__db_c_close_ser;
 	dbc->c_firstleaf = comdb2__db_c_firstleaf;
+	dbc->c_pgcount = comdb2__db_c_pgcount;
 	dbc->c_pause = comdb2__db_c_pause;
 	dbc->c_unpause = comdb2__db_c_unpause;
 	dbc->c_count = comdb2__db_c_count_pp;
@@ -1673,7 +1694,7 @@ done:	/*
 
 
 #if USE_BTPF
-	btpf_rst((btpf *) dbc->pf);
+	crsr_close(dbc);
 #endif
 	/* Downgrade any CDB lock we acquired. */
 	if (cdb_lock)
@@ -3629,6 +3650,9 @@ __bam_c_next(dbc, initial_move, deleted_okay)
 				ACQUIRE_CUR(dbc, lock_mode, pgno, ret);
 				if (ret != 0)
 					return (ret);
+#if USE_BTPF
+				crsr_pf_ovfl(dbc);
+#endif
 			}
 			cp->indx = 0;
 
@@ -3702,8 +3726,6 @@ __bam_c_prev(dbc)
 	for (;;) {
 		/* If at the beginning of the page, move to a previous one. */
 		if (cp->indx == 0) {
-
-			crsr_pf_prv(dbc);
 			/* See comments in __bam_c_next. */
 			if (F_ISSET(dbc, DBC_PAGE_ORDER)) {
 				do {
@@ -3745,6 +3767,9 @@ __bam_c_prev(dbc)
 				ACQUIRE_CUR(dbc, lock_mode, pgno, ret);
 				if (ret != 0)
 					return (ret);
+#if USE_BTPF
+				crsr_pf_ovfl(dbc);
+#endif
 			}
 
 			if ((cp->indx = NUM_ENT(cp->page)) == 0)
@@ -18,6 +18,7 @@
 
 #include "dbinc/btree.h"
 #include "logmsg.h"
+#include "comdb2_atomic.h"
 
 extern struct thdpool *gbl_udppfault_thdpool;
 
@@ -120,6 +121,9 @@ void
 btpf_copy_dbc(DBC *dbc, DBC *ndbc)
 {
 	btpf_copy(PFX(dbc), PFX(ndbc));
+	/* The pages read ahead now belong to the new cursor */
+	if (PFX(dbc))
+		PFX(dbc)->pending = 0;
 }
 
 void
@@ -151,9 +155,80 @@ btpf_rst(btpf * x)
 	x->wndw = 0;
 	x->tr_page = PGNO_INVALID;
 	x->on = PF_ON;
+	x->seq_pg_cnt = 0;
 	// TODO update stats
 }
 
+/*
+ * The cursor is leaving its scan: whatever was read ahead for it and not
+ * reached yet was wasted.  A cursor that wastes most of its window has to
+ * read a longer run of pages before it gets read ahead again, so random
+ * access quickly stops prefetching.
+ */
+static inline void
+pf_settle(DBC *dbc)
+{
+	btpf *f = PFX(dbc);
+
+	if (f->pending == 0)
+		return;
+	ATOMIC_ADD64(dbc->dbp->pf_wasted, f->pending);
+	if (f->pending * 2 > f->wndw && f->backoff < PF_MAX_BACKOFF)
+		f->backoff++;
+	f->pending = 0;
+}
+
+/* The cursor moved to another leaf page in the same direction */
+static inline void
+pf_next_page(DBC *dbc)
+{
+	btpf *f = PFX(dbc);
+
+	f->seq_pg_cnt++;
+	if (f->pending == 0)
+		return;
+	ATOMIC_ADD64(dbc->dbp->pf_hits, 1);
+	/* read all of its window: this cursor really is scanning */
+	if (--f->pending == 0 && f->backoff > 0)
+		f->backoff--;
+}
+
+void
+crsr_close(DBC *dbc)
+{
+	if (!PFX(dbc))
+		return;
+	pf_settle(dbc);
+	btpf_rst(PFX(dbc));
+}
+
+/*
+ * Read ahead the overflow items of the leaf page a scanning cursor just
+ * moved to, so that they are in the cache by the time it gets to them.
+ */
+void
+crsr_pf_ovfl(DBC *dbc)
+{
+	BTREE_CURSOR *cp = (BTREE_CURSOR *)dbc->internal;
+	DB *dbp = dbc->dbp;
+	BKEYDATA *bk;
+	db_pgno_t pgno;
+	PAGE *h = cp->page;
+	db_indx_t i;
+
+	if (!PFX(dbc) || PFX(dbc)->status != PF || h == NULL ||
+	    TYPE(h) != P_LBTREE)
+		return;
+
+	for (i = O_INDX; i < NUM_ENT(h); i += P_INDX) {
+		bk = GET_BKEYDATA(dbp, h, i);
+		if (B_TYPE(bk) != B_OVERFLOW)
+			continue;
+		ASSIGN_ALIGN(db_pgno_t, pgno, ((BOVERFLOW *)bk)->pgno);
+		LOAD(dbp->mpf, pgno);
+	}
+}
+
 static inline void
 btpf_cnt_rst(btpf * pf)
 {
@@ -173,6 +248,7 @@ crsr_nxt(DBC *dbc)
 	if (PFX(dbc)->status == LOADED_ALL)
 		return 0;
 	if (PFX(dbc)->direction == BACKWARD) {
+		pf_settle(dbc);
 		btpf_rst(PFX(dbc));
 		if (PFX(dbc)->status == PF || PFX(dbc)->status == LOADED_ALL) 
 			ret = tree_walk(dbc, SRCH_CUR, 1, RMBR_LVL );
@@ -199,6 +275,7 @@ crsr_prv(DBC *dbc)
 	if (PFX(dbc)->status == LOADED_ALL)
 		return 0;
 	if (PFX(dbc)->direction == FORWARD) {
+		pf_settle(dbc);
 		btpf_rst(PFX(dbc));
 		if (PFX(dbc)->status == PF || PFX(dbc)->status == LOADED_ALL)
 			ret = tree_walk(dbc, SRCH_CUR, 1, RMBR_LVL );
@@ -226,12 +303,14 @@ crsr_pf_nxt(DBC *dbc)
 	if (PFX(dbc)->status == LOADED_ALL)
 		return 0;
 	if (PFX(dbc)->direction == BACKWARD) {
+		pf_settle(dbc);
 		btpf_rst(PFX(dbc));
 		if (PFX(dbc)->status == PF || PFX(dbc)->status == LOADED_ALL)
 			ret = tree_walk(dbc, SRCH_CUR, 1, RMBR_LVL );
 	}
 	PFX(dbc)->direction = FORWARD;  
 	if (!ret) {
+		pf_next_page(dbc);
 		PFX(dbc)->rdr_pg_cnt++;
 		PFX(dbc)->rdr_rec_cnt++;
 		ret = chk_forward(dbc);
@@ -256,6 +335,7 @@ crsr_pf_prv(DBC *dbc)
 		return 0;
 	if (PFX(dbc)->direction == FORWARD) {
 
+		pf_settle(dbc);
 		btpf_rst(PFX(dbc));
 		if (PFX(dbc)->status == PF || PFX(dbc)->status == LOADED_ALL)
 			ret = tree_walk(dbc, SRCH_CUR, 1, RMBR_LVL );
@@ -264,6 +344,7 @@ crsr_pf_prv(DBC *dbc)
 	PFX(dbc)->direction = BACKWARD;
 
 	if (!ret) {
+		pf_next_page(dbc);
 		PFX(dbc)->rdr_pg_cnt++;
 		PFX(dbc)->rdr_rec_cnt++;
 		ret = chk_backward(dbc);
@@ -281,7 +362,8 @@ crsr_jump(DBC *dbc)
 	if (!PFX(dbc))
 		return 0;
 	TEST_STOP(dbc)
-	    btpf_rst(PFX(dbc));
+	pf_settle(dbc);
+	btpf_rst(PFX(dbc));
 
 	return (0);
 }
@@ -298,6 +380,10 @@ chk_forward(DBC *dbc)
 	if (f->status == LOADED_ALL)
 		return rst;
 
+	/* Only read ahead for cursors that are scanning */
+	if (f->status == INIT && f->seq_pg_cnt < (SEQ_PAGES(dbc) << f->backoff))
+		return rst;
+
 	th = f->wndw - f->rdr_pg_cnt - CU_GAP(dbc);  
 	fetch = (th <= 0);
 
@@ -312,6 +398,9 @@ chk_forward(DBC *dbc)
 		adj_wndw(dbc, f);
 		start_loading(dbc);
 		f->status = PF;
+		/* the window starts at the cursor, so it covers what is
+		 * still pending from the last one */
+		f->pending = f->wndw;
 		btpf_cnt_rst(f);
 	}
 	return rst;
@@ -328,7 +417,10 @@ chk_backward(DBC *dbc)
 
 	if (f->status == LOADED_ALL)
 		return rst;    
-        
+
+	if (f->status == INIT && f->seq_pg_cnt < (SEQ_PAGES(dbc) << f->backoff))
+		return rst;
+
 	th = f->wndw - f->rdr_pg_cnt - CU_GAP(dbc);
 	fetch = (th <= 0);
 
@@ -343,6 +435,7 @@ chk_backward(DBC *dbc)
 		adj_wndw(dbc,f);
 		start_loading(dbc);
 		f->status = PF;
+		f->pending = f->wndw;
 		btpf_cnt_rst(f);
 	}
 	return rst;
@@ -426,6 +519,8 @@ start_loading(DBC *dbc)
 	job->mpf = dbc->dbp->mpf;
 	job->db = dbc->dbp;
 	job->dirty = PFX(dbc)->status == PF || PFX(dbc)->status == LOADED_ALL;	// TODO it cannot be on LOADED_ALL when it runs asynchronously
+	/* the descent recorded at the last search is behind the cursor by now */
+	job->dirty |= PFX(dbc)->seq_pg_cnt > 0;
 	job->lid = dbc->lid;
 	job->locker = dbc->locker;
 #if BTPF_SAME_THREAD
@@ -667,6 +762,7 @@ page_load_f(btpf * pf, DBC *dbc)
 		}
 
 		c += p_cnt;
+		ATOMIC_ADD64(dbp->pf_pages, p_cnt);
 		pf->curindx[1] += p_cnt;
 		PAGEPUT(dbc, mpf, h, 0);
 		(void)__LPUT(dbc, lock);
@@ -746,6 +842,7 @@ page_load_b(btpf * pf, DBC *dbc)
 			fprintf(stderr, "LOADING: %u from:%u indx:%d of:%d real:%d\n", t_pgno, pgno, i, pf->maxindx[1], h->entries );
 #endif            
 			LOAD(mpf,t_pgno);
+			ATOMIC_ADD64(dbp->pf_pages, 1);
 
 			if (i == 0)
 				break; // it's an unsigned type it overflows and loop forever otherwise
@@ -17,6 +17,11 @@
 #define WNDW_INC(dbc) dbc->dbp->dbenv->attr.btpf_wndw_inc
 #define WNDW_MAX(dbc) dbc->dbp->dbenv->attr.btpf_wndw_max
 #define MIN_TH(dbc)   dbc->dbp->dbenv->attr.btpf_min_th
+#define SEQ_PAGES(dbc) dbc->dbp->dbenv->attr.btpf_seq_pages
+
+/* Cursors that keep wasting their read ahead need up to 2^PF_MAX_BACKOFF
+ * times more sequential pages before they get another one */
+#define PF_MAX_BACKOFF 5
 
 typedef enum {
 	INIT,
@@ -56,6 +61,9 @@ typedef struct {
 	u_int32_t   rdr_pg_cnt; // pages read by the cursor to catch up
 	u_int32_t   wndw;
 	u_int32_t   on; // pre-faulting is on/off
+	u_int32_t   seq_pg_cnt; // consecutive leaf pages read in the same direction
+	u_int32_t   pending; // pages read ahead that the cursor hasn't reached yet
+	u_int32_t   backoff; // scan length needed is SEQ_PAGES << backoff
    
 	db_pgno_t curlf[RMBR_LVL];	// the chain of pages to reach the cursor 
 	db_indx_t curindx[RMBR_LVL];	// current entry per level
@@ -91,4 +99,6 @@ int crsr_prv(DBC *dbc);
 int crsr_pf_nxt(DBC *dbc);
 int crsr_pf_prv(DBC *dbc);
 int crsr_jump(DBC *dbc);
+void crsr_close(DBC *dbc);
+void crsr_pf_ovfl(DBC *dbc);
 #endif
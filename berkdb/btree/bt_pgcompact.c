@@ -115,6 +115,8 @@ static const char *reasons[] = {
 int gbl_pgcomp_dryrun = 0; /* dry-run */
 int gbl_pgcomp_dbg_stdout = 0;
 int gbl_pgcomp_dbg_ctrace = 0;
+/* number of leaf pages this thread has merged away */
+__thread u_int32_t gbl_pgcomp_npages_freed = 0;
 
 #define REASON(i)																		            \
 	do {																				            \
@@ -1012,6 +1014,7 @@ retry:
 		if ((ret = __bam_dpages(dupc, dupcp->sp, 1)) != 0)
 			goto err_zero_h;
 		nh = NULL;
+		++gbl_pgcomp_npages_freed;
 
 		REASON(REASON_WHOAH);
 
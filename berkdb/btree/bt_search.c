@@ -340,6 +340,9 @@ __bam_search(dbc, root_pgno, key, flags, stop, recnop, exactp)
 	int save = 0;
 	uint16_t gen;
 	uint32_t slot;
+	int depth, levels = 0, npath, n;
+	uint32_t path_slot[RCACHE_MAX_LEVELS];
+	uint16_t path_gen[RCACHE_MAX_LEVELS];
 	unsigned int hh = 0;
 	genid_hash *hash = NULL;
 	__genid_pgno *hashtbl = NULL;
@@ -384,6 +387,7 @@ try_again:
 	pg = root_pgno == PGNO_INVALID ? cp->root : root_pgno;
 	stack = LF_ISSET(S_STACK) && F_ISSET(cp, C_RECNUM);
 	lock_mode = stack ? DB_LOCK_WRITE : DB_LOCK_READ;
+	depth = npath = 0;
 
 	dbp->pg_hash_stat.n_bt_search++;
 	gettimeofday(&before, NULL);
@@ -391,10 +395,15 @@ try_again:
 	extern int gbl_rcache;
 
 	if (gbl_rcache && pg == 1 && bfpool_pg == NULL &&
-	    lock_mode == DB_LOCK_READ && LF_ISSET(S_FIND)) {
+	    lock_mode == DB_LOCK_READ && LF_ISSET(S_FIND) &&
+	    !LF_ISSET(S_PARENT | S_STK_ONLY)) {
 		save = 1;
+		levels = rcache_levels();
 		if (rcache_find(
-		    dbp, &cached_pg, &bfpool_pg, &gen, &slot) == 0) {
+		    dbp, pg, &cached_pg, &bfpool_pg, &gen, &slot) == 0) {
+			path_slot[0] = slot;
+			path_gen[0] = gen;
+			npath = 1;
 			h = cached_pg;
 			goto got_pg;
 		}
@@ -727,6 +736,22 @@ next:		if (recnop != NULL)
 			lock_mode = stack &&
 			    LF_ISSET(S_WRITE) ? DB_LOCK_WRITE : DB_LOCK_READ;
 
+			if (cached_pg && !stack && depth + 1 < levels &&
+			    rcache_find(dbp, pg, &cached_pg, &bfpool_pg, &gen,
+				&slot) == 0) {
+				/*
+				 * The child is cached as well: keep going
+				 * without locking or fetching it.  Every copy
+				 * on the path is validated once we reach a
+				 * page we have to fetch.
+				 */
+				path_slot[npath] = slot;
+				path_gen[npath++] = gen;
+				h = cached_pg;
+				++depth;
+				continue;
+			}
+
 			if (cached_pg) {
 				/* Used rcache to get here. Don't lck couple. */
 				if ((ret = __db_lget(dbc, 0, pg, lock_mode, 0,
@@ -762,7 +787,8 @@ next:		if (recnop != NULL)
 				 */
 				cached_pg = NULL;
 
-				rcache_invalidate(slot);
+				for (n = 0; n < npath; ++n)
+					rcache_invalidate(path_slot[n]);
 				__LPUT(dbc, lock);
 				goto try_again;
 			}
@@ -771,18 +797,17 @@ next:		if (recnop != NULL)
 
 		if (cached_pg) {
 			/* Used rcache and got child page. Validate rcache. */
-			DB_LSN *l1 = &LSN(cached_pg);
-			DB_LSN *l2 = &LSN(bfpool_pg);
 			cached_pg = NULL;
 
-			if (gen == GET_BH_GEN(bfpool_pg)
-			    && memcmp(l1, l2, sizeof(DB_LSN)) == 0 && gen == GET_BH_GEN(bfpool_pg)	//re-check. warm&fuzzy
-			    ) {
-				;
-			} else {
+			for (n = 0; n < npath; ++n) {
+				if (!rcache_valid(path_slot[n], path_gen[n]))
+					break;
+			}
+			if (n < npath) {
 				PAGEPUT(dbc, mpf, h, 0);
 				__LPUT(dbc, lock);
-				rcache_invalidate(slot);
+				for (n = 0; n < npath; ++n)
+					rcache_invalidate(path_slot[n]);
 				goto try_again;
 			}
 		}
@@ -803,6 +828,13 @@ next:		if (recnop != NULL)
 		default:
 			return (__db_pgfmt(dbp->dbenv, PGNO(h)));
 		}
+
+		if (save && ++depth < levels && TYPE(h) == P_IBTREE) {
+			uint16_t gen = LSN(h).file + LSN(h).offset;
+
+			GET_BH_GEN(h) = gen;
+			rcache_save(dbp, h, gen);
+		}
 	}
 	/* NOTREACHED */
 
@@ -403,6 +403,123 @@ __bam_stat_callback(dbp, h, cookie, putp)
 	return (0);
 }
 
+/* How many leaf pages __bam_pgcount visits between calls to its tick. */
+#define	PGCOUNT_TICK_PAGES	64
+
+/*
+ * __bam_pgcount --
+ *	comdb2 addition: count the records in a btree from its leaf pages
+ *	without copying out any keys or data.  Descends once to the leftmost
+ *	leaf, then follows the leaf chain lock-coupled, exactly like a cursor
+ *	walk, so a DBC_SNAPSHOT cursor counts the page versions it would see
+ *	through c_get.  Overflow pages are never read.  If tick is not NULL it
+ *	is called every PGCOUNT_TICK_PAGES leaves and a non-zero return stops
+ *	the walk and is returned to the caller.
+ *
+ * PUBLIC: int __bam_pgcount __P((DBC *, u_int64_t *,
+ * PUBLIC:     int (*)(void *), void *));
+ */
+int
+__bam_pgcount(dbc, countp, tick, tickarg)
+	DBC *dbc;
+	u_int64_t *countp;
+	int (*tick) __P((void *));
+	void *tickarg;
+{
+	BKEYDATA *bk;
+	BTREE_CURSOR *cp;
+	DB *dbp;
+	DB_BTREE_STAT dupstat;
+	DB_LOCK lock;
+	DB_MPOOLFILE *mpf;
+	PAGE *h;
+	db_indx_t indx, top;
+	db_pgno_t pgno;
+	u_int64_t count, npages;
+	int ret, t_ret;
+
+	dbp = dbc->dbp;
+	mpf = dbp->mpf;
+	cp = (BTREE_CURSOR *)dbc->internal;
+	h = NULL;
+	LOCK_INIT(lock);
+	count = npages = 0;
+
+	pgno = cp->root;
+	if ((ret = __db_lget(dbc, 0, pgno, DB_LOCK_READ, 0, &lock)) != 0)
+		goto err;
+	if ((ret = PAGEGET(dbc, mpf, &pgno, 0, &h)) != 0)
+		goto err;
+
+	/* Record-numbered trees keep the total in the root. */
+	if (F_ISSET(dbp, DB_AM_RECNUM) && TYPE(h) == P_IBTREE) {
+		count = RE_NREC(h);
+		goto done;
+	}
+
+	/* Descend the left spine. */
+	while (TYPE(h) == P_IBTREE) {
+		pgno = GET_BINTERNAL(dbp, h, 0)->pgno;
+		if ((ret = PAGEPUT(dbc, mpf, h, 0)) != 0)
+			goto err;
+		h = NULL;
+		if ((ret = __db_lget(dbc,
+		    LCK_COUPLE_ALWAYS, pgno, DB_LOCK_READ, 0, &lock)) != 0)
+			goto err;
+		if ((ret = PAGEGET(dbc, mpf, &pgno, 0, &h)) != 0)
+			goto err;
+	}
+
+	for (;;) {
+		if (TYPE(h) != P_LBTREE) {
+			ret = __db_pgfmt(dbp->dbenv, PGNO(h));
+			goto err;
+		}
+
+		top = NUM_ENT(h);
+		for (indx = 0; indx < top; indx += P_INDX) {
+			bk = GET_BKEYDATA(dbp, h, indx + O_INDX);
+			if (B_DISSET(bk))
+				continue;
+			if (B_TYPE(bk) != B_DUPLICATE) {
+				++count;
+				continue;
+			}
+			/* Off-page duplicate set: count its leaves instead. */
+			memset(&dupstat, 0, sizeof(dupstat));
+			if ((ret = __bam_traverse(dbc, DB_LOCK_READ,
+			    GET_BOVERFLOW(dbp, h, indx + O_INDX)->pgno,
+			    __bam_stat_callback, &dupstat)) != 0)
+				goto err;
+			count += dupstat.bt_ndata;
+		}
+
+		if ((pgno = NEXT_PGNO(h)) == PGNO_INVALID)
+			break;
+
+		if (tick != NULL && ++npages % PGCOUNT_TICK_PAGES == 0 &&
+		    (ret = tick(tickarg)) != 0)
+			goto err;
+
+		if ((ret = PAGEPUT(dbc, mpf, h, 0)) != 0)
+			goto err;
+		h = NULL;
+		if ((ret = __db_lget(dbc,
+		    LCK_COUPLE_ALWAYS, pgno, DB_LOCK_READ, 0, &lock)) != 0)
+			goto err;
+		if ((ret = PAGEGET(dbc, mpf, &pgno, 0, &h)) != 0)
+			goto err;
+	}
+
+done:	*countp = count;
+
+err:	if (h != NULL && (t_ret = PAGEPUT(dbc, mpf, h, 0)) != 0 && ret == 0)
+		ret = t_ret;
+	__LPUT(dbc, lock);
+
+	return (ret);
+}
+
 /*
  * __bam_key_range --
  *	Return proportion of keys relative to given key.  The numbers are
@@ -176,6 +176,9 @@ struct __mempv_cache; typedef struct __mempv_cache MEMPV_CACHE;
 struct __mempv_cache_page_header; typedef struct __mempv_cache_page_header MEMPV_CACHE_PAGE_HEADER;
 struct __mempv_cache_page_key; typedef struct __mempv_cache_page_key MEMPV_CACHE_PAGE_KEY;
 struct __mempv_cache_page_versions; typedef struct __mempv_cache_page_versions MEMPV_CACHE_PAGE_VERSIONS;
+struct __mempv_vstore; typedef struct __mempv_vstore MEMPV_VSTORE;
+struct __mempv_vstore_stripe; typedef struct __mempv_vstore_stripe MEMPV_VSTORE_STRIPE;
+struct __mempv_vstore_entry; typedef struct __mempv_vstore_entry MEMPV_VSTORE_ENTRY;
 
 struct txn_properties;
 
@@ -1883,6 +1886,14 @@ struct __db {
 	int offset_bias;
 	uint8_t olcompact;
 	struct __db_trigger_subscription *trigger_subscription;
+
+	/* Cursor read ahead (bt_pf.c) */
+	u_int64_t pf_pages;		/* Leaf pages read ahead. */
+	u_int64_t pf_hits;		/* .. that a cursor went on to read. */
+	u_int64_t pf_wasted;		/* .. that a cursor never reached. */
+
+	/* Don't keep copies of this btree's top levels (bt_cache.c). */
+	u_int8_t norcache;
 };
 
 /*
@@ -2014,6 +2025,8 @@ struct __dbc {
 	int (*c_getpgno) __P((DBC *, db_pgno_t *pgno));
 	int (*c_getnextpgno) __P((DBC *, db_pgno_t *nextpgno));
 	int (*c_firstleaf) __P((DBC *, db_pgno_t *pgno));
+	int (*c_pgcount) __P((DBC *, u_int64_t *count,
+				int (*tick)(void *), void *tickarg));
 	int (*c_getgenids) __P((DBC *, unsigned long long *genids, int *num,
 							 int max  ));
 	int (*c_close_ser) __P((DBC *, DBCS *));
@@ -2892,8 +2905,37 @@ struct __mempv_cache
 	LISTC_T(struct __mempv_cache_page_header) evict_list;
 };
 
+/*
+ * Recently written page log records, kept so that snapshot readers can
+ * unroll page versions without going to the log.  Striped by LSN so that
+ * writers and readers rarely contend on the same lock.
+ */
+#define	MEMPV_VSTORE_STRIPES	16
+
+struct __mempv_vstore_entry
+{
+	DB_LSN lsn;
+	u_int32_t size;
+	LINKC_T(struct __mempv_vstore_entry) lnk;
+	u_int8_t data[1];
+};
+
+struct __mempv_vstore_stripe
+{
+	pthread_mutex_t lock;
+	hash_t *records;
+	size_t bytes;
+	LISTC_T(struct __mempv_vstore_entry) fifo;
+};
+
+struct __mempv_vstore
+{
+	struct __mempv_vstore_stripe stripes[MEMPV_VSTORE_STRIPES];
+};
+
 struct __mempv {
 	struct __mempv_cache cache;
+	struct __mempv_vstore vstore;
 };
 
 struct __mempv_cache_page_versions
@@ -430,6 +430,35 @@ err:	if ((t_ret = __db_c_close(dbc)) != 0)
 	return (ret);
 }
 
+/*
+ * __db_c_pgcount --
+ *  DBC->c_pgcount
+ *  comdb2 addition: count the records under this cursor's btree from
+ *  leaf page headers.  The cursor's snapshot settings are honored.
+ *
+ * PUBLIC: int __db_c_pgcount __P((DBC *, u_int64_t *,
+ * PUBLIC:     int (*)(void *), void *));
+ */
+int
+__db_c_pgcount(dbc, countp, tick, tickarg)
+	DBC *dbc;
+	u_int64_t *countp;
+	int (*tick) __P((void *));
+	void *tickarg;
+{
+	switch (dbc->dbtype) {
+	case DB_BTREE:
+		return (__bam_pgcount(dbc, countp, tick, tickarg));
+	case DB_RECNO:
+	case DB_HASH:
+	case DB_QUEUE:
+	case DB_UNKNOWN:
+	default:
+		return (__db_unknown_type(dbc->dbp->dbenv, "__db_c_pgcount",
+		    dbc->dbtype));
+	}
+}
+
 /*
  * __db_c_pause --
  *	DBC->c_pause.
@@ -27,12 +27,13 @@ BERK_DEF_ATTR(check_applied_lsns_debug, "Lots of verbose trace for debugging app
 BERK_DEF_ATTR(sgio_enabled, "Do scatter gather I/O", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(sgio_max, "Max scatter gather I/O to do at one time", BERK_ATTR_TYPE_INTEGER, 10 * MEGABYTE)
 BERK_DEF_ATTR(btpf_enabled, "Enables index pages read ahead", BERK_ATTR_TYPE_BOOLEAN, 0)
-BERK_DEF_ATTR(btpf_wndw_min, "Minimum number of pages read ahead", BERK_ATTR_TYPE_INTEGER, 100 )
-BERK_DEF_ATTR(btpf_wndw_max, "Maximum number of pages read ahead", BERK_ATTR_TYPE_INTEGER, 1000 )
-BERK_DEF_ATTR(btpf_wndw_inc, "Increment factor for the number of pages read ahead", BERK_ATTR_TYPE_INTEGER, 1)
+BERK_DEF_ATTR(btpf_wndw_min, "Minimum number of pages read ahead", BERK_ATTR_TYPE_INTEGER, 16 )
+BERK_DEF_ATTR(btpf_wndw_max, "Maximum number of pages read ahead", BERK_ATTR_TYPE_INTEGER, 512 )
+BERK_DEF_ATTR(btpf_wndw_inc, "Increment factor for the number of pages read ahead", BERK_ATTR_TYPE_INTEGER, 2)
 BERK_DEF_ATTR(btpf_pg_gap, "Min. number of records to the page limit before read ahead", BERK_ATTR_TYPE_INTEGER, 0)
 BERK_DEF_ATTR(btpf_cu_gap, "How close a cursor should be (pages) to the prefaulted limit before prefaulting again", BERK_ATTR_TYPE_INTEGER, 5)
 BERK_DEF_ATTR(btpf_min_th, "Preload pages only if the tree has heigth less than this parameter", BERK_ATTR_TYPE_INTEGER, 1)
+BERK_DEF_ATTR(btpf_seq_pages, "Number of consecutive leaf pages a cursor must read in one direction before read ahead starts", BERK_ATTR_TYPE_INTEGER, 2)
 BERK_DEF_ATTR(recovery_verify, "After recovery, run a full pass to make sure everything is applied", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(recovery_verify_fatal, "Abort if recovery_verify is set, and fails.", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(cache_lc, "Collect logs into LSN_COLLECTIONs as they come in", BERK_ATTR_TYPE_BOOLEAN, 0)
@@ -57,6 +58,8 @@ BERK_DEF_ATTR(latch_max_poll, "Poll latch this many times before returning deadl
 BERK_DEF_ATTR(latch_timed_mutex, "Use a timed mutex", BERK_ATTR_TYPE_BOOLEAN, 1)
 BERK_DEF_ATTR(log_cursor_cache, "Cache log cursors", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(recovery_processor_poll_interval_us, "Recovery processor wakes this often to check workers", BERK_ATTR_TYPE_INTEGER, 1000)
+BERK_DEF_ATTR(recovery_forward_threads, "Threads applying page records in the forward pass of startup recovery (0 applies them on the recovery thread)", BERK_ATTR_TYPE_INTEGER, 0)
+BERK_DEF_ATTR(recovery_forward_queue, "Most log records queued for each forward pass recovery thread", BERK_ATTR_TYPE_INTEGER, 1000)
 BERK_DEF_ATTR(lsnerr_logflush, "Flush log on lsn error", BERK_ATTR_TYPE_BOOLEAN, 1)
 BERK_DEF_ATTR(tracked_locklist_init, "Initial allocation count for tracked locks", BERK_ATTR_TYPE_INTEGER, 10)
 /* This is a placeholder for now */
@@ -65,3 +68,4 @@ BERK_DEF_ATTR(elect_highest_committed_gen, "Bias election by the highest generat
 BERK_DEF_ATTR(sync_standalone, "Force a log-sync at commit for standalone instances", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(mempv_max_cache_entries, "Maximum number of cache entries in versioned memory pool", BERK_ATTR_TYPE_INTEGER, 50)
 BERK_DEF_ATTR(mempv_debug, "Produce debug output in versioned memory pool", BERK_ATTR_TYPE_BOOLEAN, 0)
+BERK_DEF_ATTR(mempv_version_store_size, "Bytes of recent page log records kept in memory for unrolling snapshot page versions (0 to disable)", BERK_ATTR_TYPE_INTEGER, 67108864)
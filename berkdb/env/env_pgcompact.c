@@ -25,6 +25,7 @@
 #include "db_int.h"
 #include "dbinc/db_am.h"
 #include "dbinc/log.h"
+#include "dbinc/mp.h"
 #include "dbinc/txn.h"
 #include "dbinc_auto/dbreg_auto.h"
 #include "dbinc_auto/dbreg_ext.h"
@@ -117,3 +118,86 @@ __dbenv_ispgcompactible(dbenv, fileid, pgno, dbt, ff)
 
 	return ret;
 }
+
+extern __thread u_int32_t gbl_pgcomp_npages_freed;
+
+/*
+ * __dbenv_pgcompact_scan --
+ *	Walk up to npages pages of a btree, starting at *pgnop, and merge
+ *	every leaf page that is at most ff full into its siblings.  Each
+ *	merge runs in its own transaction.  On return *pgnop is the page to
+ *	resume from, or PGNO_INVALID once the end of the file was reached.
+ *	Pages locked by someone else are skipped; a later pass finds them.
+ *
+ * PUBLIC: int __dbenv_pgcompact_scan __P((DB_ENV *, DB *, db_pgno_t *,
+ * PUBLIC:     u_int32_t, double, double, u_int32_t *, u_int32_t *,
+ * PUBLIC:     u_int32_t *, db_pgno_t *));
+ */
+int
+__dbenv_pgcompact_scan(dbenv, dbp, pgnop, npages, ff, tgtff,
+    nscannedp, nsparsep, nfreedp, lastpgnop)
+	DB_ENV *dbenv;
+	DB *dbp;
+	db_pgno_t *pgnop;
+	u_int32_t npages;
+	double ff;
+	double tgtff;
+	u_int32_t *nscannedp;
+	u_int32_t *nsparsep;
+	u_int32_t *nfreedp;
+	db_pgno_t *lastpgnop;
+{
+	int ret;
+	u_int32_t nfreed;
+	db_pgno_t pgno, last_pgno;
+	DB_TXN *txn;
+	DBT dbt;
+
+	*nscannedp = *nsparsep = *nfreedp = 0;
+
+	if (dbp->type != DB_BTREE)
+		return (EINVAL);
+
+	__memp_last_pgno(dbp->mpf, &last_pgno);
+	*lastpgnop = last_pgno;
+
+	/* Page 0 is the meta page. */
+	pgno = (*pgnop == PGNO_INVALID) ? 1 : *pgnop;
+	ret = 0;
+
+	for (; pgno <= last_pgno && *nscannedp < npages; ++pgno) {
+		++(*nscannedp);
+
+		memset(&dbt, 0, sizeof(dbt));
+		if (__db_ispgcompactible(dbp, pgno, &dbt, ff) != 0) {
+			__os_free(dbenv, dbt.data);
+			continue;
+		}
+		++(*nsparsep);
+
+		if ((ret = __txn_begin(dbenv, NULL, &txn, 0)) != 0) {
+			__os_free(dbenv, dbt.data);
+			__db_err(dbenv, "%s __txn_begin: %s",
+			    __func__, strerror(ret));
+			break;
+		}
+
+		nfreed = gbl_pgcomp_npages_freed;
+		ret = __db_pgcompact(dbp, txn, &dbt, ff, tgtff);
+		__os_free(dbenv, dbt.data);
+
+		if (ret == 0)
+			ret = __txn_commit(txn, DB_TXN_NOSYNC);
+		else
+			(void)__txn_abort(txn);
+
+		/* A page we could not merge (deadlock, the page changed under
+		   us, ...) is left for the next pass. */
+		if (ret == 0)
+			*nfreedp += gbl_pgcomp_npages_freed - nfreed;
+		ret = 0;
+	}
+
+	*pgnop = (pgno > last_pgno) ? PGNO_INVALID : pgno;
+	return (ret);
+}
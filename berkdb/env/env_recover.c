@@ -933,6 +933,346 @@ void log_recovery_progress(int stage, int progress)
 	}
 }
 
+/*
+ * Parallel forward pass.
+ *
+ * Page records of committed transactions are handed to a pool of threads,
+ * partitioned by file, so records for any one file are still applied in
+ * log order, by one thread.  The records we hand out never look at the
+ * transaction list, so the lookups in it (and everything else) stay on the
+ * recovery thread.  Records that open or close files, allocate or free
+ * pages, or that we don't know about wait for every queued record to be
+ * applied first, and then run on the recovery thread as before.
+ */
+struct fwd_rec {
+	DB_LSN lsn;
+	u_int32_t rectype;
+	DBT rec;
+	struct fwd_rec *next;
+};
+
+struct fwd_roll;
+
+struct fwd_worker {
+	struct fwd_roll *fr;
+	pthread_t tid;
+	pthread_mutex_t lk;
+	pthread_cond_t cond;
+	struct fwd_rec *head, *tail;
+	int count;
+	int stop;
+};
+
+struct fwd_roll {
+	DB_ENV *dbenv;
+	void *txninfo;
+	int nworkers;
+	int maxqueue;
+	struct fwd_worker *workers;
+	pthread_mutex_t lk;
+	pthread_cond_t cond;
+	int inflight;		/* queued or being applied */
+	int ret;		/* first failure, and where */
+	DB_LSN errlsn;
+	u_int64_t nparallel;
+	u_int64_t nbarriers;
+};
+
+static void *
+__fwd_roll_worker(void *arg)
+{
+	struct fwd_worker *w = arg;
+	struct fwd_roll *fr = w->fr;
+	DB_ENV *dbenv = fr->dbenv;
+	struct fwd_rec *r;
+	DB_LSN lsn;
+	int ret;
+
+	for (;;) {
+		Pthread_mutex_lock(&w->lk);
+		while (w->head == NULL && !w->stop)
+			Pthread_cond_wait(&w->cond, &w->lk);
+		if ((r = w->head) == NULL) {
+			Pthread_mutex_unlock(&w->lk);
+			break;
+		}
+		if ((w->head = r->next) == NULL)
+			w->tail = NULL;
+		if (w->count-- == fr->maxqueue)
+			Pthread_cond_broadcast(&w->cond);
+		Pthread_mutex_unlock(&w->lk);
+
+		/* After a failure, just drain the queue */
+		if (fr->ret == 0) {
+			lsn = r->lsn;
+			ret = dbenv->recover_dtab[r->rectype](dbenv, &r->rec,
+			    &lsn, DB_TXN_FORWARD_ROLL, fr->txninfo);
+			if (ret != 0) {
+				Pthread_mutex_lock(&fr->lk);
+				if (fr->ret == 0) {
+					fr->ret = ret;
+					fr->errlsn = r->lsn;
+				}
+				Pthread_mutex_unlock(&fr->lk);
+			}
+		}
+		free(r);
+
+		Pthread_mutex_lock(&fr->lk);
+		if (--fr->inflight == 0)
+			Pthread_cond_broadcast(&fr->cond);
+		Pthread_mutex_unlock(&fr->lk);
+	}
+	return NULL;
+}
+
+static struct fwd_roll *
+__fwd_roll_start(DB_ENV *dbenv, void *txninfo)
+{
+	struct fwd_roll *fr;
+	int i, nworkers = dbenv->attr.recovery_forward_threads;
+
+	if (nworkers <= 0)
+		return NULL;
+	if ((fr = calloc(1, sizeof(*fr))) == NULL ||
+	    (fr->workers = calloc(nworkers, sizeof(*fr->workers))) == NULL) {
+		free(fr);
+		return NULL;
+	}
+	fr->dbenv = dbenv;
+	fr->txninfo = txninfo;
+	fr->maxqueue = dbenv->attr.recovery_forward_queue;
+	if (fr->maxqueue < 1)
+		fr->maxqueue = 1;
+	Pthread_mutex_init(&fr->lk, NULL);
+	Pthread_cond_init(&fr->cond, NULL);
+
+	for (i = 0; i < nworkers; i++) {
+		struct fwd_worker *w = &fr->workers[i];
+		w->fr = fr;
+		Pthread_mutex_init(&w->lk, NULL);
+		Pthread_cond_init(&w->cond, NULL);
+		if (pthread_create(&w->tid, NULL, __fwd_roll_worker, w) != 0) {
+			Pthread_mutex_destroy(&w->lk);
+			Pthread_cond_destroy(&w->cond);
+			break;
+		}
+		fr->nworkers++;
+	}
+	if (fr->nworkers == 0) {
+		Pthread_mutex_destroy(&fr->lk);
+		Pthread_cond_destroy(&fr->cond);
+		free(fr->workers);
+		free(fr);
+		return NULL;
+	}
+	logmsg(LOGMSG_WARN, "forward pass using %d threads\n", fr->nworkers);
+	return fr;
+}
+
+/* Wait for everything queued to be applied.  Returns the first failure. */
+static int
+__fwd_roll_drain(struct fwd_roll *fr, DB_LSN *errlsn)
+{
+	Pthread_mutex_lock(&fr->lk);
+	while (fr->inflight > 0)
+		Pthread_cond_wait(&fr->cond, &fr->lk);
+	Pthread_mutex_unlock(&fr->lk);
+	if (fr->ret != 0)
+		*errlsn = fr->errlsn;
+	return fr->ret;
+}
+
+static int
+__fwd_roll_stop(struct fwd_roll *fr, DB_LSN *errlsn)
+{
+	int i, ret;
+
+	if (fr == NULL)
+		return 0;
+	ret = __fwd_roll_drain(fr, errlsn);
+	for (i = 0; i < fr->nworkers; i++) {
+		struct fwd_worker *w = &fr->workers[i];
+		Pthread_mutex_lock(&w->lk);
+		w->stop = 1;
+		Pthread_cond_signal(&w->cond);
+		Pthread_mutex_unlock(&w->lk);
+		Pthread_join(w->tid, NULL);
+		Pthread_mutex_destroy(&w->lk);
+		Pthread_cond_destroy(&w->cond);
+	}
+	logmsg(LOGMSG_WARN, "forward pass applied %"PRIu64" records in parallel, "
+	    "waited for workers %"PRIu64" times\n", fr->nparallel,
+	    fr->nbarriers);
+	Pthread_mutex_destroy(&fr->lk);
+	Pthread_cond_destroy(&fr->cond);
+	free(fr->workers);
+	free(fr);
+	return ret;
+}
+
+/*
+ * Where the file of a page record is in the record, or -1 if the record
+ * isn't one we apply in parallel.  These only touch pages of their own
+ * file and don't use the transaction list.
+ */
+static int
+__fwd_roll_fileid_offset(u_int32_t rectype, int utxnid_logged)
+{
+	int off = sizeof(u_int32_t) + sizeof(u_int32_t) + sizeof(DB_LSN);
+
+	if (utxnid_logged)
+		off += sizeof(u_int64_t);
+
+	switch (rectype) {
+	case DB___bam_split:
+	case DB___bam_rsplit:
+	case DB___bam_adj:
+	case DB___bam_cadjust:
+	case DB___bam_cdel:
+	case DB___bam_repl:
+	case DB___bam_root:
+	case DB___bam_prefix:
+	case DB___db_ovref:
+		return off;
+	case DB___db_addrem:
+	case DB___db_big:
+	case DB___db_relink:
+		/* these have an opcode first */
+		return off + sizeof(u_int32_t);
+	default:
+		return -1;
+	}
+}
+
+/*
+ * Records that don't touch pages or open files can run on the recovery
+ * thread while the workers are still busy.
+ */
+static int
+__fwd_roll_no_barrier(u_int32_t rectype)
+{
+	switch (rectype) {
+	case DB___txn_regop:
+	case DB___txn_regop_gen:
+	case DB___txn_regop_rowlocks:
+	case DB___txn_dist_prepare:
+	case DB___txn_dist_commit:
+	case DB___txn_dist_abort:
+	case DB___txn_child:
+	case DB___txn_xa_regop:
+	case DB___db_debug:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+/*
+ * Queue the record if a worker can apply it.  Returns 1 if it was queued
+ * (or needs nothing done), 0 if the caller has to dispatch it.
+ */
+static int
+__fwd_roll_queue(struct fwd_roll *fr, DBT *data, DB_LSN *lsnp)
+{
+	DB_ENV *dbenv = fr->dbenv;
+	struct fwd_worker *w;
+	struct fwd_rec *r;
+	u_int8_t ufid[DB_FILE_ID_LEN];
+	u_int32_t rectype, txnid, fileid, h;
+	int utxnid_logged, is_ufid, off, i;
+
+	LOGCOPY_32(&rectype, data->data);
+	utxnid_logged = normalize_rectype(&rectype);
+	if (rectype >= 10000)
+		return 0;
+	is_ufid = rectype > 1000;
+	if (is_ufid)
+		rectype -= 1000;
+	if ((off = __fwd_roll_fileid_offset(rectype, utxnid_logged)) < 0 ||
+	    off + DB_FILE_ID_LEN > data->size)
+		return 0;
+
+	/* Same test as __db_dispatch makes for these records */
+	LOGCOPY_32(&txnid, (u_int8_t *)data->data + sizeof(u_int32_t));
+	if (txnid == 0 ||
+	    __db_txnlist_find(dbenv, fr->txninfo, txnid) != TXN_COMMIT)
+		return 1;
+
+	/* Records for one file can log either its ufid or its dbreg id */
+	if (is_ufid)
+		memcpy(ufid, (u_int8_t *)data->data + off, DB_FILE_ID_LEN);
+	else {
+		DB *dbp = NULL;
+		LOGCOPY_32(&fileid, (u_int8_t *)data->data + off);
+		if (__dbreg_id_to_db(dbenv, NULL, &dbp, fileid, 0, lsnp, 0) != 0 ||
+		    dbp == NULL)
+			return 0;
+		memcpy(ufid, dbp->fileid, DB_FILE_ID_LEN);
+	}
+	for (h = 0, i = 0; i < DB_FILE_ID_LEN; i++)
+		h = h * 31 + ufid[i];
+	w = &fr->workers[h % fr->nworkers];
+
+	if ((r = malloc(sizeof(*r) + data->size)) == NULL)
+		return 0;
+	r->lsn = *lsnp;
+	r->rectype = rectype;
+	memset(&r->rec, 0, sizeof(r->rec));
+	r->rec.data = r + 1;
+	r->rec.size = data->size;
+	memcpy(r->rec.data, data->data, data->size);
+	r->next = NULL;
+
+	Pthread_mutex_lock(&fr->lk);
+	fr->inflight++;
+	Pthread_mutex_unlock(&fr->lk);
+
+	Pthread_mutex_lock(&w->lk);
+	while (w->count >= fr->maxqueue)
+		Pthread_cond_wait(&w->cond, &w->lk);
+	if (w->tail)
+		w->tail->next = r;
+	else
+		w->head = r;
+	w->tail = r;
+	if (w->count++ == 0)
+		Pthread_cond_broadcast(&w->cond);
+	Pthread_mutex_unlock(&w->lk);
+
+	fr->nparallel++;
+	return 1;
+}
+
+/*
+ * Forward pass for one record: queue it, or wait for the workers if it
+ * needs them to be done, and dispatch it here.
+ */
+static int
+__fwd_roll_dispatch(DB_ENV *dbenv, struct fwd_roll *fr, DBT *data,
+    DB_LSN *lsnp, void *txninfo)
+{
+	u_int32_t rectype;
+	int ret;
+
+	if (fr != NULL) {
+		if (__fwd_roll_queue(fr, data, lsnp)) {
+			if ((ret = fr->ret) != 0)
+				*lsnp = fr->errlsn;
+			return ret;
+		}
+		LOGCOPY_32(&rectype, data->data);
+		normalize_rectype(&rectype);
+		if (!__fwd_roll_no_barrier(rectype)) {
+			fr->nbarriers++;
+			if ((ret = __fwd_roll_drain(fr, lsnp)) != 0)
+				return ret;
+		}
+	}
+	return __db_dispatch(dbenv, dbenv->recover_dtab,
+	    dbenv->recover_dtab_size, data, lsnp, DB_TXN_FORWARD_ROLL, txninfo);
+}
+
 
 
 
@@ -969,6 +1309,9 @@ __db_apprec(dbenv, max_lsn, trunclsn, update, flags)
 	void *txninfo;
 	DB_LSN logged_checkpoint_lsn;
 	int start_recovery_at_dbregs;
+	struct fwd_roll *fr;
+	time_t last_report;
+	u_int64_t nrecs;
 
 	COMPQUIET(nfiles, (double)0);
 
@@ -1442,6 +1785,9 @@ __db_apprec(dbenv, max_lsn, trunclsn, update, flags)
 
 	logmsg(LOGMSG_WARN, "running forward pass from %u:%u -> %u:%u\n",
 		lsn.file, lsn.offset, stop_lsn.file, stop_lsn.offset);
+	fr = __fwd_roll_start(dbenv, txninfo);
+	last_report = time(NULL);
+	nrecs = 0;
 	for (ret = __log_c_get(logc, &lsn, &data, DB_NEXT);
 		ret == 0; ret = __log_c_get(logc, &lsn, &data, DB_NEXT)) {
 		/*
@@ -1465,18 +1811,28 @@ __db_apprec(dbenv, max_lsn, trunclsn, update, flags)
 			dbenv->db_feedback(dbenv, DB_RECOVER, progress);
 		}
 
-		ret = __db_dispatch(dbenv, dbenv->recover_dtab,
-			dbenv->recover_dtab_size, &data, &lsn,
-			DB_TXN_FORWARD_ROLL, txninfo);
+		if (++nrecs % 10000 == 0 && (now = time(NULL)) - last_report >= 10) {
+			logmsg(LOGMSG_WARN, "forward pass at %u:%u of %u:%u, %d%%, "
+			    "%"PRIu64" records\n", lsn.file, lsn.offset,
+			    stop_lsn.file, stop_lsn.offset, progress, nrecs);
+			last_report = now;
+		}
+
+		ret = __fwd_roll_dispatch(dbenv, fr, &data, &lsn, txninfo);
 		if (ret != 0) {
-			if (ret != DB_TXN_CKP)
+			if (ret != DB_TXN_CKP) {
+				(void)__fwd_roll_stop(fr, &lsn);
 				goto msgerr;
-			else
+			} else
 				ret = 0;
 		}
 
 	}
 
+	if ((t_ret = __fwd_roll_stop(fr, &lsn)) != 0) {
+		ret = t_ret;
+		goto msgerr;
+	}
 	if (ret != 0 && ret != DB_NOTFOUND)
 		goto err;
 	dbenv->recovery_pass = DB_TXN_NOT_IN_RECOVERY;
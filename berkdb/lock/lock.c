@@ -44,6 +44,7 @@ static const char revid[] = "$Id: lock.c,v 11.134 2003/11/18 21:30:38 ubell Exp
 #include "thread_stats.h"
 #include "tohex.h"
 #include "txn_properties.h"
+#include "histogram.h"
 
 #include <bbhrtime.h>
 
@@ -2953,14 +2954,16 @@ upgrade:
 		}
 		MUTEX_LOCK(dbenv, &newl->mutex);
 
+		if (gbl_bb_berkdb_enable_lock_timing) {
+			x2 = bb_berkdb_fasttime();
+			comdb2_histogram_add(gbl_lock_wait_hist, x2 - x1);
+		} else {
+			x2 = x1;
+		}
+
 		if (gbl_bb_berkdb_enable_thread_stats) {
 			struct berkdb_thread_stats *t;
 			struct berkdb_thread_stats *p;
-			if (gbl_bb_berkdb_enable_lock_timing) {
-				x2 = bb_berkdb_fasttime();
-			} else {
-				x2 = x1;
-			}
 			t = bb_berkdb_get_thread_stats();
 			p = bb_berkdb_get_process_stats();
             uint64_t d = (x2 - x1);
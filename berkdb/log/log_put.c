@@ -44,6 +44,7 @@ static const char revid[] = "$Id: log_put.c,v 11.145 2003/09/13 19:20:39 bostic
 #include <netinet/in.h>
 
 #include "logmsg.h"
+#include "histogram.h"
 #include <sys_wrap.h>
 #include <poll.h>
 
@@ -51,6 +52,7 @@ extern unsigned long long get_commit_context(const void *, uint32_t generation);
 extern int bdb_update_startlwm_berk(void *statearg, unsigned long long ltranid,
     DB_LSN *firstlsn);
 extern int bdb_commitdelay(void *arg);
+extern void __mempv_vstore_put(DB_ENV *, const DB_LSN *, const DBT *);
 extern int bdb_push_pglogs_commit(void *in_bdb_state, DB_LSN commit_lsn, 
 	uint32_t generation, unsigned long long ltranid, int push);
 
@@ -402,6 +404,10 @@ err:
 	if (need_free)
 		__os_free(dbenv, dbt->data);
 
+	/* Keep page records in memory for snapshot readers. */
+	if (ret == 0)
+		__mempv_vstore_put(dbenv, &lsn, udbt);
+
 	if (gbl_num_logput_listeners > 0) {
 		Pthread_mutex_lock(&gbl_logput_lk);
 		if (gbl_num_logput_listeners > 0)
@@ -1341,6 +1347,7 @@ __log_flush_int(dblp, lsnp, release)
 	LOG *lp;
 	u_int32_t ncommit, w_off, listcnt;
 	int do_flush, first, ret, wrote_inmem;
+	uint64_t startus;
 
 	dbenv = dblp->dbenv;
 	lp = dblp->reginfo.primary;
@@ -1482,6 +1489,7 @@ __log_flush_int(dblp, lsnp, release)
 	 * the region lock except during file switches.
 	 */
 flush:	MUTEX_LOCK(dbenv, flush_mutexp);
+	startus = bb_berkdb_fasttime();
 
 	/*
 	 * If the LSN is less than or equal to the last-sync'd LSN, we're done.
@@ -1574,6 +1582,7 @@ flush:	MUTEX_LOCK(dbenv, flush_mutexp);
 		ret = __db_panic(dbenv, ret);
 		return (ret);
 	}
+	comdb2_histogram_add(gbl_log_flush_hist, bb_berkdb_fasttime() - startus);
 
 	/*
 	 * Set the last-synced LSN.
@@ -2387,6 +2396,8 @@ err:
 	R_UNLOCK(dbenv, &dblp->reginfo);
 	if (need_free)
 		__os_free(dbenv, t.data);
+	if (ret == 0)
+		__mempv_vstore_put(dbenv, lsnp, rec);
 	return (ret);
 }
 
@@ -19,6 +19,9 @@ extern int __txn_commit_map_get(DB_ENV *, u_int64_t, DB_LSN *);
 extern int __mempv_cache_init(DB_ENV *, MEMPV_CACHE *cache);
 extern int __mempv_cache_get(DB *dbp, MEMPV_CACHE *cache, u_int8_t file_id[DB_FILE_ID_LEN], db_pgno_t pgno, DB_LSN target_lsn, BH *bhp);
 extern int __mempv_cache_put(DB *dbp, MEMPV_CACHE *cache, u_int8_t file_id[DB_FILE_ID_LEN], db_pgno_t pgno, BH *bhp, DB_LSN target_lsn);
+extern int __mempv_vstore_init(DB_ENV *, MEMPV_VSTORE *vstore);
+extern void __mempv_vstore_destroy(MEMPV_VSTORE *vstore);
+extern int __mempv_vstore_get(DB_ENV *, const DB_LSN *, DBT *);
 
 /*
  * __mempv_init --
@@ -42,6 +45,11 @@ int __mempv_init(dbenv)
 		goto done;
 	}
 
+	if ((ret = __mempv_vstore_init(dbenv, &(mempv->vstore))), ret != 0) {
+		__mempv_cache_destroy(&(mempv->cache));
+		goto done;
+	}
+
 	dbenv->mempv = mempv;
 
 done:
@@ -59,6 +67,7 @@ void __mempv_destroy(dbenv)
 	DB_ENV *dbenv;
 {
 	__mempv_cache_destroy(&(dbenv->mempv->cache));
+	__mempv_vstore_destroy(&(dbenv->mempv->vstore));
 	__os_free(dbenv, dbenv->mempv);
 	dbenv->mempv = NULL;
 }
@@ -310,10 +319,18 @@ int __mempv_fget(mpf, dbp, pgno, target_lsn, highest_checkpoint_lsn, ret_page, f
 			goto err;
 		}
 		
-		ret = __log_c_get(logc, &cur_page_lsn, &dbt, DB_SET);
-		if (ret || (dbt.size < sizeof(int))) {
-			logmsg(LOGMSG_ERROR, "%s: Failed to get log cursor\n", __func__);
-			goto err;
+		// Recently written records are kept in memory; only go to the log for older ones.
+		if (__mempv_vstore_get(dbenv, &cur_page_lsn, &dbt) == 0) {
+			if (mempv_debug) {
+				logmsg(LOGMSG_USER, "%s: Found record %"PRIu32":%"PRIu32" in version store\n",
+					__func__, cur_page_lsn.file, cur_page_lsn.offset);
+			}
+		} else {
+			ret = __log_c_get(logc, &cur_page_lsn, &dbt, DB_SET);
+			if (ret || (dbt.size < sizeof(int))) {
+				logmsg(LOGMSG_ERROR, "%s: Failed to get log cursor\n", __func__);
+				goto err;
+			}
 		}
 
 		if ((ret = __mempv_read_log_record(dbenv, data_t != NULL ? data_t : dbt.data, &apply, &utxnid, PGNO(page_image))) != 0) {
@@ -0,0 +1,250 @@
+#include "db_config.h"
+#include "db_int.h"
+#include "dbinc/btree.h"
+#include "dbinc/mp.h"
+#include "dbinc/log.h"
+#include "dbinc/db_swap.h"
+#include "dbinc/db_shash.h"
+
+#include "logmsg.h"
+#include "sys_wrap.h"
+
+extern int free_it(void *obj, void *arg);
+extern void destroy_hash(hash_t *h, hashforfunc_t *const free_func);
+
+extern int gbl_use_modsnap_for_snapshot;
+extern int gbl_modsnap_asof;
+
+#define MEMPV_VSTORE_STRIPE(vstore, lsnp) \
+	(&(vstore)->stripes[((lsnp)->file ^ ((lsnp)->offset >> 3)) % MEMPV_VSTORE_STRIPES])
+
+/*
+ * __mempv_vstore_can_unroll --
+ * Returns 1 if `rec` is a log record that __mempv_fget knows how to undo.
+ * Only those records are ever looked up while unrolling a page.
+ */
+static int __mempv_vstore_can_unroll(rec)
+	const DBT *rec;
+{
+	u_int32_t rectype;
+
+	if (rec->size < sizeof(u_int32_t) + sizeof(u_int32_t) + sizeof(DB_LSN) + sizeof(u_int64_t)) {
+		return 0;
+	}
+
+	LOGCOPY_32(&rectype, rec->data);
+	if (normalize_rectype(&rectype) != 1) {
+		return 0;
+	}
+	if ((rectype > 1000 && rectype < 10000) || rectype > 11000) {
+		rectype -= 1000; // For logs with ufid
+	}
+
+	switch (rectype) {
+		case DB___db_addrem:
+		case DB___db_big:
+		case DB___db_ovref:
+		case DB___db_relink:
+		case DB___db_pg_alloc:
+		case DB___bam_split:
+		case DB___bam_rsplit:
+		case DB___bam_repl:
+		case DB___bam_adj:
+		case DB___bam_cadjust:
+		case DB___bam_cdel:
+		case DB___bam_prefix:
+		case DB___db_pg_freedata:
+		case DB___db_pg_free:
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+/*
+ * __mempv_vstore_init --
+ * Initializes a version store.
+ *
+ * dbenv: Associated dbenv.
+ * vstore: Allocated version store to be initialized.
+ *
+ * Returns 0 on success and non-0 on failure.
+ *
+ * PUBLIC: int __mempv_vstore_init
+ * PUBLIC:	__P((DB_ENV *, MEMPV_VSTORE *));
+ */
+int __mempv_vstore_init(dbenv, vstore)
+	DB_ENV *dbenv;
+	MEMPV_VSTORE *vstore;
+{
+	MEMPV_VSTORE_STRIPE *stripe;
+	int i;
+
+	for (i = 0; i < MEMPV_VSTORE_STRIPES; i++) {
+		stripe = &vstore->stripes[i];
+		stripe->bytes = 0;
+		stripe->records = hash_init_o(offsetof(MEMPV_VSTORE_ENTRY, lsn), sizeof(DB_LSN));
+		if (stripe->records == NULL) {
+			while (--i >= 0) {
+				hash_free(vstore->stripes[i].records);
+				pthread_mutex_destroy(&vstore->stripes[i].lock);
+			}
+			return ENOMEM;
+		}
+		listc_init(&stripe->fifo, offsetof(MEMPV_VSTORE_ENTRY, lnk));
+		pthread_mutex_init(&stripe->lock, NULL);
+	}
+
+	return 0;
+}
+
+/*
+ * __mempv_vstore_destroy --
+ * Destroys a version store.
+ *
+ * vstore: Version store to be destroyed.
+ *
+ * PUBLIC: void __mempv_vstore_destroy
+ * PUBLIC:	__P((MEMPV_VSTORE *));
+ */
+void __mempv_vstore_destroy(vstore)
+	MEMPV_VSTORE *vstore;
+{
+	int i;
+
+	for (i = 0; i < MEMPV_VSTORE_STRIPES; i++) {
+		destroy_hash(vstore->stripes[i].records, free_it);
+		pthread_mutex_destroy(&vstore->stripes[i].lock);
+	}
+}
+
+/*
+ * __mempv_vstore_put --
+ * Keeps a copy of a log record that was just written at `lsnp`. This is
+ * called from the log write path on masters and replicants, so the records
+ * that most recently modified each page are always available in memory.
+ * Each record carries the LSN that its page had before the change, so the
+ * records of a page form a chain that __mempv_fget can follow backwards.
+ *
+ * Records that can't unroll a page are ignored. Once the store is over
+ * `mempv_version_store_size` bytes, the oldest records of the stripe are
+ * dropped and readers fall back to the log for them.
+ *
+ * dbenv: Associated dbenv.
+ * lsnp: LSN of the record.
+ * rec: Unencrypted log record.
+ *
+ * PUBLIC: void __mempv_vstore_put
+ * PUBLIC:	__P((DB_ENV *, const DB_LSN *, const DBT *));
+ */
+void __mempv_vstore_put(dbenv, lsnp, rec)
+	DB_ENV *dbenv;
+	const DB_LSN *lsnp;
+	const DBT *rec;
+{
+	MEMPV_VSTORE_STRIPE *stripe;
+	MEMPV_VSTORE_ENTRY *entry, *old, *evicted;
+	size_t max_bytes;
+
+	if (dbenv->mempv == NULL || CRYPTO_ON(dbenv) ||
+	    dbenv->attr.mempv_version_store_size <= 0 ||
+	    (!gbl_use_modsnap_for_snapshot && !gbl_modsnap_asof)) {
+		return;
+	}
+
+	max_bytes = dbenv->attr.mempv_version_store_size / MEMPV_VSTORE_STRIPES;
+	if (rec->size > max_bytes || !__mempv_vstore_can_unroll(rec)) {
+		return;
+	}
+
+	if (__os_malloc(dbenv, offsetof(MEMPV_VSTORE_ENTRY, data) + rec->size, &entry) != 0) {
+		return;
+	}
+	entry->lsn = *lsnp;
+	entry->size = rec->size;
+	memcpy(entry->data, rec->data, rec->size);
+
+	evicted = NULL;
+	stripe = MEMPV_VSTORE_STRIPE(&dbenv->mempv->vstore, lsnp);
+
+	Pthread_mutex_lock(&stripe->lock);
+
+	// A replicant can rewrite an LSN after its log was truncated.
+	if ((old = hash_find(stripe->records, &entry->lsn)) != NULL) {
+		hash_del(stripe->records, old);
+		listc_rfl(&stripe->fifo, old);
+		stripe->bytes -= old->size;
+		old->lnk.next = evicted;
+		evicted = old;
+	}
+
+	while (stripe->bytes + entry->size > max_bytes &&
+	    (old = listc_rtl(&stripe->fifo)) != NULL) {
+		hash_del(stripe->records, old);
+		stripe->bytes -= old->size;
+		old->lnk.next = evicted;
+		evicted = old;
+	}
+
+	if (hash_add(stripe->records, entry) != 0) {
+		entry->lnk.next = evicted;
+		evicted = entry;
+	} else {
+		listc_abl(&stripe->fifo, entry);
+		stripe->bytes += entry->size;
+	}
+
+	Pthread_mutex_unlock(&stripe->lock);
+
+	while (evicted != NULL) {
+		old = evicted;
+		evicted = old->lnk.next;
+		__os_free(dbenv, old);
+	}
+}
+
+/*
+ * __mempv_vstore_get --
+ * Copies the log record at `lsnp` into `dbt` if the version store still
+ * has it.
+ *
+ * dbenv: Associated dbenv.
+ * lsnp: LSN of the record.
+ * dbt: Destination. Must be DB_DBT_REALLOC.
+ *
+ * Returns 0 if found and non-0 otherwise.
+ *
+ * PUBLIC: int __mempv_vstore_get
+ * PUBLIC:	__P((DB_ENV *, const DB_LSN *, DBT *));
+ */
+int __mempv_vstore_get(dbenv, lsnp, dbt)
+	DB_ENV *dbenv;
+	const DB_LSN *lsnp;
+	DBT *dbt;
+{
+	MEMPV_VSTORE_STRIPE *stripe;
+	MEMPV_VSTORE_ENTRY *entry;
+	int ret;
+
+	if (dbenv->mempv == NULL || dbenv->attr.mempv_version_store_size <= 0) {
+		return DB_NOTFOUND;
+	}
+
+	ret = DB_NOTFOUND;
+	stripe = MEMPV_VSTORE_STRIPE(&dbenv->mempv->vstore, lsnp);
+
+	Pthread_mutex_lock(&stripe->lock);
+	if ((entry = hash_find(stripe->records, (void *)lsnp)) != NULL) {
+		if (dbt->data == NULL || dbt->size < entry->size) {
+			if ((ret = __os_urealloc(dbenv, entry->size, &dbt->data)) != 0) {
+				goto done;
+			}
+		}
+		memcpy(dbt->data, entry->data, entry->size);
+		dbt->size = entry->size;
+		ret = 0;
+	}
+done:
+	Pthread_mutex_unlock(&stripe->lock);
+	return ret;
+}
@@ -46,6 +46,7 @@ int dyns_is_idx_primary(int index);
 int dyns_is_idx_datacopy(int index);
 int dyns_is_idx_partial_datacopy(int index);
 int dyns_is_idx_uniqnulls(int index);
+int dyns_is_idx_deferwrites(int index);
 int dyns_get_idx_count(void);
 int dyns_get_idx_size(int index);
 int dyns_get_idx_piece(int index, int piece, char *sname, int slen, int *type,
@@ -184,7 +184,9 @@ enum INDEXFLAGS {
     PRIMARY = 0x00000004,
     DATAKEY = 0x00000008, /* key flag to indicate index has data */
     UNIQNULLS = 0x00000010, /* all NULL values are treated as UNIQUE */
-    PARTIALDATAKEY = 0x00000020 /* key flag to indicate index has some data */
+    PARTIALDATAKEY = 0x00000020, /* key flag to indicate index has some data */
+    DEFERWRITES = 0x00000040 /* key writes of multi-row transactions are
+                                applied at commit */
 };
 
 typedef struct macc_globals_t {
@@ -319,6 +321,7 @@ void key_setprimary(void);
 void key_setdatakey(void);
 void key_setpartialdatakey(void);
 void key_setuniqnulls(void);
+void key_setdeferwrites(void);
 void reset_key_exprtype(void);
 void key_exprtype_add(int type, int arraysz);
 void key_piece_add(char *buf, int is_expr);
@@ -958,6 +958,12 @@ void key_setuniqnulls(void)
     macc_globals->workkeyflag |= UNIQNULLS;
 }
 
+void key_setdeferwrites(void)
+{
+    CHECK_LEGACY_SCHEMA(1);
+    macc_globals->workkeyflag |= DEFERWRITES;
+}
+
 void key_piece_clear() /* used by parser, clears work key */
 {
     macc_globals->workkey = 0;          /* clear work key */
@@ -1010,6 +1016,13 @@ static void key_add_comn(int ix, char *tag, char *exprname,
         any_errors++;
         return;
     }
+    /* a unique key must be checked by the statement adding it */
+    if ((macc_globals->workkeyflag & DEFERWRITES) &&
+        !(macc_globals->workkeyflag & DUPKEY)) {
+        csc2_error("ERROR: DEFERWRITES REQUIRES A DUP KEY\n");
+        any_errors++;
+        return;
+    }
 #endif
     if (ix == -1) {
         int lastix = -1;
@@ -2729,6 +2742,12 @@ int dyns_is_idx_uniqnulls(int index)
     return dyns_is_idx_flagged(index, UNIQNULLS);
 }
 
+/* are the key writes of this index deferred to commit? */
+int dyns_is_idx_deferwrites(int index)
+{
+    return dyns_is_idx_flagged(index, DEFERWRITES);
+}
+
 int dyns_get_idx_partial_datacopy(int index, struct partial_datacopy **partial_datacopy) {
     int lastix, i;
     if (index < 0 || index >= numix()) {
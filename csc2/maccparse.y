@@ -55,7 +55,7 @@
 %token T_CON_ON  T_CON_UPDATE T_CON_DELETE T_RESTRICT
 %token T_CHECK
 
-%token T_RECNUMS T_PRIMARY T_DATAKEY T_UNIQNULLS
+%token T_RECNUMS T_PRIMARY T_DATAKEY T_UNIQNULLS T_DEFERWRITES
 %token T_YES T_NO
 
 %token T_ASCEND T_DESCEND T_DUP                    /*MODIFIERS*/
@@ -461,6 +461,7 @@ keyflags:    T_DUP        { key_setdup(); }
                 | T_DATAKEY '(' compounddatakey ')'     { key_setpartialdatakey(); }
                 | T_DATAKEY     { key_setdatakey(); }
                 | T_UNIQNULLS   { key_setuniqnulls(); }
+                | T_DEFERWRITES { key_setdeferwrites(); }
         ;
 
 compounddatakey: datakeypiece
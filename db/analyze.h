@@ -53,6 +53,12 @@ sampler_t *analyze_get_sampler(struct sqlclntstate *client, char *table,
  */
 int64_t analyze_get_nrecs(int iTable);
 
+/**
+ * Returns 1 if this index had no keys added or removed since the last analyze
+ * (see analyze_incremental), and keeps its previous stats.
+ */
+int analyze_is_skipped(int iTable);
+
 /**
  * Retrieve the number of sampled (previously misnamed compressed) records in
  *this sampled index.  This
@@ -113,6 +119,13 @@ void analyze_disable_sampled_indicies(void);
  */
 int analyze_dump_stats(void);
 
+/* Sampling thread totals since startup, kept by bdb_summarize_table */
+extern uint64_t gbl_analyze_pages_read;
+extern uint64_t gbl_analyze_block_sampled_pages;
+extern uint64_t gbl_analyze_throttle_waits;
+extern uint64_t gbl_analyze_throttle_ms;
+extern uint64_t gbl_analyze_idle_ioprio_runs;
+
 /**
  * Return 1 if analyze is running, 0 otherwise.
  */
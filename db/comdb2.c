@@ -132,6 +132,7 @@ void berk_memp_sync_alarm_ms(int);
 #include "cron.h"
 #include "metrics.h"
 #include "time_accounting.h"
+#include "histogram.h"
 #include <build/db.h>
 #include "comdb2_ruleset.h"
 #include <hostname_support.h>
@@ -143,6 +144,7 @@ void berk_memp_sync_alarm_ms(int);
 #include "sc_csc2.h"
 #include "reverse_conn.h"
 #include "alias.h"
+#include "pgcompact.h"
 #define tokdup strndup
 
 int gbl_thedb_stopped = 0;
@@ -773,6 +775,7 @@ int gbl_abort_invalid_query_info_key;
 
 extern int gbl_direct_count;
 extern int gbl_parallel_count;
+extern int gbl_direct_count_pages;
 extern int gbl_debug_sqlthd_failures;
 extern int gbl_random_get_curtran_failures;
 extern int gbl_random_blkseq_replays;
@@ -2779,6 +2782,7 @@ struct dbenv *newdbenv(char *dbname, char *lrlname)
     dbenv->concurrent_queries = time_metric_new("concurrent_queries");
     dbenv->connections = time_metric_new("connections");
     dbenv->watchdog_time = time_metric_new("watchdog_time");
+    comdb2_histograms_init();
 
     return dbenv;
 }
@@ -5414,6 +5418,9 @@ static void register_all_int_switches()
     register_int_switch("parallel_count",
                         "When 'direct_count' is on, enable thread-per-stripe",
                         &gbl_parallel_count);
+    register_int_switch("direct_count_pages",
+                        "When 'direct_count' is on, count from btree leaf page headers",
+                        &gbl_direct_count_pages);
     register_int_switch("debug_sqlthd_failures",
                         "Force sqlthd failures in unusual places",
                         &gbl_debug_sqlthd_failures);
@@ -5707,6 +5714,7 @@ int main(int argc, char **argv)
     create_watchdog_thread(thedb);
     create_old_blkseq_thread(thedb);
     create_stat_thread(thedb);
+    create_pgcompact_thread();
 
     /* create the offloadsql repository */
     if (!gbl_create_mode && thedb->nsiblings > 0) {
@@ -43,6 +43,7 @@ struct reqlogger;
 struct thdpool;
 struct schema_change_type;
 struct rootpage;
+struct convert_prog;
 
 typedef long long tranid_t;
 
@@ -415,7 +416,8 @@ enum DB_METADATA {
     META_QUEUE_ODH = -14,
     META_QUEUE_COMPRESS = -15,
     META_QUEUE_PERSISTENT_SEQ = -16,
-    META_QUEUE_SEQ = -17
+    META_QUEUE_SEQ = -17,
+    META_INLINE_BLOBS = -18 /* OPTIONS INLINE size of blob and text columns */
 };
 
 enum CONSTRAINT_FLAGS {
@@ -615,6 +617,7 @@ typedef struct dbtable {
     int ix_datacopylen[MAXINDEX]; /* datacopy len in bytes (0 if full datacopy) */
     signed char ix_collattr[MAXINDEX];
     signed char ix_nullsallowed[MAXINDEX];
+    signed char ix_defer[MAXINDEX]; /* key writes applied at commit */
 
     shard_limits_t *sharding;
 
@@ -660,7 +663,13 @@ typedef struct dbtable {
     int64_t aa_saved_counter; // zeroed out at autoanalyze
     int64_t aa_lastepoch;
     int64_t aa_needs_analyze_time; // time when analyze is needed for table in request mode, otherwise 0
+    /* key adds/deletes per index, and their values when this node last
+     * analyzed the table as master (see analyze_incremental) */
+    int64_t ix_write_count[MAXINDEX];
+    int64_t aa_ix_saved_write_count[MAXINDEX];
+    uint32_t aa_ix_saved_gen; // rep generation of the saved counts, 0 if none
     int64_t read_count; // counter for reads to this table
+    int64_t deferred_ix_write_count; // keys of deferwrites indexes applied at commit
     int64_t index_used_count;   // counter for number of times a table index was used
 
     /* Foreign key constraints */
@@ -763,11 +772,16 @@ typedef struct dbtable {
     unsigned int * versmap[MAXVER + 1];
     /* is tag version compatible with ondisk schema */
     uint8_t vers_compat_ondisk[MAXVER + 1];
+    /* conversion programs for schema version to curr schema */
+    struct convert_prog *versprog[MAXVER + 1];
+    /* conversion programs for .ONDISK to each index, built on first use */
+    struct convert_prog *ixprog[MAXINDEX];
 
     /* lock for consumer list */
     pthread_rwlock_t consumer_lk;
 
     unsigned has_datacopy_ix : 1; /* set to 1 if we have datacopy indexes */
+    unsigned has_defer_ix : 1;    /* set to 1 if we have deferwrites indexes */
     unsigned ix_partial : 1;      /* set to 1 if we have partial indexes */
     unsigned ix_expr : 1;         /* set to 1 if we have indexes on expressions */
     unsigned ix_blob : 1;         /* set to 1 if blobs are involved in indexes */
@@ -1895,6 +1909,7 @@ extern int gbl_dohsql_full_queue_poll_msec;
 extern int gbl_dohsql_max_threads;
 extern int gbl_dohsql_pool_thr_slack;
 extern int gbl_dohsql_sc_max_threads;
+extern int gbl_dohsql_stripe_scan_shards;
 extern int gbl_sockbplog;
 extern int gbl_sockbplog_sockpool;
 
@@ -2494,6 +2509,9 @@ int get_db_bthash_tran(struct dbtable *, int *bthashsz, tran_type *);
 int put_db_instant_schema_change(struct dbtable *db, tran_type *tran, int isc);
 int get_db_instant_schema_change(struct dbtable *db, int *isc);
 int get_db_instant_schema_change_tran(struct dbtable *, int *isc, tran_type *tran);
+int put_db_inline_blobs(struct dbtable *db, tran_type *tran, int size);
+int get_db_inline_blobs(struct dbtable *db, int *size);
+int get_db_inline_blobs_tran(struct dbtable *, int *size, tran_type *tran);
 
 int set_meta_odh_flags(struct dbtable *db, int odh, int compress, int compress_blobs,
                        int ipupates);
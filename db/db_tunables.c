@@ -34,6 +34,8 @@
 #include "sc_rename_table.h"
 #include <disttxn.h>
 #include "views.h"
+#include "sql_fairshare.h"
+#include "pgcompact.h"
 
 /* Maximum allowable size of the value of tunable. */
 #define MAX_TUNABLE_VALUE_SIZE 512
@@ -118,6 +120,7 @@ extern int gbl_max_lua_instructions;
 extern int gbl_max_sqlcache;
 extern int __gbl_max_mpalloc_sleeptime;
 extern int gbl_mem_nice;
+extern int gbl_mem_tcache_max;
 extern int gbl_notimeouts;
 extern int gbl_watchdog_disable_at_start;
 extern int gbl_osql_verify_retries_max;
@@ -322,6 +325,18 @@ extern int gbl_debug_drop_nth_rep_message;
 extern int gbl_fdb_emulate_old;
 
 extern long long sampling_threshold;
+extern int gbl_analyze_block_sampling;
+extern int gbl_analyze_max_pages_per_sec;
+extern int gbl_analyze_idle_ioprio;
+extern int gbl_analyze_incremental;
+extern int gbl_sql_hash_join;
+extern int gbl_sql_hash_join_max_mem;
+extern int gbl_sql_scan_batch_rows;
+extern int gbl_sql_zerocopy_min_bytes;
+extern int gbl_sql_fairshare_default_share;
+extern int gbl_sql_fairshare_default_max_concurrent;
+extern int gbl_sql_fairshare_max_waiting;
+extern int gbl_sql_fairshare_cost_us;
 
 extern size_t gbl_lk_hash;
 extern size_t gbl_lk_parts;
@@ -432,6 +447,8 @@ extern int gbl_instrument_consumer_lock;
 extern int gbl_reject_mixed_ddl_dml;
 extern int gbl_debug_create_master_entry;
 extern int eventlog_nkeep;
+extern int gbl_eventlog_queue_max_bytes;
+extern int gbl_eventlog_block_on_full;
 extern int gbl_debug_systable_locks;
 extern int gbl_assert_systable_locks;
 extern int gbl_track_curtran_gettran_locks;
@@ -479,6 +496,7 @@ extern int gbl_physrep_reconnect_penalty;
 extern int gbl_physrep_register_interval;
 extern int gbl_physrep_shuffle_host_list;
 extern int gbl_physrep_ignore_queues;
+extern int gbl_physrep_timestamp_index;
 
 /* source-name / host is from lrl */
 extern char *gbl_physrep_source_dbname;
@@ -890,6 +908,20 @@ static int maxcolumns_verify(void *context, void *value)
     return 0;
 }
 
+static int zerocopy_min_bytes_verify(void *context, void *value)
+{
+    comdb2_tunable *tunable = (comdb2_tunable *)context;
+    int val = *(int *)value;
+
+    /* Smaller pieces are tags and lengths packed into stack scratch space */
+    if (val != 0 && val < 4096) {
+        logmsg(LOGMSG_ERROR, "Invalid value for '%s'. (0 or at least 4096)\n",
+               tunable->name);
+        return 1;
+    }
+    return 0;
+}
+
 static int loghist_update(void *context, void *value)
 {
     comdb2_tunable *tunable = (comdb2_tunable *)context;
@@ -1206,6 +1238,40 @@ static int test_log_file_update(void *context, void *value)
     return 0;
 }
 
+static void *sql_fairshare_key_value(void *context)
+{
+    comdb2_tunable *tunable = (comdb2_tunable *)context;
+    return (void *)sql_fairshare_key_str(*(int *)tunable->var);
+}
+
+static int sql_fairshare_key_update(void *context, void *value)
+{
+    comdb2_tunable *tunable = (comdb2_tunable *)context;
+    char *tok;
+    int st = 0;
+    int ltok;
+    char key[32];
+
+    tok = segtok(value, strlen(value), &st, &ltok);
+    if (ltok <= 0 || ltok >= sizeof(key))
+        return 1;
+    tokcpy(tok, ltok, key);
+
+    int k = sql_fairshare_key_from_str(key);
+    if (k < 0) {
+        logmsg(LOGMSG_ERROR, "Invalid value '%s' for tunable '%s'\n", key,
+               tunable->name);
+        return 1;
+    }
+    *(int *)tunable->var = k;
+    return 0;
+}
+
+static int sql_fairshare_class_update(void *context, void *value)
+{
+    return sql_fairshare_set_class(value);
+}
+
 static void *file_permissions_value(void *context)
 {
     static char val[15];
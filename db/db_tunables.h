@@ -56,6 +56,11 @@ REGISTER_TUNABLE("allow_user_schema",
                  "Enable to allow per-user schemas. (Default: off)",
                  TUNABLE_BOOLEAN, &gbl_allow_user_schema, READONLY | NOARG,
                  NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("analyze_block_sampling",
+                 "Read only the sampled pages of an index rather than the "
+                 "whole file when analyze coverage is below 100%. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_analyze_block_sampling, 0, NULL, NULL,
+                 NULL, NULL);
 REGISTER_TUNABLE("analyze_comp_threads",
                  "Number of thread to use when generating samples for "
                  "computing index statistics. (Default: 10)",
@@ -66,6 +71,21 @@ REGISTER_TUNABLE("analyze_comp_threshold",
                  "scan the entire index. (Default: 104857600)",
                  TUNABLE_INTEGER, &sampling_threshold, READONLY, NULL, NULL,
                  analyze_set_sampling_threshold, NULL);
+REGISTER_TUNABLE("analyze_idle_ioprio",
+                 "Run analyze sampling threads at the idle I/O scheduling "
+                 "class. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_analyze_idle_ioprio, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("analyze_incremental",
+                 "Keep the previous stats of indexes which had no keys added "
+                 "or removed since the last analyze. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_analyze_incremental, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("analyze_max_pages_per_sec",
+                 "Maximum number of pages read per second by each analyze "
+                 "sampling thread, 0 for no limit. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_analyze_max_pages_per_sec, 0, NULL, NULL,
+                 NULL, NULL);
 REGISTER_TUNABLE("analyze_tbl_threads",
                  "Number of threads to go through generated samples when "
                  "generating index statistics. (Default: 5)",
@@ -796,6 +816,11 @@ REGISTER_TUNABLE("max_query_fingerprints",
                  NULL, NULL, NULL);
 REGISTER_TUNABLE("memnice", NULL, TUNABLE_INTEGER, &gbl_mem_nice,
                  READONLY | NOARG, NULL, NULL, memnice_update, NULL);
+REGISTER_TUNABLE("mem_tcache_max",
+                 "Maximum number of freed blocks cached per thread, size class "
+                 "and allocator. 0 disables thread caching. (Default: 32)",
+                 TUNABLE_INTEGER, &gbl_mem_tcache_max, 0, NULL, NULL, NULL,
+                 NULL);
 REGISTER_TUNABLE("mempget_timeout", NULL, TUNABLE_INTEGER,
                  &__gbl_max_mpalloc_sleeptime, READONLY, NULL, NULL, NULL,
                  NULL);
@@ -931,6 +956,31 @@ REGISTER_TUNABLE("osql_verify_retry_max",
 REGISTER_TUNABLE("override_cachekb", NULL, TUNABLE_INTEGER, &db->override_cacheszkb, READONLY, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("page_compact_latency_ms", NULL, TUNABLE_INTEGER, &gbl_pg_compact_latency_ms, READONLY, NULL, NULL,
                  NULL, NULL);
+REGISTER_TUNABLE("page_compact_service",
+                 "On the master, scan tables in the background and merge "
+                 "sparse btree pages. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_page_compact_service, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("page_compact_service_batch_pages",
+                 "Pages the page compaction service scans per batch. "
+                 "(Default: 256)",
+                 TUNABLE_INTEGER, &gbl_page_compact_service_batch_pages, NOZERO,
+                 NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("page_compact_service_pause_ms",
+                 "Pause between the batches of the page compaction service. "
+                 "(Default: 100ms)",
+                 TUNABLE_INTEGER, &gbl_page_compact_service_pause_ms, 0, NULL,
+                 NULL, NULL, NULL);
+REGISTER_TUNABLE("page_compact_service_pass_sec",
+                 "Pause between two passes of the page compaction service over "
+                 "all tables. (Default: 600secs)",
+                 TUNABLE_INTEGER, &gbl_page_compact_service_pass_sec, 0, NULL,
+                 NULL, NULL, NULL);
+REGISTER_TUNABLE("page_compact_service_thresh_ff",
+                 "The page compaction service merges leaf pages at most this "
+                 "full. (Default: 0.35)",
+                 TUNABLE_DOUBLE, &gbl_page_compact_service_thresh_ff, 0, NULL,
+                 NULL, NULL, NULL);
 REGISTER_TUNABLE("page_compact_target_ff", NULL, TUNABLE_DOUBLE, &gbl_pg_compact_target_ff, NOARG, NULL, NULL,
                  page_compact_target_ff_update, NULL);
 REGISTER_TUNABLE("page_compact_thresh_ff", NULL, TUNABLE_DOUBLE, &gbl_pg_compact_thresh, READONLY | NOARG, NULL, NULL,
@@ -1111,6 +1161,63 @@ REGISTER_TUNABLE("sqlsortermem", "Maximum amount of memory to be "
                                  "(Default: 314572800)",
                  TUNABLE_INTEGER, &gbl_sqlite_sorter_mem, READONLY, NULL, NULL,
                  NULL, NULL);
+REGISTER_TUNABLE("sql_hash_join",
+                 "Build automatic indexes of equi-joins as in-memory hash "
+                 "tables. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_sql_hash_join, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("sql_hash_join_max_mem",
+                 "Bytes a hash join table may hold in memory before it "
+                 "spills to a temp table. (Default: 67108864)",
+                 TUNABLE_INTEGER, &gbl_sql_hash_join_max_mem, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("sql_scan_batch_rows",
+                 "Number of rows a forward table scan of a read-only statement "
+                 "reads ahead per batch, 0 to disable. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_sql_scan_batch_rows, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("sql_zerocopy_min_bytes",
+                 "Column values of at least this many bytes are sent to the "
+                 "client in place instead of being copied into the write "
+                 "buffer, 0 to disable, otherwise at least 4096. "
+                 "(Default: 65536)",
+                 TUNABLE_INTEGER, &gbl_sql_zerocopy_min_bytes, 0, NULL,
+                 zerocopy_min_bytes_verify, NULL, NULL);
+REGISTER_TUNABLE("sql_fairshare",
+                 "Share the SQL engine pool fairly between classes of requests "
+                 "when it is busy. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_sql_fairshare, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("sql_fairshare_key",
+                 "What puts SQL requests in the same fair-share class: user, "
+                 "host, task or fingerprint. (Default: user)",
+                 TUNABLE_ENUM, &gbl_sql_fairshare_key, 0, sql_fairshare_key_value,
+                 NULL, sql_fairshare_key_update, NULL);
+REGISTER_TUNABLE("sql_fairshare_class",
+                 "Set the share and maximum concurrent requests of a "
+                 "fair-share class: <class> <share> [<max concurrent>]",
+                 TUNABLE_RAW, NULL, 0, NULL, NULL, sql_fairshare_class_update,
+                 NULL);
+REGISTER_TUNABLE("sql_fairshare_default_share",
+                 "Share of fair-share classes not set with sql_fairshare_class. "
+                 "(Default: 1)",
+                 TUNABLE_INTEGER, &gbl_sql_fairshare_default_share, NOZERO, NULL,
+                 NULL, NULL, NULL);
+REGISTER_TUNABLE("sql_fairshare_default_max_concurrent",
+                 "Maximum concurrent requests of fair-share classes not set "
+                 "with sql_fairshare_class, 0 for no limit. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_sql_fairshare_default_max_concurrent, 0,
+                 NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("sql_fairshare_max_waiting",
+                 "Run requests right away instead of holding them for their "
+                 "turn once this many are waiting. (Default: 1000)",
+                 TUNABLE_INTEGER, &gbl_sql_fairshare_max_waiting, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("sql_fairshare_cost_us",
+                 "Microseconds of CPU time one unit of query cost is charged "
+                 "as. (Default: 10)",
+                 TUNABLE_INTEGER, &gbl_sql_fairshare_cost_us, 0, NULL, NULL,
+                 NULL, NULL);
 REGISTER_TUNABLE("sql_stat4_scan", "Possibly adjust the cost of a full table "
                                    "scan based on STAT4 data.  (Default: off)",
                  TUNABLE_BOOLEAN, &gbl_sqlite_stat4_scan, READONLY | INTERNAL |
@@ -1738,6 +1845,13 @@ REGISTER_TUNABLE(
     "If the partition has more shards than this, we run one shard at a time.",
     TUNABLE_INTEGER, &gbl_dohsql_sc_max_threads, 8, NULL, NULL, NULL, NULL);
 
+REGISTER_TUNABLE(
+    "dohsql_stripe_scan_shards",
+    "Split eligible single table scans into this many per-stripe shards "
+    "(0 or 1 to disable).",
+    TUNABLE_INTEGER, &gbl_dohsql_stripe_scan_shards, 0, NULL, NULL, NULL,
+    NULL);
+
 REGISTER_TUNABLE("random_fail_client_write_lock",
                  "Force a random client write-lock failure 1/this many times.  "
                  "(Default: 0)",
@@ -1845,6 +1959,9 @@ REGISTER_TUNABLE("physrep_source_host", "List of physical replication source clu
                  &gbl_physrep_source_host, READONLY, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("physrep_ignore_queues", "Don't replicate queues.", TUNABLE_BOOLEAN, &gbl_physrep_ignore_queues,
                  READONLY, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("physrep_timestamp_index",
+                 "Find the log position for a timestamp by bisecting the log files on their first timestamps instead of scanning back from the end of the log. (Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_physrep_timestamp_index, 0, NULL, NULL, NULL, NULL);
 
 /* reversql-sql */
 REGISTER_TUNABLE("revsql_allow_command_execution",
@@ -2076,6 +2193,12 @@ REGISTER_TUNABLE("longreq_log_freq_sec",
 
 REGISTER_TUNABLE("eventlog_nkeep", "Keep this many eventlog files (Default: 2)",
                  TUNABLE_INTEGER, &eventlog_nkeep, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("eventlog_queue_max_bytes",
+                 "Maximum bytes of events waiting for the eventlog writer thread (Default: 64MB)",
+                 TUNABLE_INTEGER, &gbl_eventlog_queue_max_bytes, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("eventlog_block_on_full",
+                 "Block requests when the eventlog queue is full instead of dropping events (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_eventlog_block_on_full, 0, NULL, NULL, NULL, NULL);
 
 REGISTER_TUNABLE("waitalive_iterations",
                  "Wait this many iterations for a "
@@ -547,6 +547,8 @@ static void node_free(dohsql_node_t **pnode, sqlite3 *db)
         free((*pnode)->params);
     }
 
+    free((*pnode)->stripe_order_dir);
+
     /* current node */
     if ((*pnode)->sql) {
         sqlite3_free((*pnode)->sql);
@@ -692,6 +694,52 @@ static int skip_tables(Select *p)
     return 0;
 }
 
+/**
+ * Check if a single table select can be split in per-stripe shards;
+ * rows from different stripes are disjoint, so the shard results only
+ * need merging: ordered by result columns, or by summing counts
+ */
+static void stripe_scan_candidate(Select *p, dohsql_node_t *node)
+{
+    struct SrcList_item *item = &p->pSrc->a[0];
+    int i;
+
+    if (gbl_dohsql_stripe_scan_shards < 2 || p->pSrc->nSrc != 1 ||
+        !item->pTab || item->pTab->iDb != 0 || IsVirtual(item->pTab) ||
+        item->pTab->pSelect || p->pLimit || (p->selFlags & SF_Distinct))
+        return;
+
+    if (p->selFlags & SF_Aggregate) {
+        /* only plain counts can be combined */
+        if (p->pOrderBy)
+            return;
+        for (i = 0; i < p->pEList->nExpr; i++) {
+            Expr *expr = p->pEList->a[i].pExpr;
+            if (expr->op != TK_AGG_FUNCTION ||
+                strcasecmp(expr->u.zToken, "count") ||
+                ExprHasProperty(expr, EP_Distinct))
+                return;
+        }
+        node->stripe_combine = 1;
+    } else if (p->pOrderBy) {
+        /* merge needs the order by terms in the result set */
+        node->stripe_order_dir = malloc(p->pOrderBy->nExpr * sizeof(int));
+        if (!node->stripe_order_dir)
+            return;
+        for (i = 0; i < p->pOrderBy->nExpr; i++) {
+            struct ExprList_item *term = &p->pOrderBy->a[i];
+            if (term->u.x.iOrderByCol <= 0) {
+                free(node->stripe_order_dir);
+                node->stripe_order_dir = NULL;
+                return;
+            }
+            node->stripe_order_dir[i] =
+                term->u.x.iOrderByCol * (term->sortOrder ? -1 : 1);
+        }
+    }
+    node->stripe_tnum = item->pTab->tnum;
+}
+
 static dohsql_node_t *gen_select(Vdbe *v, Select *p)
 {
     Select *crt;
@@ -726,6 +774,11 @@ static dohsql_node_t *gen_select(Vdbe *v, Select *p)
     )
         return NULL;
 
+    /* a point query on a hash partition only matches one shard; the other
+       arms are skipped as soon as they start, no need for parallel workers */
+    if (p->op == TK_ALL && sqlite3IsPartitionHashPointQuery(v->pParse, p))
+        return NULL;
+
     if (p->op == TK_SELECT) {
         ret = gen_oneselect(v, p, NULL, NULL, NULL, 0);
         if (ret) {
@@ -760,6 +813,8 @@ static dohsql_node_t *gen_select(Vdbe *v, Select *p)
                     logmsg(LOGMSG_USER, "We can push remotely to %d %s db %p\n",
                            remoteIdb, remoteDb, v->db);
                 ret->remotedb = remoteIdb;
+            } else {
+                stripe_scan_candidate(p, ret);
             }
         }
     } else
@@ -876,6 +931,131 @@ void ast_print(ast_t *ast)
 
 extern int comdb2IsPrepareOnly(Parse*);
 
+/**
+ * The compiled plan must visit the table with a plain full scan,
+ * and no other btree; any positioning by key or rowid would see
+ * rows outside the shard stripes
+ */
+static int stripe_scan_plan(Vdbe *v, int tnum)
+{
+    int csr = -1;
+    int i;
+
+    for (i = 0; i < v->nOp; i++) {
+        VdbeOp *op = &v->aOp[i];
+        switch (op->opcode) {
+        case OP_OpenRead:
+        case OP_OpenRead_Record:
+            if (op->p3 != 0 || op->p2 != tnum || (op->p5 & OPFLAG_P2ISREG) ||
+                csr != -1)
+                return 0;
+            csr = op->p1;
+            break;
+        case OP_ReopenIdx:
+        case OP_OpenWrite:
+        case OP_OpenDup:
+            return 0;
+        }
+    }
+    if (csr == -1)
+        return 0;
+
+    for (i = 0; i < v->nOp; i++) {
+        VdbeOp *op = &v->aOp[i];
+        switch (op->opcode) {
+        case OP_Count:
+        case OP_SeekRowid:
+        case OP_NotExists:
+        case OP_SeekLT:
+        case OP_SeekLE:
+        case OP_SeekGE:
+        case OP_SeekGT:
+        case OP_Found:
+        case OP_NotFound:
+        case OP_NoConflict:
+        case OP_SeekEnd:
+        case OP_Last:
+        case OP_Prev:
+            if (op->p1 == csr)
+                return 0;
+            break;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Replace a single query node with a union of identical queries, each
+ * restricted to a contiguous range of data stripes
+ */
+static dohsql_node_t *gen_stripe_scan(dohsql_node_t *node)
+{
+    dohsql_node_t *stripes;
+    int nshards = gbl_dohsql_stripe_scan_shards;
+    int i;
+
+    if (nshards > gbl_dtastripe)
+        nshards = gbl_dtastripe;
+    if (gbl_dohsql_max_threads && nshards > gbl_dohsql_max_threads)
+        nshards = gbl_dohsql_max_threads;
+    if (nshards < 2)
+        return NULL;
+
+    stripes = (dohsql_node_t *)calloc(1, sizeof(dohsql_node_t) +
+                                             nshards * sizeof(void *));
+    if (!stripes)
+        return NULL;
+
+    stripes->type = AST_TYPE_UNION;
+    stripes->nodes = (dohsql_node_t **)(stripes + 1);
+    stripes->nnodes = nshards;
+    stripes->ncols = node->ncols;
+    stripes->stripe_tnum = node->stripe_tnum;
+    stripes->stripe_combine = node->stripe_combine;
+    stripes->sql = sqlite3_mprintf("%s", node->sql);
+    if (!stripes->sql)
+        goto err;
+
+    for (i = 0; i < nshards; i++) {
+        dohsql_node_t *shard = calloc(1, sizeof(dohsql_node_t));
+        if (!shard)
+            goto err;
+        stripes->nodes[i] = shard;
+        shard->type = AST_TYPE_SELECT;
+        shard->ncols = node->ncols;
+        shard->stripe_lo = i * gbl_dtastripe / nshards;
+        shard->stripe_hi = (i + 1) * gbl_dtastripe / nshards;
+        shard->sql = sqlite3_mprintf("%s", node->sql);
+        if (!shard->sql)
+            goto err;
+        if (node->params) {
+            /* parameter values are owned by the client, as for unions */
+            shard->params = calloc(1, sizeof(struct params_info));
+            if (!shard->params)
+                goto err;
+            *shard->params = *node->params;
+            shard->params->params =
+                malloc(node->params->nparams * sizeof(struct param_data));
+            if (!shard->params->params)
+                goto err;
+            memcpy(shard->params->params, node->params->params,
+                   node->params->nparams * sizeof(struct param_data));
+        }
+    }
+
+    if (node->stripe_order_dir) {
+        stripes->order_size = node->order_size;
+        stripes->order_dir = node->stripe_order_dir;
+        node->stripe_order_dir = NULL;
+    }
+
+    return stripes;
+
+err:
+    node_free(&stripes, NULL);
+    return NULL;
+}
+
 int comdb2_check_parallel(Parse *pParse)
 {
     if (comdb2IsPrepareOnly(pParse))
@@ -913,7 +1093,18 @@ int comdb2_check_parallel(Parse *pParse)
     if (node->type == AST_TYPE_SELECT) {
         if (gbl_dohast_verbose)
             logmsg(LOGMSG_USER, "%p Single query \"%s\"\n", (void *)pthread_self(), node->sql);
-        return 0;
+        if (!node->stripe_tnum ||
+            !stripe_scan_plan(pParse->pVdbe, node->stripe_tnum))
+            return 0;
+        dohsql_node_t *stripes = gen_stripe_scan(node);
+        if (!stripes)
+            return 0;
+        /* the ast owns the new node from now on */
+        node_free(&node, NULL);
+        ast->stack[0].obj = node = stripes;
+        if (gbl_dohast_verbose)
+            logmsg(LOGMSG_USER, "%p Stripe scan %d shards\n",
+                   (void *)pthread_self(), node->nnodes);
     }
 
     if (node->type == AST_TYPE_UNION) {
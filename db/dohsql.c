@@ -19,6 +19,7 @@
 #include "sql.h"
 #include "shard_range.h"
 #include "sqliteInt.h"
+#include "vdbeInt.h"
 #include "queue.h"
 #include "reqlog.h"
 #include "dohsql.h"
@@ -35,6 +36,7 @@ int gbl_dohsql_full_queue_poll_msec = 10;       /* 10msec */
 int gbl_dohsql_max_threads = 8; /* do not run more than 8 parallel shards */
 int gbl_dohsql_pool_thr_slack = 24; /* half default sqlengine pool maxthds */
 int gbl_dohsql_sc_max_threads = 8; /* do not run more than 8 parallel sc-s */
+int gbl_dohsql_stripe_scan_shards = 0; /* split single table scans */
 /* for now we keep this tunning "private */
 static int gbl_dohsql_track_stats = 1;
 static int gbl_dohsql_que_free_highwm = 10;
@@ -73,6 +75,9 @@ struct dohsql_connector {
     int nparams;            /* parameters for the child */
     struct param_data *params;
     dohsql_connector_stats_t stats;
+    int stripe_tnum; /* stripe scan: table root restricted to */
+    int stripe_lo;   /* -- " -- first stripe */
+    int stripe_hi;   /* -- " -- past last stripe, 0 if none */
 };
 typedef struct dohsql_connector dohsql_connector_t;
 
@@ -123,10 +128,18 @@ struct dohsql {
     int order_size;
     int *order_dir;
     int nparams;
+    /* partial aggregate combine support */
+    int combine;   /* sum partial counts */
+    int agg_done;  /* combined row was returned */
+    Mem *agg;      /* combined values, coordinator owned */
+    row_t agg_row; /* row wrapper for agg */
     /* stats */
     dohsql_req_stats_t stats;
 };
 
+/* row_src of a row built by the coordinator itself */
+#define DOHSQL_AGG_SRC -1
+
 struct dohsql_stats {
     long long num_reqs;
     int max_distribution;
@@ -521,6 +534,10 @@ static int dohsql_dist_sqlite_error(struct sqlclntstate *clnt,
     if (src == 0) {
         return sqlite_stmt_error(stmt, errstr);
     }
+    if (src == DOHSQL_AGG_SRC) {
+        *errstr = NULL;
+        return SQLITE_ROW;
+    }
 
     Q_LOCK(src);
 
@@ -557,7 +574,11 @@ static int dohsql_dist_param_value(struct sqlclntstate *clnt,
 static void donate_current_row(dohsql_t *conns, int locked)
 {
     if (conns->row) {
-        if (conns->row_src) {
+        if (conns->row_src == DOHSQL_AGG_SRC) {
+            /* combined row belongs to the coordinator */
+            conns->row = NULL;
+            conns->row_src = 0;
+        } else if (conns->row_src) {
             /* free what coordinator allocated before sending the row back */
             if (conns->row->unpacked) {
                 sqlite3UnpackedResultFree(&conns->row->unpacked, conns->ncols);
@@ -870,6 +891,47 @@ got_row:
     return SQLITE_ROW;
 }
 
+/**
+ * this is a merge of N partial aggregates into one row; the shards
+ * return one row of counts each, which are summed
+ *
+ */
+static int dohsql_dist_next_row_combined(struct sqlclntstate *clnt,
+                                         sqlite3_stmt *stmt)
+{
+    dohsql_t *conns = clnt->conns;
+    int rc;
+    int i;
+
+    if (conns->agg_done) {
+        donate_current_row(conns, 0);
+        return SQLITE_DONE;
+    }
+
+    if (!conns->agg) {
+        conns->agg = (Mem *)calloc(conns->ncols, sizeof(Mem));
+        if (!conns->agg)
+            return SQLITE_NOMEM;
+        for (i = 0; i < conns->ncols; i++)
+            conns->agg[i].flags = MEM_Int;
+    }
+
+    while ((rc = dohsql_dist_next_row(clnt, stmt)) == SQLITE_ROW) {
+        for (i = 0; i < conns->ncols; i++)
+            conns->agg[i].u.i += dohsql_dist_column_int64(clnt, stmt, i);
+    }
+    if (rc != SQLITE_DONE)
+        return rc;
+
+    donate_current_row(conns, 0);
+    conns->agg_row.unpacked = conns->agg;
+    conns->row = &conns->agg_row;
+    conns->row_src = DOHSQL_AGG_SRC;
+    conns->agg_done = 1;
+
+    return SQLITE_ROW;
+}
+
 static int dohsql_write_response(struct sqlclntstate *c, int t, void *a, int i)
 {
     if (gbl_plugin_api_debug)
@@ -1086,8 +1148,12 @@ static void _master_clnt_set(struct sqlclntstate *clnt)
     clnt->adapter_backup = clnt->adapter;
 
     clnt->plugin.column_count = dohsql_dist_column_count;
-    clnt->plugin.next_row = (clnt->conns->order) ? dohsql_dist_next_row_ordered
-                                                 : dohsql_dist_next_row;
+    if (clnt->conns->combine)
+        clnt->plugin.next_row = dohsql_dist_next_row_combined;
+    else if (clnt->conns->order)
+        clnt->plugin.next_row = dohsql_dist_next_row_ordered;
+    else
+        clnt->plugin.next_row = dohsql_dist_next_row;
     clnt->plugin.column_type = dohsql_dist_column_type;
     clnt->plugin.column_int64 = dohsql_dist_column_int64;
     clnt->plugin.column_double = dohsql_dist_column_double;
@@ -1190,6 +1256,7 @@ int dohsql_distribute(dohsql_node_t *node)
     conns->nconns = node->nnodes;
     conns->ncols = node->ncols;
     conns->nparams = node->nparams;
+    conns->combine = node->stripe_combine;
 
     if (node->order_size) {
         if (order_init(conns, node)) {
@@ -1221,6 +1288,11 @@ int dohsql_distribute(dohsql_node_t *node)
         if ((rc = _shard_connect(clnt, &conns->conns[i], node->nodes[i]->sql,
                                  nparams, params)) != 0)
             return rc;
+        if (node->stripe_tnum) {
+            conns->conns[i].stripe_tnum = node->stripe_tnum;
+            conns->conns[i].stripe_lo = node->nodes[i]->stripe_lo;
+            conns->conns[i].stripe_hi = node->nodes[i]->stripe_hi;
+        }
 
         if (i > 0) {
             struct string_ref *sr = create_string_ref(node->nodes[i]->sql);
@@ -1341,6 +1413,7 @@ int dohsql_end_distribute(struct sqlclntstate *clnt, struct reqlogger *logger)
         free(conns->order);
         free(conns->order_dir);
     }
+    free(conns->agg);
     clnt_plugin_reset(clnt);
     clnt->conns = NULL;
     free(conns);
@@ -1410,6 +1483,27 @@ void dohsql_wait_for_master(sqlite3_stmt *stmt, struct sqlclntstate *clnt)
     Pthread_mutex_unlock(&conn->mtx);
 }
 
+int dohsql_get_stripe_range(struct sqlclntstate *clnt, int *tnum, int *lo,
+                            int *hi)
+{
+    dohsql_connector_t *conn;
+
+    if (DOHSQL_CLIENT)
+        conn = clnt->plugin.state;
+    else if (clnt->conns)
+        conn = &clnt->conns->conns[0]; /* coordinator runs the first shard */
+    else
+        return 0;
+
+    if (!conn->stripe_hi)
+        return 0;
+
+    *tnum = conn->stripe_tnum;
+    *lo = conn->stripe_lo;
+    *hi = conn->stripe_hi;
+    return 1;
+}
+
 const char *dohsql_get_sql(struct sqlclntstate *clnt, int index)
 {
     return clnt->conns->conns[index].clnt->sql;
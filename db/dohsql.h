@@ -36,6 +36,12 @@ struct dohsql_node {
     int nparams;
     int remotedb;
     struct params_info *params;
+    /* stripe scans: table root split across shards */
+    int stripe_tnum;
+    int stripe_lo;
+    int stripe_hi;
+    int *stripe_order_dir; /* order_dir for the merge, or NULL */
+    int stripe_combine;    /* shards return partial counts to be summed */
 };
 typedef struct dohsql_node dohsql_node_t;
 
@@ -69,6 +75,14 @@ void dohsql_wait_for_master(sqlite3_stmt *stmt, struct sqlclntstate *clnt);
     struct sql_thread *thd = pthread_getspecific(query_info_key);              \
     struct sqlclntstate *clnt = thd->clnt;
 
+/**
+ * Return 1 if this engine runs a stripe scan shard; scans of table root
+ * *tnum are restricted to the stripe window [*lo, *hi)
+ *
+ */
+int dohsql_get_stripe_range(struct sqlclntstate *clnt, int *tnum, int *lo,
+                            int *hi);
+
 /**
  * Return 1 if this sql thread servers a parallel statement
  *
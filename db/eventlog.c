@@ -66,6 +66,37 @@ static int eventlog_debug_events = 0;
 static void eventlog_roll(void);
 #define min(x, y) ((x) < (y) ? (x) : (y))
 
+/*
+ * Events are serialized to JSON on the request thread and pushed onto a
+ * lock-free stack. A background writer takes the whole stack at once,
+ * restores arrival order and does compression, file I/O and rolling under
+ * eventlog_lk, off the request path.
+ */
+struct eventlog_rec {
+    struct eventlog_rec *next;
+    int size;                     /* bytes accounted against the queue */
+    int newsql;                   /* may need a "newsql" event first */
+    uint64_t startus;
+    struct string_ref *sql_ref;
+    char fingerprint[FINGERPRINTSZ];
+    int len;
+    char data[1];
+};
+
+int gbl_eventlog_queue_max_bytes = 64 * 1024 * 1024;
+int gbl_eventlog_block_on_full = 0;
+
+static struct eventlog_rec *eventlog_pending = NULL;
+static int64_t eventlog_pending_bytes = 0;
+static int64_t eventlog_dropped = 0;
+static pthread_mutex_t eventlog_queue_lk = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t eventlog_queue_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t eventlog_space_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t eventlog_writer_tid;
+static int eventlog_writer_running = 0;
+static int eventlog_writer_stop = 0;
+static void *eventlog_writer(void *unused);
+
 struct sqltrack {
     char fingerprint[FINGERPRINTSZ];
     LINKC_T(struct sqltrack) lnk;
@@ -184,6 +215,9 @@ void eventlog_init()
     listc_init(&sql_statements, offsetof(struct sqltrack, lnk));
     char *fname = eventlog_fname(thedb->envname);
     if (eventlog_enabled) eventlog = eventlog_open(fname, 0);
+
+    Pthread_create(&eventlog_writer_tid, NULL, eventlog_writer, NULL);
+    eventlog_writer_running = 1;
 }
 
 
@@ -465,11 +499,11 @@ static void eventlog_path(cson_object *obj, const struct reqlogger *logger)
 }
 
 /* add never seen before "newsql" query, also print it to log */
-static void eventlog_add_newsql(const struct reqlogger *logger)
+static void eventlog_add_newsql(const struct eventlog_rec *rec)
 {
     struct sqltrack *st;
     st = malloc(sizeof(struct sqltrack));
-    memcpy(st->fingerprint, logger->fingerprint, sizeof(logger->fingerprint));
+    memcpy(st->fingerprint, rec->fingerprint, sizeof(rec->fingerprint));
     hash_add(seen_sql, st);
     listc_abl(&sql_statements, st);
 
@@ -478,17 +512,17 @@ static void eventlog_add_newsql(const struct reqlogger *logger)
     newval = cson_value_new_object();
     newobj = cson_value_get_object(newval);
 
-    cson_object_set(newobj, "time", cson_new_int(logger->startus));
+    cson_object_set(newobj, "time", cson_new_int(rec->startus));
     cson_object_set(newobj, "type",
             cson_value_new_string("newsql", strlen("newsql")));
 
-    if (logger->sql_ref != NULL) {
-        cson_object_set(newobj, "sql", cson_value_new_string(string_ref_cstr(logger->sql_ref),
-                                                             string_ref_len(logger->sql_ref)));
+    if (rec->sql_ref != NULL) {
+        cson_object_set(newobj, "sql", cson_value_new_string(string_ref_cstr(rec->sql_ref),
+                                                             string_ref_len(rec->sql_ref)));
     }
 
     char expanded_fp[2 * FINGERPRINTSZ + 1];
-    util_tohex(expanded_fp, logger->fingerprint, FINGERPRINTSZ);
+    util_tohex(expanded_fp, rec->fingerprint, FINGERPRINTSZ);
     cson_object_set(newobj, "fingerprint",
             cson_value_new_string(expanded_fp, FINGERPRINTSZ * 2));
 
@@ -595,15 +629,134 @@ static void populate_obj(cson_object *obj, const struct reqlogger *logger)
     eventlog_path(obj, logger);
 }
 
-static inline void add_to_fingerprints(const struct reqlogger *logger)
+/* serialize `val' and hand it over to the writer thread */
+static void eventlog_enqueue(cson_value *val, const struct reqlogger *logger)
 {
-    int isSqlErr = logger->error && logger->sql_ref;
+    struct eventlog_rec *rec, *head;
+    cson_buffer buf;
+    int size;
 
-    if ((EV_SQL == logger->event_type || isSqlErr) && !hash_find(seen_sql, logger->fingerprint)) {
-        eventlog_add_newsql(logger);
+    cson_output_buffer(val, &buf);
+    size = offsetof(struct eventlog_rec, data) + buf.used + 1;
+
+    if (ATOMIC_LOAD64(eventlog_pending_bytes) + size > gbl_eventlog_queue_max_bytes) {
+        if (!gbl_eventlog_block_on_full) {
+            ATOMIC_ADD64(eventlog_dropped, 1);
+            return;
+        }
+        Pthread_mutex_lock(&eventlog_queue_lk);
+        while (eventlog_writer_running && ATOMIC_LOAD64(eventlog_pending_bytes) > 0 &&
+               ATOMIC_LOAD64(eventlog_pending_bytes) + size > gbl_eventlog_queue_max_bytes)
+            Pthread_cond_wait(&eventlog_space_cond, &eventlog_queue_lk);
+        Pthread_mutex_unlock(&eventlog_queue_lk);
+    }
+
+    rec = malloc(size);
+    if (rec == NULL) {
+        ATOMIC_ADD64(eventlog_dropped, 1);
+        return;
+    }
+    rec->size = size;
+    rec->newsql = 0;
+    rec->sql_ref = NULL;
+    if (logger) {
+        int isSqlErr = logger->error && logger->sql_ref;
+        if (EV_SQL == logger->event_type || isSqlErr) {
+            rec->newsql = 1;
+            rec->startus = logger->startus;
+            memcpy(rec->fingerprint, logger->fingerprint, sizeof(rec->fingerprint));
+            if (logger->sql_ref)
+                rec->sql_ref = get_ref(logger->sql_ref);
+        }
+    }
+    memcpy(rec->data, buf.mem, buf.used);
+    rec->data[buf.used] = '\n';
+    rec->len = buf.used + 1;
+
+    ATOMIC_ADD64(eventlog_pending_bytes, size);
+    head = __atomic_load_n(&eventlog_pending, __ATOMIC_RELAXED);
+    do {
+        rec->next = head;
+    } while (!__atomic_compare_exchange_n(&eventlog_pending, &head, rec, 1,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+    /* only the push onto an empty stack needs to wake up the writer */
+    if (head == NULL) {
+        Pthread_mutex_lock(&eventlog_queue_lk);
+        Pthread_cond_signal(&eventlog_queue_cond);
+        Pthread_mutex_unlock(&eventlog_queue_lk);
+    }
+}
+
+// write out everything queued so far
+// this function must be called while holding eventlog_lk
+static void eventlog_drain(int *call_roll_cleanup)
+{
+    struct eventlog_rec *rec, *next, *fifo = NULL;
+    int64_t drained = 0;
+
+    rec = __atomic_exchange_n(&eventlog_pending, NULL, __ATOMIC_ACQUIRE);
+    for (; rec != NULL; rec = next) {
+        next = rec->next;
+        rec->next = fifo;
+        fifo = rec;
+    }
+
+    for (rec = fifo; rec != NULL; rec = next) {
+        next = rec->next;
+        if (eventlog != NULL && eventlog_enabled) {
+            if (eventlog_rollat > 0 && bytes_written > eventlog_rollat) {
+                eventlog_roll();
+                *call_roll_cleanup = 1;
+            }
+            if (eventlog != NULL) {
+                if (rec->newsql && !hash_find(seen_sql, rec->fingerprint))
+                    eventlog_add_newsql(rec);
+                write_json(eventlog, rec->data, rec->len);
+            }
+        }
+        drained += rec->size;
+        if (rec->sql_ref)
+            put_ref(&rec->sql_ref);
+        free(rec);
+    }
+
+    if (drained > 0) {
+        ATOMIC_ADD64(eventlog_pending_bytes, -drained);
+        if (gbl_eventlog_block_on_full) {
+            Pthread_mutex_lock(&eventlog_queue_lk);
+            Pthread_cond_broadcast(&eventlog_space_cond);
+            Pthread_mutex_unlock(&eventlog_queue_lk);
+        }
     }
 }
 
+static void *eventlog_writer(void *unused)
+{
+    int stop, call_roll_cleanup;
+
+    comdb2_name_thread(__func__);
+
+    do {
+        Pthread_mutex_lock(&eventlog_queue_lk);
+        while (__atomic_load_n(&eventlog_pending, __ATOMIC_ACQUIRE) == NULL && !eventlog_writer_stop)
+            Pthread_cond_wait(&eventlog_queue_cond, &eventlog_queue_lk);
+        stop = eventlog_writer_stop;
+        Pthread_mutex_unlock(&eventlog_queue_lk);
+
+        call_roll_cleanup = 0;
+        Pthread_mutex_lock(&eventlog_lk);
+        eventlog_drain(&call_roll_cleanup);
+        Pthread_mutex_unlock(&eventlog_lk);
+
+        if (call_roll_cleanup) {
+            eventlog_roll_cleanup();
+        }
+    } while (!stop);
+
+    return NULL;
+}
+
 void eventlog_add(const struct reqlogger *logger)
 {
     if (eventlog == NULL || !eventlog_enabled ||
@@ -619,23 +772,8 @@ void eventlog_add(const struct reqlogger *logger)
     cson_value *val = cson_value_new_object();
     cson_object *obj = cson_value_get_object(val);
     populate_obj(obj, logger);
-    int call_roll_cleanup = 0;
 
-    Pthread_mutex_lock(&eventlog_lk);
-
-    if (eventlog != NULL && eventlog_enabled) {
-        if (eventlog_rollat > 0 && bytes_written > eventlog_rollat) {
-            eventlog_roll();
-            call_roll_cleanup = 1;
-        }
-        add_to_fingerprints(logger);
-        cson_output(val, write_json, eventlog);
-    }
-    Pthread_mutex_unlock(&eventlog_lk);
-
-    if (call_roll_cleanup) {
-        eventlog_roll_cleanup();
-    }
+    eventlog_enqueue(val, logger);
 
     if (eventlog_verbose)
         cson_output_FILE(val, stdout);
@@ -649,6 +787,8 @@ void eventlog_status(void)
         logmsg(LOGMSG_USER, "Eventlog enabled, file:%s\n", gbl_eventlog_fname);
     else
         logmsg(LOGMSG_USER, "Eventlog disabled\n");
+    logmsg(LOGMSG_USER, "Eventlog queue: %" PRId64 " bytes pending, %" PRId64 " events dropped\n",
+           ATOMIC_LOAD64(eventlog_pending_bytes), ATOMIC_LOAD64(eventlog_dropped));
 }
 
 // roll the log: close existing file open a new one
@@ -686,9 +826,23 @@ static void eventlog_disable(void)
 
 void eventlog_stop(void)
 {
+    int call_roll_cleanup = 0;
+
     Pthread_mutex_lock(&eventlog_lk);
+    eventlog_drain(&call_roll_cleanup);
     eventlog_disable();
     Pthread_mutex_unlock(&eventlog_lk);
+
+    Pthread_mutex_lock(&eventlog_queue_lk);
+    int running = eventlog_writer_running;
+    eventlog_writer_running = 0;
+    eventlog_writer_stop = 1;
+    Pthread_cond_signal(&eventlog_queue_cond);
+    Pthread_cond_broadcast(&eventlog_space_cond);
+    Pthread_mutex_unlock(&eventlog_queue_lk);
+
+    if (running)
+        Pthread_join(eventlog_writer_tid, NULL);
 }
 
 static inline void eventlog_set_rollat(uint64_t rollat_bytes) 
@@ -710,6 +864,7 @@ static void eventlog_help(void)
                         "events dir <dir>         - set custom directory for event log files\n"
                         "events file <file>       - set log file to custom location\n"
                         "events flush             - flush log\n"
+                        "events stat              - show writer queue and dropped events\n"
                         "events debug <on|off>    - turn on logging of debug events\n"
                         "events help              - this help message\n");
 }
@@ -823,6 +978,8 @@ static void eventlog_process_message_locked(char *line, int lline, int *toff, in
     } else if (tokcmp(tok, ltok, "flush") == 0) {
         if (eventlog)
             gzflush(eventlog, 1);
+    } else if (tokcmp(tok, ltok, "stat") == 0) {
+        eventlog_status();
     } else if (tokcmp(tok, ltok, "file") == 0) {
         // use given file for logging; when we roll, we go back to the original scheme
         tok = segtok(line, lline, toff, &ltok);
@@ -859,6 +1016,8 @@ void eventlog_process_message(char *line, int lline, int *toff)
 {
     int call_roll_cleanup = 0;
     Pthread_mutex_lock(&eventlog_lk);
+    /* commands apply to everything logged before them */
+    eventlog_drain(&call_roll_cleanup);
     eventlog_process_message_locked(line, lline, toff, &call_roll_cleanup);
     Pthread_mutex_unlock(&eventlog_lk);
 
@@ -887,9 +1046,7 @@ void eventlog_debug(char *fmt, ...) {
     cson_object_set(obj, "debug", cson_value_new_string(s, strlen(s)));
     os_free(s);
 
-    Pthread_mutex_lock(&eventlog_lk);
-    cson_output(vobj, write_json, eventlog);
-    Pthread_mutex_unlock(&eventlog_lk);
+    eventlog_enqueue(vobj, NULL);
     cson_value_free(vobj);
 }
 
@@ -928,9 +1085,6 @@ void eventlog_deadlock_cycle(locker_info *idmap, u_int32_t *deadmap,
     cson_object_set(obj, "time", cson_new_int(startus));
     cson_object_set(obj, "host", host);
     cson_object_set(obj, "deadlock_cycle", dd_list);
-    Pthread_mutex_lock(&eventlog_lk);
-    if (eventlog_enabled && eventlog != NULL)
-        cson_output(dval, write_json, eventlog);
-    Pthread_mutex_unlock(&eventlog_lk);
+    eventlog_enqueue(dval, NULL);
     cson_value_free(dval);
 }
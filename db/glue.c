@@ -1067,6 +1067,8 @@ int ix_addk(struct ireq *iq, void *trans, void *key, int ixnum,
     ACCUMULATE_TIMING(CHR_IXADDK,
                       rc = ix_addk_auxdb(AUXDB_NONE, iq, trans, key, ixnum,
                                          genid, rrn, dta, dtalen, isnull););
+    if (rc == 0)
+        ATOMIC_ADD64(iq->usedb->ix_write_count[ixnum], 1);
     return rc;
 }
 
@@ -1137,7 +1139,11 @@ int ix_delk_auxdb(int auxdb, struct ireq *iq, void *trans, void *key, int ixnum,
 int ix_delk(struct ireq *iq, void *trans, void *key, int ixnum, int rrn,
             unsigned long long genid, int isnull)
 {
-    return ix_delk_auxdb(AUXDB_NONE, iq, trans, key, ixnum, rrn, genid, isnull);
+    int rc = ix_delk_auxdb(AUXDB_NONE, iq, trans, key, ixnum, rrn, genid,
+                           isnull);
+    if (rc == 0)
+        ATOMIC_ADD64(iq->usedb->ix_write_count[ixnum], 1);
+    return rc;
 }
 
 inline int dat_upv(struct ireq *iq, void *trans, int vptr, void *vdta, int vlen,
@@ -4638,6 +4644,9 @@ get_put_db(queue_persistent_seq, META_QUEUE_PERSISTENT_SEQ)
 // put_db_queue_sequence
 get_put_db_ll(queue_sequence, META_QUEUE_SEQ)
 
+// get_db_inline_blobs, get_db_inline_blobs_tran, put_db_inline_blobs
+get_put_db(inline_blobs, META_INLINE_BLOBS)
+
 static int put_meta_int(const char *table, void *tran, int rrn, int key,
                         int value)
 {
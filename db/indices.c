@@ -23,6 +23,7 @@
 #include "sqloffload.h"
 #include "eventlog.h"
 #include "tohex.h"
+#include <comdb2_atomic.h>
 
 
 extern int gbl_partial_indexes;
@@ -216,6 +217,10 @@ int check_index(struct ireq *iq, void *trans, int ixnum, blob_buffer_t *blobs, s
         return 0;
     }
 
+    /* the key is certainly not there; skip the btree */
+    if (!bdb_ix_bloom_may_contain(iq->usedb->handle, ixnum, key, ixkeylen))
+        return 0;
+
     rc = ix_find_by_key_tran(iq, key, ixkeylen, ixnum, NULL, &fndrrn, &fndgenid,
                              NULL, NULL, 0, trans);
     if (rc == IX_FND) {
@@ -350,12 +355,25 @@ static inline void append_genid_to_key(dtikey_t *ditk, int ixkeylen)
     } while (0);
 
 
+/* The key writes of the indexes marked deferwrites (which csc2 only allows on
+ * dup indexes) of a multi-row transaction go to the defered index table like
+ * reordered ones and are applied in key order at the end of the transaction.
+ * The other indexes are still written right away, so that duplicates fail the
+ * statement that added them. */
+int defer_dup_index_writes(struct ireq *iq)
+{
+    return osql_is_dup_index_defer_on(iq->osql_flags) &&
+           iq->usedb->has_defer_ix && iq->usedb->sc_from != iq->usedb &&
+           iq->usedb->ix_expr == 0 && /* same restrictions as reordering */
+           iq->usedb->n_constraints == 0;
+}
+
 int add_record_indices(struct ireq *iq, void *trans, blob_buffer_t *blobs,
                        size_t maxblobs, int *opfailcode, int *ixfailnum,
                        int *rrn, unsigned long long *genid,
                        unsigned long long vgenid, unsigned long long ins_keys,
                        int opcode, int blkpos, void *od_dta, size_t od_len,
-                       int flags, int reorder)
+                       int flags, int reorder, int defer_dups)
 {
     int rc = 0;
     int dup_txn_insert = 0;
@@ -368,7 +386,7 @@ int add_record_indices(struct ireq *iq, void *trans, blob_buffer_t *blobs,
     void *cur = NULL;
     dtikey_t ditk = {0};
 
-    if (reorder) {
+    if (reorder || defer_dups) {
         cur = get_defered_index_tbl_cursor(1);
         if (cur == NULL) {
             logmsg(LOGMSG_ERROR, "%s : no cursor???\n", __func__);
@@ -381,6 +399,7 @@ int add_record_indices(struct ireq *iq, void *trans, blob_buffer_t *blobs,
     }
 
     for (ixnum = 0; ixnum < iq->usedb->nix; ixnum++) {
+        int defer = reorder || (defer_dups && iq->usedb->ix_defer[ixnum]);
         char *key = ditk.ixkey; // key points to chararray regardless reordering
         char mangled_key[MAXKEYLEN + 1];
         char partial_datacopy_tail[MAXRECSZ];
@@ -439,7 +458,7 @@ int add_record_indices(struct ireq *iq, void *trans, blob_buffer_t *blobs,
         if (iq->osql_step_ix)
             gbl_osqlpf_step[*(iq->osql_step_ix)].step += 2;
 
-        if (reorder) {
+        if (defer) {
             // if not datacopy, no need to save od_dta_tail
             void *data = NULL;
             int datalen = 0;
@@ -599,8 +618,9 @@ int upd_record_indices(struct ireq *iq, void *trans, int *opfailcode,
         iq->usedb->sc_from != iq->usedb &&
         iq->usedb->ix_expr == 0 && /* dont reorder if we have idx on expr */
         iq->usedb->n_constraints == 0; /* dont reorder if foreign constrts */
+    int defer_dups = !reorder && defer_dup_index_writes(iq);
 
-    if (reorder) {
+    if (reorder || defer_dups) {
         cur = get_defered_index_tbl_cursor(1);
         if (cur == NULL) {
             logmsg(LOGMSG_ERROR, "%s : no cursor???\n", __func__);
@@ -618,6 +638,7 @@ int upd_record_indices(struct ireq *iq, void *trans, int *opfailcode,
     int live_sc_delay = live_sc_delay_key_add(iq);
 
     for (int ixnum = 0; ixnum < iq->usedb->nix; ixnum++) {
+        int defer = reorder || (defer_dups && iq->usedb->ix_defer[ixnum]);
         if (flags == RECFLAGS_UPGRADE_RECORD &&
             iq->usedb->ix_datacopy[ixnum] == 0)
             // skip non-datacopy indexes if it is a record upgrade
@@ -714,7 +735,7 @@ int upd_record_indices(struct ireq *iq, void *trans, int *opfailcode,
               ixnum, *genid);*/
 
             gbl_upd_key++;
-            if (reorder) {
+            if (defer) {
                 // if not datacopy, no need to save od_dta_tail
                 void *data = NULL;
                 int datalen = 0;
@@ -768,7 +789,7 @@ int upd_record_indices(struct ireq *iq, void *trans, int *opfailcode,
             /* only delete keys when told */
             if (!gbl_partial_indexes || !iq->usedb->ix_partial ||
                 (del_keys & (1ULL << ixnum))) {
-                if (reorder) {
+                if (defer) {
                     // if not datacopy, no need to save od_dta_tail
                     void *data = NULL;
                     int datalen = 0;
@@ -822,7 +843,7 @@ int upd_record_indices(struct ireq *iq, void *trans, int *opfailcode,
 
             if (!gbl_partial_indexes || !iq->usedb->ix_partial ||
                 (ins_keys & (1ULL << ixnum))) {
-                if (reorder) {
+                if (defer) {
                     // if not datacopy, no need to save od_dta_tail
                     void *data = NULL;
                     int datalen = 0;
@@ -886,8 +907,9 @@ int del_record_indices(struct ireq *iq, void *trans, int *opfailcode, int *ixfai
         iq->usedb->sc_from != iq->usedb &&
         iq->usedb->ix_expr == 0 && /* dont reorder if we have idx on expr */
         iq->usedb->n_constraints == 0; /* dont reorder if foreign constrts */
+    int defer_dups = !reorder && defer_dup_index_writes(iq);
 
-    if (reorder) {
+    if (reorder || defer_dups) {
         cur = get_defered_index_tbl_cursor(1);
         if (cur == NULL) {
             logmsg(LOGMSG_ERROR, "%s : no cursor???\n", __func__);
@@ -899,6 +921,7 @@ int del_record_indices(struct ireq *iq, void *trans, int *opfailcode, int *ixfai
     }
 
     for (int ixnum = 0; ixnum < iq->usedb->nix; ixnum++) {
+        int defer = reorder || (defer_dups && iq->usedb->ix_defer[ixnum]);
         char *key = delditk.ixkey;
 
         /* only delete keys when told */
@@ -940,7 +963,7 @@ int del_record_indices(struct ireq *iq, void *trans, int *opfailcode, int *ixfai
         if (iq->osql_step_ix)
             gbl_osqlpf_step[*(iq->osql_step_ix)].step += 2;
 
-        if (reorder) {
+        if (defer) {
             // if not datacopy, no need to save od_dta_tail
             void *data = NULL;
             int datalen = 0;
@@ -1368,6 +1391,8 @@ int process_defered_table(struct ireq *iq, void *trans, int *blkpos, int *ixout,
         int od_tail_len = bdb_temp_table_datasize(cur);
 
         iq->usedb = ditk->usedb;
+        if (!osql_is_index_reorder_on(iq->osql_flags))
+            ATOMIC_ADD64(iq->usedb->deferred_ix_write_count, 1);
 
         if (ditk->type == DIT_ADD) {
             int addrrn = 2;
@@ -31,7 +31,9 @@ int add_record_indices(struct ireq *iq, void *trans, blob_buffer_t *blobs,
                        int *rrn, unsigned long long *genid,
                        unsigned long long vgenid, unsigned long long ins_keys,
                        int opcode, int blkpos, void *od_dta, size_t od_len,
-                       int flags, int reorder);
+                       int flags, int reorder, int defer_dups);
+
+int defer_dup_index_writes(struct ireq *iq);
 
 int upd_record_indices(struct ireq *iq, void *trans, int *opfailcode,
                        int *ixfailnum, int rrn, unsigned long long *newgenid,
@@ -227,6 +227,17 @@ static dbtable *newdb_from_schema(struct dbenv *env, char *tblname, int dbnum)
             cleanup_newdb(tbl);
             return NULL;
         }
+
+        tbl->ix_defer[ii] = dyns_is_idx_deferwrites(ii);
+        if (tbl->ix_defer[ii] < 0) {
+            logmsg(LOGMSG_ERROR,
+                   "cant find index %d deferwrites in csc schema %s\n", ii,
+                   tblname);
+            cleanup_newdb(tbl);
+            return NULL;
+        } else if (tbl->ix_defer[ii]) {
+            tbl->has_defer_ix = 1;
+        }
     }
 
     init_reverse_constraints(tbl);
@@ -387,6 +398,9 @@ static struct schema *_create_index_schema(const char *tag, int ix,
     if (dyns_is_idx_uniqnulls(ix))
         s->flags |= SCHEMA_UNIQNULLS;
 
+    if (dyns_is_idx_deferwrites(ix))
+        s->flags |= SCHEMA_DEFERWRITES;
+
     s->ixnum = ix;
 
     return s;
@@ -55,6 +55,7 @@
 #include "sc_logic.h"
 #include "gettimeofday_ms.h"
 #include "eventlog.h"
+#include "histogram.h"
 #include <disttxn.h>
 
 extern int gbl_reorder_idx_writes;
@@ -342,6 +343,7 @@ int osql_bplog_commit(struct ireq *iq, void *iq_trans, int *nops,
 {
     blocksql_tran_t *tran = iq->sorese->tran;
     ckgenid_state_t cgstate = {.iq = iq, .trans = iq_trans, .err = err};
+    int64_t startus = comdb2_time_epochus();
     int rc;
 
     /* Pre-process selectv's, getting a writelock on rows that are later updated
@@ -355,6 +357,8 @@ int osql_bplog_commit(struct ireq *iq, void *iq_trans, int *nops,
     rc = apply_changes(iq, tran, iq_trans, nops, err, osql_process_packet);
 
     iq->timings.req_applied = osql_log_time();
+    if (rc == 0)
+        comdb2_histogram_add(gbl_bplog_apply_hist, comdb2_time_epochus() - startus);
 
     return rc;
 }
@@ -1007,6 +1011,8 @@ static int process_this_session(
      * improves so this requires a solid test). */
     if (sess->tran_rows > 1 && gbl_reorder_idx_writes)
         iq->osql_flags |= OSQL_FLAGS_REORDER_IDX_ON;
+    else if (sess->tran_rows > 1) /* for deferwrites indexes */
+        iq->osql_flags |= OSQL_FLAGS_DEFER_DUP_IDX_ON;
 
     while (!rc && !rc_out) {
         char *data = NULL;
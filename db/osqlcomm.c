@@ -6228,7 +6228,9 @@ static int start_schema_change_tran_wrapper(const char *tblname,
     }
 
     if (((sc->partition.type == PARTITION_ADD_TIMED ||
-          sc->partition.type == PARTITION_ADD_MANUAL) && (arg->pos & FIRST_SHARD)) ||
+          sc->partition.type == PARTITION_ADD_MANUAL ||
+          sc->partition.type == PARTITION_ADD_COL_HASH) &&
+         (arg->pos & FIRST_SHARD)) ||
         (sc->partition.type == PARTITION_REMOVE && (arg->pos & LAST_SHARD))) {
         sc->publish = partition_publish;
         sc->unpublish = partition_unpublish;
@@ -6510,14 +6512,28 @@ static int _process_single_table_sc_partitioning(struct ireq *iq)
     }
 
     assert(sc->partition.type == PARTITION_ADD_TIMED || 
-           sc->partition.type == PARTITION_ADD_MANUAL);
+           sc->partition.type == PARTITION_ADD_MANUAL ||
+           sc->partition.type == PARTITION_ADD_COL_HASH);
 
-    /* create a new time partition object */
+    int nshards = sc->partition.u.tpt.retention;
     struct errstat err = {0};
-    sc->newpartition = timepart_new_partition(
+    if (sc->partition.type == PARTITION_ADD_COL_HASH) {
+        /* rows of an existing table would all sit in the first shard */
+        if (sc->kind != SC_ADDTABLE) {
+            sc_errf(sc, "Hash partitioning requires a new table");
+            return ERR_SC;
+        }
+        nshards = sc->partition.u.hash.nshards;
+        sc->newpartition = timepart_new_hash_partition(
+            sc->tablename, nshards, sc->partition.u.hash.column,
+            &sc->timepartition_name, &err);
+    } else {
+        /* create a new time partition object */
+        sc->newpartition = timepart_new_partition(
             sc->tablename, sc->partition.u.tpt.period,
             sc->partition.u.tpt.retention, sc->partition.u.tpt.start, NULL,
             TIMEPART_ROLLOUT_TRUNCATE, &sc->timepartition_name, &err);
+    }
     /* DHTEST 1 {
        sc->newpartition = NULL; err.errval = VIEW_ERR_PARAM;
        snprintf(err.errstr, sizeof(err.errstr), "Test fail"); } DHTEST */
@@ -6586,7 +6602,7 @@ static int _process_single_table_sc_partitioning(struct ireq *iq)
         arg.pos = 0; /* reset this so we do not set publish on additional shards */
     }
     /* should we serialize ? */
-    arg.s->nothrevent = sc->partition.u.tpt.retention > gbl_dohsql_sc_max_threads;
+    arg.s->nothrevent = nshards > gbl_dohsql_sc_max_threads;
     rc = timepart_foreach_shard_lockless(
             sc->newpartition, start_schema_change_tran_wrapper, &arg);
 
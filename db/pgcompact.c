@@ -0,0 +1,317 @@
+/*
+   Copyright 2024 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <poll.h>
+
+#include <comdb2.h>
+#include <bdb_api.h>
+#include <list.h>
+#include <logmsg.h>
+#include <schema_lk.h>
+#include "sc_util.h"
+#include "pgcompact.h"
+
+int gbl_page_compact_service = 0;
+int gbl_page_compact_service_batch_pages = 256;
+int gbl_page_compact_service_pause_ms = 100;
+int gbl_page_compact_service_pass_sec = 600;
+double gbl_page_compact_service_thresh_ff = 0.35;
+
+struct pgcompact_file {
+    char *tablename;
+    int ixnum; /* -1 for a data stripe */
+    int stripe;
+    unsigned int next_pgno;
+    int lastpass; /* last pass that got to this file */
+
+    int64_t pages;
+    int64_t passes;
+    int64_t pages_scanned;
+    int64_t sparse_pages;
+    int64_t pages_freed;
+    int64_t bytes_reclaimed;
+    LINKC_T(struct pgcompact_file) lnk;
+};
+
+static pthread_mutex_t pgcompact_lk = PTHREAD_MUTEX_INITIALIZER;
+static LISTC_T(struct pgcompact_file) files;
+static int npasses;
+
+static int pgcompact_enabled(void)
+{
+    return gbl_page_compact_service && !db_is_exiting() &&
+           thedb->master == gbl_myhostname;
+}
+
+static void pgcompact_sleep(int ms)
+{
+    while (ms > 0 && !db_is_exiting()) {
+        int n = ms < 1000 ? ms : 1000;
+        poll(NULL, 0, n);
+        ms -= n;
+    }
+}
+
+/* Called with pgcompact_lk held */
+static struct pgcompact_file *find_file(const char *tablename, int ixnum,
+                                        int stripe)
+{
+    struct pgcompact_file *f;
+
+    LISTC_FOR_EACH(&files, f, lnk)
+    {
+        if (f->ixnum == ixnum && f->stripe == stripe &&
+            strcasecmp(f->tablename, tablename) == 0)
+            return f;
+    }
+    return NULL;
+}
+
+/* Called with pgcompact_lk held */
+static struct pgcompact_file *get_file(const char *tablename, int ixnum,
+                                       int stripe)
+{
+    struct pgcompact_file *f;
+
+    if ((f = find_file(tablename, ixnum, stripe)) != NULL)
+        return f;
+    f = calloc(1, sizeof(struct pgcompact_file));
+    if (f == NULL)
+        return NULL;
+    f->tablename = strdup(tablename);
+    if (f->tablename == NULL) {
+        free(f);
+        return NULL;
+    }
+    f->ixnum = ixnum;
+    f->stripe = stripe;
+    listc_abl(&files, f);
+    return f;
+}
+
+static void free_file(struct pgcompact_file *f)
+{
+    free(f->tablename);
+    free(f);
+}
+
+/* Compact one data stripe or index from where the last pass left it to its
+ * end, a batch at a time.  Returns 0 when done with the file, 1 if the file
+ * does not exist, and -1 if the pass should stop. */
+static int compact_file(const char *tablename, int ixnum, int stripe,
+                        int pass)
+{
+    struct pgcompact_file *f;
+    struct dbtable *tbl;
+    bdb_pgcompact_batch b;
+    unsigned int pgno;
+    int rc, bdberr;
+
+    Pthread_mutex_lock(&pgcompact_lk);
+    f = find_file(tablename, ixnum, stripe);
+    pgno = f ? f->next_pgno : 0;
+    Pthread_mutex_unlock(&pgcompact_lk);
+
+    do {
+        if (!pgcompact_enabled() ||
+            get_schema_change_in_progress(__func__, __LINE__))
+            return -1;
+
+        rdlock_schema_lk();
+        tbl = get_dbtable_by_name(tablename);
+        if (tbl == NULL ||
+            (ixnum >= 0 ? ixnum >= tbl->nix : stripe >= gbl_dtastripe)) {
+            unlock_schema_lk();
+            return 1;
+        }
+        rc = bdb_pgcompact_scan(tbl->handle, 0, stripe, ixnum, &pgno,
+                                gbl_page_compact_service_batch_pages,
+                                gbl_page_compact_service_thresh_ff, &b,
+                                &bdberr);
+        unlock_schema_lk();
+
+        if (rc != 0) {
+            /* not a btree that may be compacted */
+            if (bdberr == BDBERR_BADARGS)
+                return 0;
+            if (bdberr != BDBERR_READONLY)
+                logmsg(LOGMSG_ERROR, "%s: %s %s %d: rc %d bdberr %d\n",
+                       __func__, tablename, ixnum < 0 ? "data" : "index",
+                       ixnum < 0 ? stripe : ixnum, rc, bdberr);
+            return -1;
+        }
+
+        Pthread_mutex_lock(&pgcompact_lk);
+        if ((f = get_file(tablename, ixnum, stripe)) == NULL) {
+            Pthread_mutex_unlock(&pgcompact_lk);
+            return -1;
+        }
+        f->lastpass = pass;
+        f->next_pgno = pgno;
+        f->pages = (int64_t)b.last_pgno + 1;
+        f->pages_scanned += b.nscanned;
+        f->sparse_pages += b.nsparse;
+        f->pages_freed += b.nfreed;
+        f->bytes_reclaimed += (int64_t)b.nfreed * b.pgsize;
+        if (pgno == 0)
+            f->passes++;
+        Pthread_mutex_unlock(&pgcompact_lk);
+
+        if (pgno != 0)
+            pgcompact_sleep(gbl_page_compact_service_pause_ms);
+    } while (pgno != 0);
+
+    return 0;
+}
+
+static int compact_table(const char *tablename, int pass)
+{
+    int rc;
+
+    for (int stripe = 0;; stripe++) {
+        if ((rc = compact_file(tablename, -1, stripe, pass)) != 0)
+            break;
+    }
+    if (rc < 0)
+        return rc;
+    for (int ixnum = 0;; ixnum++) {
+        if ((rc = compact_file(tablename, ixnum, 0, pass)) != 0)
+            break;
+    }
+    return rc < 0 ? rc : 0;
+}
+
+static void pgcompact_pass(void)
+{
+    struct pgcompact_file *f, *tmp;
+    char **tables;
+    int ntables, pass, rc = 0;
+
+    rdlock_schema_lk();
+    ntables = thedb->num_dbs;
+    tables = calloc(ntables, sizeof(char *));
+    for (int i = 0; tables && i < ntables; i++)
+        tables[i] = strdup(thedb->dbs[i]->tablename);
+    unlock_schema_lk();
+    if (tables == NULL)
+        return;
+
+    Pthread_mutex_lock(&pgcompact_lk);
+    pass = ++npasses;
+    Pthread_mutex_unlock(&pgcompact_lk);
+
+    for (int i = 0; i < ntables && rc == 0; i++) {
+        if (tables[i])
+            rc = compact_table(tables[i], pass);
+    }
+
+    /* Forget the files of tables that were dropped */
+    if (rc == 0) {
+        Pthread_mutex_lock(&pgcompact_lk);
+        LISTC_FOR_EACH_SAFE(&files, f, tmp, lnk)
+        {
+            if (f->lastpass != pass) {
+                listc_rfl(&files, f);
+                free_file(f);
+            }
+        }
+        Pthread_mutex_unlock(&pgcompact_lk);
+    }
+
+    for (int i = 0; i < ntables; i++)
+        free(tables[i]);
+    free(tables);
+}
+
+static void *pgcompact_thread(void *arg)
+{
+    comdb2_name_thread(__func__);
+    thrman_register(THRTYPE_GENERIC);
+    thread_started("pgcompact");
+    backend_thread_event(thedb, COMDB2_THR_EVENT_START_RDWR);
+
+    while (!db_is_exiting()) {
+        if (!pgcompact_enabled()) {
+            pgcompact_sleep(1000);
+            continue;
+        }
+        pgcompact_pass();
+        pgcompact_sleep(gbl_page_compact_service_pass_sec * 1000);
+    }
+
+    backend_thread_event(thedb, COMDB2_THR_EVENT_DONE_RDWR);
+    return NULL;
+}
+
+void create_pgcompact_thread(void)
+{
+    pthread_t tid;
+
+    listc_init(&files, offsetof(struct pgcompact_file, lnk));
+    Pthread_create(&tid, &gbl_pthread_attr_detached, pgcompact_thread, NULL);
+}
+
+int pgcompact_get_stats(pgcompact_stats **stats, int *nstats)
+{
+    struct pgcompact_file *f;
+    pgcompact_stats *s;
+    int n = 0;
+
+    *stats = NULL;
+    *nstats = 0;
+
+    Pthread_mutex_lock(&pgcompact_lk);
+    if (files.count == 0) {
+        Pthread_mutex_unlock(&pgcompact_lk);
+        return 0;
+    }
+    s = calloc(files.count, sizeof(pgcompact_stats));
+    if (s == NULL) {
+        Pthread_mutex_unlock(&pgcompact_lk);
+        return -1;
+    }
+    LISTC_FOR_EACH(&files, f, lnk)
+    {
+        s[n].tablename = strdup(f->tablename);
+        s[n].filetype = strdup(f->ixnum < 0 ? "data" : "index");
+        s[n].filenum = f->ixnum < 0 ? f->stripe : f->ixnum;
+        s[n].pages = f->pages;
+        s[n].next_page = f->next_pgno;
+        s[n].passes = f->passes;
+        s[n].pages_scanned = f->pages_scanned;
+        s[n].sparse_pages = f->sparse_pages;
+        s[n].pages_freed = f->pages_freed;
+        s[n].bytes_reclaimed = f->bytes_reclaimed;
+        n++;
+    }
+    Pthread_mutex_unlock(&pgcompact_lk);
+
+    *stats = s;
+    *nstats = n;
+    return 0;
+}
+
+void pgcompact_stats_free(pgcompact_stats *stats, int nstats)
+{
+    for (int i = 0; i < nstats; i++) {
+        free(stats[i].tablename);
+        free(stats[i].filetype);
+    }
+    free(stats);
+}
@@ -0,0 +1,55 @@
+/*
+   Copyright 2024 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef INCLUDED_PGCOMPACT_H
+#define INCLUDED_PGCOMPACT_H
+
+#include <stdint.h>
+
+/*
+ * Background page compaction service.  On the master, a thread walks the
+ * data files and indexes of every table a batch of pages at a time, and
+ * merges the leaf pages that are less than page_compact_service_thresh_ff
+ * full into their neighbours.  Every merge is a small transaction of its
+ * own.  The merged-away pages go to the free list of their file and are
+ * reused before the file grows again.
+ */
+
+typedef struct pgcompact_stats {
+    char *tablename;
+    char *filetype; /* "data" or "index" */
+    int64_t filenum; /* stripe or index number */
+    int64_t pages;
+    int64_t next_page;
+    int64_t passes;
+    int64_t pages_scanned;
+    int64_t sparse_pages;
+    int64_t pages_freed;
+    int64_t bytes_reclaimed;
+} pgcompact_stats;
+
+extern int gbl_page_compact_service;
+extern int gbl_page_compact_service_batch_pages;
+extern int gbl_page_compact_service_pause_ms;
+extern int gbl_page_compact_service_pass_sec;
+extern double gbl_page_compact_service_thresh_ff;
+
+void create_pgcompact_thread(void);
+
+int pgcompact_get_stats(pgcompact_stats **stats, int *nstats);
+void pgcompact_stats_free(pgcompact_stats *stats, int nstats);
+
+#endif
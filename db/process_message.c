@@ -211,6 +211,7 @@ static const char *HELP_STAT[] = {
     "stat dumpsql               - running sql statements",
     "stat size                  - database ondisk size info",
     "stat ixstat                - index usage stats",
+    "stat count                 - direct count btree walks by page and by row",
     "stat cursors               - cursor mode stats",
     "stat sc                    - view status of current schema change",
     "stat switch                - show switch statuses",
@@ -1919,6 +1920,13 @@ clipper_usage:
             logmsg(LOGMSG_USER, "semver: %s\n", gbl_db_semver);
         } else if (tokcmp(tok, ltok, "ixstat") == 0) {
             ixstats(dbenv);
+        } else if (tokcmp(tok, ltok, "count") == 0) {
+            bdb_direct_count_stats();
+        } else if (tokcmp(tok, ltok, "ixbloom") == 0) {
+            rdlock_schema_lk();
+            for (int dbn = 0; dbn < dbenv->num_dbs; dbn++)
+                bdb_ix_bloom_stats(dbenv->dbs[dbn]->handle);
+            unlock_schema_lk();
         } else if (tokcmp(tok, ltok, "cursors") == 0) {
             curstats(dbenv);
         } else if (tokcmp(tok, ltok, "sc") == 0) {
@@ -4882,12 +4890,54 @@ clipper_usage:
         }
         printlog(thedb->bdb_env, startfile, startoff, endfile, endoff);
 #ifdef _LINUX_SOURCE
-    } else if (tokcmp(tok, ltok, "rcache") == 0) {
-        gbl_rcache = 1;
-       logmsg(LOGMSG_USER, "enabled rcache\n");
-    } else if (tokcmp(tok, ltok, "norcache") == 0) {
-        gbl_rcache = 0;
-       logmsg(LOGMSG_USER, "disabled rcache\n");
+    } else if (tokcmp(tok, ltok, "rcache") == 0 ||
+               tokcmp(tok, ltok, "norcache") == 0) {
+        int enable = tokcmp(tok, ltok, "rcache") == 0;
+        char table[MAXTABLELEN];
+        struct dbtable *db;
+        int ixnum;
+
+        tok = segtok(line, lline, &st, &ltok);
+        if (ltok == 0) {
+            gbl_rcache = enable;
+            logmsg(LOGMSG_USER, "%s rcache\n", enable ? "enabled" : "disabled");
+            return 0;
+        }
+        /* rcache|norcache <table> <ixnum|dta>: switch a single btree */
+        if (ltok >= MAXTABLELEN) {
+            logmsg(LOGMSG_ERROR, "Invalid table name: too long (max %d)\n",
+                   MAXTABLELEN - 1);
+            return -1;
+        }
+        tokcpy(tok, ltok, table);
+        if ((db = get_dbtable_by_name(table)) == NULL) {
+            logmsg(LOGMSG_ERROR, "Unknown table %s\n", table);
+            return -1;
+        }
+        tok = segtok(line, lline, &st, &ltok);
+        if (ltok == 0) {
+            logmsg(LOGMSG_ERROR, "Expected index number or 'dta'\n");
+            return -1;
+        }
+        if (tokcmp(tok, ltok, "dta") == 0) {
+            ixnum = -1;
+        } else {
+            int i;
+            for (i = 0; i < ltok && isdigit((unsigned char)tok[i]); i++)
+                ;
+            if (i != ltok || ltok > 9) {
+                logmsg(LOGMSG_ERROR, "Expected index number or 'dta'\n");
+                return -1;
+            }
+            ixnum = toknum(tok, ltok);
+        }
+        if (bdb_handle_dbp_set_rcache(db->handle, ixnum, enable) != 0) {
+            logmsg(LOGMSG_ERROR, "Invalid index number for table %s\n", table);
+            return -1;
+        }
+        logmsg(LOGMSG_USER, "%s rcache for %s %s%d\n",
+               enable ? "enabled" : "disabled", table, ixnum < 0 ? "dta" : "ix",
+               ixnum < 0 ? 0 : ixnum);
 #endif
     } else if (tokcmp(tok, ltok, "swing") == 0) {
         ATOMIC_ADD32(gbl_master_changes, 1);
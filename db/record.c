@@ -550,12 +550,15 @@ int add_record(struct ireq *iq, void *trans, const uint8_t *p_buf_tag_name,
     }
 
     if (iq->usedb->nix > 0 || (iq->usedb->sc_to && iq->usedb->sc_to->nix > 0)) {
-        int reorder =
-            osql_is_index_reorder_on(iq->osql_flags) && !is_event_from_sc(flags) &&
+        int reorder_ok =
+            !is_event_from_sc(flags) &&
             rec_flags == 0 && iq->usedb->sc_from != iq->usedb &&
             strcasecmp(iq->usedb->tablename, "comdb2_oplog") != 0 &&
             strcasecmp(iq->usedb->tablename, "comdb2_commit_log") != 0 &&
             strncasecmp(iq->usedb->tablename, "sqlite_stat", 11) != 0;
+        int reorder = reorder_ok && osql_is_index_reorder_on(iq->osql_flags);
+        /* otherwise maybe only the keys of the non-unique indexes */
+        int defer_dups = reorder_ok && !reorder && defer_dup_index_writes(iq);
 
         if (reorder)
             rec_flags |= OSQL_ITEM_REORDERED;
@@ -591,7 +594,7 @@ int add_record(struct ireq *iq, void *trans, const uint8_t *p_buf_tag_name,
         if (!has_constraint(flags) || (flags & RECFLAGS_INLINE_CONSTRAINTS) || (rec_flags & OSQL_IGNORE_FAILURE) ||
             reorder) {
             retrc = add_record_indices(iq, trans, blobs, maxblobs, opfailcode, ixfailnum, rrn, genid, vgenid, ins_keys,
-                                       opcode, blkpos, od_dta, od_len, flags, reorder);
+                                       opcode, blkpos, od_dta, od_len, flags, reorder, defer_dups);
             if (retrc)
                 ERR("add_record_indices rc %d", rc);
         }
@@ -276,6 +276,7 @@ typedef struct {
     int sampling_pct;
     unsigned long long n_recs;
     unsigned long long n_sampled_recs;
+    int skipped; /* unchanged since last analyze, keep its stats */
 } sampled_idx_t;
 
 typedef struct sqlclntstate_fdb {
@@ -836,6 +837,13 @@ struct sqlclntstate {
     uint64_t enque_timeus;
     uint64_t deque_timeus;
 
+    /* sql_fairshare.c: class charged for the request while it waits or runs */
+    struct fairshare_class *fs_class;
+    int fs_waiting;
+    int64_t fs_cpustart_us;
+    int64_t fs_cost;
+    LINKC_T(struct sqlclntstate) fs_lnk;
+
     /* due to some sqlite vagaries, cursor is closed
        and I lose the side row; cache it here! */
     unsigned long long keyDdl;
@@ -1188,6 +1196,8 @@ struct BtCursor {
     void *query_preparer_data;
 
     int permissions; /* permissions for read/write access to table */
+
+    struct scan_batch *scan_batch; /* rows read ahead by a forward scan */
 };
 
 struct sql_hist {
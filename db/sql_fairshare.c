@@ -0,0 +1,460 @@
+/*
+   Copyright 2024 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stddef.h>
+#include <limits.h>
+#include <pthread.h>
+#include <time.h>
+
+#include <comdb2.h>
+#include <sql.h>
+#include <thdpool.h>
+#include <plhash.h>
+#include <list.h>
+#include <logmsg.h>
+#include <segstr.h>
+#include <str0.h>
+#include <epochlib.h>
+#include <tohex.h>
+#include "sql_fairshare.h"
+
+int gbl_sql_fairshare = 0;
+int gbl_sql_fairshare_key = SQL_FAIRSHARE_KEY_USER;
+int gbl_sql_fairshare_default_share = 1;
+int gbl_sql_fairshare_default_max_concurrent = 0;
+int gbl_sql_fairshare_max_waiting = 1000;
+int gbl_sql_fairshare_cost_us = 10;
+
+/* Requests from classes beyond this many are all charged to one class */
+#define FAIRSHARE_MAX_CLASSES 4096
+#define FAIRSHARE_OVERFLOW_CLASS "(other)"
+#define FAIRSHARE_UNKNOWN_CLASS "(none)"
+
+struct fairshare_class {
+    char *name;
+    int configured; /* share and max_concurrent were set explicitly */
+    int share;
+    int max_concurrent;
+
+    int running;
+    int nwaiting;
+    LISTC_T(struct sqlclntstate) waiters;
+    LINKC_T(struct fairshare_class) active_lnk;
+    int on_active;
+
+    /* cpu time and i/o cost charged so far, divided by the share */
+    double vtime;
+
+    int64_t dispatched;
+    int64_t queued;
+    int64_t queue_time_us;
+    int64_t max_queue_time_us;
+    int64_t cpu_us;
+    int64_t cost;
+};
+
+static pthread_mutex_t fairshare_lk = PTHREAD_MUTEX_INITIALIZER;
+static hash_t *fairshare_classes;
+static int nclasses;
+/* classes with waiting requests */
+static LISTC_T(struct fairshare_class) active;
+static int nrunning;
+static int nwaiting;
+/* vtime of the last class let in; idle classes catch up to it so they can't
+ * bank credit while they have nothing to run */
+static double vclock;
+
+static const char *key_names[] = {"user", "host", "task", "fingerprint"};
+
+const char *sql_fairshare_key_str(int key)
+{
+    if (key < 0 || key >= sizeof(key_names) / sizeof(key_names[0]))
+        return "?";
+    return key_names[key];
+}
+
+int sql_fairshare_key_from_str(const char *str)
+{
+    for (int i = 0; i < sizeof(key_names) / sizeof(key_names[0]); i++) {
+        if (strcasecmp(str, key_names[i]) == 0)
+            return i;
+    }
+    return -1;
+}
+
+static int64_t thread_cpu_us(void)
+{
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts))
+        return 0;
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int class_share(const struct fairshare_class *c)
+{
+    int share = c->configured ? c->share : gbl_sql_fairshare_default_share;
+    return share > 0 ? share : 1;
+}
+
+static int class_max_concurrent(const struct fairshare_class *c)
+{
+    return c->configured ? c->max_concurrent
+                         : gbl_sql_fairshare_default_max_concurrent;
+}
+
+static int class_can_run(const struct fairshare_class *c)
+{
+    int max = class_max_concurrent(c);
+    return max <= 0 || c->running < max;
+}
+
+static void fairshare_init_lk(void)
+{
+    if (fairshare_classes)
+        return;
+    fairshare_classes =
+        hash_init_strptr(offsetof(struct fairshare_class, name));
+    listc_init(&active, offsetof(struct fairshare_class, active_lnk));
+}
+
+static struct fairshare_class *get_class_lk(const char *name, int create)
+{
+    struct fairshare_class *c;
+
+    fairshare_init_lk();
+    c = hash_find(fairshare_classes, &name);
+    if (c || !create)
+        return c;
+
+    if (nclasses >= FAIRSHARE_MAX_CLASSES &&
+        strcmp(name, FAIRSHARE_OVERFLOW_CLASS) != 0)
+        return get_class_lk(FAIRSHARE_OVERFLOW_CLASS, 1);
+
+    c = calloc(1, sizeof(struct fairshare_class));
+    if (c == NULL)
+        return NULL;
+    c->name = strdup(name);
+    if (c->name == NULL) {
+        free(c);
+        return NULL;
+    }
+    listc_init(&c->waiters, offsetof(struct sqlclntstate, fs_lnk));
+    c->vtime = vclock;
+    hash_add(fairshare_classes, c);
+    nclasses++;
+    return c;
+}
+
+static void class_key(struct sqlclntstate *clnt, char *buf, size_t len)
+{
+    const char *key = NULL;
+
+    switch (gbl_sql_fairshare_key) {
+    case SQL_FAIRSHARE_KEY_USER:
+        if (clnt->current_user.have_name)
+            key = clnt->current_user.name;
+        break;
+    case SQL_FAIRSHARE_KEY_HOST:
+        key = clnt->origin_host;
+        break;
+    case SQL_FAIRSHARE_KEY_TASK:
+        key = clnt->conninfo.pename;
+        break;
+    case SQL_FAIRSHARE_KEY_FINGERPRINT: {
+        unsigned char zero[FINGERPRINTSZ] = {0};
+        if (len > FINGERPRINTSZ * 2 &&
+            memcmp(clnt->work.aFingerprint, zero, FINGERPRINTSZ) != 0) {
+            util_tohex(buf, (char *)clnt->work.aFingerprint, FINGERPRINTSZ);
+            return;
+        }
+        break;
+    }
+    }
+    if (key == NULL || key[0] == '\0')
+        key = FAIRSHARE_UNKNOWN_CLASS;
+    strncpy0(buf, key, len);
+}
+
+static void run_lk(struct fairshare_class *c, struct sqlclntstate *clnt)
+{
+    c->running++;
+    nrunning++;
+    c->dispatched++;
+    if (c->vtime > vclock)
+        vclock = c->vtime;
+    clnt->fs_class = c;
+    clnt->fs_waiting = 0;
+    clnt->fs_cpustart_us = 0;
+}
+
+/* Take the first request of the waiting class which is furthest behind its
+ * share and under its concurrency cap */
+static struct sqlclntstate *pick_lk(void)
+{
+    struct fairshare_class *c, *best = NULL;
+    struct sqlclntstate *clnt;
+
+    LISTC_FOR_EACH(&active, c, active_lnk)
+    {
+        if (class_can_run(c) && (best == NULL || c->vtime < best->vtime))
+            best = c;
+    }
+    if (best == NULL)
+        return NULL;
+
+    clnt = listc_rtl(&best->waiters);
+    best->nwaiting--;
+    nwaiting--;
+    if (best->nwaiting == 0) {
+        listc_rfl(&active, best);
+        best->on_active = 0;
+    }
+
+    int64_t waited = comdb2_time_epochus() - clnt->enque_timeus;
+    if (waited < 0)
+        waited = 0;
+    best->queue_time_us += waited;
+    if (waited > best->max_queue_time_us)
+        best->max_queue_time_us = waited;
+
+    run_lk(best, clnt);
+    return clnt;
+}
+
+static int pool_limit(void)
+{
+    int limit = thdpool_get_maxthds(get_sql_pool(NULL));
+    return limit > 0 ? limit : INT_MAX;
+}
+
+int sql_fairshare_admit(struct sqlclntstate *clnt, struct thdpool *pool)
+{
+    char key[MAX_USERNAME_LEN + FINGERPRINTSZ * 2 + 64];
+    struct fairshare_class *c;
+    int limit;
+
+    clnt->fs_class = NULL;
+    clnt->fs_waiting = 0;
+
+    /* named pools are already set apart by the ruleset */
+    if (!gbl_sql_fairshare || clnt->admin || clnt->pPool)
+        return 0;
+
+    class_key(clnt, key, sizeof(key));
+    limit = thdpool_get_maxthds(pool);
+    if (limit <= 0)
+        limit = INT_MAX;
+
+    Pthread_mutex_lock(&fairshare_lk);
+    c = get_class_lk(key, 1);
+    if (c == NULL) {
+        Pthread_mutex_unlock(&fairshare_lk);
+        return 0;
+    }
+    if (c->running == 0 && c->nwaiting == 0 && c->vtime < vclock)
+        c->vtime = vclock;
+
+    /* Statements of an open transaction never wait behind other classes:
+     * they may be holding locks that other classes are waiting for. */
+    if (in_client_trans(clnt) || nwaiting >= gbl_sql_fairshare_max_waiting ||
+        (c->nwaiting == 0 && class_can_run(c) && nrunning < limit)) {
+        run_lk(c, clnt);
+        Pthread_mutex_unlock(&fairshare_lk);
+        return 0;
+    }
+
+    listc_abl(&c->waiters, clnt);
+    c->nwaiting++;
+    c->queued++;
+    nwaiting++;
+    if (!c->on_active) {
+        listc_abl(&active, c);
+        c->on_active = 1;
+    }
+    clnt->fs_class = c;
+    clnt->fs_waiting = 1;
+    Pthread_mutex_unlock(&fairshare_lk);
+    return 1;
+}
+
+void sql_fairshare_start(struct sqlclntstate *clnt)
+{
+    if (clnt->fs_class == NULL)
+        return;
+    clnt->fs_cpustart_us = thread_cpu_us();
+    clnt->fs_cost = 0;
+}
+
+void sql_fairshare_done(struct sqlclntstate *clnt)
+{
+    LISTC_T(struct sqlclntstate) ready;
+    struct fairshare_class *c;
+    struct sqlclntstate *next;
+    int limit;
+
+    if (clnt->fs_class == NULL)
+        return;
+
+    int64_t cpu = 0;
+    if (clnt->fs_cpustart_us) {
+        cpu = thread_cpu_us() - clnt->fs_cpustart_us;
+        if (cpu < 0)
+            cpu = 0;
+    }
+    limit = pool_limit();
+    listc_init(&ready, offsetof(struct sqlclntstate, fs_lnk));
+
+    Pthread_mutex_lock(&fairshare_lk);
+    c = clnt->fs_class;
+    if (c == NULL) {
+        Pthread_mutex_unlock(&fairshare_lk);
+        return;
+    }
+    clnt->fs_class = NULL;
+    if (clnt->fs_waiting) {
+        /* never got to run */
+        listc_rfl(&c->waiters, clnt);
+        c->nwaiting--;
+        nwaiting--;
+        if (c->nwaiting == 0 && c->on_active) {
+            listc_rfl(&active, c);
+            c->on_active = 0;
+        }
+        clnt->fs_waiting = 0;
+    } else {
+        int64_t cost = clnt->fs_cpustart_us ? clnt->fs_cost : 0;
+        c->running--;
+        nrunning--;
+        c->cpu_us += cpu;
+        c->cost += cost;
+        c->vtime += (double)(cpu + cost * gbl_sql_fairshare_cost_us) /
+                    class_share(c);
+    }
+    clnt->fs_cpustart_us = 0;
+
+    while (nrunning < limit && (next = pick_lk()) != NULL)
+        listc_abl(&ready, next);
+    Pthread_mutex_unlock(&fairshare_lk);
+
+    while ((next = listc_rtl(&ready)) != NULL)
+        dispatch_fairshare_sql_query(next);
+}
+
+int sql_fairshare_set_class(const char *line)
+{
+    char name[MAX_USERNAME_LEN + FINGERPRINTSZ * 2 + 64];
+    char *tok;
+    int st = 0, ltok, len = strlen(line);
+    int share, max_concurrent = 0;
+
+    tok = segtok((char *)line, len, &st, &ltok);
+    if (ltok <= 0 || ltok >= sizeof(name)) {
+        logmsg(LOGMSG_ERROR, "%s: expected <class> <share> [<max concurrent>]\n",
+               __func__);
+        return 1;
+    }
+    tokcpy(tok, ltok, name);
+
+    tok = segtok((char *)line, len, &st, &ltok);
+    if (ltok <= 0) {
+        logmsg(LOGMSG_ERROR, "%s: missing share for class %s\n", __func__, name);
+        return 1;
+    }
+    share = toknum(tok, ltok);
+    tok = segtok((char *)line, len, &st, &ltok);
+    if (ltok > 0)
+        max_concurrent = toknum(tok, ltok);
+    if (share < 0 || max_concurrent < 0) {
+        logmsg(LOGMSG_ERROR, "%s: bad share or max concurrent for class %s\n",
+               __func__, name);
+        return 1;
+    }
+
+    Pthread_mutex_lock(&fairshare_lk);
+    struct fairshare_class *c = get_class_lk(name, 1);
+    if (c) {
+        /* a share of 0 goes back to the defaults */
+        c->configured = share > 0;
+        c->share = share;
+        c->max_concurrent = max_concurrent;
+    }
+    Pthread_mutex_unlock(&fairshare_lk);
+
+    if (c == NULL)
+        return 1;
+    logmsg(LOGMSG_USER, "SQL fair-share class %s: share %d, max concurrent %d\n",
+           name, share, max_concurrent);
+    return 0;
+}
+
+struct stats_arg {
+    sql_fairshare_stats *stats;
+    int nstats;
+};
+
+static int collect_class(void *obj, void *arg)
+{
+    struct fairshare_class *c = obj;
+    struct stats_arg *a = arg;
+    sql_fairshare_stats *s = &a->stats[a->nstats++];
+
+    s->name = strdup(c->name);
+    s->share = class_share(c);
+    s->max_concurrent = class_max_concurrent(c);
+    s->running = c->running;
+    s->waiting = c->nwaiting;
+    s->dispatched = c->dispatched;
+    s->queued = c->queued;
+    s->queue_time_us = c->queue_time_us;
+    s->max_queue_time_us = c->max_queue_time_us;
+    s->cpu_us = c->cpu_us;
+    s->cost = c->cost;
+    s->vtime = c->vtime;
+    return 0;
+}
+
+int sql_fairshare_get_stats(sql_fairshare_stats **stats, int *nstats)
+{
+    struct stats_arg a = {0};
+
+    *stats = NULL;
+    *nstats = 0;
+
+    Pthread_mutex_lock(&fairshare_lk);
+    if (nclasses > 0) {
+        a.stats = calloc(nclasses, sizeof(sql_fairshare_stats));
+        if (a.stats == NULL) {
+            Pthread_mutex_unlock(&fairshare_lk);
+            return -1;
+        }
+        hash_for(fairshare_classes, collect_class, &a);
+    }
+    Pthread_mutex_unlock(&fairshare_lk);
+
+    *stats = a.stats;
+    *nstats = a.nstats;
+    return 0;
+}
+
+void sql_fairshare_stats_free(sql_fairshare_stats *stats, int nstats)
+{
+    for (int i = 0; i < nstats; i++)
+        free(stats[i].name);
+    free(stats);
+}
@@ -0,0 +1,81 @@
+/*
+   Copyright 2024 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef INCLUDED_SQL_FAIRSHARE_H
+#define INCLUDED_SQL_FAIRSHARE_H
+
+#include <stdint.h>
+
+/*
+ * Weighted fair-share admission of SQL requests to the default SQL engine
+ * pool.  Requests are grouped into classes (by user, origin host, origin task
+ * or query fingerprint).  While the pool has idle threads and a class is
+ * under its concurrency cap, its requests run right away.  Otherwise they
+ * wait in a per-class queue, and whenever a request finishes the next one
+ * to run comes from the waiting class that has used the least CPU time and
+ * I/O cost relative to its share.
+ */
+struct sqlclntstate;
+struct thdpool;
+
+enum sql_fairshare_key {
+    SQL_FAIRSHARE_KEY_USER = 0,
+    SQL_FAIRSHARE_KEY_HOST = 1,
+    SQL_FAIRSHARE_KEY_TASK = 2,
+    SQL_FAIRSHARE_KEY_FINGERPRINT = 3
+};
+
+typedef struct sql_fairshare_stats {
+    char *name;
+    int64_t share;
+    int64_t max_concurrent;
+    int64_t running;
+    int64_t waiting;
+    int64_t dispatched;
+    int64_t queued;
+    int64_t queue_time_us;
+    int64_t max_queue_time_us;
+    int64_t cpu_us;
+    int64_t cost;
+    double vtime;
+} sql_fairshare_stats;
+
+extern int gbl_sql_fairshare;
+extern int gbl_sql_fairshare_key;
+
+/* Returns 1 if the request was queued behind other classes; it is then
+ * dispatched with dispatch_fairshare_sql_query() once its turn comes.
+ * Returns 0 if the caller should dispatch it now. */
+int sql_fairshare_admit(struct sqlclntstate *clnt, struct thdpool *pool);
+/* Mark the start of the request on the sql thread */
+void sql_fairshare_start(struct sqlclntstate *clnt);
+/* Charge a finished (or failed to dispatch) request to its class and let the
+ * next waiting requests in.  Does nothing for requests that weren't
+ * admitted. */
+void sql_fairshare_done(struct sqlclntstate *clnt);
+
+/* "<class> <share> [<max concurrent>]" */
+int sql_fairshare_set_class(const char *line);
+const char *sql_fairshare_key_str(int key);
+int sql_fairshare_key_from_str(const char *str);
+
+int sql_fairshare_get_stats(sql_fairshare_stats **stats, int *nstats);
+void sql_fairshare_stats_free(sql_fairshare_stats *stats, int nstats);
+
+/* In sqlinterfaces.c */
+int dispatch_fairshare_sql_query(struct sqlclntstate *clnt);
+
+#endif
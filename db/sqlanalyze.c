@@ -54,6 +54,10 @@ static int analyze_abort_requested = 0;
 /* global enable / disable switch */
 static int sampled_tables_enabled = 1;
 
+/* only re-analyze indexes which had keys added or removed since the last
+ * analyze of the table (requires sampled tables) */
+int gbl_analyze_incremental = 0;
+
 /* sampling threshold defaults to 100 Mb */
 long long sampling_threshold = 104857600;
 
@@ -128,6 +132,8 @@ typedef struct table_descriptor {
     struct user current_user;
     void *appdata;
     void *get_authdata;
+    int64_t ix_write_count[MAXINDEX]; /* index write counts at start */
+    uint32_t rep_gen; /* generation we were master at start, or 0 */
 } table_descriptor_t;
 
 /* loadStat4 (analyze.c) will ignore all stat entries
@@ -368,6 +374,19 @@ static int wait_for_index(index_descriptor_t *ix_des)
     return 0;
 }
 
+/* Return 1 if no keys were added to or removed from index ix since this node
+ * last analyzed the table.  Write counts are only maintained on the master, so
+ * they are only trusted if we have been master in the same generation. */
+static int analyze_index_unchanged(table_descriptor_t *td,
+                                   struct dbtable *tbl, int ix)
+{
+    if (!gbl_analyze_incremental || td->rep_gen == 0)
+        return 0;
+    if (tbl->aa_ix_saved_gen != td->rep_gen)
+        return 0;
+    return td->ix_write_count[ix] == tbl->aa_ix_saved_write_count[ix];
+}
+
 /* sample all indicies in this table */
 static int sample_indicies(table_descriptor_t *td, struct sqlclntstate *client,
                            struct dbtable *tbl, int sampling_pct, SBUF2 *sb)
@@ -400,6 +419,17 @@ static int sample_indicies(table_descriptor_t *td, struct sqlclntstate *client,
         ix_des->ix = i;
         ix_des->sampling_pct = sampling_pct;
 
+        /* keep the previous stats of an unchanged index */
+        if (analyze_index_unchanged(td, tbl, i)) {
+            strncpy0(ix_des->s_ix->name, table, sizeof(ix_des->s_ix->name));
+            ix_des->s_ix->ixnum = i;
+            ix_des->s_ix->skipped = 1;
+            ix_des->comp_state = SAMPLING_COMPLETE;
+            logmsg(LOGMSG_INFO, "Skipping unchanged index %d of table '%s'\n",
+                   i, table);
+            continue;
+        }
+
         /* start an index sampling thread */
         int rc = dispatch_sample_index_thread(ix_des);
         if (0 != rc) {
@@ -446,7 +476,7 @@ sampler_t *analyze_get_sampler(struct sqlclntstate *client, char *table,
     sampled_idx_t *s_ix;
 
     s_ix = find_sampled_index(client, table, idx);
-    if (!s_ix)
+    if (!s_ix || s_ix->skipped)
         return NULL;
     return s_ix->sampler;
 }
@@ -474,7 +504,7 @@ int64_t analyze_get_nrecs(int iTable)
     s_ix = find_sampled_index(client, db->tablename, ixnum);
 
     /* return -1 if not sampled.  Sqlite will use the value it calculated. */
-    if (!s_ix) {
+    if (!s_ix || s_ix->skipped) {
         return -1;
     }
 
@@ -489,6 +519,26 @@ int64_t analyze_get_nrecs(int iTable)
     return (int64_t)n_recs;
 }
 
+/* Called from sqlite.  Return 1 if this index is to keep its previous stats */
+int analyze_is_skipped(int iTable)
+{
+    struct sql_thread *thd;
+    struct sqlclntstate *client;
+    struct dbtable *db;
+    sampled_idx_t *s_ix;
+    int ixnum;
+
+    thd = pthread_getspecific(query_info_key);
+    client = thd->clnt;
+
+    db = get_sqlite_db(thd, iTable, &ixnum);
+    if (!db || ixnum < 0)
+        return 0;
+
+    s_ix = find_sampled_index(client, db->tablename, ixnum);
+    return (s_ix && s_ix->skipped);
+}
+
 /* Return the number of records sampled for an index */
 int64_t analyze_get_sampled_nrecs(const char *dbname, int ixnum)
 {
@@ -524,7 +574,7 @@ int analyze_is_sampled(struct sqlclntstate *client, char *table, int idx)
     sampled_idx_t *s_ix;
 
     s_ix = find_sampled_index(client, table, idx);
-    return (NULL != s_ix);
+    return (NULL != s_ix && !s_ix->skipped);
 }
 
 static int local_replicate_write_analyze(char *table)
@@ -703,6 +753,39 @@ int update_sav(sqlite3 *sqldb, struct sqlclntstate *client, SBUF2 *sb,
     return 0;
 }
 
+/* Move the saved stats of the indexes we skipped back in place */
+static int restore_skipped_stats(struct sqlclntstate *clnt,
+                                 struct dbtable *tbl, char *zErrTab,
+                                 size_t errlen)
+{
+    int stats[] = {1, 2, 4};
+    int rc = 0;
+
+    for (int i = 0; i < clnt->n_cmp_idx; i++) {
+        if (!clnt->sampled_idx_tbl[i].skipped)
+            continue;
+        for (int j = 0; j < sizeof(stats) / sizeof(stats[0]); j++) {
+            char stattbl[32];
+            snprintf(stattbl, sizeof(stattbl), "sqlite_stat%d", stats[j]);
+            if (!get_dbtable_by_name(stattbl))
+                continue;
+            char *sql = sqlite3_mprintf(
+                "update sqlite_stat%d set tbl='%q' where tbl='cdb2.%q.sav' "
+                "and idx='%q'",
+                stats[j], tbl->tablename, tbl->tablename,
+                tbl->ixschema[i]->sqlitetag);
+            assert(sql != NULL);
+            rc = run_internal_sql_clnt(clnt, sql);
+            if (rc)
+                strncpy(zErrTab, sql, errlen);
+            sqlite3_free(sql);
+            if (rc)
+                return rc;
+        }
+    }
+    return 0;
+}
+
 static int analyze_table_int(table_descriptor_t *td,
                              struct thr_handle *thr_self)
 {
@@ -742,6 +825,13 @@ static int analyze_table_int(table_descriptor_t *td,
 
     logmsg(LOGMSG_INFO, "Analyze thread starting, table %s (%d%%)\n", td->table, td->scale);
 
+    /* remember where the index write counts were when we started */
+    td->rep_gen = bdb_amimaster(thedb->bdb_env)
+                      ? bdb_get_rep_gen(thedb->bdb_env)
+                      : 0;
+    for (int i = 0; i < tbl->nix; i++)
+        td->ix_write_count[i] = ATOMIC_LOAD64(tbl->ix_write_count[i]);
+
     int rc = run_internal_sql_clnt(&clnt, "BEGIN");
     if (rc) {
         snprintf(zErrTab, sizeof(zErrTab), "BEGIN");
@@ -849,6 +939,12 @@ static int analyze_table_int(table_descriptor_t *td,
     if (rc)
         goto error;
 
+    if (sampled_table) {
+        rc = restore_skipped_stats(&clnt, tbl, zErrTab, sizeof(zErrTab));
+        if (rc)
+            goto error;
+    }
+
     if (debug_switch_test_delay_analyze_commit())
         sleep(10);
 
@@ -860,6 +956,10 @@ static int analyze_table_int(table_descriptor_t *td,
         */
         osql_unregister_sqlthr(&clnt);
         snprintf(zErrTab, sizeof(zErrTab), "COMMIT");
+    } else if (td->rep_gen) {
+        for (int i = 0; i < tbl->nix; i++)
+            tbl->aa_ix_saved_write_count[i] = td->ix_write_count[i];
+        tbl->aa_ix_saved_gen = td->rep_gen;
     }
 
 cleanup:
@@ -1253,6 +1353,15 @@ int analyze_dump_stats(void)
     logmsg(LOGMSG_USER, "Current Analyze sampling-threads:   %d threads\n",
            analyze_cur_comp_threads);
     logmsg(LOGMSG_USER, "Current Analyze counter:               %d \n", gbl_analyze_gen);
+    logmsg(LOGMSG_USER, "Pages read by sampling threads:     %" PRIu64 "\n",
+           ATOMIC_LOAD64(gbl_analyze_pages_read));
+    logmsg(LOGMSG_USER, "Pages read by block sampling:       %" PRIu64 "\n",
+           ATOMIC_LOAD64(gbl_analyze_block_sampled_pages));
+    logmsg(LOGMSG_USER, "Throttle waits:                     %" PRIu64 " (%" PRIu64 " ms)\n",
+           ATOMIC_LOAD64(gbl_analyze_throttle_waits),
+           ATOMIC_LOAD64(gbl_analyze_throttle_ms));
+    logmsg(LOGMSG_USER, "Sampling runs at idle I/O priority: %" PRIu64 "\n",
+           ATOMIC_LOAD64(gbl_analyze_idle_ioprio_runs));
     return 0;
 }
 
@@ -1371,6 +1480,12 @@ static inline int analyze_backout_table(struct sqlclntstate *clnt, char *table)
 {
     if (is_sqlite_stat(table))
         return 0;
+
+    /* the restored stats don't match the saved index write counts */
+    struct dbtable *tbl = get_dbtable_by_name(table);
+    if (tbl)
+        tbl->aa_ix_saved_gen = 0;
+
     int rc = run_internal_sql_clnt(clnt, "BEGIN");
     if (rc)
         return rc;
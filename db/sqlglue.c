@@ -92,6 +92,7 @@
 #include <thread_malloc.h>
 #include "fdb_fend.h"
 #include "fdb_access.h"
+#include "dohsql.h"
 #include "bdb_osqlcur.h"
 
 #include "debug_switches.h"
@@ -2628,6 +2629,158 @@ static int get_matching_genid(BtCursor *cur, int rrn, unsigned long long *genid)
     return 0;
 }
 
+/* Forward scans of read-only statements read up to this many rows ahead
+ * per bdb cursor call sequence, and hand them out without going back to
+ * bdb (or sql_tick) for each row.  0 or 1 disables batching. */
+int gbl_sql_scan_batch_rows = 0;
+
+/* keep a batch under this many bytes, whatever the row size */
+#define SCAN_BATCH_MAX_BYTES (1024 * 1024)
+
+struct scan_batch {
+    int nrows;          /* rows read ahead */
+    int pos;            /* next row to hand out */
+    int cap;            /* rows we have room for */
+    int datsz;          /* size of a row slot (ondisk size) */
+    int pending;        /* set if the move ending the batch is not yet seen */
+    int pending_rc;     /* .. and its result */
+    int pending_bdberr;
+    struct {
+        unsigned long long genid;
+        int rrn;
+    } * rows;
+    uint8_t *data;
+};
+
+static int scan_batch_enabled(BtCursor *pCur)
+{
+    return gbl_sql_scan_batch_rows > 1 &&
+           pCur->cursor_class == CURSORCLASS_TABLE && !gbl_rowlocks &&
+           !pCur->writeTransaction && !pCur->is_recording &&
+           !pCur->is_btree_count && pCur->db->dtastripe &&
+           pCur->db->schema->numblobs == 0 && pCur->vdbe &&
+           pCur->vdbe->readOnly;
+}
+
+static inline int scan_batch_has_rows(BtCursor *pCur)
+{
+    return pCur->scan_batch && pCur->scan_batch->pos < pCur->scan_batch->nrows;
+}
+
+/* Drop any rows read ahead; the cursor is being repositioned */
+static inline void scan_batch_reset(BtCursor *pCur)
+{
+    if (pCur->scan_batch) {
+        pCur->scan_batch->nrows = pCur->scan_batch->pos = 0;
+        pCur->scan_batch->pending = 0;
+    }
+}
+
+static void scan_batch_free(BtCursor *pCur)
+{
+    if (pCur->scan_batch) {
+        free(pCur->scan_batch->rows);
+        free(pCur->scan_batch->data);
+        free(pCur->scan_batch);
+        pCur->scan_batch = NULL;
+    }
+}
+
+/* Return the result of the move which ended the previous batch, if any */
+static int scan_batch_take_pending(BtCursor *pCur, int *rc, int *bdberr)
+{
+    struct scan_batch *b = pCur->scan_batch;
+    if (!b || !b->pending)
+        return 0;
+    *rc = b->pending_rc;
+    *bdberr = b->pending_bdberr;
+    b->pending = 0;
+    return 1;
+}
+
+/* Read up to cap rows ahead.  The first move which doesn't produce a row
+ * (eof, deadlock, error) ends the batch and is kept to be replayed once the
+ * rows are consumed.  Returns the number of rows read. */
+static int scan_batch_fill(BtCursor *pCur)
+{
+    struct scan_batch *b = pCur->scan_batch;
+
+    if (!b) {
+        int datsz = getdatsize(pCur->db);
+        int cap = SCAN_BATCH_MAX_BYTES / datsz;
+        if (cap > gbl_sql_scan_batch_rows)
+            cap = gbl_sql_scan_batch_rows;
+        if (cap < 1)
+            cap = 1;
+        b = calloc(1, sizeof(*b));
+        if (!b)
+            return 0;
+        b->rows = malloc(cap * sizeof(b->rows[0]));
+        b->data = malloc((size_t)cap * datsz);
+        if (!b->rows || !b->data) {
+            free(b->rows);
+            free(b->data);
+            free(b);
+            return 0;
+        }
+        b->cap = cap;
+        b->datsz = datsz;
+        pCur->scan_batch = b;
+    }
+
+    b->nrows = b->pos = 0;
+    b->pending = 0;
+    while (b->nrows < b->cap) {
+        int bdberr = 0;
+        int rc = ddguard_bdb_cursor_move(pCur, 0, &bdberr, CNEXT, NULL, 0);
+        if (bdberr || (rc != IX_FND && rc != IX_NOTFND)) {
+            b->pending = 1;
+            b->pending_rc = rc;
+            b->pending_bdberr = bdberr;
+            break;
+        }
+
+        void *buf;
+        int sz;
+        uint8_t ver;
+        uint8_t *slot = b->data + (size_t)b->nrows * b->datsz;
+        pCur->bdbcur->get_found_data(pCur->bdbcur, &b->rows[b->nrows].rrn,
+                                     &b->rows[b->nrows].genid, &sz, &buf,
+                                     &ver);
+        if (sz > b->datsz) {
+            logmsg(LOGMSG_ERROR, "%s: incorrect datsize %d\n", __func__, sz);
+            b->pending = 1;
+            b->pending_rc = -1;
+            b->pending_bdberr = 0;
+            break;
+        }
+        memcpy(slot, buf, sz);
+        vtag_to_ondisk_vermap(pCur->db, slot, &sz, ver);
+        if (sz > b->datsz) {
+            logmsg(LOGMSG_ERROR, "%s: incorrect datsize %d\n", __func__, sz);
+            b->pending = 1;
+            b->pending_rc = -1;
+            b->pending_bdberr = 0;
+            break;
+        }
+        b->nrows++;
+    }
+    return b->nrows;
+}
+
+static int scan_batch_next(BtCursor *pCur, int *pRes)
+{
+    struct scan_batch *b = pCur->scan_batch;
+    int i = b->pos++;
+
+    pCur->rrn = b->rows[i].rrn;
+    pCur->genid = b->rows[i].genid;
+    pCur->dtabuf = b->data + (size_t)i * b->datsz;
+    pCur->empty = 0;
+    *pRes = 0;
+    return SQLITE_OK;
+}
+
 static int cursor_move_table(BtCursor *pCur, int *pRes, int how)
 {
     struct sql_thread *thd = pCur->thd;
@@ -2642,6 +2795,14 @@ static int cursor_move_table(BtCursor *pCur, int *pRes, int how)
         return SQLITE_ACCESS;
     }
 
+    /* hand out a row we already read; the tick is done once per batch */
+    if (how == CNEXT && scan_batch_has_rows(pCur)) {
+        thd->cost += pCur->move_cost;
+        pCur->nmove++;
+        thd->nmove++;
+        return scan_batch_next(pCur, pRes);
+    }
+
     rc = cursor_move_preprop(pCur, pRes, how, &done);
     if (done) {
         return rc;
@@ -2663,7 +2824,19 @@ static int cursor_move_table(BtCursor *pCur, int *pRes, int how)
         thd->nmove++;
 
     bdberr = 0;
-    rc = ddguard_bdb_cursor_move(pCur, 0, &bdberr, how, NULL, 0);
+    if (how != CNEXT) {
+        scan_batch_reset(pCur);
+        rc = ddguard_bdb_cursor_move(pCur, 0, &bdberr, how, NULL, 0);
+    } else if (scan_batch_take_pending(pCur, &rc, &bdberr)) {
+        /* the move which ended the previous batch */
+    } else if (scan_batch_enabled(pCur)) {
+        if (scan_batch_fill(pCur) > 0)
+            return scan_batch_next(pCur, pRes);
+        if (!scan_batch_take_pending(pCur, &rc, &bdberr))
+            rc = ddguard_bdb_cursor_move(pCur, 0, &bdberr, how, NULL, 0);
+    } else {
+        rc = ddguard_bdb_cursor_move(pCur, 0, &bdberr, how, NULL, 0);
+    }
     switch(bdberr) {
     case BDBERR_NOT_DURABLE: return SQLITE_CLIENT_CHANGENODE;
     case BDBERR_TRANTOOCOMPLEX: return SQLITE_TRANTOOCOMPLEX;
@@ -3237,6 +3410,92 @@ int temp_table_cmp(KeyInfo *pKeyInfo, int k1len, const void *key1, int k2len,
         return sqlite3VdbeRecordCompare(k1len, key1, (UnpackedRecord *)key2);
 }
 
+int gbl_sql_hash_join_max_mem = 64 * 1024 * 1024;
+
+#define HASH_JOIN_FNV_PRIME 16777619u
+
+static inline unsigned int hash_join_bytes(unsigned int h, const u8 *z, int n)
+{
+    while (n-- > 0)
+        h = (h ^ *z++) * HASH_JOIN_FNV_PRIME;
+    return h;
+}
+
+/* Hash the join fields of a hash join key. Keys that are equal under
+ * sqlite3VdbeRecordCompare() with the BINARY collation must hash alike,
+ * so integral reals hash as integers and a zeroblob as its zeroes.
+ * Datetimes, intervals and decimals compare across types: leave those
+ * to the btree. */
+static int hash_join_hash(void *usermem, int nfields, void *unpacked,
+                          unsigned int *hash)
+{
+    UnpackedRecord *rec = unpacked;
+    unsigned int h = 2166136261u;
+    int i, n;
+    i64 iv;
+
+    n = (nfields < rec->nField) ? nfields : rec->nField;
+    for (i = 0; i < n; i++) {
+        Mem *m = &rec->aMem[i];
+        if (m->flags & MEM_Null) {
+            h = (h ^ 0xff) * HASH_JOIN_FNV_PRIME;
+        } else if (m->flags & (MEM_Datetime | MEM_Interval | MEM_Small)) {
+            return -1;
+        } else if (m->flags & MEM_Int) {
+            iv = m->u.i;
+            h = hash_join_bytes(h, (u8 *)&iv, sizeof(iv));
+        } else if (m->flags & MEM_Real) {
+            double r = m->u.r;
+            if (r >= -9223372036854775808.0 && r < 9223372036854775808.0 &&
+                (double)(iv = (i64)r) == r)
+                h = hash_join_bytes(h, (u8 *)&iv, sizeof(iv));
+            else
+                h = hash_join_bytes(h, (u8 *)&r, sizeof(r));
+        } else if (m->flags & (MEM_Str | MEM_Blob)) {
+            h = hash_join_bytes(h, (u8 *)m->z, m->n);
+            if (m->flags & MEM_Zero) {
+                for (int z = 0; z < m->u.nZero; z++)
+                    h *= HASH_JOIN_FNV_PRIME;
+            }
+        } else {
+            return -1;
+        }
+    }
+    *hash = h;
+    return 0;
+}
+
+static int hash_join_prefix_cmp(void *usermem, int nfields, int keylen,
+                                const void *key, void *unpacked)
+{
+    UnpackedRecord rec = *(UnpackedRecord *)unpacked;
+    if (nfields < rec.nField)
+        rec.nField = nfields;
+    rec.default_rc = 0;
+    return sqlite3VdbeRecordCompare(keylen, key, &rec);
+}
+
+/* Build the automatic index behind pCur as the hash table of a hash join
+ * on its first nField columns, see constructAutomaticIndex(). */
+int sqlite3BtreeCursorHashJoin(BtCursor *pCur, int nField)
+{
+    int bdberr = 0;
+
+    /* shared temptables stay btrees */
+    if (!pCur->bt->is_temporary || pCur->tmptable == NULL ||
+        pCur->tmptable->lk != NULL)
+        return SQLITE_OK;
+
+    if (bdb_temp_table_set_hash_join(
+            thedb->bdb_env, pCur->tmptable->tbl, nField, hash_join_hash,
+            hash_join_prefix_cmp, gbl_sql_hash_join_max_mem, &bdberr)) {
+        logmsg(LOGMSG_ERROR, "%s: bdb_temp_table_set_hash_join bdberr %d\n",
+               __func__, bdberr);
+        return SQLITE_INTERNAL;
+    }
+    return SQLITE_OK;
+}
+
 /* This is OP_MakeRecord from vdbe.c. */
 void sqlite3VdbeRecordPack(UnpackedRecord *unpacked, Mem *pOut)
 {
@@ -6506,6 +6765,8 @@ int sqlite3BtreeCloseCursor(BtCursor *pCur)
     if (pCur->blobs.numcblobs > 0)
         free_blob_status_data(&pCur->blobs);
 
+    scan_batch_free(pCur);
+
     /* update cursor use counts.  don't lock for now.
      * analyze shouldnt' affect cursor stats */
     if (pCur->db && !clnt->is_analyze) {
@@ -8248,6 +8509,7 @@ sqlite3BtreeCursor_cursor(Btree *pBt,      /* The btree */
     int sz = 0;
     struct schema *sc;
     void *shadow_tran = NULL;
+    int stripe_scan, stripe_tnum, stripe_lo, stripe_hi;
 
     assert(iTable >= RTPAGE_START);
     /* INVALID: assert(iTable < thd->rootpage_nentries + RTPAGE_START); */
@@ -8395,6 +8657,19 @@ sqlite3BtreeCursor_cursor(Btree *pBt,      /* The btree */
         shadow_tran = clnt->dbtran.shadow_tran;
     }
 
+    stripe_scan =
+        dohsql_get_stripe_range(clnt, &stripe_tnum, &stripe_lo, &stripe_hi);
+    if (stripe_scan && cur->ixnum != -1) {
+        int ixnum;
+        /* stripe shards are planned as full table scans; an index on the
+           same table would return rows from every stripe */
+        if (get_sqlite_db(thd, stripe_tnum, &ixnum) == cur->db) {
+            logmsg(LOGMSG_ERROR, "%s: stripe scan of %s uses index %d\n",
+                   __func__, cur->db->tablename, cur->ixnum);
+            return SQLITE_INTERNAL;
+        }
+    }
+
     enum bdb_open_type open_type;
     if (shadow_tran && (clnt->dbtran.mode != TRANLEVEL_SOSQL)) {
         open_type = (wrFlag) ? BDB_OPEN_BOTH_CREATE : BDB_OPEN_BOTH;
@@ -8420,6 +8695,10 @@ sqlite3BtreeCursor_cursor(Btree *pBt,      /* The btree */
         return rc;
     }
 
+    if (stripe_scan && iTable == stripe_tnum) {
+        bdb_cursor_set_stripe_range(cur->bdbcur, stripe_lo, stripe_hi);
+    }
+
     if (gbl_expressions_indexes && !clnt->isselect && cur->db->ix_expr) {
         if (!clnt->idxInsert)
             clnt->idxInsert = calloc(MAXINDEX, sizeof(uint8_t *));
@@ -10198,6 +10477,9 @@ static int ddguard_bdb_cursor_find(struct sql_thread *thd, BtCursor *pCur,
     static int simulatedeadlock = 0;
 
     int fndlen;
+
+    if (cur == pCur->bdbcur)
+        scan_batch_reset(pCur);
     void *buf;
     int cmp;
 
@@ -10401,6 +10683,8 @@ static int ddguard_bdb_cursor_find_last_dup(BtCursor *pCur,
     int rc = 0;
     struct sqlclntstate *clnt = pCur->clnt;
     assert(bdb_lockref() > 0);
+    if (cur == pCur->bdbcur)
+        scan_batch_reset(pCur);
     if (pCur->range) {
         if (pCur->range->idxnum == -1 && pCur->range->islocked == 0) {
             currange_free(pCur->range);
@@ -107,6 +107,8 @@
 #include "dohsql.h"
 #include "comdb2_query_preparer.h"
 #include "string_ref.h"
+#include "histogram.h"
+#include "sql_fairshare.h"
 
 #include "osqlsqlsocket.h"
 #include <net_appsock.h>
@@ -197,7 +199,7 @@ int gbl_random_sql_work_rejected = 0;
 
 comdb2_query_preparer_t *query_preparer_plugin;
 
-void rcache_init(size_t, size_t);
+void rcache_init(size_t, size_t, int);
 void rcache_destroy(void);
 void sql_reset_sqlthread(struct sql_thread *thd);
 int blockproc2sql_error(int rc, const char *func, int line);
@@ -1254,7 +1256,9 @@ static void sql_statement_done(struct sql_thread *thd, struct reqlogger *logger,
     h->txnid = rqid;
 
     time_metric_add(thedb->service_time, h->cost.time);
+    comdb2_histogram_add(gbl_sql_latency_hist, reqlog_current_us(logger));
     clnt->last_cost = (int64_t) h->cost.cost;
+    clnt->fs_cost += clnt->last_cost;
 
     /* request logging framework takes care of logging long sql requests */
     reqlog_set_cost(logger, h->cost.cost);
@@ -4453,6 +4457,8 @@ void signal_clnt_as_done(struct sqlclntstate *clnt)
 {
     struct sql_thread *thd = (clnt->thd && clnt->thd->sqlthd) ? clnt->thd->sqlthd : NULL;
 
+    sql_fairshare_done(clnt);
+
     /* Clear the client from the sql thread, so that sql-dump won't see it. */
     if (thd) {
         Pthread_mutex_lock(&gbl_sql_lock);
@@ -4853,6 +4859,7 @@ static void sqlengine_work_appsock_pp(struct thdpool *pool, void *work,
 
     switch (op) {
     case THD_RUN:
+        sql_fairshare_start(clnt);
         if (clnt->exec_lua_thread)
             sqlengine_work_lua_thread(thddata, work);
         else
@@ -4968,6 +4975,18 @@ static int enqueue_sql_query(struct sqlclntstate *clnt)
     time_metric_add(thedb->queue_depth, q_depth_tag_and_sql);
 
     assert(clnt->dbtran.pStmt == NULL);
+
+    if (gbl_sql_fairshare && gbl_sql_fairshare_key == SQL_FAIRSHARE_KEY_FINGERPRINT &&
+        gbl_fingerprint_queries && comdb2_ruleset_fingerprints_allowed() &&
+        (clnt->admin || !gbl_prioritize_queries || !gbl_ruleset)) {
+        /* not done by verify_dispatch_sql_query() */
+        preview_and_calc_fingerprint(clnt);
+    }
+    if (sql_fairshare_admit(clnt, pool)) {
+        /* sql_fairshare_done() of another request will dispatch it */
+        return 0;
+    }
+
     uint32_t flags = (clnt->admin ? THDPOOL_FORCE_DISPATCH : 0);
     if (gbl_thdpool_queue_only) {
         flags |= THDPOOL_QUEUE_ONLY;
@@ -4995,6 +5014,7 @@ static int enqueue_sql_query(struct sqlclntstate *clnt)
         if (rc) {
             logmsg(LOGMSG_DEBUG, "%s: failed to enqueue: %s\n", __func__, string_ref_cstr(clnt->sql_ref));
             put_ref(&sr); // failed to enqueue so we still own this reference
+            sql_fairshare_done(clnt);
             /* say something back, if the client expects it */
             if (clnt->fail_dispatch) {
                 snprintf(msg, sizeof(msg), "%s: unable to dispatch sql query, rc=%d\n",
@@ -5006,6 +5026,24 @@ static int enqueue_sql_query(struct sqlclntstate *clnt)
     return rc;
 }
 
+/* A request that waited in sql_fairshare_admit() gets its turn */
+int dispatch_fairshare_sql_query(struct sqlclntstate *clnt)
+{
+    struct thdpool *pool = get_sql_pool(clnt);
+    struct string_ref *sr = get_ref(clnt->sql_ref);
+    int rc = thdpool_enqueue(pool, sqlengine_work_appsock_pp, clnt, 1, sr,
+                             THDPOOL_FORCE_QUEUE);
+    if (rc) {
+        logmsg(LOGMSG_ERROR, "%s: failed to enqueue: %s\n", __func__,
+               string_ref_cstr(clnt->sql_ref));
+        put_ref(&sr);
+        /* the client is already waiting for the query to finish */
+        clnt->query_rc = CDB2ERR_IO_ERROR;
+        signal_clnt_as_done(clnt);
+    }
+    return rc;
+}
+
 static int wait_for_sql_query(struct sqlclntstate *clnt)
 {
     /* successful dispatch or queueing, enable heartbeats */
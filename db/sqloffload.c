@@ -760,7 +760,12 @@ int osql_is_index_reorder_on(int osql_flags)
     return osql_flags & OSQL_FLAGS_REORDER_IDX_ON;
 }
 
+int osql_is_dup_index_defer_on(int osql_flags)
+{
+    return osql_flags & OSQL_FLAGS_DEFER_DUP_IDX_ON;
+}
+
 void osql_unset_index_reorder_bit(int *osql_flags)
 {
-    (*osql_flags) &= (~OSQL_FLAGS_REORDER_IDX_ON);
+    (*osql_flags) &= ~(OSQL_FLAGS_REORDER_IDX_ON | OSQL_FLAGS_DEFER_DUP_IDX_ON);
 }
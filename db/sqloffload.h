@@ -49,6 +49,8 @@ enum {
     OSQL_FLAGS_REORDER_ON = 0x00000080,
     /* indicates if index reordering is turned on */
     OSQL_FLAGS_REORDER_IDX_ON = 0x00000100,
+    /* indicates if non-unique index writes are deferred */
+    OSQL_FLAGS_DEFER_DUP_IDX_ON = 0x00000200,
 };
 
 int osql_open(struct dbenv *dbenv);
@@ -88,5 +90,6 @@ void osql_postcommit_handle(struct ireq *iq);
 void osql_postabort_handle(struct ireq *iq);
 
 int osql_is_index_reorder_on(int osql_flags);
+int osql_is_dup_index_defer_on(int osql_flags);
 void osql_unset_index_reorder_bit(int *osql_flags);
 #endif
@@ -23,7 +23,7 @@
 
 extern int gbl_use_appsock_as_sqlthread;
 
-extern void rcache_init(size_t, size_t);
+extern void rcache_init(size_t, size_t, int);
 extern void rcache_destroy(void);
 
 typedef struct pool_foreach_data {
@@ -58,7 +58,8 @@ void sqlengine_thd_start(struct thdpool *pool, struct sqlthdstate *thd,
 
     thd->sqlthd = pthread_getspecific(query_info_key);
     rcache_init(bdb_attr_get(thedb->bdb_attr, BDB_ATTR_RCACHE_COUNT),
-                bdb_attr_get(thedb->bdb_attr, BDB_ATTR_RCACHE_PGSZ));
+                bdb_attr_get(thedb->bdb_attr, BDB_ATTR_RCACHE_PGSZ),
+                bdb_attr_get(thedb->bdb_attr, BDB_ATTR_RCACHE_LEVELS));
 }
 
 void sqlengine_thd_end(struct thdpool *pool, struct sqlthdstate *thd)
@@ -2435,6 +2435,40 @@ const uint8_t *flddtasizes_get(struct flddtasizes *p_flddtasizes,
     return p_buf;
 }
 
+/*
+ * A conversion program is stag_to_stag_field() worked out once for a pair of
+ * schemas.  Runs of target fields stored exactly like their source fields
+ * (same integer or real type, length and sort order, laid out back to back in
+ * both records) collapse into a single memcpy; every other field still goes
+ * through stag_to_stag_field(), but without looking up its source by name.
+ */
+enum { CONVERT_OP_COPY, CONVERT_OP_FIELD };
+
+struct convert_op {
+    int op;
+    int field;    /* first target field */
+    int nfields;  /* COPY: target fields in the run */
+    int from_off; /* COPY: run offset in the source record */
+    int to_off;   /* COPY: run offset in the target record */
+    int len;      /* COPY: run length */
+    int notnull;  /* COPY: run has NO_NULL target fields */
+};
+
+struct convert_prog {
+    struct schema *from;
+    struct schema *to;
+    int *map; /* source field of every target field, -1 if missing */
+    int nops;
+    struct convert_op *ops;
+};
+
+static int convert_prog_run(const struct dbtable *tbl,
+                            const struct convert_prog *prog, const char *inbuf,
+                            char *outbuf, int flags,
+                            struct convert_failure *fail_reason,
+                            blob_buffer_t *inblobs, blob_buffer_t *outblobs,
+                            int maxblobs, const char *tzname);
+
 /* Convert record from old version to ondisk.
  * This is a faster version of vtag_to_ondisk()
  * it uses a map of every version to current ondisk so we avoid lookup
@@ -2509,9 +2543,16 @@ int vtag_to_ondisk_vermap(const dbtable *db, uint8_t *rec, int *len,
         memcpy(inbuf, rec, from_schema->recsize);
 
         /* call new cached version instead of stag_to_stag_buf_flags() */
-        rc = stag_to_stag_buf_cachedmap(db, (int *)db->versmap[ver],
-                                        from_schema, to_schema, inbuf, (char *)rec,
-                                        CONVERT_NULL_NO_ERROR, &reason, NULL, 0);
+        struct convert_prog *prog = db->versprog[ver];
+        if (prog && prog->from == from_schema && prog->to == to_schema &&
+            BDB_ATTR_GET(thedb->bdb_attr, TAG_CONVERT_PROGRAMS))
+            rc = convert_prog_run(db, prog, inbuf, (char *)rec,
+                                  CONVERT_NULL_NO_ERROR, &reason, NULL, NULL, 0,
+                                  NULL);
+        else
+            rc = stag_to_stag_buf_cachedmap(db, (int *)db->versmap[ver],
+                                            from_schema, to_schema, inbuf, (char *)rec,
+                                            CONVERT_NULL_NO_ERROR, &reason, NULL, 0);
 
         if (rc) {
             char err[1024];
@@ -3680,6 +3721,170 @@ int stag_to_stag_buf_cachedmap(const struct dbtable *tbl, int tagmap[],
     return rc;
 }
 
+static int convert_field_is_copy(struct schema *tosch, struct field *from_field,
+                                 struct field *to_field)
+{
+    if (from_field->type != to_field->type || from_field->len != to_field->len)
+        return 0;
+    /* SERVER_to_SERVER() of these is a plain memcpy for equal lengths */
+    if (to_field->type != SERVER_BINT && to_field->type != SERVER_BREAL)
+        return 0;
+    if (from_field->blob_index >= 0 || to_field->blob_index >= 0)
+        return 0;
+    if ((tosch->flags & SCHEMA_INDEX) && to_field->isExpr)
+        return 0;
+    /* may be generated, see gbl_replicate_local */
+    if (strcasecmp(to_field->name, "comdb2_seqno") == 0)
+        return 0;
+    /* descending on both sides xors twice */
+    if ((from_field->flags & INDEX_DESCEND) != (to_field->flags & INDEX_DESCEND))
+        return 0;
+    return 1;
+}
+
+static void convert_prog_free(struct convert_prog *prog)
+{
+    if (prog == NULL)
+        return;
+    free(prog->map);
+    free(prog->ops);
+    free(prog);
+}
+
+/* tagmap may be NULL, in which case fields are matched by name */
+static struct convert_prog *convert_prog_build(struct schema *fromsch,
+                                               struct schema *tosch,
+                                               const int *tagmap)
+{
+    struct convert_prog *prog;
+    struct convert_op *run = NULL;
+
+    prog = calloc(1, sizeof(struct convert_prog));
+    if (prog == NULL)
+        return NULL;
+    prog->from = fromsch;
+    prog->to = tosch;
+    prog->map = malloc(sizeof(int) * (tosch->nmembers + 1));
+    prog->ops = calloc(tosch->nmembers + 1, sizeof(struct convert_op));
+    if (prog->map == NULL || prog->ops == NULL) {
+        convert_prog_free(prog);
+        return NULL;
+    }
+
+    for (int field = 0; field < tosch->nmembers; field++) {
+        struct field *to_field = &tosch->member[field];
+        struct field *from_field = NULL;
+        int field_idx;
+
+        if (tagmap)
+            field_idx = tagmap[field];
+        else if (fromsch == tosch)
+            field_idx = field;
+        else
+            field_idx = find_field_idx_in_tag(fromsch, to_field->name);
+        prog->map[field] = field_idx;
+        if (field_idx != -1)
+            from_field = &fromsch->member[field_idx];
+
+        if (from_field == NULL ||
+            !convert_field_is_copy(tosch, from_field, to_field)) {
+            struct convert_op *op = &prog->ops[prog->nops++];
+            op->op = CONVERT_OP_FIELD;
+            op->field = field;
+            run = NULL;
+            continue;
+        }
+
+        if (run == NULL || run->from_off + run->len != from_field->offset ||
+            run->to_off + run->len != to_field->offset) {
+            run = &prog->ops[prog->nops++];
+            run->op = CONVERT_OP_COPY;
+            run->field = field;
+            run->from_off = from_field->offset;
+            run->to_off = to_field->offset;
+        }
+        run->nfields++;
+        run->len += to_field->len;
+        if (to_field->flags & NO_NULL)
+            run->notnull = 1;
+    }
+    return prog;
+}
+
+/* Same as _stag_to_stag_buf_flags_blobs() for the program's schemas */
+static int convert_prog_run(const struct dbtable *tbl,
+                            const struct convert_prog *prog, const char *inbuf,
+                            char *outbuf, int flags,
+                            struct convert_failure *fail_reason,
+                            blob_buffer_t *inblobs, blob_buffer_t *outblobs,
+                            int maxblobs, const char *tzname)
+{
+    struct schema *fromsch = prog->from;
+    struct schema *tosch = prog->to;
+
+    if (fail_reason) {
+        init_convert_failure_reason(fail_reason);
+        fail_reason->source_schema = fromsch;
+        fail_reason->target_schema = tosch;
+    }
+
+    for (int i = 0; i < prog->nops; i++) {
+        const struct convert_op *op = &prog->ops[i];
+
+        if (op->op == CONVERT_OP_FIELD) {
+            int rc = stag_to_stag_field(tbl, inbuf, outbuf, flags, fail_reason,
+                                        inblobs, outblobs, maxblobs, tzname,
+                                        prog->map[op->field], op->field,
+                                        fromsch, tosch);
+            if (rc)
+                return rc;
+            continue;
+        }
+
+        for (int j = 0; op->notnull && j < op->nfields; j++) {
+            int field = op->field + j;
+            if ((tosch->member[field].flags & NO_NULL) &&
+                field_is_null(fromsch, &fromsch->member[prog->map[field]],
+                              inbuf)) {
+                if (fail_reason) {
+                    fail_reason->target_field_idx = field;
+                    fail_reason->source_field_idx = -1;
+                    fail_reason->reason =
+                        CONVERT_FAILED_NULL_CONSTRAINT_VIOLATION;
+                }
+                return -1;
+            }
+        }
+        memcpy(outbuf + op->to_off, inbuf + op->from_off, op->len);
+    }
+    return 0;
+}
+
+/* The .ONDISK to index program of a table, or NULL if the schemas are not the
+ * ones it was built for.  Programs are dropped by update_dbstore(). */
+static struct convert_prog *key_convert_prog(const struct dbtable *db,
+                                             int ixnum, struct schema *fromsch,
+                                             struct schema *tosch)
+{
+    struct convert_prog **slot = (struct convert_prog **)&db->ixprog[ixnum];
+    struct convert_prog *prog = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+
+    if (prog == NULL) {
+        struct convert_prog *cur = NULL;
+        prog = convert_prog_build(fromsch, tosch, NULL);
+        if (prog == NULL)
+            return NULL;
+        if (!__atomic_compare_exchange_n(slot, &cur, prog, 0, __ATOMIC_ACQ_REL,
+                                         __ATOMIC_ACQUIRE)) {
+            convert_prog_free(prog);
+            prog = cur;
+        }
+    }
+    if (prog->from != fromsch || prog->to != tosch)
+        return NULL;
+    return prog;
+}
+
 /*
  * Convert an ondisk format key for one table into the equivalent ondisk format
  * key in the other table.  This is used for foreign key constraint checking.
@@ -5934,6 +6139,12 @@ int init_table_sequences(struct ireq *iq, tran_type *tran, dbtable *db)
 /* Compute map of dbstores used in vtag_to_ondisk */
 void update_dbstore(dbtable *db)
 {
+    /* the schemas may have been replaced; key programs get rebuilt on use */
+    for (int ix = 0; ix < MAXINDEX; ++ix) {
+        convert_prog_free(db->ixprog[ix]);
+        db->ixprog[ix] = NULL;
+    }
+
     if (!db->instant_schema_change)
         return;
 
@@ -5970,6 +6181,8 @@ void update_dbstore(dbtable *db)
         db->versmap[v] = (unsigned int *)get_tag_mapping(ver, ondisk);
         logmsg(LOGMSG_DEBUG, "%s set table '%s' schema version %d to %p\n",
                __func__, db->tablename, v, db->versmap[v]);
+        convert_prog_free(db->versprog[v]);
+        db->versprog[v] = convert_prog_build(ver, ondisk, (int *)db->versmap[v]);
         db->vers_compat_ondisk[v] = 1;
         if (SC_TAG_CHANGE ==
             compare_tag_int(ver, ondisk, NULL, 0 /*non-strict compliance*/))
@@ -6208,8 +6421,14 @@ void freedb_int(dbtable *db, dbtable *replace)
                 free(db->versmap[v]);
                 db->versmap[v] = NULL;
             }
+            convert_prog_free(db->versprog[v]);
+            db->versprog[v] = NULL;
         }
     }
+    for (i = 0; i < MAXINDEX; i++) {
+        convert_prog_free(db->ixprog[i]);
+        db->ixprog[i] = NULL;
+    }
 
     if (replace) {
         memcpy(db, replace, sizeof(dbtable));
@@ -6575,8 +6794,15 @@ int create_key_from_schema(const struct dbtable *db, struct schema *schema, int
     fromsch = schema ? schema : get_schema(db, -1);
     tosch = get_schema(db, ixnum);
 
-    rc = _stag_to_stag_buf_flags_blobs(db, fromsch, tosch, inbuf, outbuf, 0 /*flags*/,
-                                       NULL, inblobs, NULL /*outblobs*/, maxblobs, tzname);
+    struct convert_prog *prog = NULL;
+    if (fromsch == db->schema && BDB_ATTR_GET(thedb->bdb_attr, TAG_CONVERT_PROGRAMS))
+        prog = key_convert_prog(db, ixnum, fromsch, tosch);
+    if (prog)
+        rc = convert_prog_run(db, prog, inbuf, outbuf, 0 /*flags*/, NULL, inblobs,
+                              NULL /*outblobs*/, maxblobs, tzname);
+    else
+        rc = _stag_to_stag_buf_flags_blobs(db, fromsch, tosch, inbuf, outbuf, 0 /*flags*/,
+                                           NULL, inblobs, NULL /*outblobs*/, maxblobs, tzname);
     if (rc)
         return rc;
 
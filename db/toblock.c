@@ -4863,9 +4863,11 @@ static int toblock_main_int(struct javasp_trans_state *javasp_trans_handle, stru
     ixout = -1;
     errout = 0;
 
-    if (delayed || gbl_goslow || osql_is_index_reorder_on(iq->osql_flags)) {
+    if (delayed || gbl_goslow || osql_is_index_reorder_on(iq->osql_flags) ||
+        osql_is_dup_index_defer_on(iq->osql_flags)) {
 
-        if (osql_is_index_reorder_on(iq->osql_flags)) {
+        if (osql_is_index_reorder_on(iq->osql_flags) ||
+            osql_is_dup_index_defer_on(iq->osql_flags)) {
             if (iq->debug)
                 reqpushprefixf(iq, "%p process_defered_table: ", trans);
             rc = process_defered_table(iq, trans, &blkpos, &ixout, &errout);
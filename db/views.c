@@ -65,6 +65,7 @@ struct timepart_view {
     uuid_t source_id; /* identifier for view, unique as compared to name */
     enum TIMEPART_ROLLOUT_TYPE rolltype; /* add/drop shard, or truncate */
     int current_shard; /* where to insert; always 0 for add/drop rollout */
+    char *hashcol;     /* partitioning column for hash partitions */
 };
 
 struct timepart_views {
@@ -426,6 +427,7 @@ void timepart_free_view(timepart_view_t *view)
     }
     free(view->name);
     free(view->shard0name);
+    free(view->hashcol);
 
     memset(view, 0xFF, sizeof(*view));
 
@@ -1942,6 +1944,9 @@ int views_cron_restart(timepart_views_t *views)
 
             view = views->views[i];
 
+            if (view->period == VIEW_PARTITION_HASH)
+                continue;
+
             if (view->rolltype == TIMEPART_ROLLOUT_TRUNCATE) {
                 rc = _view_restart_new_rollout(view, &xerr);
             } else {
@@ -2885,9 +2890,82 @@ done:
     return view;
 }
 
+timepart_view_t *timepart_new_hash_partition(const char *name, int nshards,
+                                             const char *column,
+                                             const char **partition_name,
+                                             struct errstat *err)
+{
+    timepart_view_t *view;
+
+    view = timepart_new_partition(name, VIEW_PARTITION_HASH, nshards, 0, NULL,
+                                  TIMEPART_ROLLOUT_TRUNCATE, partition_name,
+                                  err);
+    if (!view)
+        return NULL;
+
+    view->hashcol = strdup(column);
+    if (!view->hashcol) {
+        if (partition_name)
+            *partition_name = NULL;
+        _failed_new_view(&view, "malloc oom", VIEW_ERR_MALLOC, err, __func__,
+                         __LINE__);
+    }
+    return view;
+}
+
+int timepart_hash_shard(sqlite3_value *val, int nshards)
+{
+    unsigned char buf[8];
+    const unsigned char *key;
+    int keylen;
+    long long ival;
+    double rval;
+
+    if (nshards <= 1)
+        return 0;
+
+    switch (sqlite3_value_type(val)) {
+    case SQLITE_NULL:
+        return 0;
+    case SQLITE_FLOAT:
+        rval = sqlite3_value_double(val);
+        if (rval < -9.2e18 || rval > 9.2e18 ||
+            rval != (double)(long long)rval) {
+            key = sqlite3_value_text(val);
+            keylen = sqlite3_value_bytes(val);
+            break;
+        }
+        /* integral values hash like the integer, so that the key column
+           affinity does not change the shard */
+        ival = (long long)rval;
+        goto hash_int;
+    case SQLITE_INTEGER:
+        ival = sqlite3_value_int64(val);
+    hash_int:
+        for (keylen = 0; keylen < sizeof(buf); keylen++)
+            buf[keylen] = ((unsigned long long)ival >>
+                           (8 * (sizeof(buf) - 1 - keylen))) & 0xff;
+        key = buf;
+        break;
+    case SQLITE_BLOB:
+        key = sqlite3_value_blob(val);
+        keylen = sqlite3_value_bytes(val);
+        break;
+    default:
+        key = sqlite3_value_text(val);
+        keylen = sqlite3_value_bytes(val);
+        break;
+    }
+    if (!key)
+        return 0;
+
+    return crc32c(key, keylen) % (unsigned)nshards;
+}
+
 static int _get_starttime_to_future(timepart_view_t *view)
 {
-    if (view->period == VIEW_PARTITION_MANUAL)
+    if (view->period == VIEW_PARTITION_MANUAL ||
+        view->period == VIEW_PARTITION_HASH)
         return view->starttime;
 
     int current_time = comdb2_time_epoch();
@@ -2947,11 +3025,19 @@ int timepart_populate_shards(timepart_view_t *view, struct errstat *err)
         }
         old_name = new_name;
     }
-    /* rollout times */
-    view->shards[0].low = INT_MIN;
-    view->shards[0].high = next_rollout;
-    for (i = 1; i < view->retention; i++) {
-        view->shards[i].low = view->shards[i].high = INT_MAX;
+    if (view->period == VIEW_PARTITION_HASH) {
+        /* shard i stores the rows with partition_hash(col, nshards) == i */
+        for (i = 0; i < view->retention; i++) {
+            view->shards[i].low = i;
+            view->shards[i].high = i + 1;
+        }
+    } else {
+        /* rollout times */
+        view->shards[0].low = INT_MIN;
+        view->shards[0].high = next_rollout;
+        for (i = 1; i < view->retention; i++) {
+            view->shards[i].low = view->shards[i].high = INT_MAX;
+        }
     }
     view->nshards = view->retention;
 
@@ -2989,6 +3075,11 @@ static void _view_find_current_shard(timepart_view_t *view)
     int newest_earlier_shard = -1;
     int i;
 
+    /* hash partitions insert by key, not into a current shard */
+    if (view->period == VIEW_PARTITION_HASH) {
+        view->current_shard = 0;
+        return;
+    }
 
     /* Try to find a shard with time interval matching the current time;
      * Corner case: it is possible for the db to be down and miss a few
@@ -3194,6 +3285,9 @@ int timepart_create_inmem_view(timepart_view_t *view)
     if (rc != VIEW_NOERR) {
         logmsg(LOGMSG_ERROR, "Unable to add view %s rc %d \"%s\"\n", view->name,
                err.errval, err.errstr);
+    } else if (period == VIEW_PARTITION_HASH) {
+        /* hash partitions never roll out */
+        free(name_dup);
     } else {
         if (period == VIEW_PARTITION_MANUAL) {
             /* dedicated logical cron schedulers */
@@ -3285,6 +3379,92 @@ int timepart_is_partition(const char *name)
     return ret;
 }
 
+int timepart_is_hash_shard_filter(const char *tblname, const char *colname,
+                                  int nshards, int shard)
+{
+    struct dbtable *db;
+    timepart_view_t *view;
+    int ret = 0;
+
+    db = get_dbtable_by_name(tblname);
+    if (!db || !db->timepartition_name)
+        return 0;
+
+    Pthread_rwlock_rdlock(&views_lk);
+    view = _get_view(thedb->timepart_views, db->timepartition_name);
+    if (view && view->period == VIEW_PARTITION_HASH &&
+        view->nshards == nshards && shard >= 0 && shard < view->nshards &&
+        !strcasecmp(view->shards[shard].tblname, tblname) &&
+        !strcasecmp(view->hashcol, colname))
+        ret = 1;
+    Pthread_rwlock_unlock(&views_lk);
+
+    return ret;
+}
+
+int timepart_is_hash_shard(const char *tblname, const char *writer)
+{
+    struct dbtable *db;
+    timepart_view_t *view;
+    int ret = 0;
+
+    db = get_dbtable_by_name(tblname);
+    if (!db || !db->timepartition_name)
+        return 0;
+
+    Pthread_rwlock_rdlock(&views_lk);
+    view = _get_view(thedb->timepart_views, db->timepartition_name);
+    if (view && view->period == VIEW_PARTITION_HASH &&
+        (!writer || strcasecmp(view->name, writer)))
+        ret = 1;
+    Pthread_rwlock_unlock(&views_lk);
+
+    return ret;
+}
+
+int timepart_hash_check_schema(const char *tblname, struct schema *newschema,
+                               struct errstat *err)
+{
+    struct dbtable *db;
+    timepart_view_t *view;
+    struct field *oldfld, *newfld;
+    int oldidx, newidx;
+    int rc = VIEW_NOERR;
+
+    db = get_dbtable_by_name(tblname);
+    if (!db || !db->timepartition_name)
+        return VIEW_NOERR;
+
+    Pthread_rwlock_rdlock(&views_lk);
+    view = _get_view(thedb->timepart_views, db->timepartition_name);
+    if (!view || view->period != VIEW_PARTITION_HASH)
+        goto done;
+
+    /* the shard of every row depends on the column and on its type */
+    oldidx = find_field_idx_in_tag(db->schema, view->hashcol);
+    newidx = find_field_idx_in_tag(newschema, view->hashcol);
+    if (newidx < 0) {
+        rc = VIEW_ERR_PARAM;
+        errstat_set_rcstrf(err, rc, "Cannot drop column %s, %s is hash "
+                           "partitioned on it", view->hashcol, view->name);
+        goto done;
+    }
+    if (oldidx < 0)
+        goto done;
+    oldfld = &db->schema->member[oldidx];
+    newfld = &newschema->member[newidx];
+    if (oldfld->type != newfld->type || oldfld->len != newfld->len) {
+        rc = VIEW_ERR_PARAM;
+        errstat_set_rcstrf(err, rc, "Cannot change the type of column %s, "
+                           "%s is hash partitioned on it", view->hashcol,
+                           view->name);
+    }
+
+done:
+    Pthread_rwlock_unlock(&views_lk);
+    return rc;
+}
+
 int timepart_allow_drop(const char *zPartitionName)
 {
     timepart_view_t *view;
@@ -3353,7 +3533,8 @@ int partition_publish(tran_type *tran, struct schema_change_type *sc)
     if (sc->partition.type != PARTITION_NONE) {
         switch (sc->partition.type) {
         case PARTITION_ADD_TIMED:
-        case PARTITION_ADD_MANUAL: {
+        case PARTITION_ADD_MANUAL:
+        case PARTITION_ADD_COL_HASH: {
             assert(sc->newpartition != NULL);
             timepart_create_inmem_view(sc->newpartition);
             break;
@@ -3388,7 +3569,8 @@ void partition_unpublish(struct schema_change_type *sc)
    if (sc->partition.type != PARTITION_NONE) {
         switch (sc->partition.type) {
         case PARTITION_ADD_TIMED:
-        case PARTITION_ADD_MANUAL: {
+        case PARTITION_ADD_MANUAL:
+        case PARTITION_ADD_COL_HASH: {
             assert(sc->newpartition != NULL);
             timepart_destroy_inmem_view(sc->timepartition_name);
             break;
@@ -27,7 +27,8 @@ enum view_partition_period {
     VIEW_PARTITION_MONTHLY,
     VIEW_PARTITION_YEARLY,
     VIEW_PARTITION_TEST2MIN,
-    VIEW_PARTITION_MANUAL
+    VIEW_PARTITION_MANUAL,
+    VIEW_PARTITION_HASH
 };
 
 #define IS_TIMEPARTITION(p)                                                    \
@@ -404,6 +405,48 @@ timepart_view_t *timepart_new_partition(const char *name, int period,
                                         const char **partition_name,
                                         struct errstat *err);
 
+/**
+ * Create a hash partition object; rows go to shard
+ * partition_hash(column, nshards), and shards are never rolled out
+ *
+ */
+timepart_view_t *timepart_new_hash_partition(const char *name, int nshards,
+                                             const char *column,
+                                             const char **partition_name,
+                                             struct errstat *err);
+
+/**
+ * Shard of a hash partition with "nshards" shards that a column value
+ * belongs to; backs the partition_hash() sql function
+ *
+ */
+int timepart_hash_shard(sqlite3_value *val, int nshards);
+
+/**
+ * Returns 1 if "partition_hash(colname, nshards) = shard" holds for every
+ * row of table "tblname", i.e. it is the view filter of a hash shard
+ *
+ */
+int timepart_is_hash_shard_filter(const char *tblname, const char *colname,
+                                  int nshards, int shard);
+
+/**
+ * Returns 1 if table "tblname" is a shard of a hash partition other than
+ * "writer" (which can be NULL); rows may only be written to a shard by
+ * the triggers of its partition, which place them by key
+ *
+ */
+int timepart_is_hash_shard(const char *tblname, const char *writer);
+
+/**
+ * Check that "newschema", the new schema of table "tblname", keeps the
+ * partitioning column of its hash partition, if any, with the same type
+ * Returns VIEW_NOERR if so, an error otherwise, with the reason in "err"
+ *
+ */
+int timepart_hash_check_schema(const char *tblname, struct schema *newschema,
+                               struct errstat *err);
+
 /**
  * Populates shard information based on preset number of shards
  * view->retention
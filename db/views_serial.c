@@ -15,10 +15,11 @@
  *  data =
  *       {
  *          "NAME": "aname",
- *          "PERIOD": "daily"|"weekly"|"monthly"|"yearly|manual",
+ *          "PERIOD": "daily"|"weekly"|"monthly"|"yearly|manual|hash",
  *          "RETENTION" : n,  #here n is 4
  *          "SOURCE_ID" : "uuid string",
  *          "ROLLOUT" : "adddrop|truncate",
+ *          "HASHCOLUMN" : "acolumn", #only for hash partitions
  *          "TABLES":
  *             [
  *                {
@@ -150,6 +151,13 @@ int timepart_serialize_view(timepart_view_t *view, int *plen, char **out,
             return VIEW_ERR_MALLOC;
     }
 
+    if (view->hashcol) {
+        str = _concat(str, &len, "  \"HASHCOLUMN\": \"%s\",\n",
+                      view->hashcol);
+        if (!str)
+            return VIEW_ERR_MALLOC;
+    }
+
     str = _concat(str, &len,
                   "  \"TABLES\"    :\n"
                   "  [\n");
@@ -1086,6 +1094,7 @@ const char MONTHLY_STR[] = "monthly";
 const char YEARLY_STR[] = "yearly";
 const char TEST2MIN_STR[] = "test2min";
 const char MANUAL_STR[] = "manual";
+const char HASH_STR[] = "hash";
 const char INVALID_STR[] = "";
 
 const char *period_to_name(enum view_partition_period period)
@@ -1103,6 +1112,8 @@ const char *period_to_name(enum view_partition_period period)
         return TEST2MIN_STR;
     case VIEW_PARTITION_MANUAL:
         return MANUAL_STR;
+    case VIEW_PARTITION_HASH:
+        return HASH_STR;
     default:
         break;
     }
@@ -1123,6 +1134,8 @@ enum view_partition_period name_to_period(const char *str)
         return VIEW_PARTITION_TEST2MIN;
     if (!strcasecmp(str, MANUAL_STR))
         return VIEW_PARTITION_MANUAL;
+    if (!strcasecmp(str, HASH_STR))
+        return VIEW_PARTITION_HASH;
 
     return VIEW_PARTITION_INVALID;
 }
@@ -1430,6 +1443,17 @@ static timepart_view_t *partition_deserialize_cson_value(cson_value *cson_view,
         if (!view)
             goto error;
 
+        if (period == VIEW_PARTITION_HASH) {
+            tmp_str = _cson_extract_str(obj, "HASHCOLUMN", err);
+            if (!tmp_str) {
+                errs = "Wrong JSON format, HASHCOLUMN missing";
+                goto error;
+            }
+            view->hashcol = strdup(tmp_str);
+            if (!view->hashcol)
+                goto oom;
+        }
+
         /* TABLES */
         tbl_arr = _cson_extract_array(obj, "TABLES", err);
         if (!tbl_arr) {
@@ -1620,7 +1644,7 @@ char *convert_to_start_string(enum view_partition_period period, int value,
 {
     if (IS_TIMEPARTITION(period))
         return convert_epoch_to_time_string(value, buf, buflen);
-    if (period == VIEW_PARTITION_MANUAL) {
+    if (period == VIEW_PARTITION_MANUAL || period == VIEW_PARTITION_HASH) {
         snprintf(buf, buflen, "%d", value);
         return buf;
     }
@@ -1632,7 +1656,7 @@ int convert_from_start_string(enum view_partition_period period,
 {
     if (IS_TIMEPARTITION(period))
         return convert_time_string_to_epoch(str);
-    if (period == VIEW_PARTITION_MANUAL)
+    if (period == VIEW_PARTITION_MANUAL || period == VIEW_PARTITION_HASH)
         return atoi(str);
 
     abort();
@@ -208,9 +208,19 @@ static char *_views_create_view_query(timepart_view_t *view, sqlite3 *db,
     /* TODO: put conditions for shards */
     select_str = sqlite3_mprintf("");
     for (i = 0; i < view->nshards; i++) {
-        tmp_str = sqlite3_mprintf("%s%sSELECT %s FROM \"%w\"", select_str,
-                                  (i > 0) ? " UNION ALL " : "", cols_str,
-                                  view->shards[i].tblname);
+        if (view->period == VIEW_PARTITION_HASH) {
+            /* the filter lets the planner drop the shards a point
+               query cannot match; it is never evaluated per row */
+            tmp_str = sqlite3_mprintf(
+                "%s%sSELECT %s FROM \"%w\" WHERE "
+                "partition_hash(\"%w\", %d) = %d",
+                select_str, (i > 0) ? " UNION ALL " : "", cols_str,
+                view->shards[i].tblname, view->hashcol, view->nshards, i);
+        } else {
+            tmp_str = sqlite3_mprintf("%s%sSELECT %s FROM \"%w\"",
+                                      select_str, (i > 0) ? " UNION ALL " : "",
+                                      cols_str, view->shards[i].tblname);
+        }
         sqlite3_free(select_str);
         if (!tmp_str) {
             sqlite3_free(cols_str);
@@ -55,6 +55,11 @@ SELECT * FROM B;
  * It is on the 2nd action, the actual views switch, at which point
  * the insert will move to the lastest shard.
  *
+ * Hash partitions have no current shard; every statement of a trigger is
+ * guarded by "partition_hash(key, nshards) = i", which only depends on the
+ * trigger row and is evaluated once, so only the shard owning the key is
+ * touched.  An update that changes the shard of a row deletes it from the
+ * old shard and inserts it into the new one.
  *
  */
 
@@ -62,11 +67,93 @@ SELECT * FROM B;
 #define TRIGGER_SUFFIX_INS "ins"
 #define TRIGGER_SUFFIX_DEL "del"
 
+/* hash key of a trigger row, converted like the column would convert it */
+static char *_views_hash_key(timepart_view_t *view, const char *prefix,
+                             int use_default, struct errstat *err)
+{
+    struct dbtable *gdb;
+    struct field *fld;
+    char *in_default;
+    char *ret_str;
+    int idx;
+
+    gdb = get_dbtable_by_name(view->shards[0].tblname);
+    if (!gdb) {
+        errstat_set_rcstrf(err, VIEW_ERR_BUG, "Missing shard %s???",
+                           view->shards[0].tblname);
+        return NULL;
+    }
+    idx = find_field_idx_in_tag(gdb->schema, view->hashcol);
+    if (idx < 0) {
+        errstat_set_rcstrf(err, VIEW_ERR_BUG, "Missing hash column %s",
+                           view->hashcol);
+        return NULL;
+    }
+    fld = &gdb->schema->member[idx];
+
+    if (use_default && fld->in_default) {
+        in_default = sql_field_default_trans(fld, 0);
+        if (!in_default)
+            goto oom;
+        ret_str = sqlite3_mprintf(
+            "CAST(coalesce(%s.\"%w\", %s) AS %s)", prefix, fld->name,
+            in_default,
+            (fld->type == SERVER_BINT || fld->type == SERVER_UINT) ? "INTEGER"
+                                                                  : "TEXT");
+        sqlite3_free(in_default);
+    } else {
+        ret_str = sqlite3_mprintf(
+            "CAST(%s.\"%w\" AS %s)", prefix, fld->name,
+            (fld->type == SERVER_BINT || fld->type == SERVER_UINT) ? "INTEGER"
+                                                                  : "TEXT");
+    }
+    if (!ret_str)
+        goto oom;
+
+    return ret_str;
+
+oom:
+    errstat_set_rc(err, VIEW_ERR_MALLOC);
+    errstat_set_strf(err, "%s Malloc OOM", __func__);
+    return NULL;
+}
+
+/* "new.col1, new.col2, ..." for moving an updated row to another shard */
+static char *_views_new_row(timepart_view_t *view, struct errstat *err)
+{
+    struct dbtable *gdb;
+    char *cols_str;
+    char *tmp_str;
+    int i;
+
+    gdb = get_dbtable_by_name(view->shards[0].tblname);
+    if (!gdb) {
+        errstat_set_rcstrf(err, VIEW_ERR_BUG, "Missing shard %s???",
+                           view->shards[0].tblname);
+        return NULL;
+    }
+
+    cols_str = sqlite3_mprintf("");
+    for (i = 0; cols_str && i < gdb->schema->nmembers; i++) {
+        tmp_str = sqlite3_mprintf("%snew.\"%w\"%s", cols_str,
+                                  gdb->schema->member[i].name,
+                                  (i < (gdb->schema->nmembers - 1)) ? ", " : "");
+        sqlite3_free(cols_str);
+        cols_str = tmp_str;
+    }
+    if (!cols_str) {
+        errstat_set_rc(err, VIEW_ERR_MALLOC);
+        errstat_set_strf(err, "%s Malloc OOM", __func__);
+    }
+    return cols_str;
+}
+
 char *_views_create_delete_trigger_query(timepart_view_t *view,
                                          struct errstat *err)
 {
     char *ret_str = NULL;
     char *tmp_str = NULL;
+    char *key_str = NULL;
 
     int i;
 
@@ -76,13 +163,28 @@ char *_views_create_delete_trigger_query(timepart_view_t *view,
     if (!ret_str) {
         goto oom;
     }
+    if (view->period == VIEW_PARTITION_HASH) {
+        key_str = _views_hash_key(view, "old", 0, err);
+        if (!key_str) {
+            sqlite3_free(ret_str);
+            return NULL;
+        }
+    }
     for (i = 0; i < view->nshards; i++) {
-        tmp_str = sqlite3_mprintf(
-            "%s\nDELETE FROM \"%w\" where rowid=old.__hidden__rowid;", ret_str,
-            view->shards[i].tblname);
+        if (key_str) {
+            tmp_str = sqlite3_mprintf(
+                "%s\nDELETE FROM \"%w\" where rowid=old.__hidden__rowid and "
+                "partition_hash(%s, %d) = %d;",
+                ret_str, view->shards[i].tblname, key_str, view->nshards, i);
+        } else {
+            tmp_str = sqlite3_mprintf(
+                "%s\nDELETE FROM \"%w\" where rowid=old.__hidden__rowid;",
+                ret_str, view->shards[i].tblname);
+        }
         sqlite3_free(ret_str);
         ret_str = tmp_str;
     }
+    sqlite3_free(key_str);
     tmp_str = sqlite3_mprintf("%s\nEND;", ret_str);
     sqlite3_free(ret_str);
     ret_str = tmp_str;
@@ -136,6 +238,9 @@ char *_views_create_update_trigger_query(timepart_view_t *view,
     char *ret_str = NULL;
     char *tmp_str = NULL;
     char *cols_str = NULL;
+    char *old_key = NULL;
+    char *new_key = NULL;
+    char *new_row = NULL;
 
     int i;
 
@@ -155,13 +260,46 @@ char *_views_create_update_trigger_query(timepart_view_t *view,
         return NULL;
     }
 
+    if (view->period == VIEW_PARTITION_HASH) {
+        old_key = _views_hash_key(view, "old", 0, err);
+        new_key = _views_hash_key(view, "new", 0, err);
+        new_row = _views_new_row(view, err);
+        if (!old_key || !new_key || !new_row) {
+            sqlite3_free(old_key);
+            sqlite3_free(new_key);
+            sqlite3_free(new_row);
+            sqlite3_free(cols_str);
+            sqlite3_free(ret_str);
+            return NULL;
+        }
+    }
+
     for (i = 0; i < view->nshards; i++) {
-        tmp_str = sqlite3_mprintf(
-            "%s\nUPDATE \"%w\" SET %s where rowid=old.__hidden__rowid;", ret_str,
-            view->shards[i].tblname, cols_str);
+        if (view->period == VIEW_PARTITION_HASH) {
+            /* update in place, or move the row to its new shard */
+            tmp_str = sqlite3_mprintf(
+                "%s\nUPDATE \"%w\" SET %s where rowid=old.__hidden__rowid and "
+                "partition_hash(%s, %d) = %d and partition_hash(%s, %d) = %d;"
+                "\nDELETE FROM \"%w\" where rowid=old.__hidden__rowid and "
+                "partition_hash(%s, %d) = %d and partition_hash(%s, %d) <> %d;"
+                "\nINSERT INTO \"%w\" SELECT %s where "
+                "partition_hash(%s, %d) <> %d and partition_hash(%s, %d) = %d;",
+                ret_str, view->shards[i].tblname, cols_str, old_key,
+                view->nshards, i, new_key, view->nshards, i,
+                view->shards[i].tblname, old_key, view->nshards, i, new_key,
+                view->nshards, i, view->shards[i].tblname, new_row, old_key,
+                view->nshards, i, new_key, view->nshards, i);
+        } else {
+            tmp_str = sqlite3_mprintf(
+                "%s\nUPDATE \"%w\" SET %s where rowid=old.__hidden__rowid;",
+                ret_str, view->shards[i].tblname, cols_str);
+        }
         sqlite3_free(ret_str);
         ret_str = tmp_str;
     }
+    sqlite3_free(old_key);
+    sqlite3_free(new_key);
+    sqlite3_free(new_row);
     tmp_str = sqlite3_mprintf("%s\nEND;", ret_str);
     sqlite3_free(ret_str);
     ret_str = tmp_str;
@@ -186,6 +324,49 @@ char *_views_destroy_update_trigger_query(const char *view_name,
     return _views_destroy_trigger_query(view_name, err, TRIGGER_SUFFIX_UPD, "update");
 }
 
+/* one guarded insert per shard; only the shard owning the key matches */
+static char *_views_create_hash_insert_trigger_query(timepart_view_t *view,
+                                                     const char *cols_str,
+                                                     struct errstat *err)
+{
+    char *ret_str = NULL;
+    char *tmp_str = NULL;
+    char *key_str = NULL;
+    int i;
+
+    key_str = _views_hash_key(view, "new", 1, err);
+    if (!key_str)
+        return NULL;
+
+    ret_str = sqlite3_mprintf(
+        "CREATE TRIGGER \"%w_%w\" INSTEAD OF INSERT ON \"%w\" BEGIN",
+        view->name, TRIGGER_SUFFIX_INS, view->name);
+    for (i = 0; ret_str && i < view->nshards; i++) {
+        tmp_str = sqlite3_mprintf(
+            "%s\nINSERT INTO \"%w\" SELECT %s where partition_hash(%s, %d) = %d;",
+            ret_str, view->shards[i].tblname, cols_str, key_str, view->nshards,
+            i);
+        sqlite3_free(ret_str);
+        ret_str = tmp_str;
+    }
+    sqlite3_free(key_str);
+    if (ret_str) {
+        tmp_str = sqlite3_mprintf("%s\nEND;\n", ret_str);
+        sqlite3_free(ret_str);
+        ret_str = tmp_str;
+    }
+    if (!ret_str) {
+        errstat_set_rc(err, VIEW_ERR_MALLOC);
+        errstat_set_strf(err, "%s Malloc OOM", __func__);
+        return NULL;
+    }
+
+    errstat_set_rc(err, VIEW_NOERR);
+
+    dbg_verbose_sqlite("Generated insert trigger:\n%s\n", ret_str);
+    return ret_str;
+}
+
 char *_views_create_insert_trigger_query(timepart_view_t *view,
                                          struct errstat *err)
 {
@@ -200,6 +381,12 @@ char *_views_create_insert_trigger_query(timepart_view_t *view,
         goto oom;
     }
 
+    if (view->period == VIEW_PARTITION_HASH) {
+        ret_str = _views_create_hash_insert_trigger_query(view, cols_str, err);
+        sqlite3_free(cols_str);
+        return ret_str;
+    }
+
     ret_str = sqlite3_mprintf(
         "CREATE TRIGGER \"%w_%w\" INSTEAD OF INSERT ON \"%w\" BEGIN\n"
         "INSERT INTO \"%w\" VALUES ( %s );\n"
@@ -361,6 +361,7 @@ set all_graphs {
         {line REBUILD}
         {line REC {or NONE CRLE LZ4 RLE ZLIB}}
         {line BLOBFIELD {or NONE LZ4 RLE ZLIB}}
+        {line INLINE /integer}
     } ,}
   }
 
@@ -781,6 +782,7 @@ stack
       or
       {opt TIME PERIOD /period RETENTION /retention START /partition-start-time}
       {opt MANUAL RETENTION /retention {opt START /partition-start-number}}
+      {opt HASH ( column-name ) PARTITIONS /number-of-shards}
   }
 
   alter-table-ddl {
@@ -92,8 +92,20 @@
     ((p)[COMDB2MA_SENTINEL_OFS] ==                                             \
      COMDB2MA_SENTINEL((p) + COMDB2MA_SENTINEL_OFS, (p)[COMDB2MA_ALLOC_OFS]))
 
-#define COMDB2MA_MALLINFO_SAFE(cm)                                             \
-    ((cm)->use_lock ? mspace_mallinfo((cm)->m) : mspace_mallinfo_fast((cm)->m))
+#define COMDB2MA_MALLINFO_SAFE(cm) ma_mallinfo_safe(cm)
+
+/* dlmalloc is built without FOOTERS and MMAP, hence 1 word of chunk overhead */
+#define COMDB2MA_CHUNK_SZ(p)                                                   \
+    (dlmalloc_usable_size((void **)(p) + COMDB2MA_SENTINEL_OFS) + sizeof(size_t))
+
+/* thread cache geometry */
+#define COMDB2MA_TCACHE_SLOTS 4
+#define COMDB2MA_TCACHE_CLASSES 32
+#define COMDB2MA_TCACHE_GRAIN 32
+#define COMDB2MA_TCACHE_MAX_SZ                                                 \
+    ((COMDB2MA_TCACHE_CLASSES - 1) * COMDB2MA_TCACHE_GRAIN)
+#define COMDB2MA_TCACHE_SLOT(cm)                                               \
+    (((uintptr_t)(cm) >> 6) % COMDB2MA_TCACHE_SLOTS)
 
 #ifdef COMDB2MA_MEMABRT
 #define COMDB2MA_MEMCHK(m, sz)                                                 \
@@ -165,6 +177,8 @@ struct comdb2mspace {
                              we do not write it to name because an allocator
                              may be reused by another type of thread later on */
     unsigned int debug : 1; /* Debugging flag. */
+    unsigned int tcache : 1; /* 1 if freed blocks may be thread-cached */
+    size_t tcached;          /* bytes of chunks sitting in thread caches */
 
     size_t len;   /* length of name */
     char name[1]; /* name of the mspace */
@@ -213,6 +227,27 @@ typedef struct pair {
 
 /* for ctrace() */
 typedef void (*trc_t)(const char *, ...);
+
+/*
+** Thread cache. Small blocks freed to a subsystem allocator are kept on a
+** per-thread, per-size-class free list and handed out again by
+** comdb2_malloc() without taking the allocator lock. Blocks freed by a
+** thread other than the owner are batched the same way and returned to the
+** owning mspace under a single lock acquisition once a bin fills up.
+** Cached blocks are still in use as far as dlmalloc is concerned. Their chunk
+** sizes are tracked in `tcached' and reported as free by mallinfo, so the
+** per-subsystem numbers stay exact.
+*/
+struct ma_tcache_slot {
+    comdb2ma cm;                              /* owning allocator */
+    void **bins[COMDB2MA_TCACHE_CLASSES];     /* blocks, linked via payload */
+    int nbins[COMDB2MA_TCACHE_CLASSES];       /* # of blocks in each bin */
+    size_t bytes[COMDB2MA_TCACHE_CLASSES];    /* chunk bytes in each bin */
+};
+
+struct ma_tcache {
+    struct ma_tcache_slot slots[COMDB2MA_TCACHE_SLOTS];
+};
 // type definitions$
 
 //^static variables and function prototypes
@@ -257,6 +292,13 @@ static struct {
           .nice = 0};
 
 int gbl_mem_nice = 0;
+/* max # of blocks cached per size class per allocator. 0 disables. */
+int gbl_mem_tcache_max = 32;
+
+static pthread_once_t tcache_once = PTHREAD_ONCE_INIT;
+static pthread_key_t tcache_key;
+static __thread struct ma_tcache *t_tcache;
+static __thread int t_tcache_exited;
 
 /* internal comdb2ma creation */
 static comdb2ma comdb2ma_create_int(void *base, size_t init_sz, size_t max_cap,
@@ -268,6 +310,14 @@ static comdb2ma comdb2ma_create_int(void *base, size_t init_sz, size_t max_cap,
 /* internal comdb2ma deletion */
 static int comdb2ma_destroy_int(comdb2ma cm);
 
+/* return `n' blocks, linked via payload, to `cm' */
+static void comdb2_free_int(comdb2ma cm, void *ptr, int n);
+
+/* thread cache */
+static struct mallinfo ma_mallinfo_safe(const comdb2ma cm);
+static void *ma_tcache_take(comdb2ma cm, size_t size);
+static int ma_tcache_put(comdb2ma cm, void **p);
+
 #ifdef PER_THREAD_MALLOC
 __thread const char *thread_type_key;
 static __thread comdb2ma *t_zone;
@@ -447,7 +497,9 @@ int comdb2ma_init(size_t init_sz, size_t max_cap)
                     NULL, COMDB2MA_MT_SAFE, NULL, NULL, __FILE__, __func__,
                     __LINE__);
 
-                if (COMDB2_STATIC_MAS[i] == NULL) {
+                if (COMDB2_STATIC_MAS[i] != NULL)
+                    COMDB2_STATIC_MAS[i]->tcache = 1;
+                else {
                     /* oops. rollback all previous progress */
                     rc = errno;
                     for (--i; i != 0; --i) {
@@ -792,6 +844,8 @@ void *comdb2_malloc(comdb2ma cm, size_t size)
     if (size > COMDB2MA_MAX_MEM) {
         // force failure if integer overflow
         errno = ENOMEM;
+    } else if (!(d && cm->debug) && (out = ma_tcache_take(cm, size)) != NULL) {
+        return (void *)out;
     } else if (COMDB2MA_LOCK(cm) == 0) {
         if (!COMDB2MA_FULL(cm))
             out = mspace_malloc(cm->m, size + COMDB2MA_OVERHEAD(d));
@@ -837,6 +891,9 @@ void *comdb2_calloc(comdb2ma cm, size_t n, size_t size)
     if (n && size && COMDB2MA_MAX_MEM / n < size) {
         // force failure if integer overflow
         errno = ENOMEM;
+    } else if (!(d && cm->debug) && (out = ma_tcache_take(cm, n * size)) != NULL) {
+        memset(out, 0, n * size);
+        return (void *)out;
     } else if (COMDB2MA_LOCK(cm) == 0) {
         nb = n * size;
         if (!COMDB2MA_FULL(cm))
@@ -974,14 +1031,18 @@ void *comdb2_resize(comdb2ma cm, void *ptr, size_t n)
     return (void *)out;
 }
 
-static void comdb2_free_int(comdb2ma cm, void *ptr)
+static void comdb2_free_int(comdb2ma cm, void *ptr, int n)
 {
-    void **p = (void **)ptr;
+    void **p = (void **)ptr, **next;
+    int i;
 
     if (COMDB2MA_LOCK(cm) == 0) {
-        mspace_free(cm->m, p + COMDB2MA_SENTINEL_OFS);
+        for (i = 0; i != n; ++i, p = next) {
+            next = (void **)p[0];
+            mspace_free(cm->m, p + COMDB2MA_SENTINEL_OFS);
+        }
 #ifdef PER_THREAD_MALLOC
-        --cm->refs;
+        cm->refs -= n;
 
         /*
          * We must use (cm->nthds == 0) instead of (cm->nthds == 1) because
@@ -1041,10 +1102,10 @@ void comdb2_free(void *ptr)
         } else {
             cm = COMDB2MA_ALLOCATOR(p);
 
-            if (cm->bm == NULL)
-                comdb2_free_int(cm, ptr);
-            else
+            if (cm->bm != NULL)
                 comdb2_bfree(cm->bm, ptr);
+            else if (!ma_tcache_put(cm, p))
+                comdb2_free_int(cm, ptr, 1);
         }
     }
 }
@@ -1257,6 +1318,8 @@ static comdb2ma comdb2ma_create_int(void *base, size_t init_sz, size_t max_cap,
     out->line = line;
 
     out->debug = (debug_master_switch | debug_switches[find_switch_index(name)]);
+    out->tcache = 0;
+    out->tcached = 0;
 
 #ifdef PER_THREAD_MALLOC
     out->refs = 0;
@@ -1354,6 +1417,7 @@ static comdb2ma get_area(int indx)
                         COMDB2_STATIC_MA_METAS[indx].name, NULL, 1, NULL, NULL,
                         __FILE__, __func__, __LINE__);
                     zone[indx]->onfreelist = indx;
+                    zone[indx]->tcache = 1;
                     zone[indx]->debug = (debug_master_switch | debug_switches[indx]);
                     listc_abl(&root.busylist[indx], zone[indx]);
                 } else {
@@ -1448,6 +1512,150 @@ static void destroy_zone(void *arg)
 }
 #endif
 
+static struct mallinfo ma_mallinfo_safe(const comdb2ma cm)
+{
+    size_t cached;
+    struct mallinfo info = cm->use_lock ? mspace_mallinfo(cm->m)
+                                        : mspace_mallinfo_fast(cm->m);
+    /* thread-cached blocks are free from the callers' point of view */
+    cached = __atomic_load_n(&cm->tcached, __ATOMIC_RELAXED);
+    info.uordblks -= cached;
+    info.fordblks += cached;
+    return info;
+}
+
+static void ma_tcache_flush_bin(struct ma_tcache_slot *slot, int k)
+{
+    if (slot->nbins[k] == 0)
+        return;
+    /* cm may be destroyed as soon as the last block is returned */
+    __atomic_sub_fetch(&slot->cm->tcached, slot->bytes[k], __ATOMIC_RELAXED);
+    comdb2_free_int(slot->cm, slot->bins[k], slot->nbins[k]);
+    slot->bins[k] = NULL;
+    slot->nbins[k] = 0;
+    slot->bytes[k] = 0;
+}
+
+static void ma_tcache_flush(struct ma_tcache_slot *slot)
+{
+    int k;
+    for (k = 0; k != COMDB2MA_TCACHE_CLASSES; ++k)
+        ma_tcache_flush_bin(slot, k);
+    slot->cm = NULL;
+}
+
+static void ma_tcache_destroy(void *arg)
+{
+    struct ma_tcache *tc = (struct ma_tcache *)arg;
+    int i;
+
+    /* don't cache anything that is freed after us */
+    t_tcache_exited = 1;
+    t_tcache = NULL;
+
+    if (COMDB2MA_LOCK(&root) != 0)
+        return;
+    if (root.m != NULL) {
+        COMDB2MA_UNLOCK(&root);
+        for (i = 0; i != COMDB2MA_TCACHE_SLOTS; ++i)
+            if (tc->slots[i].cm != NULL)
+                ma_tcache_flush(&tc->slots[i]);
+        if (COMDB2MA_LOCK(&root) != 0)
+            return;
+        if (root.m != NULL)
+            mspace_free(root.m, tc);
+    }
+    COMDB2MA_UNLOCK(&root);
+}
+
+static void ma_tcache_key_init(void)
+{
+    Pthread_key_create(&tcache_key, ma_tcache_destroy);
+}
+
+/* take a block of at least `size' bytes from this thread's cache of `cm' */
+static void *ma_tcache_take(comdb2ma cm, size_t size)
+{
+    struct ma_tcache_slot *slot;
+    void **p;
+    size_t sz;
+    int k, end;
+
+    if (t_tcache == NULL || size > COMDB2MA_TCACHE_MAX_SZ)
+        return NULL;
+
+    slot = &t_tcache->slots[COMDB2MA_TCACHE_SLOT(cm)];
+    if (slot->cm != cm)
+        return NULL;
+
+    k = (size + COMDB2MA_TCACHE_GRAIN - 1) / COMDB2MA_TCACHE_GRAIN;
+    if (k == 0)
+        k = 1;
+    /* settle for a slightly larger block rather than going to the mspace */
+    end = (k + 2 < COMDB2MA_TCACHE_CLASSES) ? k + 2 : COMDB2MA_TCACHE_CLASSES;
+    for (; k != end; ++k) {
+        if ((p = slot->bins[k]) != NULL) {
+            slot->bins[k] = (void **)p[0];
+            --slot->nbins[k];
+            sz = COMDB2MA_CHUNK_SZ(p);
+            slot->bytes[k] -= sz;
+            __atomic_sub_fetch(&cm->tcached, sz, __ATOMIC_RELAXED);
+            return p;
+        }
+    }
+    return NULL;
+}
+
+/* cache a block freed by this thread. return 1 if cached. */
+static int ma_tcache_put(comdb2ma cm, void **p)
+{
+    struct ma_tcache *tc;
+    struct ma_tcache_slot *slot;
+    size_t sz;
+    int k;
+
+    if (!cm->tcache || gbl_mem_tcache_max <= 0 || t_tcache_exited ||
+        COMDB2MA_ISDEBUG(p))
+        return 0;
+
+    /* bin k only holds blocks with at least k * GRAIN bytes of payload */
+    k = comdb2_malloc_usable_size(p) / COMDB2MA_TCACHE_GRAIN;
+    if (k == 0 || k >= COMDB2MA_TCACHE_CLASSES)
+        return 0;
+
+    if ((tc = t_tcache) == NULL) {
+        pthread_once(&tcache_once, ma_tcache_key_init);
+        if (COMDB2MA_LOCK(&root) != 0)
+            return 0;
+        if (root.m != NULL)
+            tc = mspace_calloc(root.m, 1, sizeof(struct ma_tcache));
+        COMDB2MA_UNLOCK(&root);
+        if (tc == NULL)
+            return 0;
+        Pthread_setspecific(tcache_key, (void *)tc);
+        t_tcache = tc;
+    }
+
+    slot = &tc->slots[COMDB2MA_TCACHE_SLOT(cm)];
+    if (slot->cm != cm) {
+        if (slot->cm != NULL)
+            ma_tcache_flush(slot);
+        slot->cm = cm;
+    }
+
+    /* bin is full. hand the whole batch back to its mspace at once. */
+    if (slot->nbins[k] >= gbl_mem_tcache_max)
+        ma_tcache_flush_bin(slot, k);
+
+    sz = COMDB2MA_CHUNK_SZ(p);
+    p[0] = (void *)slot->bins[k];
+    slot->bins[k] = p;
+    ++slot->nbins[k];
+    slot->bytes[k] += sz;
+    __atomic_add_fetch(&cm->tcached, sz, __ATOMIC_RELAXED);
+    return 1;
+}
+
 static char *mem_to_human_readable(size_t num, char buf[], int len)
 {
     if (num >> 30) /* GB should be sufficient */
@@ -2822,7 +3030,7 @@ static void comdb2_bfree_int(comdb2bma ma, void *ptr, int lk)
     if (lk && COMDB2BMA_LOCK(ma) != 0)
         return;
 
-    comdb2_free_int(ma->alloc, ptr);
+    comdb2_free_int(ma->alloc, ptr, 1);
 
     if (mspace_footprint(ma->alloc->m) > ma->cap)
         comdb2_malloc_trim(ma->alloc, 0);
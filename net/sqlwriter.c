@@ -31,6 +31,8 @@
 //send heartbeat if no data every (seconds)
 #define min_hb_time 1
 
+int gbl_sql_zerocopy_min_bytes = KB(64);
+
 struct sqlwriter {
     sql_dispatch_timeout_fn *dispatch_timeout;
     struct sqlclntstate *clnt;
@@ -52,6 +54,7 @@ struct sqlwriter {
     unsigned timed_out : 1;
     unsigned wr_continue : 1;
     unsigned packing : 1; /* 1 if writer is in sql_pack_response and wr_lock is held. */
+    unsigned referenced : 1; /* 1 if wr_buf references data passed to sql_append_packed. */
     struct ssl_data *ssl_data;
     int (*wr_evbuffer_fn)(struct sqlwriter *, int);
 };
@@ -236,11 +239,44 @@ static int sql_pack_response(struct sqlwriter *writer, void *arg)
     return rc;
 }
 
+/* The writer failed while wr_buf still references data of the caller's that is
+ * about to go away. The connection is no good after this, so discard what is
+ * left. */
+static void sql_drop_references(struct sqlwriter *writer)
+{
+    if (!writer->referenced)
+        return;
+    evbuffer_drain(writer->wr_buf, evbuffer_get_length(writer->wr_buf));
+    writer->referenced = 0;
+}
+
+static int sql_flush_packed(struct sqlwriter *writer)
+{
+    int rc = sql_flush(writer);
+
+    /*
+     * After reacquiring `wr_lock', check again whether we should proceed,
+     * as the writer might have been marked bad by other callbacks
+     * (heartbeat, trickle, etc.).
+     */
+    if (rc != 0 || writer->bad || writer->timed_out) {
+        sql_drop_references(writer);
+        return -1;
+    }
+    writer->referenced = 0;
+    return 0;
+}
+
 /*
  * An 'append' callback to consume 'packed' data as it is being generated. The
  * function flushes every `SQLWRITER_MAX_BUF' many bytes, hence keeps the
  * memory use of the writer's evbuffer under `SQLWRITER_MAX_BUF'.
  *
+ * Pieces of at least `sql_zerocopy_min_bytes' (large column values) are added
+ * by reference instead of being copied. The caller's data (which may be a
+ * scratch buffer of the protobuf packer) is only good until we return, so the
+ * evbuffer is flushed before returning whenever a reference was added.
+ *
  * This is how the function gets invoked:
  * sql_write -> sql_pack_response -> newsql_pack -> sql_append_packed
  */
@@ -254,19 +290,12 @@ int sql_append_packed(struct sqlwriter *writer, const void *data, size_t len)
     while (nleft > 0) {
         if (evbuffer_get_length(wr_buf) >= SQLWRITER_MAX_BUF) {
             /* We've accumulated enough bytes, flush now. */
-            rc = sql_flush(writer);
-
-            /*
-             * After reacquiring `wr_lock', check again whether we should proceed,
-             * as the writer might have been marked bad by other callbacks
-             * (heartbeat, trickle, etc.).
-             */
-            if (rc != 0 || writer->bad || writer->timed_out)
+            if (sql_flush_packed(writer) != 0)
                 return -1;
         }
 
         int cap = SQLWRITER_MAX_BUF - evbuffer_get_length(wr_buf);
-        if (cap >= nleft) {
+        if (cap >= nleft && (gbl_sql_zerocopy_min_bytes <= 0 || nleft < gbl_sql_zerocopy_min_bytes)) {
             /* We're about to exit the loop. Do a copy here. */
             rc = evbuffer_add(wr_buf, ptr + (len - nleft), nleft);
             if (rc != 0)
@@ -274,16 +303,21 @@ int sql_append_packed(struct sqlwriter *writer, const void *data, size_t len)
             nleft = 0;
         } else {
             /*
-             * We know we'll continue the loop and do a flush, so we add
-             * a reference here to avoid copying the data.
+             * Either we'll continue the loop and do a flush, or the piece is
+             * large enough to be worth sending in place and we flush below.
+             * Add a reference here to avoid copying the data.
              */
-            rc = evbuffer_add_reference(wr_buf, ptr + (len - nleft), cap, NULL, NULL);
+            size_t n = cap < nleft ? cap : nleft;
+            rc = evbuffer_add_reference(wr_buf, ptr + (len - nleft), n, NULL, NULL);
             if (rc != 0)
                 return -1;
-            nleft -= cap;
+            writer->referenced = 1;
+            nleft -= n;
         }
     }
 
+    if (writer->referenced)
+        return sql_flush_packed(writer);
     return 0;
 }
 
@@ -299,6 +333,7 @@ int sql_write(struct sqlwriter *writer, void *arg, int flush)
         return -1;
     }
     if (sql_pack_response(writer, arg) != 0) {
+        sql_drop_references(writer);
         Pthread_mutex_unlock(&writer->wr_lock);
         return -1;
     }
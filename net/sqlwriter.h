@@ -23,6 +23,9 @@
 //writer will block if outstanding data hits:
 #define SQLWRITER_MAX_BUF KB(256)
 
+//column values this large are sent by reference instead of being copied
+extern int gbl_sql_zerocopy_min_bytes;
+
 struct dispatch_sql_arg;
 struct evbuffer;
 struct event_base;
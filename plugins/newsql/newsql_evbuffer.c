@@ -1021,10 +1021,29 @@ static void pb_evbuffer_append(ProtobufCBuffer *vbuf, size_t len, const uint8_t
         .vbuf = {.append = pb_evbuffer_append}, .sqlwriter = x, .rc = 0                                                \
     }
 
+/* Does the response carry a column value worth sending without a copy? */
+static int newsql_has_large_value(const CDB2SQLRESPONSE *resp)
+{
+    if (!resp || gbl_sql_zerocopy_min_bytes <= 0 || resp->response_type != RESPONSE_TYPE__COLUMN_VALUES)
+        return 0;
+    for (size_t i = 0; i < resp->n_values; ++i) {
+        if (resp->values[i].len >= gbl_sql_zerocopy_min_bytes)
+            return 1;
+    }
+    for (size_t i = 0; i < resp->n_value; ++i) {
+        if (resp->value[i]->value.len >= gbl_sql_zerocopy_min_bytes)
+            return 1;
+    }
+    return 0;
+}
+
 static int newsql_pack(struct sqlwriter *sqlwriter, void *data)
 {
     struct newsql_pack_arg *arg = data;
-    if (arg->resp_len <= SQLWRITER_MAX_BUF || arg->appdata->clnt.query_timeout) {
+    /* Large responses, and rows with large values, are streamed through
+     * sql_append_packed() which sends the values in place. */
+    if ((arg->resp_len <= SQLWRITER_MAX_BUF && !newsql_has_large_value(arg->resp)) ||
+        arg->appdata->clnt.query_timeout) {
         return newsql_pack_small(sqlwriter, arg);
     }
     struct pb_evbuffer_appender appender = PB_EVBUFFER_APPENDER_INIT(sqlwriter);
@@ -346,7 +346,8 @@ int finalize_add_table(struct ireq *iq, struct schema_change_type *s,
      * create partition here
      */
     if ((s->partition.type == PARTITION_ADD_TIMED ||
-         s->partition.type == PARTITION_ADD_MANUAL) && s->publish) {
+         s->partition.type == PARTITION_ADD_MANUAL ||
+         s->partition.type == PARTITION_ADD_COL_HASH) && s->publish) {
         struct errstat err = {0};
         assert(s->newpartition);
         rc = partition_llmeta_write(tran, s->newpartition, 0, &err);
@@ -491,6 +491,17 @@ int do_alter_table(struct ireq *iq, struct schema_change_type *s,
         return -1;
     }
 
+    /* rows of a hash partition are placed by the partitioning column */
+    if (timepart_hash_check_schema(s->tablename, newdb->schema, &err)) {
+        if (local_lock)
+            unlock_schema_lk();
+        backout(newdb);
+        cleanup_newdb(newdb);
+        sc_client_error(s, "%s", err.errstr);
+        sc_errf(s, "Failed to process schema!\n");
+        return -1;
+    }
+
     s->schema_change = changed =
         prepare_changes(s, db, newdb, &s->plan, &scinfo);
     if (changed == SC_UNKNOWN_ERROR) {
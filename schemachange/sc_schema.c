@@ -369,6 +369,14 @@ int set_header_and_properties(void *tran, struct dbtable *newdb,
         sc_errf(s, "Failed to set bthash size in meta\n");
         return SC_TRANSACTION_FAILED;
     }
+
+    /* a new table must not pick up the size of a dropped one */
+    if ((s->inline_blobs >= 0 || s->kind == SC_ADDTABLE) &&
+        put_db_inline_blobs(newdb, tran,
+                            s->inline_blobs > 0 ? s->inline_blobs : 0)) {
+        sc_errf(s, "Failed to set inline blob size in meta\n");
+        return SC_TRANSACTION_FAILED;
+    }
     return SC_OK;
 }
 
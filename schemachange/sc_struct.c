@@ -39,6 +39,7 @@ struct schema_change_type *init_schemachange_type(struct schema_change_type *sc)
     sc->compress_blobs = -1;
     sc->ip_updates = -1;
     sc->instant_sc = -1;
+    sc->inline_blobs = -1;
     sc->persistent_seq = -1;
     sc->dbnum = -1; /* -1 = not changing, anything else = set value */
     sc->source_node[0] = 0;
@@ -126,6 +127,9 @@ static size_t _partition_packed_size(struct comdb2_partition *p)
     case PARTITION_MERGE:
         return sizeof(p->type) + sizeof(p->u.mergetable.tablename) +
                sizeof(p->u.mergetable.version);
+    case PARTITION_ADD_COL_HASH:
+        return sizeof(p->type) + sizeof(p->u.hash.nshards) +
+               sizeof(p->u.hash.column);
     default:
         logmsg(LOGMSG_ERROR, "Unimplemented partition type %d\n", p->type);
         abort();
@@ -159,7 +163,7 @@ size_t schemachange_packed_size(struct schema_change_type *s)
         dests_field_packed_size(s) + sizeof(s->spname_len) + s->spname_len +
         sizeof(s->lua_func_flags) + sizeof(s->newtable) +
         sizeof(s->usedbtablevers) + sizeof(s->qdb_file_ver) +
-        _partition_packed_size(&s->partition);
+        _partition_packed_size(&s->partition) + sizeof(s->inline_blobs);
 
     return s->packed_len;
 }
@@ -312,8 +316,19 @@ void *buf_put_schemachange(struct schema_change_type *s, void *p_buf, void *p_bu
                         sizeof(s->partition.u.mergetable.version), p_buf, p_buf_end);
         break;
     }
+    case PARTITION_ADD_COL_HASH: {
+        p_buf = buf_put(&s->partition.u.hash.nshards,
+                        sizeof(s->partition.u.hash.nshards), p_buf, p_buf_end);
+        p_buf = buf_no_net_put(s->partition.u.hash.column,
+                               sizeof(s->partition.u.hash.column), p_buf,
+                               p_buf_end);
+        break;
+    }
     }
 
+    p_buf =
+        buf_put(&s->inline_blobs, sizeof(s->inline_blobs), p_buf, p_buf_end);
+
     return p_buf;
 }
 
@@ -735,8 +750,22 @@ void *buf_get_schemachange_v2(struct schema_change_type *s,
                                    p_buf_end);
         break;
     }
+    case PARTITION_ADD_COL_HASH: {
+        p_buf = (uint8_t *)buf_get(&s->partition.u.hash.nshards,
+                                   sizeof(s->partition.u.hash.nshards), p_buf,
+                                   p_buf_end);
+        p_buf = (uint8_t *)buf_no_net_get(s->partition.u.hash.column,
+                                          sizeof(s->partition.u.hash.column),
+                                          p_buf, p_buf_end);
+        break;
+    }
     }
 
+    /* not present in schema changes packed by older versions */
+    if (p_buf && p_buf < p_buf_end)
+        p_buf = (uint8_t *)buf_get(&s->inline_blobs, sizeof(s->inline_blobs),
+                                   p_buf, p_buf_end);
+
     return p_buf;
 }
 
@@ -83,6 +83,10 @@ struct comdb2_partition {
             char tablename[MAXTABLELEN];
             int version;
         } mergetable;
+        struct hashed {
+            uint32_t nshards;
+            char column[MAXCOLNAME + 1];
+        } hash;
     } u;
 };
 
@@ -167,6 +171,7 @@ struct schema_change_type {
     int persistent_seq; /* init queue with persistent sequence */
     int ip_updates;     /* inplace updates or -1 for no change */
     int instant_sc;     /* 1 is enable, 0 disable, or -1 for no change */
+    int inline_blobs;   /* OPTIONS INLINE size or -1 for no change */
     int preempted;
     int use_plan;         /* if we want to use a plan so we don't rebuild
                              everything needlessly. */
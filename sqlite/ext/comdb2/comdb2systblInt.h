@@ -100,6 +100,9 @@ int systblFdbInfoInit(sqlite3 *db);
 int systblTranCommitInit(sqlite3 *db);
 int systblTransactionStateInit(sqlite3 *db);
 int systblMemstatsInit(sqlite3 *db);
+int systblLatencyHistogramsInit(sqlite3 *db);
+int systblSqlFairshareInit(sqlite3 *db);
+int systblPageCompactionInit(sqlite3 *db);
 int systblStacks(sqlite3 *db);
 int systblPreparedInit(sqlite3 *db);
 int systblSchemaVersionsInit(sqlite3 *db);
@@ -0,0 +1,55 @@
+/*
+   Copyright 2024 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+#include "comdb2.h"
+#include "comdb2systblInt.h"
+#include "ezsystables.h"
+#include "histogram.h"
+
+sqlite3_module systblLatencyHistogramsModule = {
+    .access_flag = CDB2_ALLOW_USER,
+};
+
+static int get_histograms(void **data, int *npoints)
+{
+    return comdb2_histogram_get_stats((comdb2_histogram_stats **)data, npoints);
+}
+
+static void free_histograms(void *data, int npoints)
+{
+    comdb2_histogram_stats_free(data, npoints);
+}
+
+int systblLatencyHistogramsInit(sqlite3 *db)
+{
+    return create_system_table(db, "comdb2_latency_histograms",
+            &systblLatencyHistogramsModule, get_histograms, free_histograms,
+            sizeof(comdb2_histogram_stats),
+            CDB2_CSTRING, "name", -1, offsetof(comdb2_histogram_stats, name),
+            CDB2_CSTRING, "description", -1, offsetof(comdb2_histogram_stats, description),
+            CDB2_INTEGER, "count", -1, offsetof(comdb2_histogram_stats, count),
+            CDB2_REAL, "mean_us", -1, offsetof(comdb2_histogram_stats, mean),
+            CDB2_INTEGER, "p50_us", -1, offsetof(comdb2_histogram_stats, p50),
+            CDB2_INTEGER, "p90_us", -1, offsetof(comdb2_histogram_stats, p90),
+            CDB2_INTEGER, "p99_us", -1, offsetof(comdb2_histogram_stats, p99),
+            CDB2_INTEGER, "p999_us", -1, offsetof(comdb2_histogram_stats, p999),
+            CDB2_INTEGER, "max_us", -1, offsetof(comdb2_histogram_stats, max),
+            SYSTABLE_END_OF_FIELDS);
+}
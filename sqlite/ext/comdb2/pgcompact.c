@@ -0,0 +1,56 @@
+/*
+   Copyright 2024 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+#include "comdb2.h"
+#include "comdb2systblInt.h"
+#include "ezsystables.h"
+#include "pgcompact.h"
+
+sqlite3_module systblPageCompactionModule = {
+    .access_flag = CDB2_ALLOW_USER,
+};
+
+static int get_files(void **data, int *npoints)
+{
+    return pgcompact_get_stats((pgcompact_stats **)data, npoints);
+}
+
+static void free_files(void *data, int npoints)
+{
+    pgcompact_stats_free(data, npoints);
+}
+
+int systblPageCompactionInit(sqlite3 *db)
+{
+    return create_system_table(db, "comdb2_page_compaction",
+            &systblPageCompactionModule, get_files, free_files,
+            sizeof(pgcompact_stats),
+            CDB2_CSTRING, "tablename", -1, offsetof(pgcompact_stats, tablename),
+            CDB2_CSTRING, "filetype", -1, offsetof(pgcompact_stats, filetype),
+            CDB2_INTEGER, "filenum", -1, offsetof(pgcompact_stats, filenum),
+            CDB2_INTEGER, "pages", -1, offsetof(pgcompact_stats, pages),
+            CDB2_INTEGER, "next_page", -1, offsetof(pgcompact_stats, next_page),
+            CDB2_INTEGER, "passes", -1, offsetof(pgcompact_stats, passes),
+            CDB2_INTEGER, "pages_scanned", -1, offsetof(pgcompact_stats, pages_scanned),
+            CDB2_INTEGER, "sparse_pages", -1, offsetof(pgcompact_stats, sparse_pages),
+            CDB2_INTEGER, "pages_freed", -1, offsetof(pgcompact_stats, pages_freed),
+            CDB2_INTEGER, "bytes_reclaimed", -1, offsetof(pgcompact_stats, bytes_reclaimed),
+            SYSTABLE_END_OF_FIELDS);
+}
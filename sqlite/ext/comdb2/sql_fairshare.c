@@ -0,0 +1,58 @@
+/*
+   Copyright 2024 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+#include "comdb2.h"
+#include "comdb2systblInt.h"
+#include "ezsystables.h"
+#include "sql_fairshare.h"
+
+sqlite3_module systblSqlFairshareModule = {
+    .access_flag = CDB2_ALLOW_USER,
+};
+
+static int get_classes(void **data, int *npoints)
+{
+    return sql_fairshare_get_stats((sql_fairshare_stats **)data, npoints);
+}
+
+static void free_classes(void *data, int npoints)
+{
+    sql_fairshare_stats_free(data, npoints);
+}
+
+int systblSqlFairshareInit(sqlite3 *db)
+{
+    return create_system_table(db, "comdb2_sql_fairshare",
+            &systblSqlFairshareModule, get_classes, free_classes,
+            sizeof(sql_fairshare_stats),
+            CDB2_CSTRING, "class", -1, offsetof(sql_fairshare_stats, name),
+            CDB2_INTEGER, "share", -1, offsetof(sql_fairshare_stats, share),
+            CDB2_INTEGER, "max_concurrent", -1, offsetof(sql_fairshare_stats, max_concurrent),
+            CDB2_INTEGER, "running", -1, offsetof(sql_fairshare_stats, running),
+            CDB2_INTEGER, "waiting", -1, offsetof(sql_fairshare_stats, waiting),
+            CDB2_INTEGER, "dispatched", -1, offsetof(sql_fairshare_stats, dispatched),
+            CDB2_INTEGER, "queued", -1, offsetof(sql_fairshare_stats, queued),
+            CDB2_INTEGER, "queue_time_us", -1, offsetof(sql_fairshare_stats, queue_time_us),
+            CDB2_INTEGER, "max_queue_time_us", -1, offsetof(sql_fairshare_stats, max_queue_time_us),
+            CDB2_INTEGER, "cpu_us", -1, offsetof(sql_fairshare_stats, cpu_us),
+            CDB2_INTEGER, "cost", -1, offsetof(sql_fairshare_stats, cost),
+            CDB2_REAL, "vtime", -1, offsetof(sql_fairshare_stats, vtime),
+            SYSTABLE_END_OF_FIELDS);
+}
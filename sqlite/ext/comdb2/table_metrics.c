@@ -36,6 +36,10 @@ typedef struct systable_table_metrics {
     int64_t num_records_inserted;
     int64_t num_records_updated;
     int64_t num_records_deleted;
+    int64_t readahead_pages;
+    int64_t readahead_hits;
+    int64_t readahead_wasted;
+    int64_t deferred_index_writes;
 } systable_table_metrics_t;
 
 int get_table_metrics(void **data, int *nrecords) {
@@ -53,6 +57,13 @@ int get_table_metrics(void **data, int *nrecords) {
         systable[i].num_records_inserted = db->write_count[RECORD_WRITE_INS];
         systable[i].num_records_updated = db->write_count[RECORD_WRITE_UPD];
         systable[i].num_records_deleted = db->write_count[RECORD_WRITE_DEL];
+
+        uint64_t pages, hits, wasted;
+        bdb_get_readahead_stats(db->handle, &pages, &hits, &wasted);
+        systable[i].readahead_pages = pages;
+        systable[i].readahead_hits = hits;
+        systable[i].readahead_wasted = wasted;
+        systable[i].deferred_index_writes = db->deferred_ix_write_count;
     }
 
     *data = systable;
@@ -80,5 +91,9 @@ int systblTableMetricsInit(sqlite3 *db) {
         CDB2_INTEGER, "num_records_inserted", -1, offsetof(systable_table_metrics_t, num_records_inserted),
         CDB2_INTEGER, "num_records_updated", -1, offsetof(systable_table_metrics_t, num_records_updated),
         CDB2_INTEGER, "num_records_deleted", -1, offsetof(systable_table_metrics_t, num_records_deleted),
+        CDB2_INTEGER, "readahead_pages", -1, offsetof(systable_table_metrics_t, readahead_pages),
+        CDB2_INTEGER, "readahead_hits", -1, offsetof(systable_table_metrics_t, readahead_hits),
+        CDB2_INTEGER, "readahead_wasted", -1, offsetof(systable_table_metrics_t, readahead_wasted),
+        CDB2_INTEGER, "deferred_index_writes", -1, offsetof(systable_table_metrics_t, deferred_index_writes),
         SYSTABLE_END_OF_FIELDS);
 }
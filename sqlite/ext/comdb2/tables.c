@@ -226,6 +226,12 @@ int comdb2SystblInit(
     rc = sqlite3_carray_init(db, 0, 0);
   if (rc == SQLITE_OK)
     rc = systblMemstatsInit(db);
+  if (rc == SQLITE_OK)
+    rc = systblLatencyHistogramsInit(db);
+  if (rc == SQLITE_OK)
+    rc = systblSqlFairshareInit(db);
+  if (rc == SQLITE_OK)
+    rc = systblPageCompactionInit(db);
   if (rc == SQLITE_OK)
     rc = systblTransactionStateInit(db);
   if (rc == SQLITE_OK)
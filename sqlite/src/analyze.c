@@ -172,6 +172,7 @@ void get_disable_skipscan_all();
 
 static __thread int skip4;
 int64_t analyze_get_nrecs( int iTable );
+int analyze_is_skipped( int iTable );
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 
 /*
@@ -1315,6 +1316,8 @@ static void analyzeOneTable(
     if( pOnlyIdx && pOnlyIdx!=pIdx ) continue;
     if( pIdx->pPartIdxWhere==0 ) needTableCnt = 0;
 #if defined(SQLITE_BUILDING_FOR_COMDB2)
+    /* Index unchanged since the last analyze: keep its saved stats. */
+    if( iDb==0 && analyze_is_skipped(pIdx->tnum) ) continue;
     nCol = pIdx->nKeyCol;
     for(i=0; i < nCol; ++i){
       if( strcmp(pIdx->azColl[i], "DATACOPY")==0 ){
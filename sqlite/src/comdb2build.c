@@ -2909,6 +2909,8 @@ void comdb2WriteTransaction(Parse *pParse)
 enum {
     COLUMN_NO_NULL = 1 << 0,
     COLUMN_DELETED = 1 << 1,
+    /* Inline size was given by the table's OPTIONS INLINE */
+    COLUMN_INLINE_BLOB = 1 << 2,
 };
 
 typedef LISTC_T(struct comdb2_index_part) comdb2_index_part_lst;
@@ -2956,6 +2958,7 @@ enum {
     KEY_UNIQNULLS = 1 << 3,
     KEY_RECNUM = 1 << 4,
     KEY_PARTIALDATACOPY = 1 << 5,
+    KEY_DEFERWRITES = 1 << 6,
 };
 
 struct comdb2_partial_datacopy_field{
@@ -3068,6 +3071,8 @@ struct comdb2_ddl_context {
     /* Partitioning */
     struct comdb2_partition *partition;
     char *partition_first_shardname;
+    /* Inline size of blob and text columns (OPTIONS INLINE) */
+    int inline_blobs;
 };
 
 /* Type properties */
@@ -3615,6 +3620,10 @@ static char *format_csc2(struct comdb2_ddl_context *ctx)
             strbuf_append(csc2, "uniqnulls ");
         }
 
+        if ((key->flags & KEY_DEFERWRITES) != 0) {
+            strbuf_append(csc2, "deferwrites ");
+        }
+
         strbuf_appendf(csc2, "\"%s\" = ", key->name);
 
         int added = 0;
@@ -4039,6 +4048,40 @@ static struct comdb2_key *find_suitable_key(comdb2_index_part_lst *idx_col_list,
     return matched_key;
 }
 
+static int is_inline_blob_type(int type)
+{
+    switch (type) {
+    case SQL_TYPE_VUTF8:
+    case SQL_TYPE_TEXT:
+    case SQL_TYPE_BLOB:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/*
+  Give the blob and text columns an inline size of ctx->inline_blobs bytes, as
+  if they had been declared as BLOB(n) or TEXT(n): values that fit are kept in
+  the record, larger ones go to the blob files. Columns declared with a size of
+  their own keep it; those declared without one, including the ones an ALTER
+  adds, follow the table's size.
+*/
+static void apply_inline_blobs(struct comdb2_ddl_context *ctx)
+{
+    struct comdb2_column *column;
+
+    LISTC_FOR_EACH(&ctx->schema->column_list, column, lnk)
+    {
+        if (column->flags & COLUMN_DELETED)
+            continue;
+
+        if (is_inline_blob_type(column->type) &&
+            (column->len == 0 || (column->flags & COLUMN_INLINE_BLOB)))
+            column->len = ctx->inline_blobs;
+    }
+}
+
 static char *prepare_csc2(Parse *pParse, struct comdb2_ddl_context *ctx)
 {
     char *csc2;
@@ -4320,6 +4363,11 @@ static int retrieve_columns(Parse *pParse, struct comdb2_ddl_context *ctx,
         /* Convert type and length */
         prepare_column_for_csc2(column);
 
+        /* Remember which sizes the table's OPTIONS INLINE gave */
+        if (ctx->inline_blobs > 0 && is_inline_blob_type(column->type) &&
+            column->len == ctx->inline_blobs)
+            column->flags |= COLUMN_INLINE_BLOB;
+
         /* Add it to the list */
         listc_abl(&dst_schema->column_list, column);
     }
@@ -4551,6 +4599,7 @@ static int retrieve_schema(Parse *pParse, struct comdb2_ddl_context *ctx)
 
     /* Retrieve the table options. */
     ctx->schema->table_options = retrieve_table_options(table);
+    get_db_inline_blobs(table, &ctx->inline_blobs);
 
     /* Retrieve table columns. */
     if (retrieve_columns(pParse, ctx, schema, ctx->schema)) {
@@ -4606,6 +4655,11 @@ static int retrieve_schema(Parse *pParse, struct comdb2_ddl_context *ctx)
             key->flags |= KEY_UNIQNULLS;
         }
 
+        /* Only csc2 sets it, keep it across SQL ALTERs */
+        if (schema->ix[i]->flags & SCHEMA_DEFERWRITES) {
+            key->flags |= KEY_DEFERWRITES;
+        }
+
         listc_init(&key->partial_datacopy_list, offsetof(struct comdb2_partial_datacopy_field, lnk));
 
         if (schema->ix[i]->flags & SCHEMA_PARTIALDATACOPY) {
@@ -4861,6 +4915,8 @@ void comdb2AlterTableEnd(Parse *pParse)
     if(OPT_ON(ctx->schema->table_options, FORCE_SC)){
         sc->force = 1;
     }
+    apply_inline_blobs(ctx);
+    sc->inline_blobs = ctx->inline_blobs;
 
     if (ctx->partition) {
         sc->partition = *ctx->partition;
@@ -5034,6 +5090,8 @@ void comdb2CreateTableEnd(
     }
 
     fillTableOption(sc, comdb2Opts);
+    apply_inline_blobs(ctx);
+    sc->inline_blobs = ctx->inline_blobs;
 
     if (ctx->partition)
         sc->partition = *ctx->partition;
@@ -6914,9 +6972,40 @@ void comdb2AlterTableOptions(
     if (comdb2Opts & READ_ONLY) {
         *tableOpts |= READ_ONLY;
     }
+    if (comdb2Opts & INLINE_BLOBS) {
+        *tableOpts |= INLINE_BLOBS;
+    }
     return;
 }
 
+/*
+  OPTIONS INLINE <n>: store blob and text values of up to n bytes in the
+  record. Only SQL DDL has a column list to apply it to; with CSC2 the size is
+  given on each column.
+*/
+int comdb2InlineBlobsOption(Parse *pParse, Token *pSize)
+{
+    struct comdb2_ddl_context *ctx = pParse->comdb2_ddl_ctx;
+    int size;
+
+    if (comdb2IsPrepareOnly(pParse))
+        return 0;
+
+    if (ctx == 0) {
+        setError(pParse, SQLITE_MISUSE,
+                 "INLINE is only supported with SQL column definitions");
+        return 0;
+    }
+
+    if (!readIntFromToken(pSize, &size) || size < 0) {
+        setError(pParse, SQLITE_MISUSE, "Invalid INLINE size");
+        return 0;
+    }
+
+    ctx->inline_blobs = size;
+    return INLINE_BLOBS;
+}
+
 /*
   Implementation of PUT TUNABLE
  */
@@ -7612,6 +7701,88 @@ void comdb2CreateManualPartition(Parse *pParse, Token *retention, Token *start)
     partition->u.tpt.start = tmp;
 }
 
+/**
+ * Create Hash Partition
+ *
+ */
+void comdb2CreateHashPartition(Parse *pParse, Token *hash, Token *column,
+                               Token *partitions, Token *nshards)
+{
+    struct comdb2_partition *partition;
+    struct comdb2_ddl_context *ctx;
+    struct comdb2_column *col;
+    char colname[MAXCOLNAME + 1];
+    int32_t n;
+
+    if (!gbl_partitioned_table_enabled) {
+        setError(pParse, SQLITE_ABORT,
+                 "Create hash partitioned table not enabled");
+        return;
+    }
+
+    if (hash->n != 4 || sqlite3StrNICmp(hash->z, "hash", 4) ||
+        partitions->n != 10 ||
+        sqlite3StrNICmp(partitions->z, "partitions", 10)) {
+        setError(pParse, SQLITE_ERROR, "Invalid partitioning options");
+        return;
+    }
+
+    partition = _get_partition(pParse, 0);
+    if (!partition)
+        return;
+    ctx = pParse->comdb2_ddl_ctx;
+
+    if (_get_integer(nshards, &n) || n < 2 || n > 1000) {
+        setError(pParse, SQLITE_MISUSE,
+                 "Invalid number of partitions, expected 2 to 1000");
+        goto cleanup;
+    }
+
+    if (column->n > MAXCOLNAME) {
+        setError(pParse, SQLITE_MISUSE, "Invalid partitioning column");
+        goto cleanup;
+    }
+    strncpy0(colname, column->z, column->n + 1);
+    sqlite3Dequote(colname);
+
+    col = find_column_by_name(ctx, colname);
+    if (!col) {
+        setError(pParse, SQLITE_ERROR, "Partitioning column not found");
+        goto cleanup;
+    }
+    switch (col->type) {
+    case SQL_TYPE_SHORT:
+    case SQL_TYPE_USHORT:
+    case SQL_TYPE_INT:
+    case SQL_TYPE_UINT:
+    case SQL_TYPE_LONGLONG:
+    case SQL_TYPE_ULONGLONG:
+    case SQL_TYPE_INTEGER:
+    case SQL_TYPE_SMALLINT:
+    case SQL_TYPE_BIGINT:
+    case SQL_TYPE_LARGEINT:
+    case SQL_TYPE_CSTRING:
+    case SQL_TYPE_VUTF8:
+    case SQL_TYPE_VARCHAR:
+    case SQL_TYPE_CHAR:
+    case SQL_TYPE_TEXT:
+        break;
+    default:
+        setError(pParse, SQLITE_ERROR,
+                 "Partitioning column must be an integer or a string");
+        goto cleanup;
+    }
+
+    partition->type = PARTITION_ADD_COL_HASH;
+    partition->u.hash.nshards = n;
+    strncpy0(partition->u.hash.column, col->name,
+             sizeof(partition->u.hash.column));
+    return;
+
+cleanup:
+    free_ddl_context(pParse);
+}
+
 /*
  * Mark the partition for merging, with or without a table to be merged in
  * If the table to be merged in is provided, its data will be moved to target
@@ -36,6 +36,7 @@
 #define REBUILD_DATA  0x00800000
 #define REBUILD_BLOB  0x01000000
 #define FORCE_SC      0x02000000
+#define INLINE_BLOBS  0x04000000
 
 #define OPT_ON(opt, val) (val & opt)
 
@@ -52,6 +53,7 @@ int  comdb2SqlSchemaChange(OpFunc *);
 int  comdb2SqlSchemaChange_tran(OpFunc *arg);
 void comdb2CreateTableCSC2(Parse *, Token *, Token *, int, Token *, int, int);
 void comdb2AlterTableCSC2(Parse *, Token *, Token *, int, Token *);
+int  comdb2InlineBlobsOption(Parse *, Token *);
 void comdb2DropTable(Parse *, SrcList *);
 void comdb2AlterTableStart(Parse *, Token *, Token *);
 void comdb2AlterTableEnd(Parse *);
@@ -125,6 +127,8 @@ void comdb2DropPartition(Parse* p, Token* name);
 void comdb2CreateTimePartition(Parse* p, Token* period, Token* retention,
                                Token* start);
 void comdb2CreateManualPartition(Parse* p, Token* retention, Token* start);
+void comdb2CreateHashPartition(Parse* p, Token* hash, Token* column,
+                               Token* partitions, Token* nshards);
 void comdb2SaveMergeTable(Parse* p, Token* name, Token* database, int alter);
 
 void comdb2analyze(Parse*, int opt, Token*, Token*, int, int);
@@ -17,6 +17,7 @@
 #if defined(SQLITE_BUILDING_FOR_COMDB2)
 extern int gbl_update_delete_limit;
 int has_comdb2_index_for_sqlite(Table *pTab);
+int timepart_is_hash_shard(const char *tblname, const char *writer);
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 
 /*
@@ -98,6 +99,15 @@ int sqlite3IsReadOnly(Parse *pParse, Table *pTab, int viewOk){
     return 1;
   }
 #endif
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  /* Only the triggers of a hash partition know which shard a row goes in */
+  if( !pTab->pSelect && timepart_is_hash_shard(pTab->zName,
+        pParse->pTriggerTab ? pParse->pTriggerTab->zName : 0) ){
+    sqlite3ErrorMsg(pParse, "cannot modify %s because it is a shard of a "
+                    "hash partition", pTab->zName);
+    return 1;
+  }
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   return 0;
 }
 
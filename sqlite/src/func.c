@@ -1049,6 +1049,28 @@ static void tableVersionFunc(
 }
 
 extern char* comdb2_partition_info(const char *partition, const char *option);
+extern int timepart_hash_shard(sqlite3_value *val, int nshards);
+/*
+** Implementation of the partition_hash(VALUE, NSHARDS) SQL function.  This
+** returns the shard of a hash partitioned table with NSHARDS shards that
+** VALUE belongs to.
+*/
+static void partitionHashFunc(
+  sqlite3_context *context,
+  int argc,
+  sqlite3_value **argv
+){
+  sqlite3_int64 nShards;
+
+  assert( argc==2 );
+  nShards = sqlite3_value_int64(argv[1]);
+  if( nShards<1 || nShards>0x7fffffff ){
+    sqlite3_result_error(context, "invalid number of shards", -1);
+    return;
+  }
+  sqlite3_result_int(context, timepart_hash_shard(argv[0], (int)nShards));
+}
+
 /*
 ** Implementation of the table_version() SQL function.  This returns
 ** the comdb2 table version
@@ -3083,6 +3105,7 @@ void sqlite3RegisterBuiltinFunctions(void){
     FUNCTION(comdb2_semver,         0, 0, 0, comdb2SemVerFunc),
     FUNCTION(table_version,         1, 0, 0, tableVersionFunc),
     FUNCTION(partition_info,        2, 0, 0, partitionInfoFunc),
+    FUNCTION(partition_hash,        2, 0, 0, partitionHashFunc),
     FUNCTION(comdb2_host,           0, 0, 0, comdb2HostFunc),
     FUNCTION(comdb2_node,           0, 0, 0, comdb2HostFunc),
     FUNCTION(comdb2_port,           0, 0, 0, comdb2PortFunc),
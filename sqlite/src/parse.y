@@ -250,6 +250,9 @@ partition_options ::= MANUAL RETENTION INTEGER(R) START INTEGER(S). {
 partition_options ::= MANUAL RETENTION INTEGER(R). {
     comdb2CreateManualPartition(pParse, &R, 0);
 }
+partition_options ::= nm(H) LP nm(C) RP nm(P) INTEGER(N). {
+    comdb2CreateHashPartition(pParse, &H, &C, &P, &N);
+}
 merge ::= .
 merge ::= merge_with.
 merge_with ::= MERGE nm(Y) dbnm(Z). {
@@ -346,7 +349,7 @@ columnname(A) ::= nm(A) typetoken(Y). {sqlite3AddColumn(pParse,&A,&Y);}
   CHECK COMMITSLEEP CONSUMER CONVERTSLEEP COUNTER COVERAGE CRLE
   DATA DATABLOB DATACOPY DBPAD DEFERRABLE DETERMINISTIC DISABLE 
   DISTRIBUTION DRYRUN ENABLE EXCLUSIVE_ANALYZE EXEC EXECUTE FORCE FUNCTION GENID48 GET 
-  GRANT INCLUDE INCREMENT IPU ISC KW LUA LZ4 MANUAL MERGE NONE
+  GRANT INCLUDE INCREMENT INLINE IPU ISC KW LUA LZ4 MANUAL MERGE NONE
   ODH OFF OP OPTION OPTIONS
   PAGEORDER PARTITIONED PASSWORD PAUSE PERIOD PENDING PROCEDURE PUT
   REBUILD READ READONLY REC RESERVED RESUME RETENTION REVOKE RLE ROWLOCKS
@@ -2488,6 +2491,9 @@ comdb2optfield(A) ::= PAGEORDER. {A = PAGE_ORDER;}
 comdb2optfield(A) ::= READONLY. {A = READ_ONLY;}
 comdb2optfield(A) ::= compress_blob(C). {A = C;}
 comdb2optfield(A) ::= compress_rec(C). {A = C;}
+comdb2optfield(A) ::= INLINE INTEGER(N). {
+    A = comdb2InlineBlobsOption(pParse, &N);
+}
 
 %type odh {int}
 odh(A) ::= ODH OFF. {A = ODH_OFF;}
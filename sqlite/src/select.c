@@ -4335,6 +4335,71 @@ static int propagateConstants(
   return nChng;
 }
 
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+/*
+** Return true if pExpr is a "partition_hash(COLUMN, N) = I" term, the
+** filter that the view of a hash partitioned table puts on each shard.
+*/
+int sqlite3IsPartitionHashFilter(Expr *pExpr){
+  Expr *pFunc;
+  int iVal;
+  if( pExpr==0 || pExpr->op!=TK_EQ ) return 0;
+  pFunc = pExpr->pLeft;
+  if( pFunc->op!=TK_FUNCTION || ExprHasProperty(pFunc, EP_xIsSelect) ){
+    return 0;
+  }
+  if( sqlite3StrICmp(pFunc->u.zToken, "partition_hash")!=0 ) return 0;
+  if( pFunc->x.pList==0 || pFunc->x.pList->nExpr!=2 ) return 0;
+  if( pFunc->x.pList->a[0].pExpr->op!=TK_COLUMN ) return 0;
+  return sqlite3ExprIsInteger(pFunc->x.pList->a[1].pExpr, &iVal, 0)
+      && sqlite3ExprIsInteger(pExpr->pRight, &iVal, 0);
+}
+
+/*
+** Return the hash partition filter among the AND-connected terms of pExpr,
+** or NULL if there is none.
+*/
+static Expr *findPartitionHashFilter(Expr *pExpr){
+  Expr *pFilter;
+  if( pExpr==0 ) return 0;
+  if( pExpr->op==TK_AND ){
+    pFilter = findPartitionHashFilter(pExpr->pLeft);
+    return pFilter ? pFilter : findPartitionHashFilter(pExpr->pRight);
+  }
+  return sqlite3IsPartitionHashFilter(pExpr) ? pExpr : 0;
+}
+
+/*
+** Return true if the WHERE clause of the shard select p fixes the column of
+** its hash partition filter to a constant, so at most one shard can match.
+*/
+int sqlite3IsPartitionHashPointQuery(Parse *pParse, Select *p){
+  WhereConst x;
+  Expr *pFilter;
+  Expr *pCol;
+  int i;
+  int rc = 0;
+
+  pFilter = findPartitionHashFilter(p->pWhere);
+  if( pFilter==0 ) return 0;
+  pCol = pFilter->pLeft->x.pList->a[0].pExpr;
+
+  memset(&x, 0, sizeof(x));
+  x.pParse = pParse;
+  findConstInWhere(&x, p->pWhere);
+  for(i=0; i<x.nConst; i++){
+    if( x.apExpr[i*2]->iTable==pCol->iTable
+     && x.apExpr[i*2]->iColumn==pCol->iColumn
+    ){
+      rc = 1;
+      break;
+    }
+  }
+  sqlite3DbFree(pParse->db, x.apExpr);
+  return rc;
+}
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
+
 #if !defined(SQLITE_OMIT_SUBQUERY) || !defined(SQLITE_OMIT_VIEW)
 /*
 ** Make copies of relevant WHERE clause terms of the outer query into
@@ -5975,7 +6040,14 @@ int sqlite3Select(
   ** as the equivalent optimization will be handled by query planner in
   ** sqlite3WhereBegin().
   */
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  /* Also do it for the shards of a hash partitioned table: a constant
+  ** hash key folds the shard filter into a constant that skips the
+  ** shards not owning the key. */
+  if( (pTabList->nSrc>1 || findPartitionHashFilter(p->pWhere))
+#else /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   if( pTabList->nSrc>1
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
    && OptimizationEnabled(db, SQLITE_PropagateConst)
    && propagateConstants(pParse, p)
   ){
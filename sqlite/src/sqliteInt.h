@@ -5099,6 +5099,9 @@ char *sqlite3PackedResult(sqlite3_stmt *pStmt, long long *size);
 Mem *sqlite3UnpackedResult(sqlite3_stmt *pStmt, int ncols, char *packed, int packed_len);
 void sqlite3UnpackedResultFree(Mem **ppMem, int nCols);
 
+int sqlite3IsPartitionHashFilter(Expr *pExpr);
+int sqlite3IsPartitionHashPointQuery(Parse *pParse, Select *p);
+
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 
 int sqlite3ExprVectorSize(Expr *pExpr);
@@ -395,5 +395,6 @@ void sqlite3BtreeCursorList(Btree*);
 #endif
 
 int sqlite3BtreeSetRecording(BtCursor *pCursor, int flag);
+int sqlite3BtreeCursorHashJoin(BtCursor *pCur, int nField);
 
 #endif /* SQLITE_BTREE_H */
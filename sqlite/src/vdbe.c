@@ -4393,13 +4393,16 @@ case OP_OpenDup: {
 ** the btree.  The BTREE_OMIT_JOURNAL and BTREE_SINGLE flags are
 ** added automatically.
 */
-/* Opcode: OpenAutoindex P1 P2 * P4 *
+/* Opcode: OpenAutoindex P1 P2 P3 P4 *
 ** Synopsis: nColumn=P2
 **
 ** This opcode works the same as OP_OpenEphemeral.  It has a
 ** different name to distinguish its use.  Tables created using
 ** by this opcode will be used for automatically created transient
 ** indices in joins.
+**
+** If P3 is greater than zero, the index is only probed for equality on
+** its first P3 columns and may be built as a hash table.
 */
 case OP_OpenAutoindex: 
 case OP_OpenEphemeral: {
@@ -4456,6 +4459,9 @@ case OP_OpenEphemeral: {
           rc = sqlite3BtreeCursor(p, pCx->pBtx, pCx->pgnoRoot,
                                   BTREE_CUR_WR|BTREE_WRCSR, 0,
                                   pKeyInfo, pCx->uc.pCursor);
+          if( rc==SQLITE_OK && pOp->opcode==OP_OpenAutoindex && pOp->p3>0 ){
+            rc = sqlite3BtreeCursorHashJoin(pCx->uc.pCursor, pOp->p3);
+          }
 #else /* defined(SQLITE_BUILDING_FOR_COMDB2) */
           rc = sqlite3BtreeCursor(pCx->pBtx, pCx->pgnoRoot, BTREE_WRCSR,
                                   pKeyInfo, pCx->uc.pCursor);
@@ -45,12 +45,39 @@ static int whereLoopResize(sqlite3*, WhereLoop*, int);
 #if defined(SQLITE_BUILDING_FOR_COMDB2)
 int gbl_disable_seekscan_optimization = 1;
 int gbl_sqlite_stat4_scan = 0;
+int gbl_sql_hash_join = 0;
 
 int shard_check_parallelism(int iTable);
 int comdb2_shard_table_constraints(Parse *pParse, 
         const char *zName, const char *zDatabase, Expr **pWhere);
 int is_comdb2_index_unique(const char *tbl, char *idx);
 int comdb2_get_planner_effort();
+int timepart_is_hash_shard_filter(const char *tblname, const char *colname,
+                                  int nshards, int shard);
+
+/*
+** Return true if pExpr is the view filter of a hash partition shard that
+** is scanned directly, and therefore holds for every one of its rows.
+*/
+static int comdb2IsImpliedShardFilter(Expr *pExpr){
+  Expr *pCol;
+  int nShards, iShard;
+  if( !sqlite3IsPartitionHashFilter(pExpr) ) return 0;
+  pCol = pExpr->pLeft->x.pList->a[0].pExpr;
+  if( ExprHasProperty(pCol, EP_FixedCol) || pCol->y.pTab==0
+   || pCol->iColumn<0 || pCol->y.pTab->pSelect
+  ){
+    return 0;
+  }
+  if( !sqlite3ExprIsInteger(pExpr->pLeft->x.pList->a[1].pExpr, &nShards, 0)
+   || !sqlite3ExprIsInteger(pExpr->pRight, &iShard, 0)
+  ){
+    return 0;
+  }
+  return timepart_is_hash_shard_filter(pCol->y.pTab->zName,
+                                       pCol->y.pTab->aCol[pCol->iColumn].zName,
+                                       nShards, iShard);
+}
 
 static char *comdb2IndexName(char *src, char *dest)
 {
@@ -718,6 +745,22 @@ static int termCanDriveIndex(
 #endif
 
 
+#if defined(SQLITE_BUILDING_FOR_COMDB2) && !defined(SQLITE_OMIT_AUTOMATIC_INDEX)
+/*
+** Return TRUE if an automatic index driven by pTerm can be built as the
+** hash table of a hash join.  Only equality is probed, so this requires
+** that equal values be equal byte for byte or number for number, that is
+** the BINARY collation.
+*/
+static int termCanDriveHashJoin(Parse *pParse, WhereTerm *pTerm){
+  Expr *pX = pTerm->pExpr;
+  CollSeq *pColl;
+  if( !gbl_sql_hash_join || pX->pRight==0 ) return 0;
+  pColl = sqlite3BinaryCompareCollSeq(pParse, pX->pLeft, pX->pRight);
+  return pColl==0 || sqlite3StrICmp(pColl->zName, sqlite3StrBINARY)==0;
+}
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) && !defined(SQLITE_OMIT_AUTOMATIC_INDEX) */
+
 #ifndef SQLITE_OMIT_AUTOMATIC_INDEX
 /*
 ** Generate code to construct the Index object for an automatic index
@@ -754,6 +797,9 @@ static void constructAutomaticIndex(
   struct SrcList_item *pTabItem;  /* FROM clause term being indexed */
   int addrCounter = 0;        /* Address where integer counter is initialized */
   int regBase;                /* Array of registers where record is assembled */
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  int bHashJoin = 1;          /* True to build the index as a hash table */
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 
   /* Generate code to skip over the creation and initialization of the
   ** transient index on 2nd and subsequent iterations of the loop. */
@@ -844,6 +890,9 @@ static void constructAutomaticIndex(
         pIdx->aiColumn[n] = pTerm->u.leftColumn;
         pColl = sqlite3BinaryCompareCollSeq(pParse, pX->pLeft, pX->pRight);
         pIdx->azColl[n] = pColl ? pColl->zName : sqlite3StrBINARY;
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+        if( !termCanDriveHashJoin(pParse, pTerm) ) bHashJoin = 0;
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
         n++;
       }
     }
@@ -873,7 +922,12 @@ static void constructAutomaticIndex(
   /* Create the automatic index */
   assert( pLevel->iIdxCur>=0 );
   pLevel->iIdxCur = pParse->nTab++;
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  sqlite3VdbeAddOp3(v, OP_OpenAutoindex, pLevel->iIdxCur, nKeyCol+1,
+                    bHashJoin ? (int)pLoop->u.btree.nEq : 0);
+#else /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   sqlite3VdbeAddOp2(v, OP_OpenAutoindex, pLevel->iIdxCur, nKeyCol+1);
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   sqlite3VdbeSetP4KeyInfo(pParse, pIdx);
   VdbeComment((v, "for %s", pTable->zName));
 
@@ -3010,6 +3064,17 @@ static int whereLoopAddBtree(
         ** not be unreasonable to make this value much larger. */
         pNew->nOut = 43;  assert( 43==sqlite3LogEst(20) );
         pNew->rRun = sqlite3LogEstAdd(rLogSize,pNew->nOut);
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+        if( termCanDriveHashJoin(pWInfo->pParse, pTerm) ){
+          /* TUNING: Hashing the build input is linear, without the log2(N)
+          ** factor of sorting it, and each probe is a bucket lookup rather
+          ** than a log2(N) descent.  With N taken from sqlite_stat1, the
+          ** smaller input is the one that gets built. */
+          pNew->rSetup -= rLogSize;
+          if( pNew->rSetup<0 ) pNew->rSetup = 0;
+          pNew->rRun = pNew->nOut;
+        }
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
         pNew->wsFlags = WHERE_AUTO_INDEX;
         pNew->prereq = mPrereq | pTerm->prereqRight;
         rc = whereLoopInsert(pBuilder, pNew);
@@ -5004,6 +5069,13 @@ WhereInfo *sqlite3WhereBegin(
       sqlite3ExprIfFalse(pParse, pT->pExpr, pWInfo->iBreak, SQLITE_JUMPIFNULL);
       pT->wtFlags |= TERM_CODED;
     }
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+    /* Rows are stored in the shard their key hashes to, so the shard
+    ** filter of a hash partition view need not be checked per row */
+    else if( comdb2IsImpliedShardFilter(pT->pExpr) ){
+      pT->wtFlags |= TERM_CODED;
+    }
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   }
 
   if( wctrlFlags & WHERE_WANT_DISTINCT ){
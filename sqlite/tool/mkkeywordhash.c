@@ -361,6 +361,7 @@ static Keyword aKeywordTable[] = {
   { "GRANT",             "TK_GRANT",             ALWAYS           },
   { "INCLUDE",           "TK_INCLUDE",           ALWAYS           },
   { "INCREMENT",         "TK_INCREMENT",         ALWAYS           },
+  { "INLINE",            "TK_INLINE",            ALWAYS           },
   { "IPU",               "TK_IPU",               ALWAYS           },
   { "ISC",               "TK_ISC",               ALWAYS           },
   { "KW",                "TK_KW",                ALWAYS           },
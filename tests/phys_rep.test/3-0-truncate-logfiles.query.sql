@@ -0,0 +1 @@
+select tag, count(*), sum(length(v)) from t3 group by tag order by tag
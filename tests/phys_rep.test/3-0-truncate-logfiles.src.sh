@@ -0,0 +1,54 @@
+#!/usr/bin/env bash
+
+# Truncate back to a time in the middle of several log files.  The log
+# position found for it must be the last timestamped record at or before
+# that time, and everything written after it must be gone.
+
+master=$(getmaster)
+
+function tsql
+{
+    ${CDB2SQL_EXE} -s --tabs ${CDB2_OPTIONS} $dbname --host $master "$1"
+}
+
+# About 6MB of log, in 30 transactions
+function fill
+{
+    for i in $(seq 1 30); do
+        echo "insert into t3 select value, '$1', randomblob(2000) from generate_series($((i * 100)), $((i * 100 + 99)))"
+    done | ${CDB2SQL_EXE} -s ${CDB2_OPTIONS} $dbname --host $master - > /dev/null || failexit "fill $1"
+}
+
+tsql "create table t3 (id int, tag cstring(8), v blob)" > /dev/null || failexit "create t3"
+first_file=$(tsql "select max(lsnfile) from comdb2_transaction_logs")
+
+fill before
+sleep 2
+rewind_time=$(date +%s)
+sleep 2
+fill after
+last_file=$(tsql "select max(lsnfile) from comdb2_transaction_logs")
+
+expected=$(tsql "select lsnfile, lsnoffset from comdb2_transaction_logs(NULL, NULL, 4) where timestamp is not null and timestamp <= $rewind_time limit 1")
+efile=$(echo "$expected" | cut -f1)
+eoffset=$(echo "$expected" | cut -f2)
+if [[ -z "$efile" ]] || [[ $efile -le $first_file ]] || [[ $efile -ge $last_file ]]; then
+    failexit "expected a rewind point in a middle log file, files $first_file to $last_file, got '$expected'"
+fi
+
+sleep 1
+truncate_time=$(date +%s)
+tsql "exec procedure sys.cmd.truncate_time($rewind_time)" > /dev/null || failexit "truncate_time $rewind_time"
+
+# The log now ends at the record the lookup should have found: it is still
+# there, and nothing timestamped between the rewind time and the truncation
+# survived
+kept=$(tsql "select count(*) from comdb2_transaction_logs where lsnfile = $efile and lsnoffset = $eoffset and timestamp <= $rewind_time")
+[[ $kept -eq 1 ]] || failexit "record {$efile:$eoffset} is gone after truncating to $rewind_time"
+after=$(tsql "select count(*) from comdb2_transaction_logs where timestamp > $rewind_time and timestamp < $truncate_time")
+[[ $after -eq 0 ]] || failexit "$after records between $rewind_time and $truncate_time survived the truncation"
+
+nbefore=$(tsql "select count(*) from t3 where tag = 'before'")
+nafter=$(tsql "select count(*) from t3 where tag = 'after'")
+[[ $nbefore -eq 3000 ]] || failexit "expected 3000 rows written before $rewind_time, got $nbefore"
+[[ $nafter -eq 0 ]] || failexit "expected no rows written after $rewind_time, got $nafter"
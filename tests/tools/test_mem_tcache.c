@@ -0,0 +1,187 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <dlmalloc.h>
+#include "mem.h"
+
+int gbl_disable_exit_on_thread_error;
+
+void register_tunable(void *tunable)
+{
+}
+
+extern int gbl_mem_tcache_max;
+
+#define NBLOCKS 2048
+#define NROUNDS 200
+#define MAXSZ 1200 /* some blocks are too big to be cached */
+
+static void *blocks[NBLOCKS];
+
+static size_t used(void)
+{
+    return comdb2_mallinfo_static(COMDB2MA_STATIC_UTIL).uordblks;
+}
+
+static size_t arena(void)
+{
+    return comdb2_mallinfo_static(COMDB2MA_STATIC_UTIL).arena;
+}
+
+#define CHECK(cond, ...)                                                       \
+    do {                                                                       \
+        if (!(cond)) {                                                         \
+            fprintf(stderr, "%s:%d: ", __func__, __LINE__);                    \
+            fprintf(stderr, __VA_ARGS__);                                      \
+            fprintf(stderr, "\n");                                             \
+            exit(1);                                                           \
+        }                                                                      \
+    } while (0)
+
+static void alloc_all(void)
+{
+    int i;
+    for (i = 0; i != NBLOCKS; ++i) {
+        size_t n = 1 + rand() % MAXSZ;
+        blocks[i] = comdb2_malloc_static(COMDB2MA_STATIC_UTIL, n);
+        CHECK(blocks[i] != NULL, "malloc %zu failed", n);
+        memset(blocks[i], 0xab, n);
+    }
+}
+
+static void free_all(void)
+{
+    int i;
+    for (i = 0; i != NBLOCKS; ++i) {
+        comdb2_free(blocks[i]);
+        blocks[i] = NULL;
+    }
+}
+
+static pthread_mutex_t lk = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cd = PTHREAD_COND_INITIALIZER;
+static int freed, may_exit;
+
+/* free blocks allocated by the main thread, then park until told to exit
+   so that the caller can look at the numbers while our cache is populated */
+static void *remote_free(void *arg)
+{
+    free_all();
+    pthread_mutex_lock(&lk);
+    freed = 1;
+    pthread_cond_signal(&cd);
+    while (!may_exit)
+        pthread_cond_wait(&cd, &lk);
+    pthread_mutex_unlock(&lk);
+    return NULL;
+}
+
+/* the thread's cache is populated but the thread is still alive */
+static void cross_thread_free(size_t base)
+{
+    pthread_t t;
+
+    alloc_all();
+    CHECK(used() > base, "no growth after malloc (%zu <= %zu)", used(), base);
+
+    freed = may_exit = 0;
+    pthread_create(&t, NULL, remote_free, NULL);
+    pthread_mutex_lock(&lk);
+    while (!freed)
+        pthread_cond_wait(&cd, &lk);
+    CHECK(used() == base, "cross-thread free: used %zu, expected %zu",
+          used(), base);
+    may_exit = 1;
+    pthread_cond_signal(&cd);
+    pthread_mutex_unlock(&lk);
+    pthread_join(t, NULL);
+
+    CHECK(used() == base, "after thread exit: used %zu, expected %zu",
+          used(), base);
+}
+
+static void *alloc_and_free(void *arg)
+{
+    alloc_all();
+    free_all();
+    return NULL;
+}
+
+/* cached blocks of exited threads go back to the mspace. if they did not,
+   every round would pin another NBLOCKS blocks and the arena would grow. */
+static void flush_on_thread_exit(size_t base)
+{
+    pthread_t t;
+    size_t warm = 0;
+    int i;
+
+    for (i = 0; i != NROUNDS; ++i) {
+        pthread_create(&t, NULL, alloc_and_free, NULL);
+        pthread_join(t, NULL);
+        CHECK(used() == base, "round %d: used %zu, expected %zu", i, used(),
+              base);
+        if (i == 9)
+            warm = arena();
+    }
+    CHECK(arena() <= warm + warm / 2,
+          "arena grew from %zu to %zu over %d thread exits", warm, arena(),
+          NROUNDS - 10);
+}
+
+/* a cached block counts as free, and as used again once handed back out */
+static void same_thread_reuse(size_t base)
+{
+    void *p;
+
+    p = comdb2_malloc_static(COMDB2MA_STATIC_UTIL, 100);
+    CHECK(used() > base, "no growth after malloc");
+    comdb2_free(p);
+    CHECK(used() == base, "same-thread free: used %zu, expected %zu", used(),
+          base);
+    p = comdb2_malloc_static(COMDB2MA_STATIC_UTIL, 100);
+    CHECK(used() > base, "no growth after reusing a cached block");
+    comdb2_free(p);
+    CHECK(used() == base, "used %zu, expected %zu", used(), base);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t base;
+
+    /* start big enough that no mspace segment is added or released; their
+       overhead would otherwise move the in-use numbers */
+    comdb2ma_init(8 << 20, 0);
+    srand(42);
+
+    CHECK(gbl_mem_tcache_max > 0, "thread cache is off by default");
+
+    /* settle the mspace so that segment overhead doesn't move the baseline */
+    alloc_all();
+    free_all();
+    base = used();
+
+    same_thread_reuse(base);
+    printf("same thread reuse ok\n");
+
+    alloc_all();
+    free_all();
+    CHECK(used() == base, "same-thread free: used %zu, expected %zu", used(),
+          base);
+    printf("same thread free ok\n");
+
+    cross_thread_free(base);
+    printf("cross thread free ok\n");
+
+    flush_on_thread_exit(base);
+    printf("flush on thread exit ok\n");
+
+    /* same numbers with the cache turned off */
+    gbl_mem_tcache_max = 0;
+    cross_thread_free(base);
+    printf("cache off ok\n");
+
+    return 0;
+}
@@ -16,24 +16,36 @@ static const char revid[] =
 
 #ifndef NO_SYSTEM_INCLUDES
 #include <sys/types.h>
+#include <sys/stat.h>
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 #endif
 
 #include "build/db_int.h"
 #include "dbinc/db_page.h"
 #include "dbinc/db_am.h"
+#include "dbinc/btree.h"
 
 #include <crc32c.h>
 #include <syslog.h>
 #include <logmsg.h>
 #include <sys_wrap.h>
+#include <zlib.h>
 
-static int db_init(DB_ENV *, char *, int, u_int32_t, int *);
+/* Returned by dump_parallel when the file was written during the dump. */
+#define	DUMP_CHANGED	2
+#define	DUMP_RETRIES	10
+
+static int db_init(DB_ENV *, char *, int, u_int32_t, u_int32_t, int *);
 static int dump __P((DB *, int, int));
+static int dump_parallel __P((DB *, char *, int, int, int, int, time_t));
+static int gz_pr_callback __P((void *, const void *));
+static void *dump_range_thd __P((void *));
+static int split_keys __P((DB *, int, DBT **, int *));
 static int dump_sub __P((DB_ENV *, DB *, char *, int, int));
 static int is_sub __P((DB *, int *));
 static int show_subs __P((DB *));
@@ -56,10 +68,11 @@ tool_cdb2_dump_main(argc, argv)
 	DB *dbp;
 	u_int32_t cache;
 	int ch;
-	int exitval, keyflag, lflag, nflag, pflag, private;
-	int ret, Rflag, rflag, resize, subs;
-	char *dopt, *home, passwd[1024], *subname;
+	int exitval, keyflag, lflag, nflag, nthreads, pflag, private;
+	int ret, Rflag, rflag, resize, retries, subs, zflag;
+	char *dopt, *fopt, *home, passwd[1024], *subname;
 	FILE *crypto;
+	time_t start;
 
 	Pthread_key_create(&comdb2_open_key, NULL);
 
@@ -68,27 +81,34 @@ tool_cdb2_dump_main(argc, argv)
 
 	dbenv = NULL;
 	dbp = NULL;
-	exitval = lflag = nflag = pflag = rflag = Rflag = 0;
+	exitval = lflag = nflag = pflag = rflag = Rflag = zflag = 0;
 	keyflag = 0;
+	nthreads = 1;
+	retries = 0;
 	cache = MEGABYTE;
 	private = 0;
-	dopt = home = subname = NULL;
+	dopt = fopt = home = subname = NULL;
 	memset(passwd, 0, sizeof(passwd));
-	while ((ch = getopt(argc, argv, "d:f:h:klNpP:rRs:V")) != EOF)
+	while ((ch = getopt(argc, argv, "d:f:h:j:klNpP:rRs:Vz")) != EOF)
 		switch (ch) {
 		case 'd':
 			dopt = optarg;
 			break;
 		case 'f':
-			if (freopen(optarg, "w", stdout) == NULL) {
-				fprintf(stderr, "%s: %s: reopen: %s\n",
-				    progname, optarg, strerror(errno));
-				return (EXIT_FAILURE);
-			}
+			fopt = optarg;
 			break;
 		case 'h':
 			home = optarg;
 			break;
+		case 'j':
+			nthreads = atoi(optarg);
+			if (nthreads < 1) {
+				fprintf(stderr,
+				    "%s: -j needs a positive number of threads\n",
+				    progname);
+				return (EXIT_FAILURE);
+			}
+			break;
 		case 'k':
 			keyflag = 1;
 			break;
@@ -128,6 +148,9 @@ tool_cdb2_dump_main(argc, argv)
 		case 'V':
 			printf("%s\n", db_version(NULL, NULL, NULL));
 			return (EXIT_SUCCESS);
+		case 'z':
+			zflag = 1;
+			break;
 		case '?':
 		default:
 			return (cdb2_dump_usage());
@@ -165,6 +188,26 @@ tool_cdb2_dump_main(argc, argv)
 		return (EXIT_FAILURE);
 	}
 
+	if (nthreads > 1 &&
+	    (fopt == NULL || dopt != NULL || lflag || rflag || subname)) {
+		fprintf(stderr,
+		    "%s: -j needs -f, and may not be used with -d, -l, -r, -R "
+		    "or -s\n", progname);
+		return (EXIT_FAILURE);
+	}
+	if (zflag && nthreads == 1) {
+		fprintf(stderr, "%s: -z needs -j\n", progname);
+		return (EXIT_FAILURE);
+	}
+
+	/* With -j, each thread writes to a file of its own */
+	if (fopt != NULL && nthreads == 1 &&
+	    freopen(fopt, "w", stdout) == NULL) {
+		fprintf(stderr, "%s: %s: reopen: %s\n",
+		    progname, fopt, strerror(errno));
+		return (EXIT_FAILURE);
+	}
+
 	/* Handle possible interruptions. */
 	__db_util_siginit();
 
@@ -198,7 +241,8 @@ retry:	if ((ret = db_env_create(&dbenv, 0)) != 0) {
 	}
 
 	/* Initialize the environment. */
-	if (db_init(dbenv, home, rflag, cache, &private) != 0)
+	if (db_init(dbenv, home, rflag, cache,
+	    nthreads > 1 ? DB_THREAD : 0, &private) != 0)
 		goto err;
 
 	/* Create the DB object and open the file. */
@@ -223,8 +267,9 @@ retry:	if ((ret = db_env_create(&dbenv, 0)) != 0) {
 		goto done;
 	}
 
-	if ((ret = dbp->open(dbp, NULL,
-	    argv[0], subname, DB_UNKNOWN, DB_RDONLY, 0)) != 0) {
+	start = time(NULL);
+	if ((ret = dbp->open(dbp, NULL, argv[0], subname, DB_UNKNOWN,
+	    DB_RDONLY | (nthreads > 1 ? DB_THREAD : 0), 0)) != 0) {
 		dbp->err(dbp, ret, "open: %s", argv[0]);
 		goto err;
 	}
@@ -258,6 +303,33 @@ retry:	if ((ret = db_env_create(&dbenv, 0)) != 0) {
 		}
 		if (show_subs(dbp))
 			goto err;
+	} else if (nthreads > 1) {
+		if (is_sub(dbp, &subs))
+			goto err;
+		if (subs) {
+			dbp->errx(dbp,
+			    "%s: -j does not support subdatabases", argv[0]);
+			goto err;
+		}
+		ret = dump_parallel(dbp,
+		    fopt, nthreads, pflag, keyflag, zflag, start);
+		if (ret == DUMP_CHANGED && ++retries < DUMP_RETRIES) {
+			dbp->errx(dbp,
+			    "%s: changed during the dump, starting over",
+			    argv[0]);
+			(void)dbp->close(dbp, 0);
+			dbp = NULL;
+
+			(void)dbenv->close(dbenv, 0);
+			dbenv = NULL;
+			sleep(1);
+			goto retry;
+		}
+		if (ret == DUMP_CHANGED)
+			dbp->errx(dbp, "%s: changed during %d dumps, "
+			    "stop the writes to it first", argv[0], retries);
+		if (ret != 0)
+			goto err;
 	} else {
 		subs = 0;
 		if (subname == NULL && is_sub(dbp, &subs))
@@ -296,11 +368,11 @@ done:	if (dbp != NULL && (ret = dbp->close(dbp, 0)) != 0) {
  *	Initialize the environment.
  */
 static int
-db_init(dbenv, home, is_salvage, cache, is_privatep)
+db_init(dbenv, home, is_salvage, cache, thread, is_privatep)
 	DB_ENV *dbenv;
 	char *home;
 	int is_salvage;
-	u_int32_t cache;
+	u_int32_t cache, thread;
 	int *is_privatep;
 {
 	int ret;
@@ -324,8 +396,8 @@ db_init(dbenv, home, is_salvage, cache, is_privatep)
 	 * before we create our own.
 	 */
 	*is_privatep = 0;
-	if (dbenv->open(dbenv, home,
-	    DB_USE_ENVIRON | (is_salvage ? DB_INIT_MPOOL : DB_JOINENV), 0) == 0)
+	if (dbenv->open(dbenv, home, DB_USE_ENVIRON | thread |
+	    (is_salvage ? DB_INIT_MPOOL : DB_JOINENV), 0) == 0)
 		return (0);
 
 	/*
@@ -340,8 +412,8 @@ db_init(dbenv, home, is_salvage, cache, is_privatep)
 	 */
 	*is_privatep = 1;
 	if ((ret = dbenv->set_cachesize(dbenv, 0, cache, 1)) == 0 &&
-	    (ret = dbenv->open(dbenv, home,
-	    DB_CREATE | DB_INIT_MPOOL | DB_PRIVATE | DB_USE_ENVIRON, 0)) == 0)
+	    (ret = dbenv->open(dbenv, home, DB_CREATE | DB_INIT_MPOOL |
+	    DB_PRIVATE | DB_USE_ENVIRON | thread, 0)) == 0)
 		return (0);
 
 	/* An environment is required. */
@@ -601,6 +673,361 @@ err:	if (data.data != NULL)
 	return (failed);
 }
 
+/*
+ * A key range of a btree dumped by one thread of dump_parallel: the keys from
+ * start (or the first key) up to, but not including, stop (or to the end).
+ */
+struct dump_range {
+	DB *dbp;
+	DBT start;
+	DBT stop;
+	int empty;
+	void *fp;			/* FILE, or gzFile with -z */
+	int (*callback) __P((void *, const void *));
+	int pflag, keyflag;
+	int failed;
+};
+
+/*
+ * dump_parallel --
+ *	Dump a btree as nthreads key ranges read concurrently.  Range n is
+ *	written to <output>.n as a complete dump of its own, in key order, so
+ *	the files may be loaded one after another, or concatenated, with
+ *	cdb2_load.  With zflag, the files are compressed with gzip.
+ *
+ *	The ranges are read at different times, through a cache of our own.
+ *	A running database writes pages to the file whenever it flushes them,
+ *	so the ranges are one snapshot of the btree only if the file was not
+ *	written since start, the time the caller opened it.  Otherwise
+ *	DUMP_CHANGED is returned, and the caller starts over with an empty
+ *	cache.  A second of slack covers the granularity of file times.
+ */
+static int
+dump_parallel(dbp, output, nthreads, pflag, keyflag, zflag, start)
+	DB *dbp;
+	char *output;
+	int nthreads, pflag, keyflag, zflag;
+	time_t start;
+{
+	struct dump_range *ranges, *r;
+	struct stat sb;
+	pthread_t *tids;
+	DBT *splits;
+	size_t len;
+	char *fname;
+	int failed, i, nsplits;
+
+	if (dbp->type != DB_BTREE) {
+		dbp->errx(dbp, "-j is only supported for btrees");
+		return (1);
+	}
+
+	splits = NULL;
+	nsplits = 0;
+	if (split_keys(dbp, nthreads, &splits, &nsplits))
+		return (1);
+
+	failed = 0;
+	len = strlen(output) + 16;
+	ranges = calloc(nthreads, sizeof(struct dump_range));
+	tids = calloc(nthreads, sizeof(pthread_t));
+	fname = malloc(len);
+	if (ranges == NULL || tids == NULL || fname == NULL) {
+		dbp->err(dbp, ENOMEM, "dump ranges");
+		failed = 1;
+		goto err;
+	}
+
+	/* There are fewer ranges than threads if the keys are too close. */
+	for (i = 0; i < nthreads; i++) {
+		r = &ranges[i];
+		r->dbp = dbp;
+		r->pflag = pflag;
+		r->keyflag = keyflag;
+		r->callback = zflag ? gz_pr_callback : __db_pr_callback;
+		if (i > nsplits)
+			r->empty = 1;
+		else {
+			if (i > 0)
+				r->start = splits[i - 1];
+			if (i < nsplits)
+				r->stop = splits[i];
+		}
+		snprintf(fname, len, "%s.%d", output, i);
+		if (zflag)
+			r->fp = gzopen(fname, "wb");
+		else
+			r->fp = fopen(fname, "w");
+		if (r->fp == NULL) {
+			dbp->err(dbp, errno, "open: %s", fname);
+			failed = 1;
+			goto err;
+		}
+	}
+
+	for (i = 0; i < nthreads; i++)
+		Pthread_create(&tids[i], NULL, dump_range_thd, &ranges[i]);
+	for (i = 0; i < nthreads; i++) {
+		Pthread_join(tids[i], NULL);
+		failed |= ranges[i].failed;
+	}
+
+	/* Whatever was read from a file that changed is thrown away. */
+	if (fstat(dbp->mpf->fhp->fd, &sb) != 0) {
+		dbp->err(dbp, errno, "fstat");
+		failed = 1;
+	} else if (sb.st_mtime + 1 >= start)
+		failed = DUMP_CHANGED;
+
+err:	if (ranges != NULL) {
+		for (i = 0; i < nthreads; i++) {
+			if (ranges[i].fp == NULL)
+				continue;
+			if (zflag ? gzclose(ranges[i].fp) != Z_OK :
+			    fclose(ranges[i].fp) != 0) {
+				dbp->errx(dbp, "close: %s.%d", output, i);
+				if (failed != DUMP_CHANGED)
+					failed = 1;
+			}
+		}
+		free(ranges);
+	}
+	for (i = 0; i < nsplits; i++)
+		free(splits[i].data);
+	free(splits);
+	free(tids);
+	free(fname);
+	return (failed);
+}
+
+/*
+ * split_keys --
+ *	Pick up to nthreads - 1 keys that split a btree into ranges of about
+ *	the same width.  The keys are interpolated between the first and the
+ *	last key of the btree, over the 8 bytes after their common prefix.
+ */
+static int
+split_keys(dbp, nthreads, splitsp, nsplitsp)
+	DB *dbp;
+	int nthreads;
+	DBT **splitsp;
+	int *nsplitsp;
+{
+	DBC *dbcp;
+	DBT data, first, last, *splits;
+	u_int64_t hi, lo, step, v;
+	u_int32_t j, pfx;
+	u_int8_t *p;
+	int i, n, ret;
+
+	*splitsp = NULL;
+	*nsplitsp = 0;
+	splits = NULL;
+	n = 0;
+
+	memset(&first, 0, sizeof(first));
+	memset(&last, 0, sizeof(last));
+	memset(&data, 0, sizeof(data));
+	first.flags = last.flags = data.flags = DB_DBT_REALLOC;
+
+	if ((ret = dbp->cursor(dbp, NULL, &dbcp, 0)) != 0) {
+		dbp->err(dbp, ret, "DB->cursor");
+		return (1);
+	}
+	if ((ret = dbcp->c_get(dbcp, &first, &data, DB_FIRST)) == 0)
+		ret = dbcp->c_get(dbcp, &last, &data, DB_LAST);
+	(void)dbcp->c_close(dbcp);
+	if (ret == DB_NOTFOUND) {
+		ret = 0;
+		goto done;
+	}
+	if (ret != 0) {
+		dbp->err(dbp, ret, "DBcursor->get");
+		goto done;
+	}
+
+	for (pfx = 0; pfx < first.size && pfx < last.size &&
+	    ((u_int8_t *)first.data)[pfx] == ((u_int8_t *)last.data)[pfx];
+	    pfx++)
+		;
+	for (lo = hi = 0, j = 0; j < 8; j++) {
+		lo = lo << 8 | (pfx + j < first.size ?
+		    ((u_int8_t *)first.data)[pfx + j] : 0);
+		hi = hi << 8 | (pfx + j < last.size ?
+		    ((u_int8_t *)last.data)[pfx + j] : 0);
+	}
+	step = (hi - lo) / (u_int64_t)nthreads;
+	if (step == 0)
+		goto done;
+
+	if ((splits = calloc(nthreads - 1, sizeof(DBT))) == NULL) {
+		dbp->err(dbp, ENOMEM, "split keys");
+		ret = ENOMEM;
+		goto done;
+	}
+	for (i = 1; i < nthreads; i++, n++) {
+		if ((p = malloc(pfx + 8)) == NULL) {
+			dbp->err(dbp, ENOMEM, "split keys");
+			ret = ENOMEM;
+			goto done;
+		}
+		memcpy(p, first.data, pfx);
+		for (v = lo + step * i, j = 0; j < 8; j++)
+			p[pfx + 7 - j] = (u_int8_t)(v >> (8 * j));
+		splits[n].data = p;
+		splits[n].size = pfx + 8;
+	}
+
+done:	free(first.data);
+	free(last.data);
+	free(data.data);
+	if (ret != 0) {
+		for (i = 0; i < n; i++)
+			free(splits[i].data);
+		free(splits);
+		return (1);
+	}
+	*splitsp = splits;
+	*nsplitsp = n;
+	return (0);
+}
+
+/*
+ * dump_range_thd --
+ *	Dump one key range of a btree to its own file.
+ */
+static void *
+dump_range_thd(arg)
+	void *arg;
+{
+	struct dump_range *r;
+	DB *dbp;
+	DBC *dbcp;
+	DBT key, data, keyret, dataret;
+	int (*cmp) __P((DB *, const DBT *, const DBT *));
+	void *pointer;
+	int ret;
+
+	r = arg;
+	dbp = r->dbp;
+	dbcp = NULL;
+	cmp = ((BTREE *)dbp->bt_internal)->bt_compare;
+	memset(&key, 0, sizeof(key));
+	memset(&data, 0, sizeof(data));
+	memset(&keyret, 0, sizeof(keyret));
+	memset(&dataret, 0, sizeof(dataret));
+
+	if (__db_prheader(dbp, NULL, r->pflag, r->keyflag, r->fp,
+	    r->callback, NULL, 0)) {
+		r->failed = 1;
+		return (NULL);
+	}
+	if (r->empty)
+		goto done;
+
+	if ((ret = dbp->cursor(dbp, NULL, &dbcp, 0)) != 0) {
+		dbp->err(dbp, ret, "DB->cursor");
+		goto err;
+	}
+
+	/* Position on the first key of the range and dump it. */
+	key.flags = data.flags = DB_DBT_REALLOC;
+	if (r->start.size != 0) {
+		if ((key.data = malloc(r->start.size)) == NULL) {
+			dbp->err(dbp, ENOMEM, "range key");
+			goto err;
+		}
+		memcpy(key.data, r->start.data, r->start.size);
+		key.size = r->start.size;
+		ret = dbcp->c_get(dbcp, &key, &data, DB_SET_RANGE);
+	} else
+		ret = dbcp->c_get(dbcp, &key, &data, DB_FIRST);
+	if (ret == DB_NOTFOUND)
+		goto done;
+	if (ret != 0) {
+		dbp->err(dbp, ret, "DBcursor->get");
+		goto err;
+	}
+	if (r->stop.size != 0 && cmp(dbp, &key, &r->stop) >= 0)
+		goto done;
+	if (__db_prdbt(&key, r->pflag, " ", r->fp, r->callback,
+	    0, NULL) != 0 || __db_prdbt(&data, r->pflag, " ", r->fp,
+	    r->callback, 0, NULL) != 0) {
+		dbp->errx(dbp, NULL);
+		goto err;
+	}
+
+	/* Dump the rest in bulk, up to the start of the next range. */
+	free(data.data);
+	data.data = malloc(1024 * 1024);
+	if (data.data == NULL) {
+		dbp->err(dbp, ENOMEM, "bulk get buffer");
+		goto err;
+	}
+	data.ulen = 1024 * 1024;
+	data.flags = DB_DBT_USERMEM;
+
+retry:
+	while ((ret =
+	    dbcp->c_get(dbcp, &key, &data, DB_NEXT | DB_MULTIPLE_KEY)) == 0) {
+		DB_MULTIPLE_INIT(pointer, &data);
+		for (;;) {
+			DB_MULTIPLE_KEY_NEXT(pointer, &data, keyret.data,
+			    keyret.size, dataret.data, dataret.size);
+			if (dataret.data == NULL)
+				break;
+			if (r->stop.size != 0 &&
+			    cmp(dbp, &keyret, &r->stop) >= 0)
+				goto done;
+			if (__db_prdbt(&keyret, r->pflag, " ", r->fp,
+			    r->callback, 0, NULL) != 0 ||
+			    __db_prdbt(&dataret, r->pflag, " ", r->fp,
+			    r->callback, 0, NULL) != 0) {
+				dbp->errx(dbp, NULL);
+				goto err;
+			}
+		}
+	}
+	if (ret == ENOMEM) {
+		data.size = ALIGN(data.size, 1024);
+		data.data = realloc(data.data, data.size);
+		if (data.data == NULL) {
+			dbp->err(dbp, ENOMEM, "bulk get buffer");
+			goto err;
+		}
+		data.ulen = data.size;
+		goto retry;
+	}
+	if (ret != DB_NOTFOUND) {
+		dbp->err(dbp, ret, "DBcursor->get");
+		goto err;
+	}
+
+	if (0) {
+err:		r->failed = 1;
+	}
+done:	if (dbcp != NULL && (ret = dbcp->c_close(dbcp)) != 0) {
+		dbp->err(dbp, ret, "DBcursor->close");
+		r->failed = 1;
+	}
+	free(key.data);
+	free(data.data);
+	(void)__db_prfooter(r->fp, r->callback);
+	return (NULL);
+}
+
+/*
+ * gz_pr_callback --
+ *	Callback function for the pr_* functions writing to a gzip file.
+ */
+static int
+gz_pr_callback(handle, str)
+	void *handle;
+	const void *str;
+{
+	return (gzputs(handle, str) < 0 ? EIO : 0);
+}
+
 /*
  * cdb2_dump_usage --
  *	Display the usage message.
@@ -609,11 +1036,16 @@ static int
 cdb2_dump_usage()
 {
 	(void)fprintf(stderr,
-    "usage: cdb2_dump [-klNprRV]\n\t"
-    "[-d ahr] [-f output] [-h home] [-P /path/to/password] [-s database] db_file\n"
+    "usage: cdb2_dump [-klNprRVz]\n\t"
+    "[-d ahr] [-f output] [-h home] [-j threads] [-P /path/to/password]\n\t"
+    "[-s database] db_file\n"
     "   -d    dump options, a - detailed, r - test recovery\n"
     "   -f    output to file\n"
     "   -h    home db directory\n"
+    "   -j    dump a btree in key ranges with this many threads,\n"
+    "         range n to output.n (needs -f); the dump starts over\n"
+    "         while the file is being written to, so that the ranges\n"
+    "         are one snapshot of it\n"
     "   -k    keyflag\n"
     "   -l    check if DB file contains subtadabases\n"
     "   -N    set no locking mode\n"
@@ -621,7 +1053,8 @@ cdb2_dump_usage()
     "   -P    password file to decrypt btree content\n"
     "   -r    verify as well\n"
     "   -R    aggressive mode for verify\n"
-    "   -V    display version\n");
+    "   -V    display version\n"
+    "   -z    compress the range files with gzip (needs -j)\n");
 	return (EXIT_FAILURE);
 }
 
@@ -32,6 +32,7 @@ static const char revid[] =
 #include <sys_wrap.h>
 #include <logmsg.h>
 #include <mem.h>
+#include <zlib.h>
 
 typedef struct {			/* XXX: Globals. */
 	const char *progname;		/* Program name. */
@@ -45,27 +46,70 @@ typedef struct {			/* XXX: Globals. */
 	char	*passwd;		/* Env passwd. */
 	int	private;		/* Private env. */
 	u_int32_t cache;		/* Env cache size. */
+	u_long	batch;			/* Records per transaction. */
+	int	threads;		/* Loading threads. */
+	gzFile	in;			/* Input, plain or gzip. */
 } LDG;
 
+typedef struct {			/* Pairs put by the open batch. */
+	DBT	*key;
+	DBT	*data;
+	u_long	n;
+} BATCH;
+
+/*
+ * A dump loaded by one thread of load_parallel: one of the files written by
+ * cdb2_dump -j.
+ */
+struct load_range {
+	DB_ENV	*dbenv;
+	char	*name;
+	DBTYPE	dbtype;
+	char	**clist;
+	u_int	flags;
+	LDG	ldg;
+	int	existed;
+	int	failed;
+};
+
 static void	badend __P((DB_ENV *));
+static int	batch_add __P((DB_ENV *, BATCH *, DBT *, DBT *));
+static void	batch_free __P((BATCH *));
+static int	batch_redo __P((DB_ENV *,
+		    DB *, DB_TXN **, BATCH *, u_int32_t, int *));
 static void	badnum __P((DB_ENV *));
 static int	configure __P((DB_ENV *, DB *, char **, char **, int *));
 static int	convprintable __P((DB_ENV *, char *, char **));
-static int	db_init (DB_ENV *, char *, u_int32_t, int *);
+static int	db_init (DB_ENV *, char *, u_int32_t, u_long, int, int *);
 static int	dbt_rdump __P((DB_ENV *, DBT *));
 static int	dbt_rprint __P((DB_ENV *, DBT *));
 static int	dbt_rrecno __P((DB_ENV *, DBT *, int));
 static int	dbt_to_recno __P((DB_ENV *, DBT *, db_recno_t *));
 static int	digitize __P((DB_ENV *, int, int *));
 static int	env_create __P((DB_ENV **, LDG *));
+static int	input_error __P((DB_ENV *));
 static int	load __P((DB_ENV *, char *, DBTYPE, char **, u_int, LDG *, int *));
+static int	load_parallel __P((DB_ENV *,
+		    char *, DBTYPE, char **, u_int, LDG *, char *, int *));
+static void	*load_range_thd __P((void *));
 static int	rheader __P((DB_ENV *, DB *, DBTYPE *, char **, int *, int *));
 static int	cdb2_load_usage(void);
 static int	version_check(const char *);
 
 extern pthread_key_t comdb2_open_key;
 
-#define	G(f)	((LDG *)dbenv->app_private)->f
+/*
+ * With -j, each thread loads an input of its own, so the LDG is per thread
+ * rather than per environment.
+ */
+static __thread LDG *ldgp;
+#define	G(f)	(ldgp->f)
+
+/*
+ * Serializes configure, which edits the -c arguments in place, and the
+ * opens of the database, so that two threads do not both create it.
+ */
+static pthread_mutex_t load_lk = PTHREAD_MUTEX_INITIALIZER;
 
 					/* Flags to the load function. */
 #define	LDF_NOHEADER	0x01		/* No dump header. */
@@ -88,7 +132,7 @@ tool_cdb2_load_main(argc, argv)
 	LDG ldg;
 	u_int32_t ldf;
 	int ch, existed, exitval, ret;
-	char **clist, **clp;
+	char **clist, **clp, *fopt;
 
 	ldg.progname = "cdb2_load";
 	ldg.lineno = 0;
@@ -98,6 +142,11 @@ tool_cdb2_load_main(argc, argv)
 	ldg.hdrbuf = NULL;
 	ldg.home = NULL;
 	ldg.passwd = NULL;
+	ldg.batch = 0;
+	ldg.threads = 1;
+	ldg.in = NULL;
+	ldgp = &ldg;
+	fopt = NULL;
 
 	Pthread_key_create(&comdb2_open_key, NULL);
 
@@ -114,21 +163,31 @@ tool_cdb2_load_main(argc, argv)
 		return (EXIT_FAILURE);
 	}
 
-	while ((ch = getopt(argc, argv, "c:f:h:nP:Tt:V")) != EOF)
+	while ((ch = getopt(argc, argv, "b:c:f:h:j:nP:Tt:V")) != EOF)
 		switch (ch) {
+		case 'b':
+			if (__db_getulong(NULL, ldg.progname,
+			    optarg, 1, 0, &ldg.batch))
+				return (EXIT_FAILURE);
+			break;
 		case 'c':
 			*clp++ = optarg;
 			break;
 		case 'f':
-			if (freopen(optarg, "r", stdin) == NULL) {
-				fprintf(stderr, "%s: %s: reopen: %s\n",
-				    ldg.progname, optarg, strerror(errno));
-				return (EXIT_FAILURE);
-			}
+			fopt = optarg;
 			break;
 		case 'h':
 			ldg.home = optarg;
 			break;
+		case 'j':
+			ldg.threads = atoi(optarg);
+			if (ldg.threads < 1) {
+				fprintf(stderr,
+				    "%s: -j needs a positive number of threads\n",
+				    ldg.progname);
+				return (EXIT_FAILURE);
+			}
+			break;
 		case 'n':
 			ldf |= LDF_NOOVERWRITE;
 			break;
@@ -176,6 +235,29 @@ tool_cdb2_load_main(argc, argv)
 	if (argc != 1)
 		return (cdb2_load_usage());
 
+	/*
+	 * Each thread commits in batches, so that a deadlock between two of
+	 * them only costs a batch; see batch_redo.
+	 */
+	if (ldg.threads > 1 && (fopt == NULL || ldg.batch == 0)) {
+		fprintf(stderr,
+		    "%s: -j needs -f and -b\n", ldg.progname);
+		return (EXIT_FAILURE);
+	}
+
+	/* Read the input through zlib, which passes plain text through. */
+	if (ldg.threads == 1) {
+		if (fopt != NULL)
+			ldg.in = gzopen(fopt, "rb");
+		else
+			ldg.in = gzdopen(fileno(stdin), "rb");
+		if (ldg.in == NULL) {
+			fprintf(stderr, "%s: %s: open: %s\n", ldg.progname,
+			    fopt != NULL ? fopt : "stdin", strerror(errno));
+			return (EXIT_FAILURE);
+		}
+	}
+
 	/* Handle possible interruptions. */
 	__db_util_siginit();
 
@@ -186,10 +268,15 @@ tool_cdb2_load_main(argc, argv)
 	if (env_create(&dbenv, &ldg) != 0)
 		goto shutdown;
 
-	while (!ldg.endofile)
-		if (load(dbenv, argv[0], dbtype, clist, ldf,
-		    &ldg, &existed) != 0)
+	if (ldg.threads > 1) {
+		if (load_parallel(dbenv, argv[0], dbtype, clist, ldf,
+		    &ldg, fopt, &existed) != 0)
 			goto shutdown;
+	} else
+		while (!ldg.endofile)
+			if (load(dbenv, argv[0], dbtype, clist, ldf,
+			    &ldg, &existed) != 0)
+				goto shutdown;
 
 	if (0) {
 shutdown:	exitval = 1;
@@ -200,6 +287,9 @@ shutdown:	exitval = 1;
 		    "%s: dbenv->close: %s\n", ldg.progname, db_strerror(ret));
 	}
 
+	if (ldg.in != NULL)
+		(void)gzclose(ldg.in);
+
 	/* Resend any caught signal. */
 	__db_util_sigresend();
 	free(clist);
@@ -229,11 +319,13 @@ load(dbenv, name, argtype, clist, flags, ldg, existedp)
 	LDG *ldg;
 	int *existedp;
 {
+	BATCH batch;
 	DB *dbp;
 	DBT key, rkey, data, *readp, *writep;
 	DBTYPE dbtype;
 	DB_TXN *ctxn, *txn;
 	db_recno_t recno, datarecno;
+	u_long nput;
 	u_int32_t put_flags;
 	int ascii_recno, checkprint, hexkeys, keyflag, keys, resize, ret, rval;
 	char *subdb;
@@ -246,6 +338,7 @@ load(dbenv, name, argtype, clist, flags, ldg, existedp)
 	memset(&key, 0, sizeof(DBT));
 	memset(&data, 0, sizeof(DBT));
 	memset(&rkey, 0, sizeof(DBT));
+	memset(&batch, 0, sizeof(BATCH));
 
 retry_db:
 	dbtype = DB_UNKNOWN;
@@ -276,7 +369,10 @@ retry_db:
 	 * configuration changes to all databases that are loaded, e.g., all
 	 * subdatabases.)
 	 */
-	if (configure(dbenv, dbp, clist, &subdb, &keyflag))
+	Pthread_mutex_lock(&load_lk);
+	ret = configure(dbenv, dbp, clist, &subdb, &keyflag);
+	Pthread_mutex_unlock(&load_lk);
+	if (ret != 0)
 		goto err;
 
 	if (keys != 1) {
@@ -357,13 +453,17 @@ retry_db:
 #endif
 
 	/* Open the DB file. */
-	if ((ret = dbp->open(dbp, NULL, name, subdb, dbtype,
+	Pthread_mutex_lock(&load_lk);
+	ret = dbp->open(dbp, NULL, name, subdb, dbtype,
 	    DB_CREATE | (TXN_ON(dbenv) ? DB_AUTO_COMMIT : 0),
-	    __db_omode("rwrwrw"))) != 0) {
+	    __db_omode("rwrwrw"));
+	Pthread_mutex_unlock(&load_lk);
+	if (ret != 0) {
 		dbp->err(dbp, ret, "DB->open: %s", name);
 		goto err;
 	}
-	if (ldg->private != 0) {
+	/* The other threads share the environment; it cannot be resized. */
+	if (ldg->private != 0 && ldg->threads == 1) {
 		if ((ret =
 		    __db_util_cache(dbenv, dbp, &ldg->cache, &resize)) != 0)
 			goto err;
@@ -404,6 +504,7 @@ key_data:	if ((readp->data = malloc(readp->ulen = 1024)) == NULL) {
 	if (TXN_ON(dbenv) &&
 	    (ret = dbenv->txn_begin(dbenv, NULL, &txn, 0)) != 0)
 		goto err;
+	nput = 0;
 
 	/* Get each key/data pair and add them to the database. */
 	for (recno = 1; !__db_util_interrupted(); ++recno) {
@@ -453,6 +554,9 @@ retry:		if (txn != NULL)
 					goto err;
 				ctxn = NULL;
 			}
+			if (G(threads) > 1 &&
+			    batch_add(dbenv, &batch, writep, &data) != 0)
+				goto err;
 			break;
 		case DB_KEYEXIST:
 			*existedp = 1;
@@ -470,6 +574,14 @@ retry:		if (txn != NULL)
 				if ((ret = ctxn->abort(ctxn)) != 0)
 					goto err;
 				ctxn = NULL;
+				/*
+				 * The other thread may be waiting for a lock
+				 * of the batch, so release them all as well.
+				 */
+				if (G(threads) > 1 && (ret = batch_redo(dbenv,
+				    dbp, &txn, &batch, put_flags,
+				    existedp)) != 0)
+					goto err;
 				goto retry;
 			}
 			/* FALLTHROUGH */
@@ -486,6 +598,19 @@ retry:		if (txn != NULL)
 				goto err;
 			ctxn = NULL;
 		}
+
+		/*
+		 * With -b, commit every batch records, so that a large load
+		 * does not hold its locks and log in a single transaction.
+		 */
+		if (txn != NULL && G(batch) != 0 && ++nput % G(batch) == 0) {
+			ret = txn->commit(txn, DB_TXN_NOSYNC);
+			txn = NULL;
+			batch.n = 0;
+			if (ret != 0 ||
+			    (ret = dbenv->txn_begin(dbenv, NULL, &txn, 0)) != 0)
+				goto err;
+		}
 	}
 done:	rval = 0;
 	DB_ASSERT(ctxn == NULL);
@@ -518,10 +643,210 @@ err:		rval = 1;
 	if (rkey.data != NULL)
 		free(rkey.data);
 	free(data.data);
+	batch_free(&batch);
 
 	return (rval);
 }
 
+/*
+ * load_parallel --
+ *	Load <input>.0 to <input>.n - 1, the files written by cdb2_dump -j n,
+ *	into the same database from n threads.
+ */
+static int
+load_parallel(dbenv, name, dbtype, clist, flags, ldg, input, existedp)
+	DB_ENV *dbenv;
+	char *name, **clist;
+	DBTYPE dbtype;
+	u_int flags;
+	LDG *ldg;
+	char *input;
+	int *existedp;
+{
+	struct load_range *ranges, *r;
+	pthread_t *tids;
+	size_t len;
+	char *fname;
+	int failed, i;
+
+	failed = 0;
+	len = strlen(input) + 16;
+	ranges = calloc(ldg->threads, sizeof(struct load_range));
+	tids = calloc(ldg->threads, sizeof(pthread_t));
+	fname = malloc(len);
+	if (ranges == NULL || tids == NULL || fname == NULL) {
+		dbenv->err(dbenv, ENOMEM, "load ranges");
+		failed = 1;
+		goto err;
+	}
+
+	for (i = 0; i < ldg->threads; i++) {
+		r = &ranges[i];
+		r->dbenv = dbenv;
+		r->name = name;
+		r->dbtype = dbtype;
+		r->clist = clist;
+		r->flags = flags;
+		r->ldg = *ldg;
+		snprintf(fname, len, "%s.%d", input, i);
+		if ((r->ldg.in = gzopen(fname, "rb")) == NULL) {
+			dbenv->err(dbenv, errno, "open: %s", fname);
+			failed = 1;
+			goto err;
+		}
+	}
+
+	for (i = 0; i < ldg->threads; i++)
+		Pthread_create(&tids[i], NULL, load_range_thd, &ranges[i]);
+	for (i = 0; i < ldg->threads; i++) {
+		Pthread_join(tids[i], NULL);
+		failed |= ranges[i].failed;
+		*existedp |= ranges[i].existed;
+	}
+
+err:	if (ranges != NULL) {
+		for (i = 0; i < ldg->threads; i++)
+			if (ranges[i].ldg.in != NULL)
+				(void)gzclose(ranges[i].ldg.in);
+		free(ranges);
+	}
+	free(tids);
+	free(fname);
+	return (failed);
+}
+
+/*
+ * load_range_thd --
+ *	Load every dump of one input file.
+ */
+static void *
+load_range_thd(arg)
+	void *arg;
+{
+	struct load_range *r;
+
+	r = arg;
+	ldgp = &r->ldg;
+	while (!r->ldg.endofile)
+		if (load(r->dbenv, r->name, r->dbtype, r->clist,
+		    r->flags, &r->ldg, &r->existed) != 0) {
+			r->failed = 1;
+			break;
+		}
+	return (NULL);
+}
+
+/*
+ * batch_add --
+ *	Remember a pair put by the open batch, to put it again if the batch
+ *	is aborted by batch_redo.
+ */
+static int
+batch_add(dbenv, bp, key, data)
+	DB_ENV *dbenv;
+	BATCH *bp;
+	DBT *key, *data;
+{
+	DBT *dst, *src;
+	int i;
+
+	if (bp->key == NULL &&
+	    ((bp->key = calloc(G(batch), sizeof(DBT))) == NULL ||
+	    (bp->data = calloc(G(batch), sizeof(DBT))) == NULL)) {
+		dbenv->err(dbenv, ENOMEM, NULL);
+		return (1);
+	}
+	for (i = 0; i < 2; i++) {
+		dst = i == 0 ? &bp->key[bp->n] : &bp->data[bp->n];
+		src = i == 0 ? key : data;
+		if (dst->ulen < src->size) {
+			if ((dst->data = realloc(dst->data, src->size)) == NULL) {
+				dbenv->err(dbenv, ENOMEM, NULL);
+				return (1);
+			}
+			dst->ulen = src->size;
+		}
+		memcpy(dst->data, src->data, src->size);
+		dst->size = src->size;
+	}
+	bp->n++;
+	return (0);
+}
+
+/*
+ * batch_redo --
+ *	Abort the open batch after a deadlock, so that the thread it deadlocked
+ *	with gets its locks, and put the pairs of the batch again in a new one.
+ */
+static int
+batch_redo(dbenv, dbp, txnp, bp, put_flags, existedp)
+	DB_ENV *dbenv;
+	DB *dbp;
+	DB_TXN **txnp;
+	BATCH *bp;
+	u_int32_t put_flags;
+	int *existedp;
+{
+	u_long i;
+	int ret;
+
+retry:	ret = (*txnp)->abort(*txnp);
+	*txnp = NULL;
+	if (ret != 0 || (ret = dbenv->txn_begin(dbenv, NULL, txnp, 0)) != 0)
+		return (ret);
+	for (i = 0; i < bp->n; i++)
+		switch (ret =
+		    dbp->put(dbp, *txnp, &bp->key[i], &bp->data[i], put_flags)) {
+		case 0:
+			break;
+		case DB_KEYEXIST:
+			/* Another thread loaded it since. */
+			*existedp = 1;
+			break;
+		case DB_LOCK_DEADLOCK:
+			goto retry;
+		default:
+			dbenv->err(dbenv, ret, NULL);
+			return (ret);
+		}
+	return (0);
+}
+
+/*
+ * batch_free --
+ *	Free the pairs remembered for a batch.
+ */
+static void
+batch_free(bp)
+	BATCH *bp;
+{
+	u_long i;
+
+	if (bp->key == NULL)
+		return;
+	for (i = 0; i < G(batch); i++) {
+		free(bp->key[i].data);
+		if (bp->data != NULL)
+			free(bp->data[i].data);
+	}
+	free(bp->key);
+	free(bp->data);
+}
+
+/*
+ * input_error --
+ *	Return if reading the input failed, rather than reached its end.
+ */
+static int
+input_error(dbenv)
+	DB_ENV *dbenv;
+{
+	int errnum;
+
+	(void)gzerror(G(in), &errnum);
+	return (errnum != Z_OK);
+}
+
 /*
  * env_create --
  *	Create the environment and initialize it for error reporting.
@@ -547,7 +872,8 @@ env_create(dbenvp, ldg)
 		dbenv->err(dbenv, ret, "set_passwd");
 		return (ret);
 	}
-	if ((ret = db_init(dbenv, ldg->home, ldg->cache, &ldg->private)) != 0)
+	if ((ret = db_init(dbenv, ldg->home, ldg->cache, ldg->batch,
+	    ldg->threads, &ldg->private)) != 0)
 		return (ret);
 	dbenv->app_private = ldg;
 
@@ -559,10 +885,12 @@ env_create(dbenvp, ldg)
  *	Initialize the environment.
  */
 static int
-db_init(dbenv, home, cache, is_private)
+db_init(dbenv, home, cache, batch, threads, is_private)
 	DB_ENV *dbenv;
 	char *home;
 	u_int32_t cache;
+	u_long batch;
+	int threads;
 	int *is_private;
 {
 	u_int32_t flags;
@@ -572,6 +900,15 @@ db_init(dbenv, home, cache, is_private)
 	/* We may be loading into a live environment.  Try and join. */
 	flags = DB_USE_ENVIRON |
 	    DB_INIT_LOCK | DB_INIT_LOG | DB_INIT_MPOOL | DB_INIT_TXN;
+	if (threads > 1) {
+		LF_SET(DB_THREAD);
+		/* Threads loading into one btree deadlock on its pages. */
+		if ((ret =
+		    dbenv->set_lk_detect(dbenv, DB_LOCK_DEFAULT)) != 0) {
+			dbenv->err(dbenv, ret, "set_lk_detect");
+			return (1);
+		}
+	}
 	if (dbenv->open(dbenv, home, flags, 0) == 0)
 		return (0);
 
@@ -585,9 +922,12 @@ db_init(dbenv, home, cache, is_private)
 	 *
 	 * No environment exists (or, at least no environment that includes
 	 * an mpool region exists).  Create one, but make it private so that
-	 * no files are actually created.
+	 * no files are actually created.  With -b the private environment is
+	 * still transactional, so that the batches are real commits; its log
+	 * files are written to the home directory.
 	 */
-	LF_CLR(DB_INIT_LOCK | DB_INIT_LOG | DB_INIT_TXN);
+	if (batch == 0)
+		LF_CLR(DB_INIT_LOCK | DB_INIT_LOG | DB_INIT_TXN);
 	LF_SET(DB_CREATE | DB_PRIVATE);
 	*is_private = 1;
 	if ((ret = dbenv->set_cachesize(dbenv, 0, cache, 1)) != 0) {
@@ -758,8 +1098,8 @@ memerr:			dbp->errx(dbp, "could not allocate buffer %d", buflen);
 		buf = &G(hdrbuf)[start];
 		if (hdr == 0) {
 			for (;;) {
-				if ((ch = getchar()) == EOF) {
-					if (!first || ferror(stdin))
+				if ((ch = gzgetc(G(in))) == EOF) {
+					if (!first || input_error(dbenv))
 						goto badfmt;
 					G(endofile) = 1;
 					break;
@@ -984,7 +1324,7 @@ dbt_rprint(dbenv, dbtp)
 
 	first = 1;
 	e = escape = 0;
-	for (p = dbtp->data, len = 0; (c1 = getchar()) != '\n';) {
+	for (p = dbtp->data, len = 0; (c1 = gzgetc(G(in))) != '\n';) {
 		if (c1 == EOF) {
 			if (len == 0) {
 				G(endofile) = G(endodata) = 1;
@@ -998,8 +1338,8 @@ dbt_rprint(dbenv, dbtp)
 			if (G(version) > 1) {
 				if (c1 != ' ') {
 					buf[0] = c1;
-					if (fgets(buf + 1,
-					    sizeof(buf) - 1, stdin) == NULL ||
+					if (gzgets(G(in), buf + 1,
+					    sizeof(buf) - 1) == NULL ||
 					    strcmp(buf, "DATA=END\n") != 0) {
 						badend(dbenv);
 						return (1);
@@ -1012,7 +1352,7 @@ dbt_rprint(dbenv, dbtp)
 		}
 		if (escape) {
 			if (c1 != '\\') {
-				if ((c2 = getchar()) == EOF) {
+				if ((c2 = gzgetc(G(in))) == EOF) {
 					badend(dbenv);
 					return (1);
 				}
@@ -1062,7 +1402,7 @@ dbt_rdump(dbenv, dbtp)
 
 	first = 1;
 	e = 0;
-	for (p = dbtp->data, len = 0; (c1 = getchar()) != '\n';) {
+	for (p = dbtp->data, len = 0; (c1 = gzgetc(G(in))) != '\n';) {
 		if (c1 == EOF) {
 			if (len == 0) {
 				G(endofile) = G(endodata) = 1;
@@ -1076,8 +1416,8 @@ dbt_rdump(dbenv, dbtp)
 			if (G(version) > 1) {
 				if (c1 != ' ') {
 					buf[0] = c1;
-					if (fgets(buf + 1,
-					    sizeof(buf) - 1, stdin) == NULL ||
+					if (gzgets(G(in), buf + 1,
+					    sizeof(buf) - 1) == NULL ||
 					    strcmp(buf, "DATA=END\n") != 0) {
 						badend(dbenv);
 						return (1);
@@ -1088,7 +1428,7 @@ dbt_rdump(dbenv, dbtp)
 				continue;
 			}
 		}
-		if ((c2 = getchar()) == EOF) {
+		if ((c2 = gzgetc(G(in))) == EOF) {
 			badend(dbenv);
 			return (1);
 		}
@@ -1125,7 +1465,7 @@ dbt_rrecno(dbenv, dbtp, ishex)
 
 	++G(lineno);
 
-	if (fgets(buf, sizeof(buf), stdin) == NULL) {
+	if (gzgets(G(in), buf, sizeof(buf)) == NULL) {
 		G(endofile) = G(endodata) = 1;
 		return (0);
 	}
@@ -1251,11 +1591,14 @@ static int
 cdb2_load_usage()
 {
 	(void)fprintf(stderr,
-	    "usage: cdb2_load [-nTV] [-c name=value] [-f file]\n\t"
-    "[-h home] [-P password] [-t btree | hash | recno | queue] db_file\n"
+	    "usage: cdb2_load [-nTV] [-b batch] [-c name=value] [-f file]\n\t"
+    "[-h home] [-j threads] [-P password]\n\t"
+    "[-t btree | hash | recno | queue] db_file\n"
+    "    -b   - commit every batch records (default: one transaction)\n"
     "    -c   - configuration in name=value format\n"
-    "    -f   - file to open\n"
+    "    -f   - file to open, plain or gzip\n"
     "    -h   - home directory for db\n"
+    "    -j   - load file.0 to file.n - 1 with n threads (needs -f, -b)\n"
     "    -n   - do not overwrite\n"
     "    -P   - password file\n"
     "    -T   - no header\n"
@@ -38,22 +38,85 @@
 #include <cinttypes>
 #include <cassert>
 #include <limits.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <functional>
 
 #include "cdb2api.h"
 #include "cson.h"
 
 static cdb2_hndl_tp *cdb2h = nullptr;
 char *dbname;
-int had_errors = 0;
+/* Per-thread, since every replay thread has its own handle and transactions */
+thread_local int had_errors = 0;
+std::mutex sqltrack_lk;
 std::map<std::string, std::string> sqltrack;
-std::map<std::string, std::list<cson_value*>> transactions;
+thread_local std::map<std::string, std::list<cson_value*>> transactions;
 
 bool diffs = false;
 bool verbose = false;
+bool report = false;
 int threshold_percent = 5;
+int nthreads = 0;
+double speed = 0;
 
 int64_t maxevents = 0;
 
+/* Latency histogram for one fingerprint.  Bucket i counts statements that
+   took less than 2^i microseconds (and at least 2^(i-1)). */
+struct latency_stats {
+    static const int NBUCKETS = 40;
+    std::string sql;
+    int64_t count = 0;
+    int64_t errors = 0;
+    int64_t total = 0;
+    int64_t max = 0;
+    int64_t buckets[NBUCKETS] = {0};
+
+    void add(int64_t us) {
+        int b = 0;
+        while (b < NBUCKETS - 1 && (1LL << b) <= us)
+            b++;
+        buckets[b]++;
+        count++;
+        total += us;
+        if (us > max)
+            max = us;
+    }
+
+    void merge(const latency_stats &from) {
+        if (sql.empty())
+            sql = from.sql;
+        count += from.count;
+        errors += from.errors;
+        total += from.total;
+        if (from.max > max)
+            max = from.max;
+        for (int b = 0; b < NBUCKETS; b++)
+            buckets[b] += from.buckets[b];
+    }
+
+    /* upper bound of the bucket holding the given percentile */
+    int64_t percentile(double pct) const {
+        int64_t want = (int64_t) (count * pct / 100.0 + 0.5), seen = 0;
+        if (want < 1)
+            want = 1;
+        for (int b = 0; b < NBUCKETS; b++) {
+            seen += buckets[b];
+            if (seen >= want)
+                return std::min((int64_t) 1 << b, max);
+        }
+        return max;
+    }
+};
+typedef std::map<std::string, latency_stats> replay_stats;
+
+/* where replay() records latencies for the current thread */
+thread_local replay_stats *stats = nullptr;
+
 void replay(cdb2_hndl_tp *db, cson_value *val);
 
 static const char *usage_text =
@@ -64,6 +127,9 @@ static const char *usage_text =
     "  --verbose              Lots of verbose output\n"
     "  --threshold N          Set diff threshold to N% (default 5)\n"
     "  --stopat N             Stop after N events processed\n"
+    "  --threads N            Replay connections concurrently on N handles\n"
+    "  --speed X              Honour the original arrival times, X times faster\n"
+    "  --report               Print per-fingerprint latencies and throughput\n"
     "\n"
     ;
 
@@ -76,6 +142,7 @@ void usage() {
 
 void add_fingerprint(const std::string &fingerprint, const std::string &sql) {
     std::pair<std::string, std::string> v(fingerprint, sql);
+    std::lock_guard<std::mutex> lk(sqltrack_lk);
     sqltrack.insert(v);
     if (verbose)
         std::cout << fingerprint << " -> " << sql << std::endl;
@@ -700,6 +767,7 @@ void replay(cdb2_hndl_tp *db, cson_value *event_val) {
 		    std::cerr << "Error: No fingerprint logged?" << std::endl;
 		    return;
 	    }
+	    std::lock_guard<std::mutex> lk(sqltrack_lk);
 	    auto s = sqltrack.find(fp);
 	    if (s == sqltrack.end()) {
 		    std::cerr << "Error: Unknown fingerprint? " << fp << std::endl;
@@ -708,6 +776,14 @@ void replay(cdb2_hndl_tp *db, cson_value *event_val) {
 	    sql = (*s).second.c_str();
     }
 
+    latency_stats *st = nullptr;
+    if (stats) {
+        const char *fp = get_strprop(event_val, "fingerprint");
+        st = &(*stats)[fp ? fp : ""];
+        if (st->sql.empty())
+            st->sql = sql;
+    }
+
     std::vector<uint8_t *> blobs_vect;
     bool ok = do_bindings(db, event_val, blobs_vect);
     if (!ok) {
@@ -724,6 +800,8 @@ void replay(cdb2_hndl_tp *db, cson_value *event_val) {
 
     if (rc != CDB2_OK) {
         std::cerr << "Error: run rc " << rc << ": " << cdb2_errstr(db) << std::endl;
+        if (st)
+            st->errors++;
         return;
     }
 
@@ -753,10 +831,15 @@ void replay(cdb2_hndl_tp *db, cson_value *event_val) {
     }
     if (rc != CDB2_OK_DONE) {
         fprintf(stderr, "%s next rc %d %s\n", sql, rc, cdb2_errstr(db));
+        if (st)
+            st->errors++;
         return;
     }
     int64_t end_time = hrtime();
-    int64_t new_cost = last_cost(db);
+    if (st)
+        st->add(end_time - start_time);
+    /* only needed to report diffs, and it's an extra round trip */
+    int64_t new_cost = diffs ? last_cost(db) : 0;
 
     cson_object *obj;
     cson_value_fetch_object(event_val, &obj);
@@ -884,8 +967,11 @@ void handle_newsql(cdb2_hndl_tp *db, cson_value *val) {
        statement types, unless the user is malicious and extremely 
        clever, in which case we punish them with bad logging.
      */
-    if (sqltrack.find(fingerprint) != sqltrack.end())
-        return;
+    {
+        std::lock_guard<std::mutex> lk(sqltrack_lk);
+        if (sqltrack.find(fingerprint) != sqltrack.end())
+            return;
+    }
 
     add_fingerprint(std::string(fingerprint), std::string(sql));
 }
@@ -1058,10 +1144,81 @@ protected:
     std::vector<event_source> sources;
 };
 
+/* TODO: tier should be an option */
+int open_db(cdb2_hndl_tp **hndl) {
+    char *conf = getenv("CDB2_CONFIG");
+    if (conf) {
+        cdb2_set_comdb2db_config(conf);
+        return cdb2_open(hndl, dbname, "default", 0);
+    }
+    return cdb2_open(hndl, dbname, "local", 0);
+}
+
+/* With --speed, wait until the event is due: its offset from the first event
+   in the log, divided by the speed, after replay started. */
+struct pacer {
+    int64_t first_event = -1;
+    int64_t start = 0;
+
+    void wait(cson_value *event_val) {
+        int64_t t;
+        if (speed <= 0 || !get_intprop(event_val, "time", &t))
+            return;
+        if (first_event < 0) {
+            first_event = t;
+            start = hrtime();
+            return;
+        }
+        int64_t due = start + (int64_t) ((t - first_event) / speed);
+        int64_t now = hrtime();
+        if (due > now)
+            usleep(due - now);
+    }
+};
+
+void print_report(const replay_stats &all, int64_t elapsed, int64_t numevents) {
+    double secs = elapsed / 1000000.0;
+    if (secs <= 0)
+        secs = 1e-6;
+    printf("Replayed %" PRId64 " events in %.3f seconds, %.1f events/sec\n",
+           numevents, secs, numevents / secs);
+
+    std::vector<const std::pair<const std::string, latency_stats> *> order;
+    for (auto &it : all)
+        order.push_back(&it);
+    std::sort(order.begin(), order.end(), [](const std::pair<const std::string, latency_stats> *a,
+                                             const std::pair<const std::string, latency_stats> *b) {
+        return a->second.count > b->second.count;
+    });
+
+    printf("%-32s %8s %6s %9s %9s %9s %9s %9s %9s  %s\n", "fingerprint", "count", "errors", "per_sec", "avg_us",
+           "p50_us", "p90_us", "p99_us", "max_us", "sql");
+    for (auto it : order) {
+        const latency_stats &st = it->second;
+        std::string sql = st.sql.substr(0, 60);
+        std::replace(sql.begin(), sql.end(), '\n', ' ');
+        printf("%-32s %8" PRId64 " %6" PRId64 " %9.1f %9" PRId64 " %9" PRId64 " %9" PRId64 " %9" PRId64
+               " %9" PRId64 "  %s\n",
+               it->first.c_str(), st.count, st.errors, st.count / secs, st.count ? st.total / st.count : 0,
+               st.percentile(50), st.percentile(90), st.percentile(99), st.max, sql.c_str());
+        if (verbose) {
+            for (int b = 0; b < latency_stats::NBUCKETS; b++) {
+                if (st.buckets[b])
+                    printf("    < %" PRId64 "us: %" PRId64 "\n", (int64_t) 1 << b, st.buckets[b]);
+            }
+        }
+    }
+}
+
 void process_events(cdb2_hndl_tp *db, event_queue &queue) {
     std::string line;
     int linenum = 0;
     int64_t numevents = 0;
+    replay_stats all;
+    pacer pace;
+
+    stats = &all;
+    int64_t start = hrtime();
 
     while (!queue.empty()) {
         int rc;
@@ -1069,17 +1226,12 @@ void process_events(cdb2_hndl_tp *db, event_queue &queue) {
         cson_value *event_val = queue.get();
         const char *type = get_strprop(event_val, "type");
         if (type != nullptr) {
+            pace.wait(event_val);
             handle(cdb2h, type, event_val);
             if (had_errors) {
                 had_errors = 0;
                 cdb2_close(cdb2h);
-                char *conf = getenv("CDB2_CONFIG");
-                if (conf) {
-                    cdb2_set_comdb2db_config(conf);
-                    rc = cdb2_open(&cdb2h, dbname, "default", 0);
-                } else { 
-                    rc = cdb2_open(&cdb2h, dbname, "local", 0);
-                }
+                rc = open_db(&cdb2h);
                 db = cdb2h;
             }
             numevents++;
@@ -1091,6 +1243,152 @@ void process_events(cdb2_hndl_tp *db, event_queue &queue) {
     }
     if (verbose)
         std::cout << "got " << linenum  << " lines" << std::endl;
+    if (report)
+        print_report(all, hrtime() - start, numevents);
+    stats = nullptr;
+}
+
+/* Replays the events of the connections hashed to it, in order, on its own
+   handle. */
+struct replay_worker {
+    static const size_t MAX_QUEUED = 10000;
+
+    std::thread thd;
+    std::mutex lk;
+    std::condition_variable cond;
+    std::deque<cson_value *> queue;
+    bool done = false;
+    bool failed = false;
+    replay_stats stats;
+
+    /* Stop replaying: the run fails, and the events still queued are dropped */
+    void fail(cdb2_hndl_tp *db) {
+        std::cerr << "Error: cdb2_open() failed: " << cdb2_errstr(db) << std::endl;
+        cdb2_close(db);
+        std::lock_guard<std::mutex> l(lk);
+        failed = true;
+        for (auto event_val : queue)
+            cson_free_value(event_val);
+        queue.clear();
+        cond.notify_all();
+    }
+
+    void run() {
+        cdb2_hndl_tp *db = nullptr;
+        if (open_db(&db) != 0) {
+            fail(db);
+            return;
+        }
+        cdb2_run_statement(db, "set getcost on");
+        ::stats = &stats;
+
+        for (;;) {
+            cson_value *event_val;
+            {
+                std::unique_lock<std::mutex> l(lk);
+                cond.wait(l, [this] { return done || !queue.empty(); });
+                if (queue.empty())
+                    break;
+                event_val = queue.front();
+                queue.pop_front();
+            }
+            cond.notify_all();
+
+            handle(db, get_strprop(event_val, "type"), event_val);
+            if (had_errors) {
+                had_errors = 0;
+                cdb2_close(db);
+                if (open_db(&db) != 0) {
+                    fail(db);
+                    ::stats = nullptr;
+                    return;
+                }
+            }
+        }
+        cdb2_close(db);
+        ::stats = nullptr;
+    }
+
+    bool add(cson_value *event_val) {
+        std::unique_lock<std::mutex> l(lk);
+        cond.wait(l, [this] { return failed || queue.size() < MAX_QUEUED; });
+        if (failed) {
+            cson_free_value(event_val);
+            return false;
+        }
+        queue.push_back(event_val);
+        cond.notify_all();
+        return true;
+    }
+
+    void finish() {
+        {
+            std::lock_guard<std::mutex> l(lk);
+            done = true;
+        }
+        cond.notify_all();
+        thd.join();
+    }
+};
+
+/* Events from the same client connection (or the same cnonce, for older logs
+   without connection ids) must be replayed in order on the same handle. */
+std::string connection_key(cson_value *event_val) {
+    int64_t connid;
+    if (get_intprop(event_val, "connid", &connid)) {
+        const char *host = get_strprop(event_val, "host");
+        return std::string(host ? host : "") + ":" + std::to_string(connid);
+    }
+    const char *cnonce = get_strprop(event_val, "cnonce");
+    return cnonce ? cnonce : "";
+}
+
+int process_events_concurrent(event_queue &queue) {
+    std::vector<std::unique_ptr<replay_worker>> workers;
+    int64_t numevents = 0;
+    pacer pace;
+    int rc = 0;
+
+    for (int i = 0; i < nthreads; i++) {
+        workers.emplace_back(new replay_worker());
+        replay_worker *w = workers.back().get();
+        w->thd = std::thread([w] { w->run(); });
+    }
+
+    int64_t start = hrtime();
+    std::hash<std::string> hasher;
+    while (!queue.empty()) {
+        cson_value *event_val = queue.get();
+        const char *type = get_strprop(event_val, "type");
+        if (type == nullptr) {
+            cson_free_value(event_val);
+            continue;
+        }
+        pace.wait(event_val);
+        if (strcmp(type, "newsql") == 0) {
+            /* Fingerprint registrations carry no connection: register them
+               here, before any worker can replay a statement that uses them */
+            handle(nullptr, type, event_val);
+        } else if (!workers[hasher(connection_key(event_val)) % workers.size()]->add(event_val)) {
+            rc = 1;
+            break;
+        }
+        numevents++;
+        if (maxevents && numevents >= maxevents)
+            break;
+    }
+
+    replay_stats all;
+    for (auto &w : workers) {
+        w->finish();
+        if (w->failed)
+            rc = 1;
+        for (auto &it : w->stats)
+            all[it.first].merge(it.second);
+    }
+    if (report)
+        print_report(all, hrtime() - start, numevents);
+    return rc;
 }
 
 int main(int argc, char **argv) {
@@ -1128,6 +1426,26 @@ int main(int argc, char **argv) {
             }
             maxevents = (int) strtol(argv[0], nullptr, 10);
         }
+        else if (strcmp(argv[0], "--threads") == 0) {
+            argc--;
+            argv++;
+            if (argc == 0) {
+                fprintf(stderr, "--threads expected an argument");
+                return 1;
+            }
+            nthreads = (int) strtol(argv[0], nullptr, 10);
+        }
+        else if (strcmp(argv[0], "--speed") == 0) {
+            argc--;
+            argv++;
+            if (argc == 0) {
+                fprintf(stderr, "--speed expected an argument");
+                return 1;
+            }
+            speed = strtod(argv[0], nullptr);
+        }
+        else if (strcmp(argv[0], "--report") == 0)
+            report = true;
         else {
             fprintf(stderr, "Unknown option %s\n", argv[0]);
         }
@@ -1138,28 +1456,23 @@ int main(int argc, char **argv) {
     argc--;
     argv++;
 
-    /* TODO: tier should be an option */
-    int rc;
-    char *conf = getenv("CDB2_CONFIG");
-    if (conf) {
-        cdb2_set_comdb2db_config(conf);
-        rc = cdb2_open(&cdb2h, dbname, "default", 0);
-    } else { 
-        rc = cdb2_open(&cdb2h, dbname, "local", 0);
+    event_queue events;
+    while (argc) {
+        events.add_source(argv[0]);
+        argc--;
+        argv++;
     }
 
+    if (nthreads > 0)
+        return process_events_concurrent(events) ? EXIT_FAILURE : 0;
+
+    int rc = open_db(&cdb2h);
     if (rc) {
         std::cerr << "Error: cdb2_open() failed: " << cdb2_errstr(cdb2h) << std::endl;
         exit(EXIT_FAILURE);
     }
     cdb2_run_statement(cdb2h, "set getcost on");
 
-    event_queue events;
-    while (argc) {
-        events.add_source(argv[0]);
-        argc--;
-        argv++;
-    }
     process_events(cdb2h, events);
 
     cdb2_close(cdb2h);
@@ -0,0 +1,134 @@
+/*
+   Copyright 2024 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include "async_writer.h"
+
+#include "error.h"
+
+#include <errno.h>
+#include <stdlib.h>
+
+AsyncWriter::AsyncWriter(fdostream& out, size_t bufsize, unsigned nbufs)
+    : m_out(out), m_current(NULL), m_stop(false), m_failed(false), m_errno(0)
+{
+    for (unsigned ii = 0; ii < nbufs; ++ii) {
+        uint8_t *buf;
+        if (posix_memalign((void **)&buf, 512, bufsize)) {
+            for (size_t jj = 0; jj < m_bufs.size(); ++jj)
+                free(m_bufs[jj]);
+            throw Error("Failed to allocate output buffer");
+        }
+        m_bufs.push_back(buf);
+        m_free.push_back(buf);
+    }
+    m_thread = std::thread(&AsyncWriter::writer, this);
+}
+
+AsyncWriter::~AsyncWriter()
+{
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    m_thread.join();
+
+    for (size_t ii = 0; ii < m_bufs.size(); ++ii)
+        free(m_bufs[ii]);
+}
+
+void AsyncWriter::writer()
+{
+    std::unique_lock<std::mutex> lk(m_mutex);
+    while (true) {
+        m_cond.wait(lk, [this] { return m_stop || !m_queue.empty(); });
+        if (m_queue.empty())
+            return;
+
+        Op op = m_queue.front();
+        bool failed = m_failed;
+        lk.unlock();
+
+        // Keep draining after a failure so that buffers are still released
+        int err = 0;
+        if (!failed && op.data) {
+            if (!m_out.write((const char *)op.data, op.length))
+                err = errno ? errno : EIO;
+        } else if (!failed && op.skip) {
+            if (m_out.skip(op.skip))
+                err = errno ? errno : EIO;
+        }
+
+        lk.lock();
+        if (err && !m_failed) {
+            m_failed = true;
+            m_errno = err;
+        }
+        if (op.release)
+            m_free.push_back(op.release);
+        m_queue.pop_front();
+        m_cond.notify_all();
+    }
+}
+
+void AsyncWriter::enqueue(const Op& op)
+{
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_queue.push_back(op);
+    }
+    m_cond.notify_all();
+}
+
+uint8_t *AsyncWriter::buffer()
+{
+    if (m_current) {
+        Op op = {NULL, 0, 0, m_current};
+        enqueue(op);
+        m_current = NULL;
+    }
+
+    std::unique_lock<std::mutex> lk(m_mutex);
+    m_cond.wait(lk, [this] { return !m_free.empty(); });
+    m_current = m_free.back();
+    m_free.pop_back();
+    return m_current;
+}
+
+bool AsyncWriter::write(const uint8_t *data, size_t length)
+{
+    Op op = {data, length, 0, NULL};
+    enqueue(op);
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return !m_failed;
+}
+
+int AsyncWriter::skip(unsigned long long nbytes)
+{
+    Op op = {NULL, 0, nbytes, NULL};
+    enqueue(op);
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_failed ? -1 : 0;
+}
+
+bool AsyncWriter::flush()
+{
+    std::unique_lock<std::mutex> lk(m_mutex);
+    m_cond.wait(lk, [this] { return m_queue.empty(); });
+    return !m_failed;
+}
@@ -0,0 +1,85 @@
+/*
+   Copyright 2024 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef INCLUDED_ASYNC_WRITER
+#define INCLUDED_ASYNC_WRITER
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "fdostream.h"
+
+class AsyncWriter {
+// Writes to an output stream on a background thread, so that reading the
+// next part of the archive from stdin overlaps with writing the previous part
+// to disk.  Data is passed in buffers owned by the writer: get a buffer with
+// buffer(), fill it, then queue any number of write() and skip() calls on it.
+// The buffer is given back to the pool on the next call to buffer().
+
+    struct Op {
+        const uint8_t *data;
+        size_t length;
+        unsigned long long skip;
+        uint8_t *release;
+    };
+
+    fdostream& m_out;
+    std::vector<uint8_t *> m_bufs;
+    std::vector<uint8_t *> m_free;
+    uint8_t *m_current;
+    std::deque<Op> m_queue;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::thread m_thread;
+    bool m_stop;
+    bool m_failed;
+    int m_errno;
+
+    void writer();
+    void enqueue(const Op& op);
+
+public:
+    AsyncWriter(fdostream& out, size_t bufsize, unsigned nbufs = 3);
+    // Allocate nbufs buffers of bufsize bytes, 512 byte aligned for direct io
+
+    ~AsyncWriter();
+    // Wait for all queued operations to complete
+
+    uint8_t *buffer();
+    // Return an empty buffer, waiting for one if they are all queued
+
+    bool write(const uint8_t *data, size_t length);
+    // Queue a write of data, which must point into the current buffer.
+    // Returns false if an earlier write or skip has failed.
+
+    int skip(unsigned long long nbytes);
+    // Queue a seek forward by nbytes.  Returns 0 on success, like
+    // fdostream::skip, or -1 if an earlier write or skip has failed.
+
+    bool flush();
+    // Wait for all queued operations and return false if any of them failed
+
+    int error() const { return m_errno; }
+    // errno of the first failed operation
+};
+
+#endif // INCLUDED_ASYNC_WRITER
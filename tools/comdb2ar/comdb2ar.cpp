@@ -6,6 +6,7 @@
 
 #include "comdb2ar.h"
 #include "util.h"
+#include "parallel_reader.h"
 
 #include <exception>
 #include <iostream>
@@ -35,6 +36,7 @@ const char *help_text[] = {
 "  Database mydb is serialised into tape archive format on to stdout.",
 "  -s   serialise support files only (lrl, csc2 etc, no data or log files)",
 "  -L   do not disable log file deletion (dangerous)",
+"  -j n read each data file with n threads (default 4)",
 "",
 "To deserialise a db: comdb2ar.tsk [opts] x [/bb/bin /bb/data/mydb] < input",
 "To deserialise a db incrementally:",
@@ -129,7 +131,7 @@ int main(int argc, char *argv[])
     ss << root << "/bin/comdb2";
     std::string comdb2_task(ss.str());
 
-    while((c = getopt(argc, argv, "hsSLC:I:b:x:u:rRSkKfODE:T:A")) != EOF) {
+    while((c = getopt(argc, argv, "hsSLC:I:b:x:u:rRSkKfODE:T:Aj:")) != EOF) {
         switch(c) {
             case 'O':
                 legacy_mode = true;
@@ -236,6 +238,15 @@ int main(int argc, char *argv[])
                 new_type = std::string(optarg);
                 break;
 
+            case 'j':
+                if (std::atoi(optarg) < 1) {
+                    std::cerr << "Invalid parameter to -j: " << optarg
+                        << std::endl;
+                    std::exit(2);
+                }
+                gbl_reader_threads = std::atoi(optarg);
+                break;
+
             case '?':
                 std::cerr << "Unrecognised option: -" << (char)c << std::endl;
                 usage();
@@ -7,6 +7,7 @@
 #include "lrlerror.h"
 #include "tar_header.h"
 #include "riia.h"
+#include "async_writer.h"
 #include "increment.h"
 #include "util.h"
 #include "ar_wrap.h"
@@ -678,6 +679,12 @@ void deserialise_database(
 #endif
         RIIA_malloc free_guard(buf);
 
+        // Write the data out from a background thread while the next part of
+        // the archive is read from stdin
+        std::unique_ptr<AsyncWriter> writer;
+        if (of_ptr)
+            writer.reset(new AsyncWriter(*of_ptr, bufsize));
+
         // Read the tar data in and write it out
         unsigned long long bytesleft = filesize;
         unsigned long long pageno = 0;
@@ -703,7 +710,9 @@ void deserialise_database(
             if (readbytes > bytesleft)
                 readbytes = bytesleft;
 
-            if(readall(0, &buf[0], readbytes) != readbytes)
+            uint8_t *rdbuf = writer ? writer->buffer() : buf;
+
+            if(readall(0, &rdbuf[0], readbytes) != readbytes)
             {
                std::ostringstream ss;
 
@@ -721,12 +730,12 @@ void deserialise_database(
 
             if(is_text)
             {
-               text.append((char*) &buf[0], readbytes);
+               text.append((char*) &rdbuf[0], readbytes);
             }
             else if (file_is_sparse &&
                (readbytes == pagesize) && (bytesleft > readbytes) )
             {
-               if (memcmp(empty_page, &buf[0], pagesize) == 0)
+               if (memcmp(empty_page, &rdbuf[0], pagesize) == 0)
                {
                   skipped_bytes += pagesize;
                   /* This data won't be counted towards file size.*/
@@ -736,7 +745,7 @@ void deserialise_database(
                {
                   if (skipped_bytes)
                   {
-                     if((of_ptr->skip(skipped_bytes)))
+                     if((writer->skip(skipped_bytes)))
                      {
                         std::ostringstream ss;
 
@@ -749,7 +758,7 @@ void deserialise_database(
                      }
                      skipped_bytes = 0;
                   }
-                  if (!of_ptr->write((char*) buf, pagesize))
+                  if (!writer->write(rdbuf, pagesize))
                   {
                      std::ostringstream ss;
 
@@ -770,7 +779,7 @@ void deserialise_database(
 
                 if (file_is_sparse && skipped_bytes)
                 {
-                    if((of_ptr->skip(skipped_bytes)))
+                    if((writer->skip(skipped_bytes)))
                     {
                         std::ostringstream ss;
 
@@ -791,7 +800,7 @@ void deserialise_database(
                         lim = bytes;
                     else
                         lim = write_size;
-                    if (!of_ptr->write((char*) &buf[off], lim))
+                    if (!writer->write(&rdbuf[off], lim))
                     {
                         std::ostringstream ss;
 
@@ -840,6 +849,17 @@ void deserialise_database(
             }
         }
 
+        if (writer && !writer->flush()) {
+            std::ostringstream ss;
+
+            if (filename == "FLUFF")
+                return;
+
+            ss << "Error Writing " << filename << ": "
+               << writer->error() << " " << strerror(writer->error());
+            throw Error(ss);
+        }
+
         // Read and discard the null padding
         unsigned long long padding_bytes = (nblocks << 9) - filesize;
         if(padding_bytes) {
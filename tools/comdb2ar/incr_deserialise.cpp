@@ -3,6 +3,7 @@
 #include "increment.h"
 #include "error.h"
 #include "riia.h"
+#include "async_writer.h"
 #include "fdostream.h"
 #include "serialiseerror.h"
 #include "ar_wrap.h"
@@ -252,6 +253,10 @@ void unpack_full_file(
 #endif
     RIIA_malloc free_guard(buf);
 
+    // Write the data out from a background thread while the next part of
+    // the archive is read from stdin
+    AsyncWriter writer(*incr_of_ptr, bufsize);
+
     // Read the tar data in and write it out
     unsigned long long bytesleft = filesize;
     unsigned long long pageno = 0;
@@ -279,7 +284,9 @@ void unpack_full_file(
         if (readbytes > bytesleft)
             readbytes = bytesleft;
 
-        if(readall(0, &buf[0], readbytes) != readbytes)
+        uint8_t *rdbuf = writer.buffer();
+
+        if(readall(0, &rdbuf[0], readbytes) != readbytes)
         {
            std::ostringstream ss;
 
@@ -298,7 +305,7 @@ void unpack_full_file(
         if (file_is_sparse &&
            (readbytes == pagesize) && (bytesleft > readbytes) )
         {
-            if (memcmp(empty_page, &buf[0], pagesize) == 0)
+            if (memcmp(empty_page, &rdbuf[0], pagesize) == 0)
             {
                 skipped_bytes += pagesize;
                 /* This data won't be counted towards file size.*/
@@ -308,7 +315,7 @@ void unpack_full_file(
             {
                 if (skipped_bytes)
                 {
-                    if((incr_of_ptr->skip(skipped_bytes)))
+                    if((writer.skip(skipped_bytes)))
                     {
                         std::ostringstream ss;
 
@@ -321,7 +328,7 @@ void unpack_full_file(
                     }
                     skipped_bytes = 0;
                 }
-                if (!incr_of_ptr->write((char*) buf, pagesize))
+                if (!writer.write(rdbuf, pagesize))
                 {
                     std::ostringstream ss;
 
@@ -343,7 +350,7 @@ void unpack_full_file(
 
             if (file_is_sparse && skipped_bytes)
             {
-                if((incr_of_ptr->skip(skipped_bytes)))
+                if((writer.skip(skipped_bytes)))
                 {
                     std::ostringstream ss;
 
@@ -365,7 +372,7 @@ void unpack_full_file(
                 else
                     lim = write_size;
 
-                if (!incr_of_ptr->write((char*) &buf[off], lim)) {
+                if (!writer.write(&rdbuf[off], lim)) {
 
                     std::ostringstream ss;
 
@@ -415,6 +422,17 @@ void unpack_full_file(
         }
     }
 
+    if (!writer.flush()) {
+        std::ostringstream ss;
+
+        if (filename == "FLUFF")
+            return;
+
+        ss << "Error Writing " << filename << ": "
+           << writer.error() << " " << strerror(writer.error());
+        throw Error(ss);
+    }
+
     // Read and discard the null padding
     unsigned long long padding_bytes = (nblocks << 9) - filesize;
     if(padding_bytes) {
@@ -6,6 +6,7 @@
 #include "error.h"
 #include "tar_header.h"
 #include "riia.h"
+#include "parallel_reader.h"
 #include "cdb2_constants.h"
 
 #include <sys/stat.h>
@@ -247,7 +248,6 @@ ssize_t serialise_incr_file(
     const std::string& filepath = file.get_filepath();
 
     int flags;
-    bool skip_iomap = false;
     std::ostringstream ss;
 
     // Ensure large file support
@@ -264,68 +264,57 @@ ssize_t serialise_incr_file(
         pagesize = 4096;
     }
 
-    std::ifstream ifs (filepath, std::ifstream::in | std::ifstream::binary);
-
-    char *char_pagebuf = NULL;
-    uint8_t *pagebuf = NULL;
-
-#if ! defined  ( _SUN_SOURCE )
-    if(posix_memalign((void**) &pagebuf, 512, pagesize))
-        throw Error("Failed to allocate output buffer");
-#else
-    pagebuf = (uint8_t*) memalign(512, pagesize);
-#endif
+    int fd = open(filepath.c_str(), O_RDONLY);
+    if(fd == -1) {
+        ss << "cannot open file: " << std::strerror(errno);
+        throw SerialiseError(filename, ss.str());
+    }
+    RIIA_fd fd_guard(fd);
+
+    // Coalesce runs of consecutive changed pages into larger reads, which
+    // are spread over several reader threads.
+    std::vector<ReadChunk> chunks;
+    std::vector<uint32_t> first_pages;
+    for(size_t ii = 0; ii < pages.size(); ++ii) {
+        if(!chunks.empty() && pages[ii] == pages[ii - 1] + 1 &&
+           chunks.back().length + pagesize <= MAX_BUF_SIZE) {
+            chunks.back().length += pagesize;
+            continue;
+        }
+        chunks.push_back(ReadChunk((off_t)pagesize * pages[ii], pagesize));
+        first_pages.push_back(pages[ii]);
+    }
 
     ssize_t total_read = 0;
     ssize_t total_written = 0;
-    int retry = 5;
 
     std::string incrFilename = incr_path + "/" + filename + ".incr";
 
     std::ofstream incrFile(incrFilename, std::ofstream::out |
                             std::ofstream::in | std::ofstream::binary);
 
-    for(std::vector<uint32_t>::iterator
-            it = pages.begin();
-            it != pages.end();
-            ++it){
-tryagain:
-        ifs.seekg(pagesize * *it, ifs.beg);
-        ifs.read((char *)&pagebuf[0], pagesize);
-        ssize_t bytes_read = ifs.gcount();
-        if(bytes_read < pagesize) {
-            std::ostringstream ss;
-            ss << "read error";
-            throw SerialiseError(filename, ss.str());
-        }
-
-        uint32_t cksum;
-        bool crypto = file.get_crypto();
-        bool swapped = file.get_swapped();
+    ParallelReader reader(fd, file, chunks, pagesize, true, NULL,
+                          gbl_reader_threads);
+    const std::vector<uint32_t> *cksums;
+    const uint8_t *pagebuf;
+    size_t bytes_read;
 
-        if ((verify_checksum(pagebuf, pagesize, crypto, swapped, &cksum))
-            == 0) {
-            if(--retry == 0) {
-                std::ostringstream ss;
-                ss << "serialise_file:page failed checksum verification";
-                throw SerialiseError(filename, ss.str());
-            }
-
-            goto tryagain;
-        }
-
-        retry = 5;
+    for(size_t chunk = 0;
+        (pagebuf = reader.next(bytes_read, &cksums)) != NULL;
+        ++chunk) {
 
         // Update the diff .incr file
-        incrFile.seekp(12 * *it, incrFile.beg);
-        PAGE * pagep = (PAGE *) pagebuf;
+        for(size_t ii = 0; ii < cksums->size(); ++ii) {
+            PAGE * pagep = (PAGE *) (pagebuf + ii * pagesize);
 
-        incrFile.write((char *) &(LSN(pagep).file), 4);
-        incrFile.write((char *) &(LSN(pagep).offset), 4);
-        incrFile.write((char *) &cksum, 4);
+            incrFile.seekp(12 * (first_pages[chunk] + ii), incrFile.beg);
+            incrFile.write((char *) &(LSN(pagep).file), 4);
+            incrFile.write((char *) &(LSN(pagep).offset), 4);
+            incrFile.write((char *) &(*cksums)[ii], 4);
+        }
 
-        ssize_t bytes_written = writeall(1, pagebuf, pagesize);
-        if(bytes_written != pagesize){
+        ssize_t bytes_written = writeall(1, pagebuf, bytes_read);
+        if(bytes_written != bytes_read){
             std::ostringstream ss;
             ss << "error writing text data: " << std::strerror(errno);
             throw SerialiseError(filename, ss.str());
@@ -342,9 +331,6 @@ tryagain:
         }
     }
 
-    if (pagebuf)
-        free(pagebuf);
-
     std::clog << "a " << filename << " pages=[";
     for(size_t i = 0; i < pages.size(); ++i){
         std::clog << pages[i];
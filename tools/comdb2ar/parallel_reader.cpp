@@ -0,0 +1,226 @@
+/*
+   Copyright 2024 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include "parallel_reader.h"
+
+#include "ar_wrap.h"
+#include "error.h"
+#include "file_info.h"
+#include "serialiseerror.h"
+
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+unsigned gbl_reader_threads = 4;
+
+ParallelReader::ParallelReader(int fd, const FileInfo& file,
+        const std::vector<ReadChunk>& chunks, size_t pagesize,
+        bool verify, volatile iomap *iomap, unsigned nthreads)
+    : m_fd(fd), m_file(file), m_chunks(chunks), m_pagesize(pagesize),
+      m_verify(verify), m_iomap(iomap), m_next_read(0), m_next_out(0),
+      m_released(0), m_stop(false), m_skip_iomap(false), m_num_waits(0)
+{
+    size_t maxlen = 0;
+    for (size_t ii = 0; ii < chunks.size(); ++ii) {
+        if (chunks[ii].length > maxlen)
+            maxlen = chunks[ii].length;
+    }
+    // Checksums are always computed over whole pages
+    maxlen = (maxlen + pagesize - 1) / pagesize * pagesize;
+
+    if (nthreads == 0)
+        nthreads = 1;
+    if (nthreads > chunks.size())
+        nthreads = chunks.size();
+
+    // Two buffers per reader lets every reader work on a chunk while the
+    // caller is still writing out the previous ones.
+    m_slots.resize(nthreads * 2);
+    for (size_t ii = 0; ii < m_slots.size(); ++ii) {
+        m_slots[ii].buf = NULL;
+        m_slots[ii].length = 0;
+        m_slots[ii].ready = false;
+    }
+    for (size_t ii = 0; ii < m_slots.size() && maxlen > 0; ++ii) {
+        if (posix_memalign((void **)&m_slots[ii].buf, 512, maxlen)) {
+            for (size_t jj = 0; jj < ii; ++jj)
+                free(m_slots[jj].buf);
+            throw Error("Failed to allocate read buffer");
+        }
+    }
+
+    for (unsigned ii = 0; ii < nthreads; ++ii)
+        m_threads.push_back(std::thread(&ParallelReader::reader, this));
+}
+
+ParallelReader::~ParallelReader()
+{
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+
+    for (size_t ii = 0; ii < m_threads.size(); ++ii)
+        m_threads[ii].join();
+
+    for (size_t ii = 0; ii < m_slots.size(); ++ii)
+        free(m_slots[ii].buf);
+}
+
+void ParallelReader::reader()
+{
+    while (true) {
+        size_t idx;
+        {
+            std::unique_lock<std::mutex> lk(m_mutex);
+            // Don't run further ahead of the caller than we have buffers for
+            m_cond.wait(lk, [this] {
+                return m_stop || m_next_read >= m_chunks.size() ||
+                       m_next_read < m_released + m_slots.size();
+            });
+            if (m_stop || m_next_read >= m_chunks.size())
+                return;
+            idx = m_next_read++;
+        }
+
+        Slot& slot = m_slots[idx % m_slots.size()];
+        slot.error.clear();
+        slot.cksums.clear();
+        read_chunk(m_chunks[idx], slot);
+
+        {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            slot.ready = true;
+        }
+        m_cond.notify_all();
+    }
+}
+
+void ParallelReader::wait_for_iomap()
+{
+    while (!m_skip_iomap && m_iomap != NULL && m_iomap->memptrickle_time) {
+        int now = time(NULL);
+        if ((now - m_iomap->memptrickle_time) > 5*60) {
+            if (!m_skip_iomap.exchange(true)) {
+                std::clog << "long memptrickle (" << now - m_iomap->memptrickle_time
+                          << " seconds), continuing" << std::endl;
+            }
+            break;
+        }
+        m_num_waits++;
+        poll(0, 0, 100);
+    }
+}
+
+static ssize_t preadall(int fd, uint8_t *buf, size_t nbytes, off_t offset)
+{
+    size_t total = 0;
+    while (total < nbytes) {
+        ssize_t n = pread(fd, buf + total, nbytes - total, offset + total);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return n;
+        total += n;
+    }
+    return total;
+}
+
+void ParallelReader::read_chunk(const ReadChunk& chunk, Slot& slot)
+{
+    wait_for_iomap();
+
+    ssize_t bytesread = preadall(m_fd, slot.buf, chunk.length, chunk.offset);
+    if (bytesread != (ssize_t)chunk.length) {
+        std::ostringstream ss;
+        ss << "read error at offset " << chunk.offset << ", tried to read "
+           << chunk.length << " bytes " << std::strerror(errno);
+        slot.error = ss.str();
+        return;
+    }
+    slot.length = bytesread;
+
+    if (!m_verify)
+        return;
+
+    int retry = 5;
+    size_t n = 0;
+    while (n < slot.length) {
+        uint32_t verify_cksum;
+
+        if (verify_checksum(slot.buf + n, m_pagesize, m_file.get_crypto(),
+                            m_file.get_swapped(), &verify_cksum) == 1) {
+            // checksum verified
+            slot.cksums.push_back(verify_cksum);
+            n += m_pagesize;
+            retry = 5;
+            continue;
+        }
+
+        // Partial page read. Read the page again to see if it passes
+        // checksum verification.
+        if (--retry == 0) {
+            slot.error = "serialise_file:page failed checksum verification";
+            return;
+        }
+
+        // wait 500ms before reading page again
+        poll(0, 0, 500);
+
+        if (preadall(m_fd, slot.buf + n, m_pagesize, chunk.offset + n) != (ssize_t)m_pagesize) {
+            std::ostringstream ss;
+            ss << "serialise_file:read: " << std::strerror(errno);
+            slot.error = ss.str();
+            return;
+        }
+    }
+}
+
+const uint8_t *ParallelReader::next(size_t& length, const std::vector<uint32_t> **cksums)
+{
+    std::unique_lock<std::mutex> lk(m_mutex);
+
+    // The previous chunk has been consumed, so its buffer can be reused
+    if (m_released < m_next_out) {
+        m_slots[m_released % m_slots.size()].ready = false;
+        m_released = m_next_out;
+        m_cond.notify_all();
+    }
+
+    if (m_next_out >= m_chunks.size())
+        return NULL;
+
+    Slot& slot = m_slots[m_next_out % m_slots.size()];
+    m_cond.wait(lk, [&slot] { return slot.ready; });
+    ++m_next_out;
+    lk.unlock();
+
+    if (!slot.error.empty())
+        throw SerialiseError(m_file.get_filename(), slot.error);
+
+    length = slot.length;
+    if (cksums)
+        *cksums = &slot.cksums;
+    return slot.buf;
+}
@@ -0,0 +1,101 @@
+/*
+   Copyright 2024 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef INCLUDED_PARALLEL_READER
+#define INCLUDED_PARALLEL_READER
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "comdb2ar.h"
+
+class FileInfo;
+
+struct ReadChunk {
+// A byte range of a file to be read by ParallelReader
+    off_t offset;
+    size_t length;
+
+    ReadChunk(off_t offset_, size_t length_) : offset(offset_), length(length_) {}
+};
+
+class ParallelReader {
+// Reads a list of chunks from a file with a pool of threads, verifying page
+// checksums as it goes, and hands the chunks back to the caller strictly in
+// list order.  At most a fixed window of chunks is in memory at any time, so
+// the readers stay ahead of the writer without buffering the whole file.
+
+    struct Slot {
+        uint8_t *buf;
+        size_t length;
+        std::vector<uint32_t> cksums;
+        std::string error;
+        bool ready;
+    };
+
+    int m_fd;
+    const FileInfo& m_file;
+    const std::vector<ReadChunk>& m_chunks;
+    size_t m_pagesize;
+    bool m_verify;
+    volatile iomap *m_iomap;
+
+    std::vector<Slot> m_slots;
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    size_t m_next_read;     // next chunk a reader thread will pick up
+    size_t m_next_out;      // next chunk handed back to the caller
+    size_t m_released;      // chunks whose buffers may be reused
+    bool m_stop;
+    std::atomic<bool> m_skip_iomap;
+    std::atomic<int> m_num_waits;
+
+    void reader();
+    void read_chunk(const ReadChunk& chunk, Slot& slot);
+    void wait_for_iomap();
+
+public:
+    ParallelReader(int fd, const FileInfo& file,
+            const std::vector<ReadChunk>& chunks, size_t pagesize,
+            bool verify, volatile iomap *iomap, unsigned nthreads);
+    // Start nthreads readers over chunks.  Every chunk length must be a
+    // multiple of pagesize except possibly the last one.  If verify is true
+    // the checksum of every page is verified and recorded.
+
+    ~ParallelReader();
+
+    const uint8_t *next(size_t& length, const std::vector<uint32_t> **cksums = NULL);
+    // Wait for the next chunk in list order and return its data, or NULL once
+    // all chunks have been returned.  The data stays valid until the next
+    // call.  If cksums is not NULL it is pointed at the checksums of the
+    // chunk's pages.  Throws SerialiseError if the chunk could not be read.
+
+    int num_waits() const { return m_num_waits; }
+    // Number of times readers paused because the database was busy writing.
+};
+
+extern unsigned gbl_reader_threads;
+// Number of threads reading each data file (-j)
+
+#endif // INCLUDED_PARALLEL_READER
@@ -4,6 +4,7 @@
 #include "error.h"
 #include "file_info.h"
 #include "logholder.h"
+#include "parallel_reader.h"
 #include "repopnewlrl.h"
 #include "lrlerror.h"
 #include "riia.h"
@@ -129,7 +130,6 @@ static void serialise_file(FileInfo& file, volatile iomap *iomap=NULL, const std
 {
     const std::string& filename = file.get_filename();
     int flags;
-    bool skip_iomap = false;
     std::ostringstream ss;
 
     // Ensure large file support
@@ -212,141 +212,58 @@ reopen:
         pagesize = 4096;
     }
     size_t bufsize = pagesize;
-    int num_waits = 0;
-    int64_t filesize = 0;
 
     while((bufsize << 1) <= MAX_BUF_SIZE) {
         bufsize <<= 1;
     }
-#if 0
-    */
-    std::cerr<<"Computed bufsize="<<bufsize<<" for pagesize="<<pagesize<<" file="<<filename<<"\n";
-
-    std::vector<char> pagebuf(bufsize);
-#endif
-    uint8_t *pagebuf = NULL;
-    off_t bytesleft = st.st_size;
 
-#if ! defined  ( _SUN_SOURCE )
-        if(posix_memalign((void**) &pagebuf, 512, bufsize))
-            throw Error("Failed to allocate output buffer");
-#else
-        pagebuf = (uint8_t*) memalign(512, bufsize);
-#endif
+    // Split the file into buffer sized chunks which are read and checksummed
+    // by several threads, then written out here in order.
+    std::vector<ReadChunk> chunks;
+    for (off_t off = 0; off < st.st_size; off += bufsize) {
+        off_t left = st.st_size - off;
+        chunks.push_back(ReadChunk(off, left > bufsize ? bufsize : left));
+    }
 
     std::string incrFilename = incr_path + "/" + filename + ".incr";
     std::ofstream incrFile(incrFilename,
             std::ofstream::binary |
             std::ofstream::trunc);
 
-    while(bytesleft > 0) {
-        int now;
-        unsigned long long nbytes = bytesleft > bufsize ? bufsize : bytesleft;
-
-        while (!skip_iomap && iomap != NULL && iomap->memptrickle_time) {
-            now = time(NULL);
-            if ((now - iomap->memptrickle_time) > 5*60) {
-                std::clog << "long memptrickle (" << now - iomap->memptrickle_time << " seconds), continuing" << std::endl;
-                skip_iomap = true;
-                break;
-            }
-            num_waits++;
-            poll(0, 0, 100);
-        }
-
-        ssize_t bytesread = read(fd, &pagebuf[0], nbytes);
-        if(bytesread <= 0) {
-            std::ostringstream ss;
-            ss << "read error after " << bytesleft << " bytes, tried to read " << nbytes << " bytes "
-                << std::strerror(errno);
-            throw SerialiseError(filename, ss.str());
-        }
-        filesize += bytesread;
-
-        if (file.get_checksums()) {
-            // Save current offset
-            const off_t offset = lseek(fd, 0, SEEK_CUR);
-            if (offset == (off_t) -1) {
-                std::ostringstream ss;
-                ss << "serialise_file:lseek:initial: " << std::strerror(errno);
-                throw SerialiseError(filename, ss.str());
-            }
-
-            int retry = 5;
-            ssize_t n = 0;
-
-            while (n < bytesread && retry) {
-                PAGE * pagep = (PAGE *) (pagebuf + n);
-                uint32_t verify_cksum;
-
-                if ((verify_checksum(pagebuf + n, pagesize, file.get_crypto(),
-                                     file.get_swapped(), &verify_cksum)) == 1) {
-                    // checksum verified
-                    n += pagesize;
-                    retry = 5;
-
-
-                    // If we are in incremental mode, on initial backup creation we want to create the diff files
-                    if(incr_create){
-                        incrFile.write((char *) &(LSN(pagep).file), 4);
-                        incrFile.write((char *) &(LSN(pagep).offset), 4);
-                        incrFile.write((char *) &verify_cksum, 4);
-                    }
-
-                    continue;
-                }
-
-                // Partial page read. Read the page again to see if it passes
-                // checksum verification.
-                if (--retry == 0) {
-                    //giving up on this page
-                    std::ostringstream ss;
-                    ss << "serialise_file:page failed checksum verification";
-                    throw SerialiseError(filename, ss.str());
-                }
-
-                // wait 500ms before reading page again
-                poll(0, 0, 500);
-
-                // rewind and read the page again
-                off_t rewind = offset - (bytesread - n);
-                rewind = lseek(fd, rewind, SEEK_SET);
-                if (rewind == (off_t) -1) {
-                    std::ostringstream ss;
-                    ss << "serialise_file:lseek:rewind: " << std::strerror(errno);
-                    throw SerialiseError(filename, ss.str());
-                }
-
-                ssize_t nread, totalread = 0;
-                while (totalread < pagesize) {
-                    nread = read(fd, &pagebuf[0] + n + totalread,
-                                 pagesize - totalread);
-                    if (nread <= 0) {
-                        std::ostringstream ss;
-                        ss << "serialise_file:read: " << std::strerror(errno);
-                        throw SerialiseError(filename, ss.str());
-                    }
-                    totalread += nread;
+    int64_t filesize = 0;
+    off_t bytesleft = st.st_size;
+    int num_waits;
+    {
+        ParallelReader reader(fd, file, chunks, pagesize, file.get_checksums(),
+                              iomap, gbl_reader_threads);
+        const std::vector<uint32_t> *cksums;
+        const uint8_t *pagebuf;
+        size_t bytesread;
+
+        while ((pagebuf = reader.next(bytesread, &cksums)) != NULL) {
+            filesize += bytesread;
+
+            // If we are in incremental mode, on initial backup creation we want to create the diff files
+            if (incr_create) {
+                for (size_t ii = 0; ii < cksums->size(); ++ii) {
+                    PAGE *pagep = (PAGE *) (pagebuf + ii * pagesize);
+                    incrFile.write((char *) &(LSN(pagep).file), 4);
+                    incrFile.write((char *) &(LSN(pagep).offset), 4);
+                    incrFile.write((char *) &(*cksums)[ii], 4);
                 }
             }
 
-            // Restore to original offset
-            if (offset != lseek(fd, offset, SEEK_SET)) {
+            ssize_t byteswritten = writeall(1, pagebuf, bytesread);
+            if(byteswritten != bytesread) {
                 std::ostringstream ss;
-                ss << "serialise_file:lseek:reset: " << std::strerror(errno);
+                ss << "write error after " << bytesleft << "bytes: "
+                    << std::strerror(errno);
                 throw SerialiseError(filename, ss.str());
             }
-        }
 
-        ssize_t byteswritten = writeall(1, &pagebuf[0], bytesread);
-        if(byteswritten != bytesread) {
-            std::ostringstream ss;
-            ss << "write error after " << bytesleft << "bytes: "
-                << std::strerror(errno);
-            throw SerialiseError(filename, ss.str());
+            bytesleft -= bytesread;
         }
-
-        bytesleft -= bytesread;
+        num_waits = reader.num_waits();
     }
 
     file.set_filesize(filesize);
@@ -380,8 +297,6 @@ reopen:
 
 
     std::clog << std::endl;
-    if (pagebuf)
-        free(pagebuf);
 }
 
 std::string replace_dbname(const std::string& replaceWith, const std::string& dbname, 
@@ -0,0 +1,255 @@
+/*
+   Copyright 2024 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+#include "histogram.h"
+#include "list.h"
+#include <sys_wrap.h>
+
+#include "mem_util.h"
+#include "mem_override.h"
+
+#define HIST_SUB_BITS 4
+#define HIST_SUB_COUNT (1 << HIST_SUB_BITS)
+/* values of 2^HIST_MAX_BIT us (~3 days) and above go into the last bucket */
+#define HIST_MAX_BIT 38
+#define HIST_NBUCKETS ((HIST_MAX_BIT - HIST_SUB_BITS + 2) * HIST_SUB_COUNT)
+#define HIST_NSHARDS 16
+
+struct histogram_shard {
+    int64_t sum;
+    int64_t max;
+    int64_t buckets[HIST_NBUCKETS];
+} __attribute__((aligned(64)));
+
+struct comdb2_histogram {
+    char *name;
+    char *description;
+    struct histogram_shard shards[HIST_NSHARDS];
+    LINKC_T(struct comdb2_histogram) lnk;
+};
+
+comdb2_histogram *gbl_sql_latency_hist;
+comdb2_histogram *gbl_commit_latency_hist;
+comdb2_histogram *gbl_lock_wait_hist;
+comdb2_histogram *gbl_log_flush_hist;
+comdb2_histogram *gbl_rep_ack_hist;
+comdb2_histogram *gbl_bplog_apply_hist;
+
+static LISTC_T(struct comdb2_histogram) histograms;
+static pthread_mutex_t histograms_lk = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t histograms_once = PTHREAD_ONCE_INIT;
+
+static int next_shard;
+static __thread int my_shard = -1;
+
+static void init_histograms(void)
+{
+    listc_init(&histograms, offsetof(struct comdb2_histogram, lnk));
+}
+
+comdb2_histogram *comdb2_histogram_new(const char *name, const char *description)
+{
+    comdb2_histogram *h;
+
+    pthread_once(&histograms_once, init_histograms);
+
+    h = calloc(1, sizeof(comdb2_histogram));
+    if (h == NULL)
+        return NULL;
+    h->name = strdup(name);
+    h->description = strdup(description);
+    if (h->name == NULL || h->description == NULL) {
+        free(h->name);
+        free(h->description);
+        free(h);
+        return NULL;
+    }
+
+    Pthread_mutex_lock(&histograms_lk);
+    listc_abl(&histograms, h);
+    Pthread_mutex_unlock(&histograms_lk);
+
+    return h;
+}
+
+static inline int bucket_index(int64_t value)
+{
+    int msb, shift;
+
+    if (value < HIST_SUB_COUNT)
+        return value < 0 ? 0 : value;
+
+    msb = 63 - __builtin_clzll(value);
+    if (msb > HIST_MAX_BIT)
+        return HIST_NBUCKETS - 1;
+    shift = msb - HIST_SUB_BITS;
+    return (shift + 1) * HIST_SUB_COUNT + ((value >> shift) - HIST_SUB_COUNT);
+}
+
+/* highest value that lands in bucket `b` */
+static int64_t bucket_value(int b)
+{
+    int shift;
+
+    if (b < HIST_SUB_COUNT)
+        return b;
+    shift = b / HIST_SUB_COUNT - 1;
+    return (((int64_t)(b % HIST_SUB_COUNT + HIST_SUB_COUNT + 1)) << shift) - 1;
+}
+
+void comdb2_histogram_add(comdb2_histogram *h, int64_t value)
+{
+    struct histogram_shard *s;
+    int64_t max;
+
+    if (h == NULL)
+        return;
+
+    if (my_shard == -1)
+        my_shard = __atomic_fetch_add(&next_shard, 1, __ATOMIC_RELAXED) % HIST_NSHARDS;
+    s = &h->shards[my_shard];
+
+    __atomic_fetch_add(&s->buckets[bucket_index(value)], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&s->sum, value, __ATOMIC_RELAXED);
+
+    max = __atomic_load_n(&s->max, __ATOMIC_RELAXED);
+    while (value > max &&
+           !__atomic_compare_exchange_n(&s->max, &max, value, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+/* Sums up the shards.  Concurrent adds may or may not be included. */
+static int64_t histogram_totals(comdb2_histogram *h, int64_t *buckets, int64_t *sum, int64_t *max)
+{
+    int64_t count = 0;
+
+    memset(buckets, 0, sizeof(int64_t) * HIST_NBUCKETS);
+    *sum = *max = 0;
+    for (int i = 0; i < HIST_NSHARDS; i++) {
+        struct histogram_shard *s = &h->shards[i];
+        for (int b = 0; b < HIST_NBUCKETS; b++) {
+            int64_t n = __atomic_load_n(&s->buckets[b], __ATOMIC_RELAXED);
+            buckets[b] += n;
+            count += n;
+        }
+        *sum += __atomic_load_n(&s->sum, __ATOMIC_RELAXED);
+        int64_t m = __atomic_load_n(&s->max, __ATOMIC_RELAXED);
+        if (m > *max)
+            *max = m;
+    }
+    return count;
+}
+
+static int64_t percentile(const int64_t *buckets, int64_t count, int64_t max, double pct)
+{
+    int64_t want, seen = 0;
+
+    if (count == 0)
+        return 0;
+    want = (int64_t)(count * pct / 100.0 + 0.5);
+    if (want < 1)
+        want = 1;
+    for (int b = 0; b < HIST_NBUCKETS; b++) {
+        seen += buckets[b];
+        if (seen >= want) {
+            int64_t v = bucket_value(b);
+            return v < max ? v : max;
+        }
+    }
+    return max;
+}
+
+int64_t comdb2_histogram_percentile(comdb2_histogram *h, double pct)
+{
+    int64_t buckets[HIST_NBUCKETS];
+    int64_t sum, max, count;
+
+    count = histogram_totals(h, buckets, &sum, &max);
+    return percentile(buckets, count, max, pct);
+}
+
+void comdb2_histogram_clear(comdb2_histogram *h)
+{
+    for (int i = 0; i < HIST_NSHARDS; i++) {
+        struct histogram_shard *s = &h->shards[i];
+        for (int b = 0; b < HIST_NBUCKETS; b++)
+            __atomic_store_n(&s->buckets[b], 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&s->sum, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&s->max, 0, __ATOMIC_RELAXED);
+    }
+}
+
+int comdb2_histogram_get_stats(comdb2_histogram_stats **stats, int *nstats)
+{
+    comdb2_histogram_stats *out;
+    comdb2_histogram *h;
+    int64_t buckets[HIST_NBUCKETS];
+    int n = 0;
+
+    pthread_once(&histograms_once, init_histograms);
+
+    Pthread_mutex_lock(&histograms_lk);
+    out = calloc(histograms.count ? histograms.count : 1, sizeof(comdb2_histogram_stats));
+    if (out == NULL) {
+        Pthread_mutex_unlock(&histograms_lk);
+        return -1;
+    }
+    LISTC_FOR_EACH(&histograms, h, lnk) {
+        comdb2_histogram_stats *st = &out[n++];
+        int64_t sum, max;
+
+        st->name = strdup(h->name);
+        st->description = strdup(h->description);
+        st->count = histogram_totals(h, buckets, &sum, &max);
+        st->mean = st->count ? (double)sum / st->count : 0;
+        st->p50 = percentile(buckets, st->count, max, 50);
+        st->p90 = percentile(buckets, st->count, max, 90);
+        st->p99 = percentile(buckets, st->count, max, 99);
+        st->p999 = percentile(buckets, st->count, max, 99.9);
+        st->max = max;
+    }
+    Pthread_mutex_unlock(&histograms_lk);
+
+    *stats = out;
+    *nstats = n;
+    return 0;
+}
+
+void comdb2_histogram_stats_free(comdb2_histogram_stats *stats, int nstats)
+{
+    for (int i = 0; i < nstats; i++) {
+        free(stats[i].name);
+        free(stats[i].description);
+    }
+    free(stats);
+}
+
+void comdb2_histograms_init(void)
+{
+    if (gbl_sql_latency_hist)
+        return;
+    gbl_sql_latency_hist = comdb2_histogram_new("sql", "Time to run a SQL statement, including results");
+    gbl_commit_latency_hist = comdb2_histogram_new("commit", "Time to commit a transaction on the master");
+    gbl_lock_wait_hist = comdb2_histogram_new("lock_wait", "Time spent blocked waiting for a lock");
+    gbl_log_flush_hist = comdb2_histogram_new("log_flush", "Time to write and sync the transaction log");
+    gbl_rep_ack_hist = comdb2_histogram_new("rep_ack", "Time the master waits for replicants to acknowledge a commit");
+    gbl_bplog_apply_hist = comdb2_histogram_new("bplog_apply", "Time to apply a block processor log on the master");
+}
@@ -0,0 +1,66 @@
+/*
+   Copyright 2024 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef INCLUDED_HISTOGRAM_H
+#define INCLUDED_HISTOGRAM_H
+
+#include <stdint.h>
+
+/*
+ * Log-linear (HDR style) histograms of latencies in microseconds.  Every
+ * power of two is split into 16 linear sub-buckets, so any recorded value is
+ * reported within ~6% of its real value.  Values are added with relaxed
+ * atomics to one of several shards picked per thread, so recording is cheap
+ * enough for every request and never takes a lock.
+ */
+struct comdb2_histogram;
+typedef struct comdb2_histogram comdb2_histogram;
+
+typedef struct comdb2_histogram_stats {
+    char *name;
+    char *description;
+    int64_t count;
+    double mean;
+    int64_t p50;
+    int64_t p90;
+    int64_t p99;
+    int64_t p999;
+    int64_t max;
+} comdb2_histogram_stats;
+
+comdb2_histogram *comdb2_histogram_new(const char *name, const char *description);
+void comdb2_histogram_add(comdb2_histogram *h, int64_t value);
+/* Lowest value that `pct` percent of the recorded values are at or below */
+int64_t comdb2_histogram_percentile(comdb2_histogram *h, double pct);
+void comdb2_histogram_clear(comdb2_histogram *h);
+
+/* Snapshot of all histograms; free with comdb2_histogram_stats_free() */
+int comdb2_histogram_get_stats(comdb2_histogram_stats **stats, int *nstats);
+void comdb2_histogram_stats_free(comdb2_histogram_stats *stats, int nstats);
+
+/* Histograms recorded by the different layers.  NULL until
+ * comdb2_histograms_init() is called, and comdb2_histogram_add() ignores a
+ * NULL histogram. */
+extern comdb2_histogram *gbl_sql_latency_hist;
+extern comdb2_histogram *gbl_commit_latency_hist;
+extern comdb2_histogram *gbl_lock_wait_hist;
+extern comdb2_histogram *gbl_log_flush_hist;
+extern comdb2_histogram *gbl_rep_ack_hist;
+extern comdb2_histogram *gbl_bplog_apply_hist;
+
+void comdb2_histograms_init(void);
+
+#endif